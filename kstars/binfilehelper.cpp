@@ -18,6 +18,8 @@
 
 #include "binfilehelper.h"
 
+#include <QFile>
+
 #include <kstandarddirs.h>
 #include <kde_file.h>
 #include "byteorder.h"
@@ -26,6 +28,9 @@ class BinFileHelper;
 
 BinFileHelper::BinFileHelper() {
     fileHandle = NULL;
+    mappedFile = NULL;
+    mappedData = NULL;
+    mappedSize = 0;
     init();
 }
 
@@ -36,6 +41,7 @@ BinFileHelper::~BinFileHelper() {
 }
 
 void BinFileHelper::init() {
+    unmapData();
     if(fileHandle)
         fclose(fileHandle);
     fileHandle = NULL;
@@ -69,6 +75,7 @@ bool BinFileHelper::testFileExists( const QString &fileName ) {
 FILE *BinFileHelper::openFile(const QString &fileName) {
     QString FilePath = KStandardDirs::locate( "appdata", fileName );
     init();
+    filePath = FilePath;
     QByteArray b = FilePath.toAscii();
     const char *filepath = b.data();
 
@@ -221,10 +228,54 @@ bool BinFileHelper::readHeader() {
 }
 
 void BinFileHelper::closeFile() {
+    unmapData();
     fclose(fileHandle);
     fileHandle = NULL;
 }
 
+const char *BinFileHelper::mapData() {
+    if( mappedData )
+        return mappedData;
+    if( !fileHandle || !indexUpdated )
+        return NULL;
+
+    mappedFile = new QFile( filePath );
+    if( mappedFile->open( QIODevice::ReadOnly ) && mappedFile->size() > dataOffset ) {
+        mappedSize = mappedFile->size() - dataOffset;
+        mappedData = (const char *) mappedFile->map( dataOffset, mappedSize );
+    }
+
+    if( !mappedData ) {
+        // Could not map the file, so read the whole data region in one go instead
+        delete mappedFile;
+        mappedFile = NULL;
+
+        KDE_fseek( fileHandle, 0, SEEK_END );
+        long size = KDE_ftell( fileHandle ) - dataOffset;
+        if( size <= 0 )
+            return NULL;
+        dataBuffer.resize( size );
+        KDE_fseek( fileHandle, dataOffset, SEEK_SET );
+        if( fread( dataBuffer.data(), size, 1, fileHandle ) != 1 ) {
+            dataBuffer.clear();
+            return NULL;
+        }
+        mappedData = dataBuffer.constData();
+        mappedSize = size;
+    }
+
+    return mappedData;
+}
+
+void BinFileHelper::unmapData() {
+    // Deleting the QFile also removes the memory map
+    delete mappedFile;
+    mappedFile = NULL;
+    dataBuffer.clear();
+    mappedData = NULL;
+    mappedSize = 0;
+}
+
 int BinFileHelper::getErrorNumber() {
     int err = errnum;
     errnum = ERR_NULL;
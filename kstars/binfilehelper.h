@@ -22,10 +22,12 @@
 
 #include <QString>
 #include <QVector>
+#include <QByteArray>
 
 #include <stdio.h>
 
 class QString;
+class QFile;
 
 /**
  *@short   A structure describing a data field in the file
@@ -92,6 +94,35 @@ class BinFileHelper {
 
     void closeFile();
 
+    /**
+     *@short  Make the data region of the file available in memory
+     *
+     *The data region (from getDataOffset() to the end of the file) is memory-mapped
+     *if possible. If the platform cannot map the file, it is read into a buffer with
+     *a single fread() instead. The data stays available till unmapData() or closeFile()
+     *is called.
+     *@note   To be called only after the header has been read
+     *@return Pointer to the first byte of the data region, NULL if an error occurred
+     */
+    const char *mapData();
+
+    /**
+     *@short  Release the memory made available by mapData()
+     */
+    void unmapData();
+
+    /**
+     *@return the size in bytes of the data region made available by mapData(), 0 if none
+     */
+    inline qint64 getMappedSize() { return (mappedData ? mappedSize : 0); }
+
+    /**
+     *@short  Returns a pointer to the first record under the given index ID in the mapped data
+     *@param  id  ID of the index entry
+     *@return Pointer into the mapped data region, NULL if mapData() has not been called
+     */
+    inline const char *getRecordPointer(int id) { return (mappedData ? mappedData + ( getOffset( id ) - dataOffset ) : NULL); }
+
     /**
      *@short   Get error number
      *@return  A number corresponding to the error
@@ -131,6 +162,12 @@ class BinFileHelper {
      */
     inline FILE *getFileHandle() { return fileHandle; }
 
+    /**
+     *@short  Get the full path of the currently open file
+     *@return The path of the file, empty if no file has been opened
+     */
+    inline QString getFilePath() { return filePath; }
+
     /**
      *@short  Returns the offset in the file corresponding to the given index ID
      *@param  id  ID of the index entry whose offset is required
@@ -249,6 +286,11 @@ class BinFileHelper {
     void init();
 
     FILE *fileHandle;                     // Handle to the file.
+    QString filePath;                     // Full path of the currently open file
+    QFile *mappedFile;                    // File object holding the memory map, if mapData() could map the file
+    QByteArray dataBuffer;                // Holds the data region if mapData() had to fall back to reading it
+    const char *mappedData;               // Start of the data region in memory, NULL if not mapped
+    qint64 mappedSize;                    // Size of the data region in memory
     QVector<unsigned long> indexOffset;   // Stores offsets corresponding to each index table entry
     QVector<unsigned int> indexCount;     // Stores number of records under each index table entry
     bool indexUpdated;                    // True if the data from the index, and associated properties have been updated
@@ -32,7 +32,7 @@
 #include "skyobjects/starobject.h"
 #include "skyqpainter.h"
 
-ColorScheme::ColorScheme() : FileName() {
+ColorScheme::ColorScheme() : Generation( 0 ), FileName() {
     //Each color has two names associated with it.  The KeyName is its
     //identification in the QMap, the *.colors file, and the config file.
     //The Name is what appears in the ViewOpsDialog ListBox.
@@ -120,6 +120,7 @@ QString ColorScheme::nameFromKey( const QString &key ) const {
 void ColorScheme::setColor( const QString &key, const QString &color ) {
     //We can blindly insert() the new value; if the key exists, the old value is replaced
     Palette.insert( key, color );
+    ++Generation;
 
     KConfigGroup cg = KGlobal::config()->group( "Colors" );
     cg.writeEntry( key, color );
@@ -285,12 +286,14 @@ void ColorScheme::saveToConfig() {
 
 void ColorScheme::setStarColorMode( int mode ) { 
     StarColorMode = mode;
+    ++Generation;
     Options::setStarColorMode( mode );
     SkyQPainter::initStarImages();
 }
 
 void ColorScheme::setStarColorIntensity( int intens ) { 
     StarColorIntensity = intens;
+    ++Generation;
     Options::setStarColorIntensity( intens );
     SkyQPainter::initStarImages();
 }
@@ -298,6 +301,7 @@ void ColorScheme::setStarColorIntensity( int intens ) {
 void ColorScheme::setStarColorModeIntensity( int mode, int intens) {
     StarColorMode = mode;
     StarColorIntensity = intens;
+    ++Generation;
     Options::setStarColorMode( mode );
     Options::setStarColorIntensity( intens );
     SkyQPainter::initStarImages();
@@ -123,11 +123,18 @@ public:
      */
     void setStarColorModeIntensity( int mode, int intens);
 
+    /**@return a counter which is incremented whenever a color or the star
+     * color mode or intensity changes, so that drawings made with the
+     * scheme can tell whether they are out of date.
+     */
+    unsigned int generation() const { return Generation; }
+
 private:
     /** Append items to all string lists. */
     void appendItem(QString key, QString name, QString def);
 
     int StarColorMode, StarColorIntensity;
+    unsigned int Generation;
     QString FileName;
     QStringList KeyName, Name, Default;
     QMap<QString,QString> Palette;
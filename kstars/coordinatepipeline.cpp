@@ -0,0 +1,304 @@
+/***************************************************************************
+              coordinatepipeline.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "coordinatepipeline.h"
+
+#include <cmath>
+
+#include <QtGlobal>
+
+#include "Options.h"
+#include "skyobjects/skypoint.h"
+#include "skyobjects/starobject.h"
+
+namespace {
+    // Points transformed at a time: the vectors stay in the cache
+    const int chunkSize = 256;
+
+    inline void toXYZ( const dms &ra, const dms &dec, double *v ) {
+        double sinRa, cosRa, sinDec, cosDec;
+        ra.SinCos( sinRa, cosRa );
+        dec.SinCos( sinDec, cosDec );
+        v[0] = cosDec * cosRa;
+        v[1] = cosDec * sinRa;
+        v[2] = sinDec;
+    }
+
+    // c = a b
+    void multiply( const double a[3][3], const double b[3][3], double c[3][3] ) {
+        for ( int i = 0; i < 3; ++i ) {
+            for ( int j = 0; j < 3; ++j )
+                c[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+
+    // Rotation of the axes by an angle about the x axis
+    void rotationX( double angle, double r[3][3] ) {
+        double s = sin( angle ), c = cos( angle );
+        r[0][0] = 1.0; r[0][1] = 0.0; r[0][2] = 0.0;
+        r[1][0] = 0.0; r[1][1] = c;   r[1][2] = s;
+        r[2][0] = 0.0; r[2][1] = -s;  r[2][2] = c;
+    }
+
+    // Rotation of the axes by an angle about the z axis
+    void rotationZ( double angle, double r[3][3] ) {
+        double s = sin( angle ), c = cos( angle );
+        r[0][0] = c;   r[0][1] = s;   r[0][2] = 0.0;
+        r[1][0] = -s;  r[1][1] = c;   r[1][2] = 0.0;
+        r[2][0] = 0.0; r[2][1] = 0.0; r[2][2] = 1.0;
+    }
+
+    inline dms fromRadians( double angle ) {
+        dms a;
+        a.setRadians( angle );
+        return a;
+    }
+}
+
+CoordinatePipeline::CoordinatePipeline( const KSNumbers *num ) :
+    m_num( *num )
+{
+    setEpoch( num );
+    computeHorizon();
+}
+
+void CoordinatePipeline::setEpoch( const KSNumbers *num ) {
+    m_num = *num;
+
+    // Precession from J2000: the transpose of P2, see SkyPoint::precess()
+    double precession[3][3];
+    for ( int i = 0; i < 3; ++i ) {
+        for ( int j = 0; j < 3; ++j )
+            precession[i][j] = num->p2( j, i );
+    }
+
+    // Nutation: to the mean ecliptic, along it by dEcLong, and back to the
+    // equator with the true obliquity
+    double eps = num->obliquity()->radians();
+    double toEcliptic[3][3], shift[3][3], toEquator[3][3], product[3][3], nutation[3][3];
+    rotationX( eps, toEcliptic );
+    rotationZ( -num->dEcLong() * dms::DegToRad, shift );
+    rotationX( -( eps + num->dObliq() * dms::DegToRad ), toEquator );
+    multiply( shift, toEcliptic, product );
+    multiply( toEquator, product, nutation );
+
+    multiply( nutation, precession, m_matrix );
+
+    // Aberration: the velocity of the Earth, from the Sun's true longitude and
+    // the longitude of the perihelion, as in SkyPoint::aberrate()
+    double K = num->constAberr().radians();
+    double e = num->earthEccentricity();
+    double sinL, cosL, sinP, cosP, sinOb, cosOb;
+    num->sunTrueLongitude().SinCos( sinL, cosL );
+    num->earthPerihelionLongitude().SinCos( sinP, cosP );
+    num->obliquity()->SinCos( sinOb, cosOb );
+    double a = sinL - e * sinP;
+    double b = cosL - e * cosP;
+    m_velocity[0] = K * a;
+    m_velocity[1] = -K * b * cosOb;
+    m_velocity[2] = -K * b * sinOb;
+}
+
+void CoordinatePipeline::setHorizon( const dms *LST, const dms *lat ) {
+    if ( LST->Degrees() == m_LST.Degrees() && lat->Degrees() == m_lat.Degrees() )
+        return;
+    m_LST = *LST;
+    m_lat = *lat;
+    computeHorizon();
+}
+
+void CoordinatePipeline::computeHorizon() {
+    double sinLST, cosLST, sinLat, cosLat;
+    m_LST.SinCos( sinLST, cosLST );
+    m_lat.SinCos( sinLat, cosLat );
+
+    // Rows: the North, East and zenith directions in apparent equatorial coordinates
+    m_horizon[0][0] = -sinLat * cosLST;  m_horizon[0][1] = -sinLat * sinLST;  m_horizon[0][2] = cosLat;
+    m_horizon[1][0] = -sinLST;           m_horizon[1][1] = cosLST;            m_horizon[1][2] = 0.0;
+    m_horizon[2][0] = cosLat * cosLST;   m_horizon[2][1] = cosLat * sinLST;   m_horizon[2][2] = sinLat;
+}
+
+void CoordinatePipeline::apparent( double *xyz, int n ) const {
+    const double (*m)[3] = m_matrix;
+    const double *V = m_velocity;
+    for ( int i = 0; i < n; ++i, xyz += 3 ) {
+        double x = m[0][0] * xyz[0] + m[0][1] * xyz[1] + m[0][2] * xyz[2];
+        double y = m[1][0] * xyz[0] + m[1][1] * xyz[1] + m[1][2] * xyz[2];
+        double z = m[2][0] * xyz[0] + m[2][1] * xyz[1] + m[2][2] * xyz[2];
+
+        // Aberration: add the part of the velocity across the line of sight
+        double d = x * V[0] + y * V[1] + z * V[2];
+        x += V[0] - d * x;
+        y += V[1] - d * y;
+        z += V[2] - d * z;
+
+        double norm = 1.0 / sqrt( x * x + y * y + z * z );
+        xyz[0] = x * norm;
+        xyz[1] = y * norm;
+        xyz[2] = z * norm;
+    }
+}
+
+void CoordinatePipeline::toHorizontal( const double *xyz, int n, double *alt, double *az ) const {
+    const double (*h)[3] = m_horizon;
+    for ( int i = 0; i < n; ++i, xyz += 3 ) {
+        double north  = h[0][0] * xyz[0] + h[0][1] * xyz[1] + h[0][2] * xyz[2];
+        double east   = h[1][0] * xyz[0] + h[1][1] * xyz[1];
+        double zenith = h[2][0] * xyz[0] + h[2][1] * xyz[1] + h[2][2] * xyz[2];
+
+        alt[i] = asin( qBound( -1.0, zenith, 1.0 ) );
+        az[i] = atan2( east, north );
+        if ( az[i] < 0.0 )
+            az[i] += 2.0 * dms::PI;
+    }
+}
+
+void CoordinatePipeline::toEquatorial( const double *xyz, int n, double *ra, double *dec ) {
+    for ( int i = 0; i < n; ++i, xyz += 3 ) {
+        ra[i] = atan2( xyz[1], xyz[0] );
+        if ( ra[i] < 0.0 )
+            ra[i] += 2.0 * dms::PI;
+        dec[i] = asin( qBound( -1.0, xyz[2], 1.0 ) );
+    }
+}
+
+void CoordinatePipeline::catalogVectors( SkyPoint *const *points, int n, double *xyz ) {
+    for ( int i = 0; i < n; ++i )
+        toXYZ( points[i]->ra0(), points[i]->dec0(), xyz + 3 * i );
+}
+
+void CoordinatePipeline::properMotion( StarObject *const *stars, int n, const KSNumbers *num, double *xyz ) {
+    // The great circle motion of StarObject::getIndexCoords()
+    for ( int i = 0; i < n; ++i, xyz += 3 ) {
+        StarObject *star = stars[i];
+        double pm = star->pmMagnitude() * num->julianMillenia();   // in arcseconds
+        double rate = sqrt( star->pmRA() * star->pmRA() + star->pmDec() * star->pmDec() );
+        double cosDec = sqrt( xyz[0] * xyz[0] + xyz[1] * xyz[1] );
+        if ( pm == 0.0 || rate == 0.0 || cosDec == 0.0 )
+            continue;
+
+        // Bearing of the motion, from the North through the East
+        double sign = pm > 0.0 ? 1.0 : -1.0;
+        double sinDir = sign * star->pmRA() / rate;
+        double cosDir = sign * star->pmDec() / rate;
+
+        double dst = fabs( pm ) * dms::DegToRad / 3600.0;
+        double sinDst = sin( dst ), cosDst = cos( dst );
+
+        double cosRa = xyz[0] / cosDec, sinRa = xyz[1] / cosDec, sinDec = xyz[2];
+        double tx = -sinDir * sinRa - cosDir * sinDec * cosRa;
+        double ty =  sinDir * cosRa - cosDir * sinDec * sinRa;
+        double tz =  cosDir * cosDec;
+
+        xyz[0] = xyz[0] * cosDst + tx * sinDst;
+        xyz[1] = xyz[1] * cosDst + ty * sinDst;
+        xyz[2] = xyz[2] * cosDst + tz * sinDst;
+    }
+}
+
+void CoordinatePipeline::store( SkyPoint *const *points, int n, const double *xyz, bool horizontal ) const {
+    double ra[ chunkSize ], dec[ chunkSize ], alt[ chunkSize ], az[ chunkSize ];
+    toEquatorial( xyz, n, ra, dec );
+    for ( int i = 0; i < n; ++i ) {
+        points[i]->setRA( fromRadians( ra[i] ) );
+        points[i]->setDec( fromRadians( dec[i] ) );
+    }
+    if ( ! horizontal )
+        return;
+
+    toHorizontal( xyz, n, alt, az );
+    for ( int i = 0; i < n; ++i ) {
+        points[i]->setAlt( fromRadians( alt[i] ) );
+        points[i]->setAz( fromRadians( az[i] ) );
+    }
+}
+
+void CoordinatePipeline::updateCoords( SkyPoint *const *points, int n, bool horizontal ) const {
+    if ( Options::useRelativistic() ) {
+        KSNumbers *num = const_cast<KSNumbers*>( &m_num );
+        for ( int i = 0; i < n; ++i ) {
+            points[i]->updateCoords( num );
+            if ( horizontal )
+                points[i]->EquatorialToHorizontal( &m_LST, &m_lat );
+        }
+        return;
+    }
+
+    double xyz[ 3 * chunkSize ];
+    for ( int start = 0; start < n; start += chunkSize ) {
+        int count = qMin( chunkSize, n - start );
+        catalogVectors( points + start, count, xyz );
+        apparent( xyz, count );
+        store( points + start, count, xyz, horizontal );
+    }
+}
+
+void CoordinatePipeline::updateStars( StarObject *const *stars, int n, bool horizontal ) const {
+    if ( Options::useRelativistic() ) {
+        KSNumbers *num = const_cast<KSNumbers*>( &m_num );
+        for ( int i = 0; i < n; ++i ) {
+            stars[i]->updateCoords( num );
+            if ( horizontal )
+                stars[i]->EquatorialToHorizontal( &m_LST, &m_lat );
+        }
+        return;
+    }
+
+    double xyz[ 3 * chunkSize ];
+    SkyPoint *points[ chunkSize ];
+    for ( int start = 0; start < n; start += chunkSize ) {
+        int count = qMin( chunkSize, n - start );
+        for ( int i = 0; i < count; ++i ) {
+            points[i] = stars[ start + i ];
+            toXYZ( points[i]->ra0(), points[i]->dec0(), xyz + 3 * i );
+        }
+        properMotion( stars + start, count, &m_num, xyz );
+        apparent( xyz, count );
+        store( points, count, xyz, horizontal );
+    }
+}
+
+void CoordinatePipeline::updateHorizontal( SkyPoint *const *points, int n ) const {
+    double xyz[ 3 * chunkSize ], alt[ chunkSize ], az[ chunkSize ];
+    for ( int start = 0; start < n; start += chunkSize ) {
+        int count = qMin( chunkSize, n - start );
+        for ( int i = 0; i < count; ++i )
+            toXYZ( points[ start + i ]->ra(), points[ start + i ]->dec(), xyz + 3 * i );
+        toHorizontal( xyz, count, alt, az );
+        for ( int i = 0; i < count; ++i ) {
+            points[ start + i ]->setAlt( fromRadians( alt[i] ) );
+            points[ start + i ]->setAz( fromRadians( az[i] ) );
+        }
+    }
+}
+
+void CoordinatePipeline::indexCoords( StarObject *const *stars, int n, const KSNumbers *num, double *ra, double *dec ) {
+    double xyz[ 3 * chunkSize ];
+    for ( int start = 0; start < n; start += chunkSize ) {
+        int count = qMin( chunkSize, n - start );
+        for ( int i = 0; i < count; ++i ) {
+            const StarObject *star = stars[ start + i ];
+            toXYZ( star->ra0(), star->dec0(), xyz + 3 * i );
+        }
+        properMotion( stars + start, count, num, xyz );
+        toEquatorial( xyz, count, ra + start, dec + start );
+        for ( int i = start; i < start + count; ++i ) {
+            ra[i]  /= dms::DegToRad;
+            dec[i] /= dms::DegToRad;
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/***************************************************************************
+               coordinatepipeline.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef COORDINATEPIPELINE_H
+#define COORDINATEPIPELINE_H
+
+#include "dms.h"
+#include "ksnumbers.h"
+
+class SkyPoint;
+class StarObject;
+
+/**
+ *@class CoordinatePipeline
+ *
+ *Computes the apparent coordinates of many points at once, for one epoch.
+ *
+ *SkyPoint::updateCoords() precesses, nutates and aberrates each point with
+ *its own spherical trigonometry. Here precession and nutation are folded
+ *into one rotation matrix, built once from a KSNumbers, and the points are
+ *handled as unit vectors: the catalog vector is rotated by the matrix, then
+ *aberration is added as a shift along the velocity of the Earth. Only the
+ *final RA/Dec, or Alt/Az through the matrix of the local horizon, need
+ *inverse trigonometric functions.
+ *
+ *Nutation is the exact rotation for all declinations. The per-object path
+ *uses a first order formula below 80 degrees of declination, where both
+ *agree within a few hundredths of an arcsecond, and the same rotation above.
+ *Its aberration is first order in RA/Dec too, so within a degree of the
+ *poles the two paths differ by about 0.06 arcseconds divided by the
+ *distance to the pole in degrees.
+ *
+ *While Options::useRelativistic() is set, the points are handed to
+ *SkyPoint::updateCoords() instead, which bends the light passing near the Sun.
+ *
+ *@short Batched precession, nutation and aberration of SkyPoints
+ *@version 1.0
+ */
+
+class CoordinatePipeline {
+
+ public:
+
+    /**
+     *Constructor
+     *@param num the epoch of the apparent coordinates
+     */
+    explicit CoordinatePipeline( const KSNumbers *num );
+
+    /**
+     *@short Set the epoch of the apparent coordinates
+     */
+    void setEpoch( const KSNumbers *num );
+
+    /** @return the epoch of the pipeline */
+    const KSNumbers* epoch() const { return &m_num; }
+
+    /**
+     *@short Set the local sidereal time and the latitude used by the
+     *horizontal coordinates. Both are 0 until set.
+     */
+    void setHorizon( const dms *LST, const dms *lat );
+
+    /**
+     *@short Turn catalog (J2000) unit vectors into apparent ones: the
+     *precession-nutation matrix, then aberration
+     *@param xyz n unit vectors, three doubles each, replaced in place
+     *@param n the number of vectors
+     */
+    void apparent( double *xyz, int n ) const;
+
+    /**
+     *@short The horizontal coordinates of apparent unit vectors
+     *@param xyz n apparent unit vectors, three doubles each
+     *@param n the number of vectors
+     *@param alt the altitudes, in radians
+     *@param az the azimuths, in radians from the North through the East
+     */
+    void toHorizontal( const double *xyz, int n, double *alt, double *az ) const;
+
+    /**
+     *@short The RA/Dec of unit vectors
+     *@param xyz n unit vectors, three doubles each
+     *@param n the number of vectors
+     *@param ra the right ascensions, in radians from 0 to 2 pi
+     *@param dec the declinations, in radians
+     */
+    static void toEquatorial( const double *xyz, int n, double *ra, double *dec );
+
+    /**
+     *@short The unit vectors of the catalog coordinates RA0/Dec0 of points
+     *@param xyz three doubles per point
+     */
+    static void catalogVectors( SkyPoint *const *points, int n, double *xyz );
+
+    /**
+     *@short The same as SkyPoint::updateCoords() on each point, and
+     *EquatorialToHorizontal() if horizontal is true
+     *@param points the points. Their updateCoords() must not be overridden:
+     *use updateStars() for stars.
+     */
+    void updateCoords( SkyPoint *const *points, int n, bool horizontal = true ) const;
+
+    /**
+     *@short The same as StarObject::updateCoords() on each star, proper
+     *motion included, and EquatorialToHorizontal() if horizontal is true
+     */
+    void updateStars( StarObject *const *stars, int n, bool horizontal = true ) const;
+
+    /**
+     *@short The same as SkyPoint::EquatorialToHorizontal() on each point
+     */
+    void updateHorizontal( SkyPoint *const *points, int n ) const;
+
+    /**
+     *@short The same as StarObject::getIndexCoords() on each star: the J2000
+     *position moved by the proper motion up to an epoch
+     *@param ra, dec the coordinates, in degrees
+     */
+    static void indexCoords( StarObject *const *stars, int n, const KSNumbers *num, double *ra, double *dec );
+
+ private:
+
+    /** @short Move the catalog vectors of stars by their proper motion */
+    static void properMotion( StarObject *const *stars, int n, const KSNumbers *num, double *xyz );
+
+    /** @short Fill the matrix of the horizon from m_LST and m_lat */
+    void computeHorizon();
+
+    /** @short Write the RA/Dec, and Alt/Az if asked, of apparent vectors into points */
+    void store( SkyPoint *const *points, int n, const double *xyz, bool horizontal ) const;
+
+    KSNumbers m_num;
+    double m_matrix[3][3];      // Precession, then nutation
+    double m_velocity[3];       // Velocity of the Earth over c, equatorial
+    double m_horizon[3][3];     // Apparent equatorial to (North, East, Zenith)
+    dms m_LST, m_lat;           // Of m_horizon
+};
+
+#endif
@@ -29,6 +29,7 @@
 #include "skyobjects/skyobject.h"
 #include "skycomponents/starcomponent.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/nameindex.h"
 
 FindDialogUI::FindDialogUI( QWidget *parent ) : QFrame( parent ) {
     setupUi( this );
@@ -141,87 +142,70 @@ void FindDialog::initSelection() {
     listFiltered = true;
 }
 
-void FindDialog::filterByType() {
-    KStarsData *data = KStarsData::Instance();
-
+qint64 FindDialog::typeMask() const {
     switch ( ui->FilterType->currentIndex() ) {
-    case 0: // All object types
-        {
-            QStringList allObjects;
-            foreach( int type, data->skyComposite()->objectNames().keys() )
-                allObjects += data->skyComposite()->objectNames( type );
-            fModel->setStringList( allObjects );
-            break;
-        }
     case 1: //Stars
-        {
-            QStringList starObjects;
-            starObjects += data->skyComposite()->objectNames( SkyObject::STAR );
-            starObjects += data->skyComposite()->objectNames( SkyObject::CATALOG_STAR );
-            fModel->setStringList( starObjects );
-            break;
-        }
+        return NameIndex::typeMask( SkyObject::STAR ) | NameIndex::typeMask( SkyObject::CATALOG_STAR );
     case 2: //Solar system
-        {
-            QStringList ssObjects;
-            ssObjects += data->skyComposite()->objectNames( SkyObject::PLANET );
-            ssObjects += data->skyComposite()->objectNames( SkyObject::COMET );
-            ssObjects += data->skyComposite()->objectNames( SkyObject::ASTEROID );
-            ssObjects += data->skyComposite()->objectNames( SkyObject::MOON );
-            ssObjects += i18n("Sun");
-            fModel->setStringList( ssObjects );
-            break;
-        }
+        return NameIndex::typeMask( SkyObject::PLANET ) | NameIndex::typeMask( SkyObject::COMET ) |
+               NameIndex::typeMask( SkyObject::ASTEROID ) | NameIndex::typeMask( SkyObject::MOON );
     case 3: //Open Clusters
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::OPEN_CLUSTER ) );
-        break;
-    case 4: //Open Clusters
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::GLOBULAR_CLUSTER ) );
-        break;
+        return NameIndex::typeMask( SkyObject::OPEN_CLUSTER );
+    case 4: //Globular Clusters
+        return NameIndex::typeMask( SkyObject::GLOBULAR_CLUSTER );
     case 5: //Gaseous nebulae
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::GASEOUS_NEBULA ) );
-        break;
+        return NameIndex::typeMask( SkyObject::GASEOUS_NEBULA );
     case 6: //Planetary nebula
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::PLANETARY_NEBULA ) );
-        break;
+        return NameIndex::typeMask( SkyObject::PLANETARY_NEBULA );
     case 7: //Galaxies
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::GALAXY ) );
-        break;
+        return NameIndex::typeMask( SkyObject::GALAXY );
     case 8: //Comets
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::COMET ) );
-        break;
+        return NameIndex::typeMask( SkyObject::COMET );
     case 9: //Asteroids
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::ASTEROID ) );
-        break;
+        return NameIndex::typeMask( SkyObject::ASTEROID );
     case 10: //Constellations
-        fModel->setStringList( data->skyComposite()->objectNames( SkyObject::CONSTELLATION ) );
-        break;
+        return NameIndex::typeMask( SkyObject::CONSTELLATION );
+    default: // All object types
+        return NameIndex::AllTypes;
     }
 }
 
+void FindDialog::filterByType() {
+    NameIndex &index = KStarsData::Instance()->skyComposite()->nameIndex();
+    fModel->setStringList( index.names( QString(), typeMask() ) );
+}
+
 void FindDialog::filterList() {  
     QString SearchText;
     SearchText = processSearchText();
-    sortModel->setFilterFixedString( SearchText );
-    filterByType();
+
+    //The index lists the names with a word starting with the search text;
+    //if there is none, it may be misspelt, so list the closest names
+    NameIndex &index = KStarsData::Instance()->skyComposite()->nameIndex();
+    QStringList items = index.names( SearchText, typeMask() );
+    if ( items.isEmpty() )
+        items = index.fuzzy( SearchText, 2, typeMask() );
+    fModel->setStringList( items );
     initSelection();
 
-    //Select the first item in the list that begins with the filter string
-    if ( !SearchText.isEmpty() ) {
-        QStringList mItems = fModel->stringList().filter( QRegExp( '^'+SearchText, Qt::CaseInsensitive ) );
-        mItems.sort();
-    
-        if ( mItems.size() ) {
-            QModelIndex qmi = fModel->index( fModel->stringList().indexOf( mItems[0] ) );
-            QModelIndex selectItem = sortModel->mapFromSource( qmi );
-    
-            if ( selectItem.isValid() ) {
-                ui->SearchList->selectionModel()->select( selectItem, QItemSelectionModel::ClearAndSelect );
-                ui->SearchList->scrollTo( selectItem );
-                ui->SearchList->setCurrentIndex( selectItem );
-                button( Ok )->setEnabled( true );
+    //Select the first item in the list that begins with the search text,
+    //or else the first one
+    if ( !SearchText.isEmpty() && items.size() ) {
+        int row = 0;
+        for ( int i = 0; i < items.size(); ++i ) {
+            if ( items[i].startsWith( SearchText, Qt::CaseInsensitive ) ) {
+                row = i;
+                break;
             }
         }
+        QModelIndex selectItem = sortModel->mapFromSource( fModel->index( row ) );
+
+        if ( selectItem.isValid() ) {
+            ui->SearchList->selectionModel()->select( selectItem, QItemSelectionModel::ClearAndSelect );
+            ui->SearchList->scrollTo( selectItem );
+            ui->SearchList->setCurrentIndex( selectItem );
+            button( Ok )->setEnabled( true );
+        }
     }
 
     listFiltered = true;
@@ -103,6 +103,9 @@ private:
      */
     void filterByType();
 
+    /** @return the mask of the object types selected in the type combobox */
+    qint64 typeMask() const;
+
     FindDialogUI* ui;
     SkyObject* currentitem;
     QStringListModel *fModel;
@@ -229,9 +229,6 @@ FITSHistogramCommand::FITSHistogramCommand(QWidget * parent, FITSHistogram *inHi
     viewer    = (FITSViewer *) parent;
     type      = newType;
     histo     = inHisto;
-    //oldImage  = new QImage();
-    // TODO apply maximum compression against this buffer
-    buffer = (float *) malloc (viewer->image->getWidth() * viewer->image->getHeight() * sizeof(float));
 
     min = lmin;
     max = lmax;
@@ -240,81 +237,15 @@ FITSHistogramCommand::FITSHistogramCommand(QWidget * parent, FITSHistogram *inHi
 
 FITSHistogramCommand::~FITSHistogramCommand()
 {
-    free(buffer);
-    //delete (oldImage);
 }
 
 void FITSHistogramCommand::redo()
 {
 
-    float val, bufferVal;
-    double coeff;
     FITSImage *image = viewer->image;
-    float *image_buffer = image->getImageBuffer();
-    int width  = image->getWidth();
-    int height = image->getHeight();
 
-    /*
-    if (buffer == NULL)
-    {
-     // TODO how to remove this item from redo/undo history?
-     KMessageBox(0, i18n("There is no enough memory to perform this operation."));
-     return;
-    }
-    */
-
-    memcpy(buffer, image_buffer, width * height * sizeof(float));
-    //*oldImage = image->displayImage->copy();
-
-    switch (type)
-    {
-    case FITSImage::FITSAuto:
-    case FITSImage::FITSLinear:
-        for (int i=0; i < height; i++)
-            for (int j=0; j < width; j++)
-            {
-                bufferVal = image_buffer[i * width + j];
-                if (bufferVal < min) bufferVal = min;
-                else if (bufferVal > max) bufferVal = max;
-                image_buffer[i * width + j] = bufferVal;
-
-            }
-        break;
-
-    case FITSImage::FITSLog:
-        coeff = max / log(1 + max);
-
-        for (int i=0; i < height; i++)
-            for (int j=0; j < width; j++)
-            {
-                bufferVal = image_buffer[i * width + j];
-                if (bufferVal < min) bufferVal = min;
-                else if (bufferVal > max) bufferVal = max;
-                val = (coeff * log(1 + bufferVal));
-                if (val < min) val = min;
-                else if (val > max) val = max;
-                image_buffer[i * width + j] = val;
-            }
-        break;
-
-    case FITSImage::FITSSqrt:
-        coeff = max / sqrt(max);
-
-        for (int i=0; i < height; i++)
-            for (int j=0; j < width; j++)
-            {
-                bufferVal = (int) image_buffer[i * width + j];
-                if (bufferVal < min) bufferVal = min;
-                else if (bufferVal > max) bufferVal = max;
-                val = (int) (coeff * sqrt(bufferVal));
-                image_buffer[i * width + j] = val;
-            }
-        break;
-
-
-    default:
-        break;
-    }
+    // The stretch is applied on top of the raw image, nothing is copied for undo
+    image->pushOperation(FITSPipeline::Operation(type, min, max));
 
     image->rescale(FITSImage::ZOOM_KEEP_LEVEL);
 
@@ -328,7 +259,7 @@ void FITSHistogramCommand::undo()
 {
 
     FITSImage *image = viewer->image;
-    memcpy( image->getImageBuffer(), buffer, image->getWidth() * image->getHeight() * sizeof(float));
+    image->popOperation();
     image->rescale(FITSImage::ZOOM_KEEP_LEVEL);
     image->calculateStats();
 
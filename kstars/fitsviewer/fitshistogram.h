@@ -93,7 +93,6 @@ private:
     FITSHistogram *histo;
     int type;
     int min, max;
-    float *buffer;
     FITSViewer *viewer;
 };
 
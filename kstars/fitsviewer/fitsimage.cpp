@@ -40,7 +40,9 @@
 #include <KFileDialog>
 
 #include "fitsviewer.h"
+#include "fitskernels.h"
 #include "ksutils.h"
+#include "Options.h"
 
 #define ZOOM_DEFAULT	100.0
 #define ZOOM_MIN	10
@@ -88,8 +90,10 @@ FITSImage::FITSImage(QWidget * parent) : QScrollArea(parent) , zoomFactor(1.2)
     viewer = (FITSViewer *) parent;
 
     image_frame = new FITSLabel(this);
-    image_buffer = NULL;
     displayImage = NULL;
+    fptr = NULL;
+    fitsDataPtr = NULL;
+    fitsDataSize = 0;
     setBackgroundRole(QPalette::Dark);
 
     currentZoom = 0.0;
@@ -102,16 +106,38 @@ FITSImage::FITSImage(QWidget * parent) : QScrollArea(parent) , zoomFactor(1.2)
 
 FITSImage::~FITSImage()
 {
-    int status;
+    closeFits();
 
-    if (fits_close_file(fptr, &status))
+    delete(displayImage);
+}
+
+void FITSImage::closeFits()
+{
+    int status=0;
+
+    if (fptr && fits_close_file(fptr, &status))
         fits_report_error(stderr, status);
 
-    delete(image_buffer);
-    delete(displayImage);
+    fptr = NULL;
+    fitsData.clear();
+    fitsDataPtr = NULL;
+    fitsDataSize = 0;
 }
 
 int FITSImage::loadFits ( const QString &filename )
+{
+    return openFits(filename, QByteArray());
+}
+
+int FITSImage::loadFits ( const QByteArray &data, const QString &name )
+{
+    if (data.isEmpty())
+        return -1;
+
+    return openFits(name, data);
+}
+
+int FITSImage::openFits ( const QString &filename, const QByteArray &data )
 {
 
     int status=0, nulval=0, anynull=0;
@@ -125,8 +151,23 @@ int FITSImage::loadFits ( const QString &filename )
      fitsProg.setValue(30);
      //qApp->processEvents(QEventLoop::ExcludeSocketNotifiers);
 
-    if (fits_open_image(&fptr, filename.toAscii(), READONLY, &status))
+    closeFits();
+
+    if (data.isEmpty())
+        fits_open_image(&fptr, filename.toAscii(), READONLY, &status);
+    else
+    {
+        // Read only, so cfitsio never writes to nor reallocates the shared data
+        fitsData     = data;
+        fitsDataPtr  = (void *) fitsData.constData();
+        fitsDataSize = fitsData.size();
+        fits_open_memfile(&fptr, filename.toAscii(), READONLY, &fitsDataPtr, &fitsDataSize, 0, NULL, &status);
+    }
+
+    if (status)
     {
+        fptr = NULL;
+        fitsData.clear();
         fits_report_error(stderr, status);
         fits_get_errstatus(status, error_status);
         KMessageBox::error(0, i18n("FITS file open error: %1", QString::fromUtf8(error_status)), i18n("FITS Open"));
@@ -166,14 +207,14 @@ int FITSImage::loadFits ( const QString &filename )
 
     //kDebug() << "bitpix: " << stats.bitpix << " dim[0]: " << stats.dim[0] << " dim[1]: " << stats.dim[1] << " ndim: " << stats.ndim << " Image Type: " << data_type;
 
-    delete (image_buffer);
+    // Drop the previous frame and its processing history before allocating the new one
+    pipeline.reset(NULL, 0, 0);
     delete (displayImage);
-    image_buffer = NULL;
     displayImage = NULL;
 
-    image_buffer = new float[stats.dim[0] * stats.dim[1]];
+    float *buffer = new float[stats.dim[0] * stats.dim[1]];
 
-    if (image_buffer == NULL)
+    if (buffer == NULL)
     {
 	// Display error message here after freeze
         kDebug() << "Not enough memory for image_buffer";
@@ -186,13 +227,15 @@ int FITSImage::loadFits ( const QString &filename )
     {
 	// Display error message here after freeze
         kDebug() << "Not enough memory for display_image";
+        delete [] buffer;
 	return -1;
     }
 
     if (fitsProg.wasCanceled())
     {
-      delete (image_buffer);
+      delete [] buffer;
       delete (displayImage);
+      displayImage = NULL;
       return -1;
     }
 
@@ -208,19 +251,25 @@ int FITSImage::loadFits ( const QString &filename )
     fpixel[0] = 1;
     fpixel[1] = 1;
 
-    if (fits_read_pix(fptr, TFLOAT, fpixel, nelements, &nulval, image_buffer, &anynull, &status))
+    if (fits_read_pix(fptr, TFLOAT, fpixel, nelements, &nulval, buffer, &anynull, &status))
     {
         fits_report_error(stderr, status);
+        delete [] buffer;
         return -1;
     }
 
     if (fitsProg.wasCanceled())
     {
-      delete (image_buffer);
+      delete [] buffer;
       delete (displayImage);
+      displayImage = NULL;
       return -1;
     }
 
+    // The pixels of the file are kept untouched, stretches are applied on top of them
+    pipeline.reset(buffer, stats.dim[0], stats.dim[1]);
+    pipeline.setCacheLimit(qint64(Options::fitsCacheSize()) * 1024 * 1024);
+
     fitsProg.setValue(80);
     //qApp->processEvents(QEventLoop::ExcludeSocketNotifiers);
 
@@ -235,8 +284,9 @@ int FITSImage::loadFits ( const QString &filename )
 
     if (fitsProg.wasCanceled())
     {
-      delete (image_buffer);
+      pipeline.reset(NULL, 0, 0);
       delete (displayImage);
+      displayImage = NULL;
       return -1;
     }
 
@@ -246,8 +296,9 @@ int FITSImage::loadFits ( const QString &filename )
 
     if (fitsProg.wasCanceled())
     {
-      delete (image_buffer);
+      pipeline.reset(NULL, 0, 0);
       delete (displayImage);
+      displayImage = NULL;
       return -1;
     }
 
@@ -266,6 +317,9 @@ int FITSImage::saveFITS( const QString &filename )
     long fpixel[2], nelements;
     fitsfile *new_fptr;
 
+    if (fptr == NULL)
+        return -1;
+
     nelements = stats.dim[0] * stats.dim[1];
     fpixel[0] = 1;
     fpixel[1] = 1;
@@ -293,9 +347,13 @@ int FITSImage::saveFITS( const QString &filename )
     }
 
     fptr = new_fptr;
+    /* The image no longer needs the memory it was read from */
+    fitsData.clear();
+    fitsDataPtr = NULL;
+    fitsDataSize = 0;
 
     /* Write Data */
-    if (fits_write_pix(fptr, TFLOAT, fpixel, nelements, image_buffer, &status))
+    if (fits_write_pix(fptr, TFLOAT, fpixel, nelements, pipeline.output(), &status))
     {
         fits_report_error(stderr, status);
         return -1;
@@ -338,7 +396,6 @@ int FITSImage::saveFITS( const QString &filename )
 int FITSImage::calculateMinMax(bool refresh)
 {
     int status, nfound=0;
-    long npixels;
 
     status = 0;
 
@@ -359,15 +416,11 @@ int FITSImage::calculateMinMax(bool refresh)
             return 0;
     }
 
-    npixels  = stats.dim[0] * stats.dim[1];         /* number of pixels in the image */
-    stats.min= 1.0E30;
-    stats.max= -1.0E30;
+    if (!pipeline.output()) return -1;
 
-    for (int i=0; i < npixels; i++)
-    {
-        if (image_buffer[i] < stats.min) stats.min = image_buffer[i];
-        else if (image_buffer[i] > stats.max) stats.max = image_buffer[i];
-    }
+    FITSKernels::Statistics result = FITSKernels::statistics(pipeline.output(), stats.dim[0], stats.dim[1]);
+    stats.min = result.min;
+    stats.max = result.max;
 
     kDebug() << "DATAMIN: " << stats.min << " - DATAMAX: " << stats.max;
     return 0;
@@ -375,8 +428,6 @@ int FITSImage::calculateMinMax(bool refresh)
 
 int FITSImage::rescale(zoomType type)
 {
-    float val=0;
-    double bscale, bzero;
     QAction *toolAction = NULL;
 
     // Get Min Max failed, scaling is not possible
@@ -403,20 +454,12 @@ int FITSImage::rescale(zoomType type)
         return -1;
     }
 
-    bscale = 255. / (stats.max - stats.min);
-    bzero  = (-stats.min) * (255. / (stats.max - stats.min));
-
     image_frame->setScaledContents(true);
     currentWidth  = displayImage->width();
     currentHeight = displayImage->height();
 
     /* Fill in pixel values using indexed map, linear scale */
-    for (int j = 0; j < stats.dim[1]; j++)
-        for (int i = 0; i < stats.dim[0]; i++)
-        {
-            val = image_buffer[j * stats.dim[0] + i];
-            displayImage->setPixel(i, j, ((int) (val * bscale + bzero)));
-        }
+    FITSKernels::mapTo8Bit(pipeline.output(), stats.min, stats.max, displayImage);
 
     switch (type)
     {
@@ -550,57 +593,12 @@ void FITSImage::fitsZoomDefault()
 
 void FITSImage::calculateStats()
 {
+    if (!pipeline.output()) return;
 
-    // #1 call average, average is used in std deviation
-    stats.average = average();
-    // #2 call std deviation
-    stats.stddev  = stddev();
-
-}
-
-double FITSImage::average()
-{
-
-    double sum=0;
-    int row=0;
-    int width   = stats.dim[0];
-    int height  = stats.dim[1];
-
-    if (!image_buffer) return -1;
-
-    for (int i= 0 ; i < height; i++)
-    {
-        row = (i * width);
-        for (int j= 0; j < width; j++)
-            sum += image_buffer[row+j];
-    }
-
-    return (sum / (width * height ));
-
-}
-
-double FITSImage::stddev()
-{
-
-    int row=0;
-    double lsum=0;
-    int width   = stats.dim[0];
-    int height  = stats.dim[1];
-
-    if (!image_buffer) return -1;
-
-    for (int i= 0 ; i < height; i++)
-    {
-        row = (i * width);
-        for (int j= 0; j < width; j++)
-        {
-            lsum += (image_buffer[row + j] - stats.average) * (image_buffer[row+j] - stats.average);
-        }
-    }
-
-    return (sqrt(lsum/(width * height - 1)));
-
-
+    // Average and standard deviation in a single pass over the image
+    FITSKernels::Statistics result = FITSKernels::statistics(pipeline.output(), stats.dim[0], stats.dim[1]);
+    stats.average = result.average;
+    stats.stddev  = result.stddev;
 }
 
 void FITSImage::setFITSMinMax(double newMin,  double newMax)
@@ -614,6 +612,9 @@ int FITSImage::getFITSRecord(QString &recordList, int &nkeys)
     char *header;
     int status=0;
 
+    if (fptr == NULL)
+        return -1;
+
     if (fits_hdr2str(fptr, 0, NULL, 0, &header, &nkeys, &status))
     {
         fits_report_error(stderr, status);
@@ -20,6 +20,7 @@
 #ifndef FITSIMAGE_H_
 #define FITSIMAGE_H_
 
+#include <QByteArray>
 #include <QFrame>
 #include <QImage>
 #include <QPixmap>
@@ -39,6 +40,8 @@
 
 #include <fitsio.h>
 
+#include "fitspipeline.h"
+
 class FITSViewer;
 class FITSImage;
 
@@ -68,18 +71,26 @@ public:
 
     /* Loads FITS image, scales it, and displays it in the GUI */
     int  loadFits(const QString &filename);
+    /* Loads FITS image from memory through cfitsio's memory files. The data is shared, not copied */
+    int  loadFits(const QByteArray &data, const QString &name);
     /* Save FITS */
     int saveFITS(const QString &filename);
-    /* Rescale image lineary from image_buffer, fit to window if desired */
+    /* Rescale image lineary from the image buffer, fit to window if desired */
     int rescale(zoomType type);
     /* Calculate stats */
     void calculateStats();
+    /* Apply a stretch on top of the current ones */
+    void pushOperation(const FITSPipeline::Operation &op) { pipeline.push(op); }
+    /* Remove the last stretch applied */
+    void popOperation() { pipeline.pop(); }
+    /* Keep the stretches applied, they can no longer be undone */
+    void commitOperations() { pipeline.commit(); }
 
 
     // Access functions
     FITSViewer * getViewer() { return viewer; }
     double getCurrentZoom() { return currentZoom; }
-    float * getImageBuffer() { return image_buffer; }
+    float * getImageBuffer() { return pipeline.output(); }
     void getFITSSize(double *w, double *h) { *w = stats.dim[0]; *h = stats.dim[1]; }
     void getFITSMinMax(double *min, double *max) { *min = stats.min; *max = stats.max; }
     long getWidth() { return stats.dim[0]; }
@@ -111,19 +122,23 @@ public slots:
 
 private:
 
-    double average();
-    double stddev();
-
     int calculateMinMax(bool refresh=false);
+    /* Opens the file, or the data if not empty, and reads the image */
+    int openFits(const QString &filename, const QByteArray &data);
+    /* Closes the FITS file and releases the memory it was read from */
+    void closeFits();
 
     FITSViewer *viewer;                 /* parent FITSViewer */
     FITSLabel *image_frame;
-    float *image_buffer;				/* scaled image buffer (0-255) range */
+    FITSPipeline pipeline;             /* raw image buffer and the stretches applied to it */
 
     double currentWidth,currentHeight; /* Current width and height due to zoom */
     const double zoomFactor;           /* Image zoom factor */
     double currentZoom;                /* Current Zoom level */
     fitsfile* fptr;
+    QByteArray fitsData;               /* Memory the file is read from, if any */
+    void *fitsDataPtr;                 /* cfitsio keeps the address of these two */
+    size_t fitsDataSize;
     int data_type;                     /* FITS data type when opened */
     QImage  *displayImage;             /* FITS image that is displayed in the GUI */
 };
@@ -0,0 +1,238 @@
+/***************************************************************************
+                          fitskernels.cpp  -  FITS Image
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "fitskernels.h"
+
+#include <math.h>
+
+#include <QImage>
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include "fitsimage.h"
+
+namespace {
+    // Rows per tile. Large enough to amortize the thread pool, small enough to balance the load
+    const int TILE_ROWS = 64;
+    // Independent accumulators of the statistics kernel, so that the loop carries no dependency
+    const int LANES = 4;
+
+    struct Tile {
+        long begin, end;        // Range of pixels [begin, end)
+        int firstRow, nRows;
+    };
+
+    QVector<Tile> makeTiles( int width, int height ) {
+        QVector<Tile> tiles;
+        tiles.reserve( ( height + TILE_ROWS - 1 ) / TILE_ROWS );
+        for ( int row = 0; row < height; row += TILE_ROWS ) {
+            Tile t;
+            t.firstRow = row;
+            t.nRows    = qMin( TILE_ROWS, height - row );
+            t.begin    = long( row ) * width;
+            t.end      = t.begin + long( t.nRows ) * width;
+            tiles.append( t );
+        }
+        return tiles;
+    }
+
+    struct TileStatistics {
+        float min, max;
+        double sum, sumSquares;     // Of the pixels minus the shift
+        long count;
+    };
+
+    // Sums are taken relative to a pixel of the image, so that the variance
+    // is not lost in the cancellation of two large sums
+    struct StatisticsKernel {
+        typedef TileStatistics result_type;
+
+        StatisticsKernel( const float *b, float s ) : buffer( b ), shift( s ) {}
+
+        TileStatistics operator()( const Tile &tile ) const {
+            float mn[ LANES ], mx[ LANES ];
+            double s1[ LANES ], s2[ LANES ];
+            for ( int k = 0; k < LANES; ++k ) {
+                mn[ k ] = mx[ k ] = buffer[ tile.begin ];
+                s1[ k ] = s2[ k ] = 0.0;
+            }
+
+            long i = tile.begin;
+            for ( ; i + LANES <= tile.end; i += LANES ) {
+                for ( int k = 0; k < LANES; ++k ) {
+                    float v = buffer[ i + k ];
+                    mn[ k ] = v < mn[ k ] ? v : mn[ k ];
+                    mx[ k ] = v > mx[ k ] ? v : mx[ k ];
+                    double d = v - shift;
+                    s1[ k ] += d;
+                    s2[ k ] += d * d;
+                }
+            }
+            for ( ; i < tile.end; ++i ) {
+                float v = buffer[ i ];
+                mn[ 0 ] = v < mn[ 0 ] ? v : mn[ 0 ];
+                mx[ 0 ] = v > mx[ 0 ] ? v : mx[ 0 ];
+                double d = v - shift;
+                s1[ 0 ] += d;
+                s2[ 0 ] += d * d;
+            }
+
+            TileStatistics t;
+            t.min = mn[ 0 ];
+            t.max = mx[ 0 ];
+            t.sum = t.sumSquares = 0.0;
+            for ( int k = 0; k < LANES; ++k ) {
+                t.min = qMin( t.min, mn[ k ] );
+                t.max = qMax( t.max, mx[ k ] );
+                t.sum += s1[ k ];
+                t.sumSquares += s2[ k ];
+            }
+            t.count = tile.end - tile.begin;
+            return t;
+        }
+
+        const float *buffer;
+        float shift;
+    };
+
+    struct StretchKernel {
+        StretchKernel( float *b, int t, int mn, int mx ) : buffer( b ), type( t ), min( mn ), max( mx ) {}
+
+        void operator()( const Tile &tile ) const {
+            float *p   = buffer + tile.begin;
+            float *end = buffer + tile.end;
+            const float lo = min, hi = max;
+
+            switch ( type ) {
+            case FITSImage::FITSAuto:
+            case FITSImage::FITSLinear:
+                for ( ; p < end; ++p ) {
+                    float v = *p;
+                    v = v < lo ? lo : v;
+                    *p = v > hi ? hi : v;
+                }
+                break;
+
+            case FITSImage::FITSLog: {
+                const double coeff = max / log( 1.0 + max );
+                for ( ; p < end; ++p ) {
+                    float v = *p;
+                    v = v < lo ? lo : v;
+                    v = v > hi ? hi : v;
+                    v = coeff * log( 1.0 + v );
+                    v = v < lo ? lo : v;
+                    *p = v > hi ? hi : v;
+                }
+                break;
+            }
+
+            case FITSImage::FITSSqrt: {
+                const double coeff = max / sqrt( double( max ) );
+                for ( ; p < end; ++p ) {
+                    float v = (int) *p;
+                    v = v < lo ? lo : v;
+                    v = v > hi ? hi : v;
+                    *p = (int) ( coeff * sqrt( v ) );
+                }
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+
+        float *buffer;
+        int type, min, max;
+    };
+
+    // Writes straight into the scanlines; the image is only read from the calling thread
+    struct MapKernel {
+        MapKernel( const float *b, int w, uchar *bi, int bpl, float s, float z ) :
+            buffer( b ), width( w ), bits( bi ), bytesPerLine( bpl ), bscale( s ), bzero( z ) {}
+
+        void operator()( const Tile &tile ) const {
+            for ( int j = tile.firstRow; j < tile.firstRow + tile.nRows; ++j ) {
+                const float *row = buffer + long( j ) * width;
+                uchar *line = bits + long( j ) * bytesPerLine;
+                for ( int i = 0; i < width; ++i ) {
+                    float v = row[ i ] * bscale + bzero;
+                    v = v < 0.0f ? 0.0f : v;
+                    v = v > 255.0f ? 255.0f : v;
+                    line[ i ] = (uchar) v;
+                }
+            }
+        }
+
+        const float *buffer;
+        int width;
+        uchar *bits;
+        int bytesPerLine;
+        float bscale, bzero;
+    };
+}
+
+FITSKernels::Statistics FITSKernels::statistics( const float *buffer, int width, int height ) {
+    Statistics s;
+    s.min = s.max = s.average = s.stddev = 0.0;
+
+    if ( ! buffer || width <= 0 || height <= 0 )
+        return s;
+
+    QVector<Tile> tiles = makeTiles( width, height );
+    QVector<TileStatistics> parts =
+        QtConcurrent::blockingMapped< QVector<TileStatistics> >( tiles, StatisticsKernel( buffer, buffer[ 0 ] ) );
+
+    double sum = 0.0, sumSquares = 0.0;
+    long count = 0;
+    s.min = parts.first().min;
+    s.max = parts.first().max;
+    foreach ( const TileStatistics &t, parts ) {
+        s.min = qMin( s.min, double( t.min ) );
+        s.max = qMax( s.max, double( t.max ) );
+        sum += t.sum;
+        sumSquares += t.sumSquares;
+        count += t.count;
+    }
+
+    s.average = buffer[ 0 ] + sum / count;
+    if ( count > 1 )
+        s.stddev = sqrt( qMax( 0.0, ( sumSquares - sum * sum / count ) / ( count - 1 ) ) );
+    return s;
+}
+
+void FITSKernels::stretch( float *buffer, int width, int height, int type, int min, int max ) {
+    if ( ! buffer || width <= 0 || height <= 0 )
+        return;
+
+    QVector<Tile> tiles = makeTiles( width, height );
+    QtConcurrent::blockingMap( tiles, StretchKernel( buffer, type, min, max ) );
+}
+
+void FITSKernels::mapTo8Bit( const float *buffer, double min, double max, QImage *image ) {
+    if ( ! buffer || ! image || image->isNull() || max == min )
+        return;
+
+    double bscale = 255. / ( max - min );
+    double bzero  = -min * bscale;
+
+    // bits() may detach the image, so call it once before the threads start
+    uchar *bits = image->bits();
+    QVector<Tile> tiles = makeTiles( image->width(), image->height() );
+    QtConcurrent::blockingMap( tiles, MapKernel( buffer, image->width(), bits, image->bytesPerLine(),
+                                                 bscale, bzero ) );
+}
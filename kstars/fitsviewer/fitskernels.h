@@ -0,0 +1,76 @@
+/***************************************************************************
+                          fitskernels.h  -  FITS Image
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FITSKERNELS_H_
+#define FITSKERNELS_H_
+
+class QImage;
+
+/**
+ *Pixel kernels of the FITS viewer.
+ *
+ *Each kernel makes a single pass over the image, which is split into tiles
+ *of rows processed in parallel. The inner loops are branch free so that the
+ *compiler can vectorize them.
+ */
+namespace FITSKernels
+{
+    /**
+     *@short Statistics of an image
+     */
+    struct Statistics
+    {
+        double min, max;
+        double average;
+        double stddev;
+    };
+
+    /**
+     *@short Compute the minimum, maximum, average and standard deviation
+     *of an image in one pass.
+     *@param buffer the pixels, row after row
+     *@param width the width of the image
+     *@param height the height of the image
+     */
+    Statistics statistics( const float *buffer, int width, int height );
+
+    /**
+     *@short Stretch the pixels of an image in place.
+     *
+     *The pixels are clipped to [min, max]. The log and square root
+     *stretches then map them so that max is unchanged.
+     *@param buffer the pixels, row after row
+     *@param width the width of the image
+     *@param height the height of the image
+     *@param type a FITSImage::scaleType
+     *@param min the lowest pixel value kept
+     *@param max the highest pixel value kept
+     */
+    void stretch( float *buffer, int width, int height, int type, int min, int max );
+
+    /**
+     *@short Map the pixels of an image linearly to 8 bits, from min to 0
+     *and from max to 255, straight into the scanlines of an indexed image.
+     *@param buffer the pixels, row after row
+     *@param min the value mapped to 0
+     *@param max the value mapped to 255
+     *@param image an 8 bit indexed image of the size of the buffer
+     */
+    void mapTo8Bit( const float *buffer, double min, double max, QImage *image );
+}
+
+#endif
@@ -0,0 +1,147 @@
+/***************************************************************************
+                          fitspipeline.cpp  -  FITS Image
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "fitspipeline.h"
+
+#include <string.h>
+
+#include "fitskernels.h"
+
+FITSPipeline::FITSPipeline() :
+    m_Raw( 0 ), m_Result( 0 ), m_Width( 0 ), m_Height( 0 ), m_CacheLimit( 0 )
+{}
+
+FITSPipeline::~FITSPipeline() {
+    clearCache();
+    delete [] m_Result;
+    delete [] m_Raw;
+}
+
+void FITSPipeline::reset( float *raw, int width, int height ) {
+    clearCache();
+    m_Operations.clear();
+
+    // The result buffer is only reused for an image of the same size
+    if ( width != m_Width || height != m_Height ) {
+        delete [] m_Result;
+        m_Result = 0;
+    }
+    if ( raw != m_Raw )
+        delete [] m_Raw;
+
+    m_Raw = raw;
+    m_Width = width;
+    m_Height = height;
+}
+
+float* FITSPipeline::output() const {
+    return m_Operations.isEmpty() ? m_Raw : m_Result;
+}
+
+void FITSPipeline::push( const Operation &op ) {
+    if ( ! m_Raw )
+        return;
+
+    if ( m_Operations.isEmpty() ) {
+        if ( ! m_Result )
+            m_Result = new float[ qint64( m_Width ) * m_Height ];
+        memcpy( m_Result, m_Raw, imageBytes() );
+    } else {
+        // Keep the output below the new operation, for undo
+        cacheResult();
+    }
+
+    m_Operations.append( op );
+    apply( op );
+}
+
+void FITSPipeline::pop() {
+    if ( m_Operations.isEmpty() )
+        return;
+
+    m_Operations.removeLast();
+    int target = m_Operations.size();
+
+    // Results deeper than the target used the operation just removed
+    while ( ! m_Cache.isEmpty() && ( m_Cache.end() - 1 ).key() > target )
+        delete [] m_Cache.take( ( m_Cache.end() - 1 ).key() );
+
+    if ( target == 0 )
+        return;
+
+    // Replay from the deepest cached result, or from the raw pixels
+    int start = 0;
+    if ( ! m_Cache.isEmpty() ) {
+        start = ( m_Cache.end() - 1 ).key();
+        memcpy( m_Result, m_Cache.value( start ), imageBytes() );
+    } else {
+        memcpy( m_Result, m_Raw, imageBytes() );
+    }
+
+    for ( int i = start; i < target; ++i )
+        apply( m_Operations.at( i ) );
+}
+
+void FITSPipeline::commit() {
+    if ( m_Operations.isEmpty() )
+        return;
+
+    // The old raw buffer becomes the scratch buffer of the next operations
+    float *old = m_Raw;
+    m_Raw = m_Result;
+    m_Result = old;
+
+    m_Operations.clear();
+    clearCache();
+}
+
+void FITSPipeline::apply( const Operation &op ) {
+    FITSKernels::stretch( m_Result, m_Width, m_Height, op.type, op.min, op.max );
+}
+
+void FITSPipeline::cacheResult() {
+    int d = depth();
+    if ( d == 0 || m_Cache.contains( d ) || imageBytes() > m_CacheLimit )
+        return;
+
+    // Make room by dropping the shallowest results, undo reaches them last
+    trimCache( m_CacheLimit - imageBytes() );
+
+    float *copy = new float[ qint64( m_Width ) * m_Height ];
+    memcpy( copy, m_Result, imageBytes() );
+    m_Cache.insert( d, copy );
+}
+
+void FITSPipeline::setCacheLimit( qint64 bytes ) {
+    m_CacheLimit = qMax( qint64( 0 ), bytes );
+    trimCache( m_CacheLimit );
+}
+
+qint64 FITSPipeline::cacheSize() const {
+    return m_Cache.size() * imageBytes();
+}
+
+void FITSPipeline::trimCache( qint64 limit ) {
+    while ( ! m_Cache.isEmpty() && cacheSize() > limit )
+        delete [] m_Cache.take( m_Cache.begin().key() );
+}
+
+void FITSPipeline::clearCache() {
+    foreach ( float *buffer, m_Cache )
+        delete [] buffer;
+    m_Cache.clear();
+}
@@ -0,0 +1,133 @@
+/***************************************************************************
+                          fitspipeline.h  -  FITS Image
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FITSPIPELINE_H_
+#define FITSPIPELINE_H_
+
+#include <QList>
+#include <QMap>
+
+/**
+ *@class FITSPipeline
+ *Non-destructive processing of a FITS image.
+ *
+ *The pixels read from the file are never modified. The stretches applied
+ *by the user are kept as a stack of operations, and the output is the raw
+ *image with all the operations applied in order. Pushing and popping an
+ *operation costs no memory of its own, so the undo history of the viewer
+ *stays small whatever the size of the image.
+ *
+ *To make undo fast, the intermediate results are cached, up to a memory
+ *limit. Popping an operation restores the cached result below it if there
+ *is one, and otherwise replays the operations from the nearest cached
+ *result (or from the raw image).
+ *@author KStars Developers
+ *@version 1.0
+ */
+class FITSPipeline
+{
+public:
+    /**
+     *@class FITSPipeline::Operation
+     *A stretch of the pixel values.
+     */
+    class Operation {
+    public:
+        Operation( int t = 0, int mn = 0, int mx = 0 ) : type( t ), min( mn ), max( mx ) {}
+
+        int type;           // FITSImage::scaleType
+        int min, max;       // The pixels are clipped to [min, max]
+    };
+
+    /**
+     *@short Constructor. The pipeline is empty until reset() is called.
+     */
+    FITSPipeline();
+
+    ~FITSPipeline();
+
+    /**
+     *@short Start over with a new image. The operations and the cache are cleared.
+     *@param raw the pixels read from the file. The pipeline takes ownership of them.
+     *@param width the width of the image
+     *@param height the height of the image
+     */
+    void reset( float *raw, int width, int height );
+
+    /**
+     *@short Apply an operation on top of the current ones
+     */
+    void push( const Operation &op );
+
+    /**
+     *@short Remove the last operation, going back to the previous output
+     */
+    void pop();
+
+    /**
+     *@short Make the output the new raw image. The operations applied so far
+     *can no longer be removed, and the cache is cleared.
+     */
+    void commit();
+
+    /**
+     *@return the image with all the operations applied, or 0 if there is
+     *no image. It must not be modified, and is valid until the next call
+     *to reset(), push() or pop().
+     */
+    float* output() const;
+
+    /** @return the pixels read from the file */
+    inline const float* raw() const { return m_Raw; }
+
+    /** @return the number of operations applied */
+    inline int depth() const { return m_Operations.size(); }
+
+    /**
+     *@short Set the memory the cached intermediate results may use
+     *@param bytes the limit; 0 disables the cache
+     */
+    void setCacheLimit( qint64 bytes );
+
+    /** @return the memory used by the cached intermediate results, in bytes */
+    qint64 cacheSize() const;
+
+private:
+    /** @return the size of an image, in bytes */
+    inline qint64 imageBytes() const { return qint64( m_Width ) * m_Height * sizeof( float ); }
+
+    /** @short Apply an operation in place on the result buffer */
+    void apply( const Operation &op );
+
+    /** @short Store the result buffer as the output at the current depth, if it fits */
+    void cacheResult();
+
+    /** @short Drop cached results until the cache fits in the limit */
+    void trimCache( qint64 limit );
+
+    /** @short Drop all cached results */
+    void clearCache();
+
+    float *m_Raw;                   // Pixels of the file
+    float *m_Result;                // Output when there are operations, allocated on the first push
+    int m_Width, m_Height;
+    QList<Operation> m_Operations;
+    QMap<int, float*> m_Cache;      // Output after the first n operations, n > 0
+    qint64 m_CacheLimit;
+};
+
+#endif
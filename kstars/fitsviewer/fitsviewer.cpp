@@ -67,7 +67,7 @@
 #include "ksutils.h"
 #include "Options.h"
 
-FITSViewer::FITSViewer (const KUrl *url, QWidget *parent)
+FITSViewer::FITSViewer (const KUrl *url, QWidget *parent, const QByteArray &imageData)
         : KXmlGuiWindow (parent)
 {
     image      = NULL;
@@ -99,7 +99,7 @@ FITSViewer::FITSViewer (const KUrl *url, QWidget *parent)
     statusBar()->setItemAlignment(4 , Qt::AlignLeft);
 
     /* FITS initializations */
-    if (!initFITS()) {
+    if (!initFITS(imageData)) {
         close();
         return;
     } 
@@ -148,22 +148,26 @@ FITSViewer::FITSViewer (const KUrl *url, QWidget *parent)
 FITSViewer::~FITSViewer()
 {}
 
-bool FITSViewer::initFITS()
+bool FITSViewer::initFITS(const QByteArray &imageData)
 {
+    int result;
+
     /* Display image in the central widget */
-    if (image->loadFits(currentURL.path()) == -1)
+    if (imageData.isEmpty())
+        result = image->loadFits(currentURL.path());
+    else
+        result = image->loadFits(imageData, currentURL.isEmpty() ? QString("mem://") : currentURL.fileName());
+
+    if (result == -1)
     {
-        QFile::remove(currentURL.path());
         close();
         return false;
     }
 
-    QFile::remove(currentURL.path());
-
     /* Clear history */
     history->clear();
     /* Set new file caption */
-    setWindowTitle(currentURL.fileName());
+    setWindowTitle(currentURL.isEmpty() ? i18n("Untitled") : currentURL.fileName());
     statusBar()->changeItem( QString("%1 x %2").arg( (int) image->stats.dim[0]).arg( (int) image->stats.dim[1]), 2);
     return true;
 }
@@ -262,6 +266,7 @@ void FITSViewer::fileSave()
 
         m_Dirty = false;
         history->clear();
+        image->commitOperations();
         fitsRestore();
     } else {
         QString message = i18n( "Invalid URL: %1", currentURL.url() );
@@ -291,14 +296,14 @@ void FITSViewer::fitsRestore(bool clean)
 {
     if (clean) {
         m_Dirty = false;
-        setWindowTitle(currentURL.fileName());
+        setWindowTitle(currentURL.isEmpty() ? i18n("Untitled") : currentURL.fileName());
     }
 }
 
 void FITSViewer::fitsChange()
 {
     m_Dirty = true;
-    setWindowTitle(currentURL.fileName() + i18n(" [modified]"));
+    setWindowTitle((currentURL.isEmpty() ? i18n("Untitled") : currentURL.fileName()) + i18n(" [modified]"));
 }
 
 void FITSViewer::fitsStatistics()
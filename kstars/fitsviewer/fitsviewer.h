@@ -20,6 +20,7 @@
 #ifndef FITSViewer_H_
 #define FITSViewer_H_
 
+#include <QByteArray>
 #include <QCloseEvent>
 
 #include <kdialog.h>
@@ -49,8 +50,13 @@ public:
     friend class FITSHistogram;
     friend class FITSHistogramCommand;
 
-    /**Constructor. */
-    FITSViewer (const KUrl *imageName, QWidget *parent);
+    /**Constructor.
+     *@param imageName the FITS file. If imageData is not empty, the file the
+     *image is saved to, or an empty URL if it is not saved.
+     *@param parent the parent widget
+     *@param imageData the content of a FITS file received in memory
+     */
+    FITSViewer (const KUrl *imageName, QWidget *parent, const QByteArray &imageData = QByteArray());
     ~FITSViewer();
 
 protected:
@@ -73,7 +79,7 @@ private slots:
 private:
     /** Ask user whether he wants to save changes and save if he do. */
     void saveUnsaved();
-    bool initFITS();
+    bool initFITS(const QByteArray &imageData = QByteArray());
 
     FITSImage *image;           /* FITS image object */
     FITSHistogram *histogram;   /* FITS Histogram */
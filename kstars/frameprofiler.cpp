@@ -0,0 +1,281 @@
+/***************************************************************************
+                 frameprofiler.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "frameprofiler.h"
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QStringList>
+#include <QtAlgorithms>
+
+#include <kglobalsettings.h>
+#include <klocale.h>
+
+#include "Options.h"
+
+namespace {
+    const char *frameSection = "Frame";
+    // Rows of the overlay, after the frame itself
+    const int overlayRows = 12;
+
+    inline double toMs( qint64 nsecs ) { return nsecs / 1.0e6; }
+
+    struct BySlowest {
+        BySlowest( const QVector<double> &m ) : means( m ) {}
+        bool operator()( int a, int b ) const { return means[ a ] > means[ b ]; }
+        const QVector<double> &means;
+    };
+}
+
+FrameProfiler *FrameProfiler::pinstance = 0;
+bool FrameProfiler::s_Enabled = false;
+
+FrameProfiler* FrameProfiler::Instance() {
+    if ( ! pinstance )
+        pinstance = new FrameProfiler();
+    return pinstance;
+}
+
+FrameProfiler::FrameProfiler() :
+    m_Requested( false ), m_FrameEnds( WINDOW, 0 ), m_NextFrameEnd( 0 ), m_Frames( 0 )
+{
+    m_Clock.start();
+}
+
+void FrameProfiler::setRequested( bool on ) {
+    m_Requested = on;
+    s_Enabled = m_Requested || Options::showFrameProfile();
+}
+
+void FrameProfiler::beginFrame() {
+    // The overlay option may have changed since the last frame
+    s_Enabled = m_Requested || Options::showFrameProfile();
+    if ( s_Enabled )
+        m_FrameTimer.start();
+}
+
+void FrameProfiler::endFrame() {
+    if ( ! s_Enabled || ! m_FrameTimer.isValid() )
+        return;
+
+    add( frameSection, m_FrameTimer.nsecsElapsed() );
+    m_FrameTimer.invalidate();
+
+    for ( int i = 0; i < m_Sections.size(); ++i ) {
+        if ( m_Sections[ i ].frameCalls > 0 )
+            pushSample( m_Sections[ i ] );
+    }
+
+    m_FrameEnds[ m_NextFrameEnd ] = m_Clock.nsecsElapsed();
+    m_NextFrameEnd = ( m_NextFrameEnd + 1 ) % WINDOW;
+    m_Frames = qMin( m_Frames + 1, WINDOW );
+}
+
+int FrameProfiler::sectionIndex( const char *name ) {
+    QHash<const char*, int>::const_iterator it = m_ByAddress.constFind( name );
+    if ( it != m_ByAddress.constEnd() )
+        return it.value();
+
+    QString key = QString::fromLatin1( name );
+    int index = m_ByName.value( key, -1 );
+    if ( index < 0 ) {
+        Section s;
+        s.name = key;
+        s.frameTotal = 0;
+        s.frameCalls = 0;
+        s.samples.fill( 0, WINDOW );
+        s.calls.fill( 0, WINDOW );
+        s.next = s.count = 0;
+        for ( int k = 0; k < BUCKETS; ++k )
+            s.histogram[ k ] = 0;
+
+        index = m_Sections.size();
+        m_Sections.append( s );
+        m_ByName.insert( key, index );
+    }
+    m_ByAddress.insert( name, index );
+    return index;
+}
+
+void FrameProfiler::add( const char *section, qint64 nsecs ) {
+    Section &s = m_Sections[ sectionIndex( section ) ];
+    s.frameTotal += nsecs;
+    ++s.frameCalls;
+}
+
+int FrameProfiler::bucket( qint64 nsecs ) {
+    qint64 usecs = nsecs / 1000;
+    int k = 0;
+    while ( usecs > 1 && k < BUCKETS - 1 ) {
+        usecs >>= 1;
+        ++k;
+    }
+    return k;
+}
+
+void FrameProfiler::pushSample( Section &s ) {
+    // The oldest sample leaves the histogram when the ring is full
+    if ( s.count == WINDOW )
+        --s.histogram[ bucket( s.samples[ s.next ] ) ];
+    else
+        ++s.count;
+
+    s.samples[ s.next ] = s.frameTotal;
+    s.calls[ s.next ] = s.frameCalls;
+    ++s.histogram[ bucket( s.frameTotal ) ];
+    s.next = ( s.next + 1 ) % WINDOW;
+
+    s.frameTotal = 0;
+    s.frameCalls = 0;
+}
+
+void FrameProfiler::reset() {
+    for ( int i = 0; i < m_Sections.size(); ++i ) {
+        Section &s = m_Sections[ i ];
+        s.frameTotal = 0;
+        s.frameCalls = 0;
+        s.next = s.count = 0;
+        for ( int k = 0; k < BUCKETS; ++k )
+            s.histogram[ k ] = 0;
+    }
+    m_NextFrameEnd = 0;
+    m_Frames = 0;
+}
+
+FrameProfiler::Summary FrameProfiler::summarize( const Section &s ) const {
+    Summary r;
+    r.last = r.mean = r.median = r.p95 = r.max = r.calls = 0.0;
+    if ( s.count == 0 )
+        return r;
+
+    QVector<qint64> sorted = s.samples.mid( 0, s.count );
+    qSort( sorted );
+
+    qint64 sum = 0;
+    int calls = 0;
+    for ( int i = 0; i < s.count; ++i ) {
+        sum += s.samples[ i ];
+        calls += s.calls[ i ];
+    }
+
+    r.last   = toMs( s.samples[ ( s.next + WINDOW - 1 ) % WINDOW ] );
+    r.mean   = toMs( sum ) / s.count;
+    r.median = toMs( sorted[ s.count / 2 ] );
+    r.p95    = toMs( sorted[ qMin( s.count - 1, ( s.count * 95 ) / 100 ) ] );
+    r.max    = toMs( sorted.last() );
+    r.calls  = double( calls ) / s.count;
+    return r;
+}
+
+double FrameProfiler::framesPerSecond() const {
+    if ( m_Frames < 2 )
+        return 0.0;
+    qint64 newest = m_FrameEnds[ ( m_NextFrameEnd + WINDOW - 1 ) % WINDOW ];
+    qint64 oldest = m_FrameEnds[ ( m_NextFrameEnd + WINDOW - m_Frames ) % WINDOW ];
+    return newest > oldest ? ( m_Frames - 1 ) * 1.0e9 / ( newest - oldest ) : 0.0;
+}
+
+QString FrameProfiler::report() const {
+    QStringList lines;
+    lines << QString( "Profiling %1, %2 frames, %3 fps, times in ms" )
+                 .arg( s_Enabled ? "on" : "off" ).arg( m_Frames ).arg( framesPerSecond(), 0, 'f', 1 );
+    lines << QString( "%1 %2 %3 %4 %5 %6 %7" )
+                 .arg( "Section", -32 ).arg( "Calls", 9 ).arg( "Last", 9 ).arg( "Mean", 9 )
+                 .arg( "Median", 9 ).arg( "95%", 9 ).arg( "Max", 9 );
+
+    for ( int i = 0; i < m_Sections.size(); ++i ) {
+        const Section &s = m_Sections[ i ];
+        if ( s.count == 0 )
+            continue;
+        Summary r = summarize( s );
+        lines << QString( "%1 %2 %3 %4 %5 %6 %7" )
+                     .arg( s.name, -32 ).arg( r.calls, 9, 'f', 1 ).arg( r.last, 9, 'f', 3 )
+                     .arg( r.mean, 9, 'f', 3 ).arg( r.median, 9, 'f', 3 )
+                     .arg( r.p95, 9, 'f', 3 ).arg( r.max, 9, 'f', 3 );
+    }
+
+    // Histograms: number of samples below each power of two of microseconds
+    lines << QString();
+    for ( int i = 0; i < m_Sections.size(); ++i ) {
+        const Section &s = m_Sections[ i ];
+        if ( s.count == 0 )
+            continue;
+        QStringList buckets;
+        for ( int k = 0; k < BUCKETS; ++k ) {
+            if ( s.histogram[ k ] )
+                buckets << QString( "<%1us:%2" ).arg( qint64( 1 ) << ( k + 1 ) ).arg( s.histogram[ k ] );
+        }
+        lines << QString( "%1 %2" ).arg( s.name, -32 ).arg( buckets.join( " " ) );
+    }
+
+    return lines.join( "\n" );
+}
+
+void FrameProfiler::drawOverlay( QPainter &p ) const {
+    // Slowest sections first, the frame itself on top
+    QVector<double> means( m_Sections.size(), 0.0 );
+    QList<int> order;
+    int frame = -1;
+    for ( int i = 0; i < m_Sections.size(); ++i ) {
+        if ( m_Sections[ i ].count == 0 )
+            continue;
+        means[ i ] = summarize( m_Sections[ i ] ).mean;
+        if ( m_Sections[ i ].name == QLatin1String( frameSection ) )
+            frame = i;
+        else
+            order.append( i );
+    }
+    qSort( order.begin(), order.end(), BySlowest( means ) );
+    if ( order.size() > overlayRows )
+        order.erase( order.begin() + overlayRows, order.end() );
+
+    QStringList lines;
+    lines << i18n( "%1 fps", QString::number( framesPerSecond(), 'f', 1 ) );
+    if ( frame >= 0 )
+        order.prepend( frame );
+    foreach ( int i, order ) {
+        Summary r = summarize( m_Sections[ i ] );
+        lines << QString( "%1 %2 %3" ).arg( m_Sections[ i ].name, -28 )
+                     .arg( r.mean, 8, 'f', 2 ).arg( r.p95, 8, 'f', 2 );
+    }
+    if ( ! s_Enabled )
+        lines << i18n( "(profiling is off)" );
+
+    p.save();
+    QFont font = KGlobalSettings::fixedFont();
+    font.setPointSize( 8 );
+    p.setFont( font );
+    QFontMetrics fm( font );
+
+    int width = 0;
+    foreach ( const QString &line, lines )
+        width = qMax( width, fm.width( line ) );
+    int height = lines.size() * fm.lineSpacing();
+
+    QRect box( 4, p.viewport().height() - height - 12, width + 8, height + 8 );
+    p.setPen( Qt::NoPen );
+    p.setBrush( QColor( 0, 0, 0, 160 ) );
+    p.drawRect( box );
+
+    p.setPen( Qt::white );
+    int y = box.top() + 4 + fm.ascent();
+    foreach ( const QString &line, lines ) {
+        p.drawText( box.left() + 4, y, line );
+        y += fm.lineSpacing();
+    }
+    p.restore();
+}
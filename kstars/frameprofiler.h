@@ -0,0 +1,197 @@
+/***************************************************************************
+                  frameprofiler.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class QPainter;
+
+/**
+ *@class FrameProfiler
+ *
+ *Collects the time spent in the sections of the code which make up a frame
+ *of the sky map: the draw() of each component, the stages of
+ *KStarsData::updateTime(), JIT updates, label placement and painter calls.
+ *
+ *A section is timed with a FrameProfiler::Timer. The times of a section are
+ *summed over a frame; at the end of the frame the sum becomes one sample of
+ *the section. The last WINDOW samples of each section are kept, with a
+ *histogram of them, and summarised by report() and drawOverlay().
+ *
+ *Sections may nest: the time of a painter call is also part of the time of
+ *the component which made it.
+ *
+ *Profiling is off unless requested with setRequested() or the frame profile
+ *overlay is shown; a timer then costs a test of a static flag.
+ *
+ *@short Rolling timings of the sections of a sky map frame
+ *@version 1.0
+ */
+
+class FrameProfiler {
+
+ public:
+
+    /** Number of samples kept for each section */
+    static const int WINDOW = 120;
+
+    /** Number of histogram buckets; bucket k holds the samples from 2^k to 2^(k+1) microseconds */
+    static const int BUCKETS = 20;
+
+    /**
+     *@class FrameProfiler::Timer
+     *Adds the time from its construction to its destruction to a section.
+     *
+     *Consecutive sections can share one timer: lap() closes the current
+     *section and starts the next one.
+     */
+    class Timer {
+    public:
+        /**
+         *@param section the name of the section. It must be a string literal
+         *(or otherwise outlive the profiler), as it is looked up by address.
+         *A null section is only timed with lap().
+         */
+        explicit Timer( const char *section = 0 ) : m_Section( section ), m_Running( s_Enabled ) {
+            if ( m_Running )
+                m_Timer.start();
+        }
+
+        ~Timer() {
+            if ( m_Running && m_Section )
+                FrameProfiler::Instance()->add( m_Section, m_Timer.nsecsElapsed() );
+        }
+
+        /**
+         *@short Add the time since the last lap to a section, and start over
+         */
+        void lap( const char *section ) {
+            if ( ! m_Running )
+                return;
+            FrameProfiler::Instance()->add( section, m_Timer.nsecsElapsed() );
+            m_Timer.restart();
+        }
+
+    private:
+        const char *m_Section;
+        bool m_Running;
+        QElapsedTimer m_Timer;
+    };
+
+    /** @return a pointer to the profiler */
+    static FrameProfiler* Instance();
+
+    /** @return true if the timers are recording */
+    static inline bool isEnabled() { return s_Enabled; }
+
+    /**
+     *@short Turn profiling on or off, e.g. from D-Bus. Profiling is also on
+     *while the overlay is shown.
+     */
+    void setRequested( bool on );
+
+    /**
+     *@short Start a frame of the sky map. The time from here to endFrame()
+     *is the "Frame" section.
+     */
+    void beginFrame();
+
+    /**
+     *@short End a frame: the sums of the sections timed since the last
+     *frame become their new samples.
+     */
+    void endFrame();
+
+    /**
+     *@short Add time to a section in the current frame
+     *@param section the name of the section, looked up by address
+     *@param nsecs the time, in nanoseconds
+     */
+    void add( const char *section, qint64 nsecs );
+
+    /**
+     *@short Drop all the samples
+     */
+    void reset();
+
+    /**
+     *@return a table of the sections: calls per frame, and the last, mean,
+     *median, 95th percentile and largest times, followed by the histograms
+     */
+    QString report() const;
+
+    /**
+     *@short Draw the slowest sections in a box at the bottom left of the sky map
+     */
+    void drawOverlay( QPainter &p ) const;
+
+ private:
+
+    struct Section {
+        QString name;
+        qint64 frameTotal;              // Time in the current frame, in nanoseconds
+        int frameCalls;                 // Timings in the current frame
+        QVector<qint64> samples;        // Ring of the last WINDOW frame totals
+        QVector<int> calls;             // Timings of each of these frames
+        int next;                       // Ring index of the next sample
+        int count;                      // Number of samples in the ring
+        int histogram[ BUCKETS ];       // Of the samples in the ring
+    };
+
+    /** Summary of the samples of a section, in milliseconds */
+    struct Summary {
+        double last, mean, median, p95, max;
+        double calls;
+    };
+
+    FrameProfiler();
+
+    /** @return the index of the section, which is created if needed */
+    int sectionIndex( const char *name );
+
+    /** @short Push the total of the current frame as a sample of the section */
+    void pushSample( Section &s );
+
+    /** @return the summary of the samples of a section */
+    Summary summarize( const Section &s ) const;
+
+    /** @return the number of frames per second over the window */
+    double framesPerSecond() const;
+
+    /** @return the histogram bucket of a time */
+    static int bucket( qint64 nsecs );
+
+    static FrameProfiler *pinstance;
+    static bool s_Enabled;
+
+    bool m_Requested;
+    QVector<Section> m_Sections;
+    QHash<const char*, int> m_ByAddress;   // A literal may have several addresses,
+    QHash<QString, int> m_ByName;          // so names resolve them to one section
+    QElapsedTimer m_Clock;                 // Running since construction
+    QElapsedTimer m_FrameTimer;
+    QVector<qint64> m_FrameEnds;           // Ring of the end times of the last frames
+    int m_NextFrameEnd;
+    int m_Frames;
+};
+
+#endif
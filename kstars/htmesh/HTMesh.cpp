@@ -70,23 +70,19 @@ Trixel HTMesh::index(double ra, double dec) const
     return (Trixel) htm->idByPoint( SpatialVector(ra, dec) ) - magicNum;
 }
 
-bool HTMesh::performIntersection(RangeConvex* convex, BufNum bufNum) {
-
-    if ( ! validBufNum(bufNum) )
-        return false;
+bool HTMesh::performIntersection(RangeConvex* convex, MeshBuffer *result) const {
 
     convex->setOlevel(m_level);
     HtmRange range;
     convex->intersect(htm, &range);
     HtmRangeIterator iterator(&range);
 
-    MeshBuffer* buffer = m_meshBuffer[bufNum];
-    buffer->reset();
+    result->reset();
     while (iterator.hasNext() ) {
-        buffer->append( (Trixel) iterator.next() - magicNum);
+        result->append( (Trixel) iterator.next() - magicNum);
     }
 
-    if (buffer->error() ) {
+    if (result->error() ) {
         fprintf(stderr, "%s: trixel overflow.\n", name);
         return false;
     };
@@ -95,59 +91,96 @@ bool HTMesh::performIntersection(RangeConvex* convex, BufNum bufNum) {
 }
 
 
-// CIRCLE
+// The shared buffers are filled by the reentrant routines below
+
 void HTMesh::intersect(double ra, double dec, double radius, BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect( ra, dec, radius, m_meshBuffer[bufNum] );
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect( ra1, dec1, ra2, dec2, m_meshBuffer[bufNum] );
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect( ra1, dec1, ra2, dec2, ra3, dec3, m_meshBuffer[bufNum] );
+}
+
+void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, double ra4, double dec4,
+                       BufNum bufNum)
+{
+    if ( validBufNum(bufNum) )
+        intersect( ra1, dec1, ra2, dec2, ra3, dec3, ra4, dec4, m_meshBuffer[bufNum] );
+}
+
+
+// CIRCLE
+bool HTMesh::intersect(double ra, double dec, double radius, MeshBuffer *result) const
 {
     double d = cos(radius * degree2Rad);
     SpatialConstraint c(SpatialVector(ra, dec), d);
     RangeConvex convex;
     convex.add(c);                      // [ed:RangeConvex::add]
 
-    if ( ! performIntersection(&convex, bufNum) )
+    if ( ! performIntersection(&convex, result) ) {
         printf("In intersect(%f, %f, %f)\n", ra, dec, radius);
+        return false;
+    }
+    return true;
 }
 
 
 // TRIANGLE
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
-                       double ra3, double dec3, BufNum bufNum)
+bool HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, MeshBuffer *result) const
 {
     if ( fabs(ra1 - ra3) + fabs( dec1 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2 );
+        return intersect( ra1, dec1, ra2, dec2, result );
 
     else if ( fabs(ra1 - ra2) + fabs(dec1 - dec2) < eps )
-        return intersect( ra1, dec1, ra3, dec3 );
+        return intersect( ra1, dec1, ra3, dec3, result );
 
     else if ( fabs(ra2 - ra3) + fabs(dec2 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2 );
+        return intersect( ra1, dec1, ra2, dec2, result );
 
     SpatialVector p1(ra1, dec1);
     SpatialVector p2(ra2, dec2);
     SpatialVector p3(ra3, dec3);
     RangeConvex convex(&p1, &p2, &p3);
 
-    if ( ! performIntersection(&convex, bufNum) )
+    if ( ! performIntersection(&convex, result) ) {
         printf("In intersect(%f, %f, %f, %f, %f, %f)\n",
                 ra1, dec1, ra2, dec2, ra3, dec3);
+        return false;
+    }
+    return true;
 }
 
 
 // QUADRILATERAL
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+bool HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
                        double ra3, double dec3, double ra4, double dec4,
-                       BufNum bufNum)
+                       MeshBuffer *result) const
 {
     if ( fabs(ra1 - ra4) + fabs(dec1 - dec4) < eps )
-        return intersect( ra2, dec2, ra3, dec3, ra4, dec4 );
+        return intersect( ra2, dec2, ra3, dec3, ra4, dec4, result );
 
     else if ( fabs(ra1 - ra2) + fabs(dec1 - dec2) < eps )
-        return intersect( ra2, dec2, ra3, dec3, ra4, dec4 );
+        return intersect( ra2, dec2, ra3, dec3, ra4, dec4, result );
 
     else if ( fabs(ra2 - ra3) + fabs(dec2 - dec3) < eps )
-        return intersect( ra1, dec1, ra2, dec2, ra4, dec4 );
+        return intersect( ra1, dec1, ra2, dec2, ra4, dec4, result );
 
     else if ( fabs(ra3 - ra4) + fabs(dec3 - dec4) < eps )
-        return intersect( ra1, dec1, ra2, dec2, ra4, dec4 );
+        return intersect( ra1, dec1, ra2, dec2, ra4, dec4, result );
 
 
     SpatialVector p1(ra1, dec1);
@@ -156,13 +189,16 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
     SpatialVector p4(ra4, dec4);
     RangeConvex convex( &p1, &p2, &p3, &p4);
 
-    if ( ! performIntersection(&convex, bufNum) )
+    if ( ! performIntersection(&convex, result) ) {
         printf("In intersect(%f, %f, %f, %f, %f, %f, %f, %f)\n",
                ra1, dec1, ra2, dec2, ra3, dec3, ra4, dec4);
+        return false;
+    }
+    return true;
 }
 
 
-void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z)
+void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z) const
 {
     ra  *= degree2Rad;
     dec *= degree2Rad;
@@ -182,8 +218,8 @@ void HTMesh::toXYZ(double ra, double dec, double *x, double *y, double *z)
 // intersection.  Use cross product to ensure we have a perpendicular vector.
 
 // LINE
-void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
-                       BufNum bufNum)
+bool HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
+                       MeshBuffer *result) const
 {
     double x1, y1, z1, x2, y2, z2;
     
@@ -210,8 +246,9 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
         printf("len : %f (radians) %f (degrees)\n", len,  len  / degree2Rad);
     }
 
+    // A circle around the first point, which reaches the second one
     if ( len < edge10 )
-        return intersect( ra1, len, bufNum);
+        return intersect( ra1, dec1, len / degree2Rad, result );
 
     // Cartesian cross product => perpendicular!.  Ugh.
     double cx = y1 * z2 - z1 * y2;
@@ -248,8 +285,11 @@ void HTMesh::intersect(double ra1, double dec1, double ra2, double dec2,
     SpatialVector p2(ra2, dec2);
     RangeConvex convex(&p1, &p0, &p2);
 
-    if ( ! performIntersection(&convex, bufNum) )
+    if ( ! performIntersection(&convex, result) ) {
         printf("In intersect(%f, %f, %f, %f)\n", ra1, dec1, ra2, dec2);
+        return false;
+    }
+    return true;
 }
 
 
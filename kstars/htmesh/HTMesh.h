@@ -52,6 +52,13 @@ class MeshBuffer;
  * is just one buffer and all routines that use the buffers default to using the
  * just the first buffer.
  *
+ * The buffers belong to the HTMesh, so two queries using the same buffer
+ * cannot overlap.  For queries which may run at the same time as others, e.g.
+ * in another thread, each intersect() routine also comes in a const version
+ * that fills a MeshBuffer owned by the caller.  These versions touch nothing
+ * but the caller's buffer, so any number of them can run concurrently on the
+ * same HTMesh.  A MeshBuffer can be reused for any number of queries.
+ *
  * NOTE: all Right Ascensions (ra) and Declinations (dec) are in degrees.
  */
 
@@ -115,6 +122,34 @@ public:
                        double ra3, double dec3, double ra4, double dec4,
                        BufNum bufNum=0);
 
+        /* NOTE: The reentrant versions of the intersect() routines above.  The
+         * trixels are stored in the result buffer, which must have been
+         * created for this mesh, and which can then be read with a
+         * MeshIterator( result ).  They return false if the intersection
+         * failed.
+         */
+
+        /* @short finds the trixels that cover the specified circle
+         */
+        bool intersect(double ra, double dec, double radius,
+                       MeshBuffer *result) const;
+
+        /* @short finds the trixels that cover the specified line segment
+         */
+        bool intersect(double ra1, double dec1, double ra2, double dec2,
+                       MeshBuffer *result) const;
+
+        /* @short find the trixels that cover the specified triangle
+         */
+        bool intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, MeshBuffer *result) const;
+
+        /* @short finds the trixels that cover the specified quadrilateral
+         */
+        bool intersect(double ra1, double dec1, double ra2, double dec2,
+                       double ra3, double dec3, double ra4, double dec4,
+                       MeshBuffer *result) const;
+
         /* @short returns the number of trixels in the result buffer bufNum.
          */
         int intersectSize(BufNum bufNum=0);
@@ -156,10 +191,10 @@ public:
 
         int htmDebug;
 
-        /* @short fills the specified buffer with the intersection results in the
+        /* @short fills the result buffer with the intersection results in the
          * RangeConvex.
          */
-        bool performIntersection(RangeConvex* convex, BufNum bufNum=0);
+        bool performIntersection(RangeConvex* convex, MeshBuffer *result) const;
 
         /* @short users can only use the allocated buffers
          */
@@ -174,7 +209,7 @@ public:
         /* @short used by the line intersection routine.  Maybe there is a
          * simpler and faster approach that does not require this conversion.
          */
-        void toXYZ( double ra, double dec, double *x, double *y, double *z);
+        void toXYZ( double ra, double dec, double *x, double *y, double *z) const;
 
 };
 
@@ -20,12 +20,15 @@ class HTMesh;
  * the life of an HTMesh.  Each mesh buffer is re-usable.  Simply reset() it and
  * then fill it by append()'ing trixels.  A MeshIterator grabs the size() and
  * the buffer() so it can iterate over the results.
+ *
+ * A MeshBuffer can also be created and owned by a caller of the reentrant
+ * HTMesh::intersect() routines, to hold their results.
  */
 
 class MeshBuffer {
 
     public:
-        MeshBuffer(HTMesh *mesh);
+        MeshBuffer(const HTMesh *mesh);
 
         ~MeshBuffer();
 
@@ -12,3 +12,9 @@ MeshIterator::MeshIterator(HTMesh *mesh, BufNum bufNum)
     index = buffer->buffer();
 }
 
+MeshIterator::MeshIterator(const MeshBuffer *buffer)
+{
+    cnt = 0;
+    m_size = buffer->size();
+    index = buffer->buffer();
+}
@@ -12,6 +12,7 @@
 #include "typedef.h"
 
 class HTMesh;
+class MeshBuffer;
 
 /* @class MeshIterator is a very lightweight class used to iterate over the
  * result set of an HTMesh intersection.  If you want to iterate over the same
@@ -24,6 +25,11 @@ class MeshIterator {
     public:
         MeshIterator(HTMesh *mesh, BufNum bufNum=0);
 
+        /* @short iterates over the trixels of a result buffer filled by one
+         * of the reentrant HTMesh::intersect() routines.
+         */
+        MeshIterator(const MeshBuffer *buffer);
+
         /* @short true if there are more trixel to iterate over.
          */
         bool hasNext() const { return cnt < m_size; }
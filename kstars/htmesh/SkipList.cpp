@@ -11,43 +11,35 @@
 
 #include <iostream> // cout
 #include <iomanip> // setw
-#include <stdlib.h> // rand(), drand48()
 
 #include "SkipListElement.h"
 #include "SkipList.h"
 
-#include <config-htmesh.h>
-
-#ifndef HAVE_DRAND48
-double drand48()
+////////////////////////////////////////////////////////////////////////////////
+// uniform random number in [0, 1).  Each list has its own generator (a 32 bit
+// LCG): drand48() keeps its state in a global, shared by all the threads
+// running HTM queries.
+////////////////////////////////////////////////////////////////////////////////
+double SkipList::nextRandom()
 {
-  double result;
-#ifdef _WIN32
-  result = static_cast<double>( rand() );
-  result /= RAND_MAX;
-#else
-  result = static_cast<double>( random() );
-  result /= LONG_MAX;
-#endif
-  return result;
+    mySeed = mySeed * 1664525u + 1013904223u;
+    return (mySeed >> 8) * (1.0 / 16777216.0);
 }
-#endif /* HAVE_DRAND48 */
-
 
 ////////////////////////////////////////////////////////////////////////////////
 // get new element level using given probability
 ////////////////////////////////////////////////////////////////////////////////
-long getNewLevel(long maxLevel, float probability)
+long SkipList::getNewLevel(long maxLevel, float probability)
 {
     long newLevel = 0;
-    while ( (newLevel < maxLevel - 1) && (drand48() < probability) ) // fast hack. fix later
+    while ( (newLevel < maxLevel - 1) && (nextRandom() < probability) ) // fast hack. fix later
         newLevel++;
     return(newLevel);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 SkipList::SkipList(float probability)
-    : myProbability(probability)
+    : myProbability(probability), mySeed(12345u)
 {
     myHeader = new SkipListElement(); // get memory for header element
     myHeader->setKey( KEY_MAX);
@@ -53,7 +53,11 @@ public:
     void stat(); 
 
 private:
+    double nextRandom();
+    long getNewLevel(long maxLevel, float probability);
+
     float myProbability;
+    unsigned int mySeed;
     /// the header (first) list element
     SkipListElement* myHeader;
     SkipListElement* iter;
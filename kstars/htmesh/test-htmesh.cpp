@@ -1,56 +1,221 @@
 #include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <pthread.h>
 
 #include "HTMesh.h"
+#include "MeshBuffer.h"
 #include "MeshIterator.h"
 
 
-int main() {
+/******************************************************************************
+ * Stress test of the reentrant intersect() routines: several threads run the
+ * same queries at the same time on one HTMesh, each into its own MeshBuffer,
+ * while another thread keeps using the shared buffer of the mesh.  Every
+ * result must match the one computed beforehand by a single thread.
+ *****************************************************************************/
+
+enum { CIRCLE, LINE, TRIANGLE, QUAD, NUM_SHAPES };
+
+struct Query {
+    int shape;
+    double p[8];                    // (ra, dec) of the vertices, or center and radius
+    int size;                       // Expected result, computed by one thread
+    Trixel *trixels;
+};
+
+struct Worker {
+    HTMesh *mesh;
+    Query *queries;
+    int numQueries;
+    int rounds;
+    int seed;
+    bool shared;                    // Use the shared buffer of the mesh
+    int errors;
+};
+
+static double uniform( unsigned int *seed, double lo, double hi )
+{
+    return lo + (hi - lo) * ( rand_r( seed ) / ( RAND_MAX + 1.0 ) );
+}
+
+static void makeQuery( Query *q, unsigned int *seed )
+{
+    q->shape = rand_r( seed ) % NUM_SHAPES;
+    double ra  = uniform( seed, 0.0, 360.0 );
+    double dec = uniform( seed, -85.0, 85.0 );
+    double r   = uniform( seed, 0.1, 5.0 );
+
+    // Vertices of a small convex polygon, counterclockwise around (ra, dec)
+    q->p[0] = ra - r;  q->p[1] = dec - r;
+    q->p[2] = ra + r;  q->p[3] = dec - r;
+    q->p[4] = ra + r;  q->p[5] = dec + r;
+    q->p[6] = ra - r;  q->p[7] = dec + r;
+
+    if ( q->shape == CIRCLE ) {
+        q->p[0] = ra;
+        q->p[1] = dec;
+        q->p[2] = r;
+    }
+    else if ( q->shape == TRIANGLE ) {
+        q->p[4] = ra;
+    }
+}
+
+static bool runQuery( const HTMesh *mesh, const Query *q, MeshBuffer *result )
+{
+    const double *p = q->p;
+    switch ( q->shape ) {
+        case CIRCLE:
+            return mesh->intersect( p[0], p[1], p[2], result );
+        case LINE:
+            return mesh->intersect( p[0], p[1], p[4], p[5], result );
+        case TRIANGLE:
+            return mesh->intersect( p[0], p[1], p[2], p[3], p[4], p[5], result );
+        default:
+            return mesh->intersect( p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7], result );
+    }
+}
+
+static bool sameResult( const Query *q, int size, const Trixel *trixels )
+{
+    return size == q->size && memcmp( trixels, q->trixels, size * sizeof(Trixel) ) == 0;
+}
+
+static void* work( void *arg )
+{
+    Worker *w = (Worker*) arg;
+    MeshBuffer result( w->mesh );
+    unsigned int seed = w->seed;
+
+    for ( int round = 0; round < w->rounds; round++ ) {
+        for ( int i = 0; i < w->numQueries; i++ ) {
+            // Each thread walks the queries in its own order
+            const Query *q = &w->queries[ rand_r( &seed ) % w->numQueries ];
+
+            if ( w->shared ) {
+                // The old API: only this thread uses buffer 0
+                const double *p = q->p;
+                if ( q->shape == CIRCLE )
+                    w->mesh->intersect( p[0], p[1], p[2] );
+                else if ( q->shape == LINE )
+                    w->mesh->intersect( p[0], p[1], p[4], p[5] );
+                else if ( q->shape == TRIANGLE )
+                    w->mesh->intersect( p[0], p[1], p[2], p[3], p[4], p[5] );
+                else
+                    w->mesh->intersect( p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7] );
+
+                MeshBuffer *buffer = w->mesh->meshBuffer();
+                if ( ! sameResult( q, buffer->size(), buffer->buffer() ) )
+                    w->errors++;
+                continue;
+            }
+
+            if ( ! runQuery( w->mesh, q, &result ) ||
+                 ! sameResult( q, result.size(), result.buffer() ) )
+                w->errors++;
+        }
+    }
+    return 0;
+}
+
+static int stressTest( int level, int numThreads, int numQueries, int rounds )
+{
+    HTMesh *mesh = new HTMesh( level, level );
+    unsigned int seed = 17;
+
+    // The expected results
+    Query *queries = new Query[ numQueries ];
+    MeshBuffer result( mesh );
+    for ( int i = 0; i < numQueries; i++ ) {
+        Query *q = &queries[i];
+        makeQuery( q, &seed );
+        runQuery( mesh, q, &result );
+        q->size = result.size();
+        q->trixels = new Trixel[ q->size ];
+        memcpy( q->trixels, result.buffer(), q->size * sizeof(Trixel) );
+    }
+
+    // All the threads, plus one on the shared buffer
+    Worker *workers = new Worker[ numThreads + 1 ];
+    pthread_t *threads = new pthread_t[ numThreads + 1 ];
+    for ( int t = 0; t <= numThreads; t++ ) {
+        Worker *w = &workers[t];
+        w->mesh = mesh;
+        w->queries = queries;
+        w->numQueries = numQueries;
+        w->rounds = rounds;
+        w->seed = 1000 + t;
+        w->shared = ( t == numThreads );
+        w->errors = 0;
+        pthread_create( &threads[t], 0, work, w );
+    }
+
+    int errors = 0;
+    for ( int t = 0; t <= numThreads; t++ ) {
+        pthread_join( threads[t], 0 );
+        errors += workers[t].errors;
+    }
+
+    printf("Stress test: level %d, %d threads, %d queries x %d rounds: %d errors\n",
+           level, numThreads, numQueries, rounds, errors);
+
+    for ( int i = 0; i < numQueries; i++ )
+        delete [] queries[i].trixels;
+    delete [] queries;
+    delete [] workers;
+    delete [] threads;
+    delete mesh;
+    return errors;
+}
+
+
+int main( int argc, char **argv ) {
     int level = 5;
     printf("level = %d\n", level);
     HTMesh *mesh = new HTMesh( level, level );
     mesh->setDebug(17);
-  
+
     double ra=6.75 * 15.;
     double dec=-16.72;
-  
+
     //Lookup the triangle containing (ra,dec)
-    long id = mesh->index( ra, dec );
-    const char *name = mesh->indexToName( id );
-    printf("(%8.4f %8.4f): %s\n", ra, dec, name);
-  
+    Trixel id = mesh->index( ra, dec );
+    printf("(%8.4f %8.4f): %u\n", ra, dec, id);
+
     double vr1, vd1, vr2, vd2, vr3, vd3;
     mesh->vertices( id, &vr1, &vd1, &vr2, &vd2, &vr3, &vd3);
 
-    printf("\nThe three vertices of %s are:\n", name);
+    printf("\nThe three vertices of %u are:\n", id);
     printf("    (%6.2f, %6.2f)\n", vr1, vd1);
     printf("    (%6.2f, %6.2f)\n", vr2, vd2);
     printf("    (%6.2f, %6.2f)\n", vr3, vd3);
-  
+
     printf("\n");
     //Loop over triangles within one degree of (ra,dec)
-  
+
     double radius = 2.0;
     //printf("Leak test! ...\n");
     for ( int ii = 0; ii < 1; ii++) {
-  
+
         mesh->intersect( ra, dec, ra - radius, dec, ra - radius , dec + radius );
-        mesh->intersect( ra, dec, ra - radius, dec, ra - radius , dec + radius, 
+        mesh->intersect( ra, dec, ra - radius, dec, ra - radius , dec + radius,
                          ra , dec + radius);
-     
+
 
         mesh->intersect( ra, dec, radius );
         //continue;
-      
+
         MeshIterator iterator(mesh);
-      
+
         printf("Number of trixels = %d\n\n", mesh->intersectSize() );
         printf("Triangles within %5.2f degrees of (%6.2f, %6.2f)\n", radius, ra, dec);
-      
+
         while ( iterator.hasNext() ) {
-            printf("%s\n",  mesh->indexToName( iterator.next() ));    
+            printf("%u\n", iterator.next() );
         }
     }
-  
+
     double ra1, dec1, ra2, dec2;
     ra1  = 275.874939;
     ra2  = 274.882451;
@@ -62,6 +227,12 @@ int main() {
 
     mesh->intersect(ra1, dec1, ra2, dec2);
     printf("found %d trixels\n", mesh->intersectSize());
+    delete mesh;
 
-    return 0;
+    int numThreads = argc > 1 ? atoi( argv[1] ) : 8;
+    int rounds     = argc > 2 ? atoi( argv[2] ) : 20;
+    int errors = stressTest( 3, numThreads, 500, rounds );
+    errors += stressTest( level, numThreads, 500, rounds );
+
+    return errors ? 1 : 0;
 }
@@ -0,0 +1,77 @@
+/*  INDI BLOB Writer
+    Copyright (C) 2026 KStars Developers (kstars-devel@kde.org)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    2026-10-17	Writes the BLOBs received from the devices to disk in a background thread.
+ */
+
+#include "blobwriter.h"
+
+#include <QFile>
+#include <QMutexLocker>
+
+#include <kdebug.h>
+
+BLOBWriter::BLOBWriter() :
+    m_stop( false )
+{}
+
+BLOBWriter::~BLOBWriter()
+{
+    // Captures are not dropped: the queue is drained before the thread ends
+    m_mutex.lock();
+    m_stop = true;
+    m_requestAdded.wakeOne();
+    m_mutex.unlock();
+    wait();
+}
+
+void BLOBWriter::write( const QString &filename, const QByteArray &data )
+{
+    QMutexLocker locker( &m_mutex );
+    Request r;
+    r.filename = filename;
+    r.data = data;
+    m_queue.enqueue( r );
+
+    if ( !isRunning() )
+        start( QThread::LowPriority );
+    m_requestAdded.wakeOne();
+}
+
+int BLOBWriter::pending()
+{
+    QMutexLocker locker( &m_mutex );
+    return m_queue.size();
+}
+
+void BLOBWriter::run()
+{
+    forever {
+        m_mutex.lock();
+        while ( m_queue.isEmpty() && !m_stop )
+            m_requestAdded.wait( &m_mutex );
+        if ( m_queue.isEmpty() ) {
+            m_mutex.unlock();
+            break;
+        }
+        Request r = m_queue.dequeue();
+        m_mutex.unlock();
+
+        bool ok = false;
+        QFile file( r.filename );
+        if ( file.open( QIODevice::WriteOnly ) ) {
+            ok = ( file.write( r.data ) == r.data.size() );
+            file.close();
+        }
+
+        if ( !ok )
+            kDebug() << "Error: Unable to write " << r.filename << endl;
+
+        emit fileWritten( r.filename, ok );
+    }
+}
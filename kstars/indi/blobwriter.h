@@ -0,0 +1,77 @@
+/*  INDI BLOB Writer
+    Copyright (C) 2026 KStars Developers (kstars-devel@kde.org)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    2026-10-17	Writes the BLOBs received from the devices to disk in a background thread.
+ */
+
+#ifndef BLOBWRITER_H_
+#define BLOBWRITER_H_
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QByteArray>
+#include <QString>
+
+/**
+ *@class BLOBWriter
+ *Writes the BLOBs received from a device to disk in a background thread, so
+ *that a large capture never blocks the GUI thread or the parsing of the
+ *stream. The data is implicitly shared with the caller: queuing a BLOB costs
+ *no copy.
+ *
+ *Files are written in the order they are queued. fileWritten() is emitted
+ *from the writer thread, so it must be connected with a queued connection
+ *to touch any widget.
+ */
+class BLOBWriter : public QThread
+{
+    Q_OBJECT
+public:
+    BLOBWriter();
+
+    /**
+     *@short Destructor. Waits until all the queued files are written.
+     */
+    ~BLOBWriter();
+
+    /**
+     *@short Queue data to be written to a file, replacing its content
+     *@param filename full path of the file
+     *@param data the content of the file
+     */
+    void write( const QString &filename, const QByteArray &data );
+
+    /** @return the number of files not written yet */
+    int pending();
+
+signals:
+    /**
+     *@short A queued file was written
+     *@param filename full path of the file
+     *@param ok false if the file could not be written
+     */
+    void fileWritten( const QString &filename, bool ok );
+
+protected:
+    void run();
+
+private:
+    struct Request {
+        QString filename;
+        QByteArray data;
+    };
+
+    QMutex m_mutex;                   // Guards m_queue and m_stop
+    QWaitCondition m_requestAdded;
+    QQueue<Request> m_queue;
+    bool m_stop;
+};
+
+#endif
@@ -54,6 +54,7 @@ DeviceManager::DeviceManager(INDIMenu *INDIparent, QString inHost, uint inPort,
     parent		= INDIparent;
     serverProcess	= NULL;
     XMLParser		= NULL;
+    streamParser	= NULL;
     host		= inHost;
     port		= inPort;
     mode		= inMode;
@@ -73,6 +74,8 @@ DeviceManager::~DeviceManager()
 
     XMLParser = NULL;
 
+    delete (streamParser);
+
     while ( ! indi_dev.isEmpty() ) delete indi_dev.takeFirst();
 }
 
@@ -161,6 +164,10 @@ void DeviceManager::connectionSuccess()
         delLilXML(XMLParser);
     XMLParser = newLilXML();
 
+    if (streamParser == NULL)
+        streamParser = new INDIStreamParser();
+    streamParser->reset();
+
     serverFP << QString("<getProperties version='%1'/>\n").arg(INDIVERSION);
 }
 
@@ -194,42 +201,87 @@ void DeviceManager::processStandardError()
 }
   
 void DeviceManager::dataReceived()
+{
+    int err_code=0;
+    QString err_cmd;
+
+    if (!streamParser)
+        return;
+
+    /* parse the raw bytes as they come, messages are queued as they complete */
+    streamParser->feed(serverSocket.readAll());
+
+    while (streamParser->hasMessages())
+    {
+        INDIStreamParser::Message msg = streamParser->takeMessage();
+
+        /* definitions and other rare messages still go through LilXML */
+        if (msg.kind == INDIStreamParser::Message::Element)
+        {
+            dispatchElement(msg.xml);
+            continue;
+        }
+
+        if ( (err_code = dispatchVector(msg, err_cmd)) < 0)
+        {
+            // Silenty ignore property duplication errors
+            if (err_code != INDI_PROPERTY_DUPLICATED)
+                kDebug() << "Dispatch command error: " << err_cmd << endl;
+        }
+    }
+}
+
+void DeviceManager::dispatchElement(const QByteArray &xml)
 {
     char errmsg[ERRMSG_SIZE];
-    int nr=0, err_code=0;
-    QTextStream serverFP(&serverSocket);
-    QString ibuf, err_cmd;
-  
-    ibuf = serverFP.readAll();
-    nr = ibuf.length();
-  
-        /* process each char */
-       for (int i = 0; i < nr; i++)
-       {
-           if (!XMLParser)
-              return;
-
-           XMLEle *root = readXMLEle (XMLParser, ibuf[i].toAscii(), errmsg);
-           if (root)
-           {
-                if ( (err_code = dispatchCommand(root, err_cmd)) < 0)
+    int err_code=0;
+    QString err_cmd;
+
+    if (!XMLParser)
+        return;
+
+    for (int i = 0; i < xml.size(); i++)
+    {
+        XMLEle *root = readXMLEle (XMLParser, xml.at(i), errmsg);
+        if (root)
+        {
+            if ( (err_code = dispatchCommand(root, err_cmd)) < 0)
+            {
+                // Silenty ignore property duplication errors
+                if (err_code != INDI_PROPERTY_DUPLICATED)
                 {
-		     // Silenty ignore property duplication errors
-		     if (err_code != INDI_PROPERTY_DUPLICATED)
-		     {
-	                    kDebug() << "Dispatch command error: " << err_cmd << endl;
-	       	            prXMLEle (stderr, root, 0);
-                     }
+                    kDebug() << "Dispatch command error: " << err_cmd << endl;
+                    prXMLEle (stderr, root, 0);
                 }
+            }
 
-                delXMLEle (root);
-           }
-           else if (*errmsg)
-	   {
-                kDebug() << "XML Root Error: " << errmsg;
-	   }
-          }
-  }
+            delXMLEle (root);
+        }
+        else if (*errmsg)
+        {
+            kDebug() << "XML Root Error: " << errmsg;
+        }
+    }
+}
+
+/* dispatch a set*Vector parsed by the stream parser.
+ * return 0 if ok, else < 0 with reason in errmsg.
+ */
+int DeviceManager::dispatchVector(const INDIStreamParser::Message &msg, QString & errmsg)
+{
+    if (!msg.hasAttribute("device"))
+    {
+        errmsg = QString("No device attribute found in element %1").arg(QString(msg.tag));
+        return INDI_DEVICE_NOT_FOUND;
+    }
+
+    /* a device is created by its definitions, not by new values */
+    INDI_D *dp = findDev (msg.attribute("device"), errmsg);
+    if (dp == NULL)
+        return INDI_DEVICE_NOT_FOUND;
+
+    return dp->setAnyCmd(msg, errmsg);
+}
 
 int DeviceManager::dispatchCommand(XMLEle *root, QString & errmsg)
 {
@@ -257,12 +309,6 @@ int DeviceManager::dispatchCommand(XMLEle *root, QString & errmsg)
         return dp->buildLightsGUI(root, errmsg);
     else if (!strcmp (tagXMLEle(root), "defBLOBVector"))
         return dp->buildBLOBGUI(root, errmsg);
-    else if (!strcmp (tagXMLEle(root), "setTextVector") ||
-             !strcmp (tagXMLEle(root), "setNumberVector") ||
-             !strcmp (tagXMLEle(root), "setSwitchVector") ||
-             !strcmp (tagXMLEle(root), "setLightVector") ||
-             !strcmp (tagXMLEle(root), "setBLOBVector"))
-        return dp->setAnyCmd(root, errmsg);
 
     return INDI_DISPATCH_ERROR;
 }
@@ -442,16 +488,34 @@ void DeviceManager::checkMsg (XMLEle *root, INDI_D *dp)
         doMsg(root, dp);
 }
 
+void DeviceManager::checkMsg (const INDIStreamParser::Message &msg, INDI_D *dp)
+{
+    if (msg.hasAttribute("message"))
+        doMsg(msg.attribute("message"), msg.attribute("timestamp"), dp);
+}
+
 /* display valu of message and timestamp in dp's scrolled area, if any, else general.
  * prefix our time stamp if not included.
  * N.B. don't put carriage control in msg, we take care of that.
  */
 void DeviceManager::doMsg (XMLEle *msg, INDI_D *dp)
 {
-    QTextEdit *txt_w;
     XMLAtt *message;
     XMLAtt *timestamp;
 
+    message = findXMLAtt(msg, "message");
+
+    if (!message) return;
+
+    timestamp = findXMLAtt (msg, "timestamp");
+
+    doMsg(QString(valuXMLAtt(message)), timestamp ? QString(valuXMLAtt(timestamp)) : QString(), dp);
+}
+
+void DeviceManager::doMsg (const QString &message, const QString &timestamp, INDI_D *dp)
+{
+    QTextEdit *txt_w;
+
     if (dp == NULL)
     {
         kDebug() << "Warning: dp is null.";
@@ -461,26 +525,20 @@ void DeviceManager::doMsg (XMLEle *msg, INDI_D *dp)
     txt_w = dp->msgST_w;
 
     /* prefix our timestamp if not with msg */
-    timestamp = findXMLAtt (msg, "timestamp");
-
-    if (timestamp)
-        txt_w->insertPlainText(QString(valuXMLAtt(timestamp)) + QString(" "));
+    if (!timestamp.isEmpty())
+        txt_w->insertPlainText(timestamp + QString(" "));
     else
         txt_w->insertPlainText( KStarsDateTime::currentDateTime().toString("yyyy/mm/dd - h:m:s ap "));
 
     /* finally! the msg */
-    message = findXMLAtt(msg, "message");
-
-    if (!message) return;
-
     // Prepend to the log viewer
-    txt_w->insertPlainText( QString(valuXMLAtt(message)) + QString("\n"));
+    txt_w->insertPlainText( message + QString("\n"));
     QTextCursor c = txt_w->textCursor();
     c.movePosition(QTextCursor::Start);
     txt_w->setTextCursor(c); 
 
     if ( Options::showINDIMessages() )
-        parent->ksw->statusBar()->changeItem( QString(valuXMLAtt(message)), 0);
+        parent->ksw->statusBar()->changeItem( message, 0);
 
 }
 
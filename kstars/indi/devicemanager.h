@@ -16,6 +16,7 @@
 
 #include "indielement.h"
 #include "indidriver.h"
+#include "indistreamparser.h"
 #include <QTcpSocket>
 
 class INDIMenu;
@@ -42,6 +43,7 @@ public:
 
     QTcpSocket		 serverSocket;
     LilXML		 *XMLParser;
+    INDIStreamParser	 *streamParser;
     QString		 host;
     uint		 port;
     QString 		 serverBuffer;
@@ -49,6 +51,8 @@ public:
     KProcess 		 *serverProcess;
 
     int dispatchCommand   (XMLEle *root, QString & errmsg);
+    int dispatchVector    (const INDIStreamParser::Message &msg, QString & errmsg);
+    void dispatchElement  (const QByteArray &xml);
 
     INDI_D *  addDevice   (XMLEle *dep , QString & errmsg);
     INDI_D *  findDev     (XMLEle *root, int  create, QString & errmsg);
@@ -72,7 +76,9 @@ public:
 
     int  messageCmd     (XMLEle *root, QString & errmsg);
     void checkMsg       (XMLEle *root, INDI_D *dp);
+    void checkMsg       (const INDIStreamParser::Message &msg, INDI_D *dp);
     void doMsg          (XMLEle *msg , INDI_D *dp);
+    void doMsg          (const QString &message, const QString &timestamp, INDI_D *dp);
 
     void appendManagedDevices(QList<IDevice *> & processed_devices);
     void startServer();
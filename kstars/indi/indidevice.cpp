@@ -48,7 +48,6 @@
 #endif
 #include <zlib.h>
 #include <indicom.h>
-#include <base64.h>
 
 #include <QFrame>
 #include <QCheckBox>
@@ -100,8 +99,6 @@ INDI_D::INDI_D(INDIMenu *menuParent, DeviceManager *InParentManager, const QStri
     msgST_w        	= new KTextEdit();
     msgST_w->setReadOnly(true);
   
-    dataBuffer 		= (unsigned char *) malloc (1);
-  
     stdDev 		= new INDIStdDevice(this, parent->ksw);
   
     curGroup      	= NULL;
@@ -120,8 +117,6 @@ INDI_D::~INDI_D()
 
     delete(deviceVBox);
     delete (stdDev);
-    free (dataBuffer);
-    dataBuffer = NULL;
     deviceVBox = NULL;
     stdDev     = NULL;
 }
@@ -168,51 +163,48 @@ int INDI_D::removeProperty(INDI_P *pp)
 /* implement any <set???> received from the device.
  * return 0 if ok, else -1 with reason in errmsg[]
  */
-int INDI_D::setAnyCmd (XMLEle *root, QString & errmsg)
+int INDI_D::setAnyCmd (const INDIStreamParser::Message &msg, QString & errmsg)
 {
-    XMLAtt *ap;
     INDI_P *pp;
 
-    ap = findAtt (root, "name", errmsg);
-    if (!ap)
+    if (!msg.hasAttribute("name"))
+    {
+        errmsg = QString("INDI: <%1> missing attribute 'name'").arg(QString(msg.tag));
         return (-1);
+    }
 
-    pp = findProp (valuXMLAtt(ap));
+    pp = findProp (msg.attribute("name"));
     if (!pp)
     {
-        errmsg = QString("INDI: <%1> device %2 has no property named %3").arg(tagXMLEle(root)).arg(name).arg(valuXMLAtt(ap));
+        errmsg = QString("INDI: <%1> device %2 has no property named %3").arg(QString(msg.tag)).arg(name).arg(msg.attribute("name"));
         return (-1);
     }
 
-    deviceManager->checkMsg (root, this);
+    deviceManager->checkMsg (msg, this);
 
-    return (setValue (pp, root, errmsg));
+    return (setValue (pp, msg, errmsg));
 }
 
 /* set the given GUI property according to the XML command.
  * return 0 if ok else -1 with reason in errmsg
  */
-int INDI_D::setValue (INDI_P *pp, XMLEle *root, QString & errmsg)
+int INDI_D::setValue (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg)
 {
-    XMLAtt *ap;
-
     /* set overall property state, if any */
-    ap = findXMLAtt (root, "state");
-    if (ap)
+    if (msg.hasAttribute("state"))
     {
-        if (crackLightState (valuXMLAtt(ap), &pp->state) == 0)
+        if (crackLightState (msg.attributes.value("state").data(), &pp->state) == 0)
             pp->drawLt (pp->state);
         else
         {
-            errmsg = QString("INDI: <%1> bogus state %2 for %3 %4").arg(tagXMLEle(root)).arg(valuXMLAtt(ap)).arg(name).arg(pp->name);
+            errmsg = QString("INDI: <%1> bogus state %2 for %3 %4").arg(QString(msg.tag)).arg(msg.attribute("state")).arg(name).arg(pp->name);
             return (-1);
         }
     }
 
     /* allow changing the timeout */
-    ap = findXMLAtt (root, "timeout");
-    if (ap)
-        pp->timeout = atof(valuXMLAtt(ap));
+    if (msg.hasAttribute("timeout"))
+        pp->timeout = msg.attribute("timeout").toDouble();
 
     /* process specific GUI features */
     switch (pp->guitype)
@@ -222,18 +214,18 @@ int INDI_D::setValue (INDI_P *pp, XMLEle *root, QString & errmsg)
 
     case PG_NUMERIC:	/* FALLTHRU */
     case PG_TEXT:
-        return (setTextValue (pp, root, errmsg));
+        return (setTextValue (pp, msg, errmsg));
         break;
 
     case PG_BUTTONS:
     case PG_LIGHTS:
     case PG_RADIO:
     case PG_MENU:
-        return (setLabelState (pp, root, errmsg));
+        return (setLabelState (pp, msg, errmsg));
         break;
 
     case PG_BLOB:
-        return (setBLOB(pp, root, errmsg));
+        return (setBLOB(pp, msg, errmsg));
         break;
 
     default:
@@ -248,28 +240,25 @@ int INDI_D::setValue (INDI_P *pp, XMLEle *root, QString & errmsg)
  * root should have <text> or <number> child.
  * return 0 if ok else -1 with reason in errmsg
  */
-int INDI_D::setTextValue (INDI_P *pp, XMLEle *root, QString & errmsg)
+int INDI_D::setTextValue (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg)
 {
-    XMLEle *ep;
-    XMLAtt *ap;
     INDI_E *lp;
     QString elementName;
     char iNumber[32];
     double min, max;
 
-    for (ep = nextXMLEle (root, 1); ep != NULL; ep = nextXMLEle (root, 0))
+    foreach (const INDIStreamParser::Member &ep, msg.members)
     {
-        if (strcmp (tagXMLEle(ep), "oneText") && strcmp(tagXMLEle(ep), "oneNumber"))
+        if (ep.tag != "oneText" && ep.tag != "oneNumber")
             continue;
 
-        ap = findXMLAtt(ep, "name");
-        if (!ap)
+        if (!ep.hasAttribute("name"))
         {
             kDebug() << "Error: unable to find attribute 'name' for property " << pp->name;
             return (-1);
         }
 
-        elementName = valuXMLAtt(ap);
+        elementName = ep.attribute("name");
 
         lp = pp->findElement(elementName);
 
@@ -286,20 +275,18 @@ int INDI_D::setTextValue (INDI_P *pp, XMLEle *root, QString & errmsg)
         case PP_RO:
             if (pp->guitype == PG_TEXT)
             {
-                lp->text = QString(pcdataXMLEle(ep));
+                lp->text = ep.text();
                 lp->read_w->setText(lp->text);
             }
             else if (pp->guitype == PG_NUMERIC)
             {
-                lp->value = atof(pcdataXMLEle(ep));
+                lp->value = atof(ep.value.constData());
                 numberFormat(iNumber, lp->format.toAscii(), lp->value);
                 lp->text = iNumber;
                 lp->read_w->setText(lp->text);
 
-                ap = findXMLAtt (ep, "min");
-                if (ap) { min = atof(valuXMLAtt(ap)); lp->setMin(min); }
-                ap = findXMLAtt (ep, "max");
-                if (ap) { max = atof(valuXMLAtt(ap)); lp->setMax(max); }
+                if (ep.hasAttribute("min")) { min = ep.attribute("min").toDouble(); lp->setMin(min); }
+                if (ep.hasAttribute("max")) { max = ep.attribute("max").toDouble(); lp->setMax(max); }
 
                 /*if (lp->spin_w)
                 {
@@ -325,10 +312,8 @@ int INDI_D::setTextValue (INDI_P *pp, XMLEle *root, QString & errmsg)
                 else
                    lp->write_w->setText(lp->text);*/
 
-                ap = findXMLAtt (ep, "min");
-                if (ap) { min = (int) atof(valuXMLAtt(ap)); lp->setMin(min); }
-                ap = findXMLAtt (ep, "max");
-                if (ap) { max = (int) atof(valuXMLAtt(ap)); lp->setMax(max); }
+                if (ep.hasAttribute("min")) { min = (int) ep.attribute("min").toDouble(); lp->setMin(min); }
+                if (ep.hasAttribute("max")) { max = (int) ep.attribute("max").toDouble(); lp->setMax(max); }
             }
             break;
 
@@ -348,47 +333,46 @@ int INDI_D::setTextValue (INDI_P *pp, XMLEle *root, QString & errmsg)
  * root should have some <switch> or <light> children.
  * return 0 if ok else -1 with reason in errmsg
  */
-int INDI_D::setLabelState (INDI_P *pp, XMLEle *root, QString & errmsg)
+int INDI_D::setLabelState (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg)
 {
     int menuChoice=0;
     unsigned i=0;
-    XMLEle *ep;
-    XMLAtt *ap;
     INDI_E *lp = NULL;
     int islight;
     PState state;
+    QByteArray stateName;
 
     /* for each child element */
-    for (ep = nextXMLEle (root, 1), i=0; ep != NULL; ep = nextXMLEle (root, 0), i++)
+    for (i=0; i < (unsigned) msg.members.size(); i++)
     {
+        const INDIStreamParser::Member &ep = msg.members.at(i);
 
         /* only using light and switch */
-        islight = !strcmp (tagXMLEle(ep), "oneLight");
-        if (!islight && strcmp (tagXMLEle(ep), "oneSwitch"))
+        islight = (ep.tag == "oneLight");
+        if (!islight && ep.tag != "oneSwitch")
             continue;
 
-        ap =  findXMLAtt (ep, "name");
         /* no name */
-        if (!ap)
+        if (!ep.hasAttribute("name"))
         {
-            errmsg = QString("INDI: <%1> %2 %3 %4 requires name").arg(tagXMLEle(root)).arg(name,pp->name).arg(tagXMLEle(ep));
+            errmsg = QString("INDI: <%1> %2 %3 %4 requires name").arg(QString(msg.tag)).arg(name,pp->name).arg(QString(ep.tag));
             return (-1);
         }
 
-        if ((islight && crackLightState (pcdataXMLEle(ep), &state) < 0)
-                || (!islight && crackSwitchState (pcdataXMLEle(ep), &state) < 0))
+        stateName = ep.value;
+        if ((islight && crackLightState (stateName.data(), &state) < 0)
+                || (!islight && crackSwitchState (stateName.data(), &state) < 0))
         {
-            errmsg = QString("INDI: <%1> unknown state %2 for %3 %4 %5").arg(tagXMLEle(root)).arg(pcdataXMLEle(ep)).arg(name).arg(pp->name).arg(tagXMLEle(ep));
+            errmsg = QString("INDI: <%1> unknown state %2 for %3 %4 %5").arg(QString(msg.tag)).arg(ep.text()).arg(name).arg(pp->name).arg(QString(ep.tag));
             return (-1);
         }
 
         /* find matching label */
-        //fprintf(stderr, "Find matching label. Name from XML is %s\n", valuXMLAtt(ap));
-        lp = pp->findElement(QString(valuXMLAtt(ap)));
+        lp = pp->findElement(ep.attribute("name"));
 
         if (!lp)
         {
-            errmsg = QString("INDI: <%1> %2 %3 has no choice named %4").arg(tagXMLEle(root)).arg(name).arg(pp->name).arg(valuXMLAtt(ap));
+            errmsg = QString("INDI: <%1> %2 %3 has no choice named %4").arg(QString(msg.tag)).arg(name).arg(pp->name).arg(ep.attribute("name"));
             return (-1);
         }
 
@@ -417,7 +401,7 @@ int INDI_D::setLabelState (INDI_P *pp, XMLEle *root, QString & errmsg)
             {
                 if (menuChoice)
                 {
-                    errmsg = QString("INDI: <%1> %2 %3 has multiple ON states").arg(tagXMLEle(root)).arg(name).arg(pp->name);
+                    errmsg = QString("INDI: <%1> %2 %3 has multiple ON states").arg(QString(msg.tag)).arg(name).arg(pp->name);
                     return (-1);
                 }
                 menuChoice = 1;
@@ -443,24 +427,23 @@ int INDI_D::setLabelState (INDI_P *pp, XMLEle *root, QString & errmsg)
 /* Set BLOB vector. Process incoming data stream
  * Return 0 if okay, -1 if error
 */
-int INDI_D::setBLOB(INDI_P *pp, XMLEle * root, QString & errmsg)
+int INDI_D::setBLOB(INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg)
 {
-    XMLEle *ep;
     INDI_E *blobEL;
 
-    for (ep = nextXMLEle(root,1); ep; ep = nextXMLEle(root,0))
+    foreach (const INDIStreamParser::Member &ep, msg.members)
     {
 
-        if (strcmp(tagXMLEle(ep), "oneBLOB") == 0)
+        if (ep.tag == "oneBLOB")
         {
 
-            blobEL = pp->findElement(QString(findXMLAttValu (ep, "name")));
+            blobEL = pp->findElement(ep.attribute("name"));
 
             if (blobEL)
                 return processBlob(blobEL, ep, errmsg);
             else
             {
-                errmsg = QString("INDI: set %1.%2.%3 not found").arg(name).arg(pp->name).arg(findXMLAttValu(ep, "name"));
+                errmsg = QString("INDI: set %1.%2.%3 not found").arg(name).arg(pp->name).arg(ep.attribute("name"));
                 return (-1);
             }
         }
@@ -473,56 +456,40 @@ int INDI_D::setBLOB(INDI_P *pp, XMLEle * root, QString & errmsg)
 /* Process incoming data stream
  * Return 0 if okay, -1 if error
 */
-int INDI_D::processBlob(INDI_E *blobEL, XMLEle *ep, QString & errmsg)
+int INDI_D::processBlob(INDI_E *blobEL, const INDIStreamParser::Member &ep, QString & errmsg)
 {
-    XMLAtt *ap = NULL;
     int blobSize=0, r=0;
     DTypes dataType;
     uLongf dataSize=0;
     QString dataFormat;
-    char *baseBuffer=NULL;
-    unsigned char *blobBuffer(NULL);
+    const unsigned char *blobBuffer(NULL);
     bool iscomp(false);
 
-    ap = findXMLAtt(ep, "size");
-    if (!ap)
+    if (!ep.hasAttribute("size"))
     {
         errmsg = QString("INDI: set %1 size not found").arg(blobEL->name);
         return (-1);
     }
 
-    dataSize = atoi(valuXMLAtt(ap));
+    dataSize = ep.attribute("size").toInt();
 
-    ap = findXMLAtt(ep, "format");
-    if (!ap)
+    if (!ep.hasAttribute("format"))
     {
         errmsg = QString("INDI: set %1 format not found").arg(blobEL->name);
         return (-1);
     }
 
-    dataFormat = QString(valuXMLAtt(ap));
-
-    baseBuffer = (char *) malloc ( (3*pcdatalenXMLEle(ep)/4) * sizeof (char));
+    dataFormat = ep.attribute("format");
 
-    if (baseBuffer == NULL)
-    {
-	errmsg = QString("Unable to allocate memory for FITS base buffer");
-	kDebug() << errmsg;
-	return (-1);
-    }
- 
-    blobSize   = from64tobits (baseBuffer, pcdataXMLEle(ep));
-    blobBuffer = (unsigned char *) baseBuffer;
+    /* The stream parser decoded the base64 content as it arrived */
+    blobSize   = ep.value.size();
+    blobBuffer = (const unsigned char *) ep.value.constData();
 
     /* Blob size = 0 when only state changes */
     if (dataSize == 0)
-    {
-        free (blobBuffer);
         return (0);
-    }
-    else if (blobSize < 0)
+    else if (ep.badBase64)
     {
-        free (blobBuffer);
         errmsg = QString("INDI: %1.%2.%3 bad base64").arg(name).arg(blobEL->pp->name).arg(blobEL->name);
         return (-1);
     }
@@ -542,31 +509,33 @@ int INDI_D::processBlob(INDI_E *blobEL, XMLEle *ep, QString & errmsg)
 
     if (iscomp)
     {
+        /* The previous BLOB may still be shared with the viewer or the writer */
+        dataBuffer.clear();
+        dataBuffer.resize(dataSize);
 
-        dataBuffer = (unsigned char *) realloc (dataBuffer,  (dataSize * sizeof(unsigned char)));
-	if (baseBuffer == NULL)
-        {
-		free (blobBuffer);
-		errmsg = QString("Unable to allocate memory for FITS data buffer");
-		kDebug() << errmsg;
-		return (-1);
-    	}
-
-        r = uncompress(dataBuffer, &dataSize, blobBuffer, (uLong) blobSize);
+        r = uncompress((unsigned char *) dataBuffer.data(), &dataSize, blobBuffer, (uLong) blobSize);
         if (r != Z_OK)
         {
             errmsg = QString("INDI: %1.%2.%3 compression error: %d").arg(name).arg(blobEL->pp->name).arg(r);
-            free (blobBuffer);
             return -1;
         }
 
+        dataBuffer.truncate(dataSize);
         //kDebug() << "compressed";
     }
     else
     {
         //kDebug() << "uncompressed!!";
-        dataBuffer = (unsigned char *) realloc (dataBuffer,  (dataSize * sizeof(unsigned char)));
-        memcpy(dataBuffer, blobBuffer, dataSize);
+        if (dataSize > (uLongf) blobSize)
+        {
+            errmsg = QString("INDI: %1.%2.%3 is shorter than its size").arg(name).arg(blobEL->pp->name).arg(blobEL->name);
+            return (-1);
+        }
+
+        /* No copy: the buffer is shared with the parsed message */
+        dataBuffer = ep.value;
+        if ((uLongf) blobSize > dataSize)
+            dataBuffer.truncate(dataSize);
     }
 
     if (dataType == ASCII_DATA_STREAM && blobEL->pp->state != PS_BUSY)
@@ -574,15 +543,10 @@ int INDI_D::processBlob(INDI_E *blobEL, XMLEle *ep, QString & errmsg)
         stdDev->asciiFileDirty = true;
 
         if (blobEL->pp->state == PS_IDLE)
-        {
-            free (blobBuffer);
             return(0);
-        }
     }
 
-    stdDev->handleBLOB(dataBuffer, dataSize, dataFormat, dataType);
-
-    free (blobBuffer);
+    stdDev->handleBLOB(dataBuffer, dataFormat, dataType);
 
     return (0);
 
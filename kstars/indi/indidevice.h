@@ -14,6 +14,7 @@
 #include <unistd.h>
 
 #include "indielement.h"
+#include "indistreamparser.h"
 
 #include <QGridLayout>
 #include <QFrame>
@@ -69,7 +70,7 @@ public:
 
     QTabWidget  *groupContainer;	/* Groups within the device */
     QTextEdit	*msgST_w;		/* scrolled text for messages */
-    unsigned char *dataBuffer;          /* Generic buffer */
+    QByteArray    dataBuffer;           /* Last BLOB, shared with the stream parser when not compressed */
 
     INDIStdDevice  *stdDev;
 
@@ -109,15 +110,15 @@ public:
     /*****************************************************************
     * Set/New
     ******************************************************************/
-    int setValue       (INDI_P *pp, XMLEle *root, QString & errmsg);
-    int setLabelState  (INDI_P *pp, XMLEle *root, QString & errmsg);
-    int setTextValue   (INDI_P *pp, XMLEle *root, QString & errmsg);
-    int setBLOB        (INDI_P *pp, XMLEle * root, QString & errmsg);
+    int setValue       (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg);
+    int setLabelState  (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg);
+    int setTextValue   (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg);
+    int setBLOB        (INDI_P *pp, const INDIStreamParser::Message &msg, QString & errmsg);
 
     int newValue       (INDI_P *pp, XMLEle *root, QString & errmsg);
     int newTextValue   (INDI_P *pp, XMLEle *root, QString & errmsg);
 
-    int setAnyCmd      (XMLEle *root, QString & errmsg);
+    int setAnyCmd      (const INDIStreamParser::Message &msg, QString & errmsg);
     int newAnyCmd      (XMLEle *root, QString & errmsg);
 
     int  removeProperty(INDI_P *pp);
@@ -131,7 +132,7 @@ public:
     /*****************************************************************
     * Data processing
     ******************************************************************/
-    int processBlob(INDI_E *blobEL, XMLEle *ep, QString & errmsg);
+    int processBlob(INDI_E *blobEL, const INDIStreamParser::Member &ep, QString & errmsg);
 
     /*****************************************************************
     * INDI standard property policy
@@ -24,6 +24,7 @@
 #include "devicemanager.h"
 #include "dialogs/timedialog.h"
 #include "streamwg.h"
+#include "blobwriter.h"
 
 #include <config-kstars.h>
 
@@ -80,11 +81,13 @@ INDIStdDevice::INDIStdDevice(INDI_D *associatedDevice, KStars * kswPtr)
     devTimer 		= new QTimer(this);
     seqLister		= new KDirLister();
     ascii_data_file     = new QFile();
+    blobWriter          = new BLOBWriter();
 
     telescopeSkyObject   = new SkyObject(0, 0, 0, 0, i18n("Telescope"));
 
     connect( devTimer, SIGNAL(timeout()), this, SLOT(timerDone()) );
     connect( seqLister, SIGNAL(newItems (const KFileItemList & )), this, SLOT(checkSeqBoundary(const KFileItemList &)));
+    connect( blobWriter, SIGNAL(fileWritten(QString, bool)), this, SLOT(blobWritten(QString, bool)), Qt::QueuedConnection);
 
     //downloadDialog = new KProgressDialog(NULL, i18n("INDI"), i18n("Downloading Data..."));
     //downloadDialog->reject();
@@ -100,9 +103,11 @@ INDIStdDevice::~INDIStdDevice()
     streamDisabled();
     delete (telescopeSkyObject);
     delete (seqLister);
+    // Waits for the pending captures to be on disk
+    delete (blobWriter);
 }
 
-void INDIStdDevice::handleBLOB(unsigned char *buffer, int bufferSize, const QString &dataFormat, INDI_D::DTypes dataType)
+void INDIStdDevice::handleBLOB(const QByteArray &data, const QString &dataFormat, INDI_D::DTypes dataType)
 {
 
     if (dataType == INDI_D::VIDEO_STREAM)
@@ -111,14 +116,14 @@ void INDIStdDevice::handleBLOB(unsigned char *buffer, int bufferSize, const QStr
             return;
 
         streamWindow->show();
-        streamWindow->streamFrame->newFrame( buffer, bufferSize, streamWindow->streamWidth, streamWindow->streamHeight);
+        // The frame stays valid as long as the device holds on to it
+        streamWindow->streamFrame->newFrame( (unsigned char *) data.constData(), data.size(), streamWindow->streamWidth, streamWindow->streamHeight);
         return;
     }
 
     // It's either FITS or OTHER
-    char file_template[MAX_FILENAME_LEN];
     QString currentDir = Options::fitsDir();
-    int fd, nr, n=0;
+    int nr, n=0;
 
     if (currentDir.endsWith('/'))
 		currentDir.truncate(sizeof(currentDir)-1);
@@ -127,41 +132,31 @@ void INDIStdDevice::handleBLOB(unsigned char *buffer, int bufferSize, const QStr
 
     streamWindow->close();
 
-    if (dataType == INDI_D::DATA_FITS && !batchMode && Options::showFITS())
-    {
-        strncpy(file_template, "/tmp/fitsXXXXXX", MAX_FILENAME_LEN);
-        if ((fd = mkstemp(file_template)) < 0)
-        {
-            KMessageBox::error(NULL, i18n("Error making temporary filename."));
-            return;
-        }
-	filename = QString(file_template);
-        close(fd);
-    }
-    // Save file to disk
-    else
-    {
-         QString ts = QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss");
+    // FITS shown in the viewer are read from memory, and only saved if requested
+    bool display = (dataType == INDI_D::DATA_FITS && !batchMode && Options::showFITS());
+    bool save    = (!display || Options::saveDisplayedFITS());
 
-        if (dataType == INDI_D::DATA_FITS)
+    QString ts = QDateTime::currentDateTime().toString("yyyy-MM-ddThh:mm:ss");
+
+    if (dataType == INDI_D::DATA_FITS)
+    {
+        if ( batchMode)
         {
-            if ( batchMode)
-	    {
-		if (!ISOMode)
-			filename += seqPrefix + (seqPrefix.isEmpty() ? "" : "_") +  QString("%1.fits").arg(seqCount , 2);
-		else
-			filename += seqPrefix + (seqPrefix.isEmpty() ? "" : "_") + QString("%1_%2.fits").arg(seqCount, 2).arg(ts);
-	    }
+            if (!ISOMode)
+                filename += seqPrefix + (seqPrefix.isEmpty() ? "" : "_") +  QString("%1.fits").arg(seqCount , 2);
             else
-		filename += QString("file_") + ts + ".fits";
-
-            seqCount++;
+                filename += seqPrefix + (seqPrefix.isEmpty() ? "" : "_") + QString("%1_%2.fits").arg(seqCount, 2).arg(ts);
         }
-        else if (dataType == INDI_D::ASCII_DATA_STREAM)
-            filename += QString("file_") + ts + dataFormat;
         else
-	    filename += QString("file_") + ts + '.' + dataFormat;
+            filename += QString("file_") + ts + ".fits";
+
+        if (save)
+            seqCount++;
     }
+    else if (dataType == INDI_D::ASCII_DATA_STREAM)
+        filename += QString("file_") + ts + dataFormat;
+    else
+        filename += QString("file_") + ts + '.' + dataFormat;
 
     //kDebug() << "Final file name is " << filename;
 
@@ -180,60 +175,57 @@ void INDIStdDevice::handleBLOB(unsigned char *buffer, int bufferSize, const QStr
         }
 
            QDataStream out(ascii_data_file);
-           for (nr=0; nr < (int) bufferSize; nr += n)
-               n = out.writeRawData( (const char *) (buffer+nr), bufferSize - nr);
+           for (nr=0; nr < data.size(); nr += n)
+               n = out.writeRawData( data.constData() + nr, data.size() - nr);
 
            out.writeRawData( (const char *) "\n" , 1);
            ascii_data_file->flush();
 
+           return;
      }
-    else
-    {
-        QFile fits_temp_file(filename);
-        if (!fits_temp_file.open(QIODevice::WriteOnly))
-        {
-                kDebug() << "Error: Unable to open " << fits_temp_file.fileName() << endl;
-		return;
-        }
-
-        QDataStream out(&fits_temp_file);
-
-        for (nr=0; nr < (int) bufferSize; nr += n)
-            n = out.writeRawData( (const char *) (buffer+nr), bufferSize - nr);
-
-        fits_temp_file.close();
-    }
 
+    // Files are written in the background, the status bar is updated in blobWritten()
+    if (save)
+        blobWriter->write(filename, data);
 
-    // We're done if we have DATA_OTHER or DATA_STREAM or DATA_FITS if CFITSIO is not enabled.
-    if (dataType == INDI_D::DATA_OTHER || dataType == INDI_D::ASCII_DATA_STREAM)
-    {
-        if (dataType == INDI_D::DATA_OTHER)
-            ksw->statusBar()->changeItem( i18n("Data file saved to %1", filename ), 0);
+    if (dataType == INDI_D::DATA_OTHER)
         return;
-    }
 
-    if (dataType == INDI_D::DATA_FITS && (batchMode || !Options::showFITS()))
+    if (!display)
     {
-        ksw->statusBar()->changeItem( i18n("FITS file saved to %1", filename ), 0);
         emit FITSReceived(dp->label);
         return;
     }
 
-
     // FIXME It appears that FITSViewer causes a possible stack corruption, needs to investigate
 
     // Unless we have cfitsio, we're done.
     #ifdef HAVE_CFITSIO_H
-    KUrl fileURL(filename);
+    KUrl fileURL;
+    if (save)
+        fileURL = KUrl(filename);
 
-    FITSViewer * fv = new FITSViewer(&fileURL, ksw);
+    FITSViewer * fv = new FITSViewer(&fileURL, ksw, data);
     fv->fitsChange();
     fv->show();
     #endif
 
 }
 
+void INDIStdDevice::blobWritten(const QString &filename, bool ok)
+{
+    if (!ok)
+    {
+        ksw->statusBar()->changeItem( i18n("Unable to save %1", filename ), 0);
+        return;
+    }
+
+    if (filename.endsWith(".fits"))
+        ksw->statusBar()->changeItem( i18n("FITS file saved to %1", filename ), 0);
+    else
+        ksw->statusBar()->changeItem( i18n("Data file saved to %1", filename ), 0);
+}
+
 /*******************************************************************************/
 /* Process TEXT & NUMBER property updates received FROM the driver	       */
 /*******************************************************************************/
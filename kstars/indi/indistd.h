@@ -30,6 +30,7 @@ class KProgressDialog;
 class KDirLister;
 class SkyObject;
 class SkyPoint;
+class BLOBWriter;
 
 
 /* This class implmements standard properties on the device level*/
@@ -51,7 +52,7 @@ public:
     void setTextValue(INDI_P *pp);
     void setLabelState(INDI_P *pp);
     void registerProperty(INDI_P *pp);
-    void handleBLOB(unsigned char *buffer, int bufferSize, const QString &dataFormat, INDI_D::DTypes dataType);
+    void handleBLOB(const QByteArray &data, const QString &dataFormat, INDI_D::DTypes dataType);
 
     /* Device options */
     void createDeviceInit();
@@ -77,6 +78,7 @@ public:
     bool		ISOMode;
     bool		driverLocationUpdated, driverTimeUpdated, asciiFileDirty;
     KDirLister          *seqLister;
+    BLOBWriter          *blobWriter;        /* Saves the BLOBs in the background */
     SkyObject		*telescopeSkyObject;
 
 public slots:
@@ -86,6 +88,7 @@ public slots:
 
 protected slots:
     void checkSeqBoundary(const KFileItemList & items);
+    void blobWritten(const QString &filename, bool ok);
 
 signals:
     void linkRejected();
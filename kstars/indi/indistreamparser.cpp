@@ -0,0 +1,370 @@
+/*  INDI Stream Parser
+    Copyright (C) 2026 KStars Developers (kstars-devel@kde.org)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    2026-10-17	Incremental parser of the XML stream sent by indiserver.
+ */
+
+#include "indistreamparser.h"
+
+#include <string.h>
+#include <ctype.h>
+
+#include <KDebug>
+
+namespace {
+    // Base64 decoding table: the value of each character, or one of these
+    const signed char BAD  = -1;    // Not base64
+    const signed char PAD  = -2;    // Padding
+    const signed char SKIP = -3;    // White space, INDI breaks the content in lines
+
+    const signed char BASE64[256] = {
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, SKIP, SKIP, BAD, BAD, SKIP, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        SKIP, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, 62, BAD, BAD, BAD, 63,
+        52, 53, 54, 55, 56, 57, 58, 59, 60, 61, BAD, BAD, BAD, PAD, BAD, BAD,
+        BAD, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+        15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, BAD, BAD, BAD, BAD, BAD,
+        BAD, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+        41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+        BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD
+    };
+
+    // Replaces the predefined entities, which are all INDI escapes
+    QByteArray unescape( const char *s, int length ) {
+        if ( ! memchr( s, '&', length ) )
+            return QByteArray( s, length );
+
+        QByteArray result;
+        result.reserve( length );
+        for ( int i = 0; i < length; ++i ) {
+            if ( s[ i ] != '&' ) {
+                result.append( s[ i ] );
+                continue;
+            }
+            const char *e = s + i;
+            int left = length - i;
+            if ( left >= 4 && ! strncmp( e, "&lt;", 4 ) )        { result.append( '<' );  i += 3; }
+            else if ( left >= 4 && ! strncmp( e, "&gt;", 4 ) )   { result.append( '>' );  i += 3; }
+            else if ( left >= 5 && ! strncmp( e, "&amp;", 5 ) )  { result.append( '&' );  i += 4; }
+            else if ( left >= 6 && ! strncmp( e, "&quot;", 6 ) ) { result.append( '"' ); i += 5; }
+            else if ( left >= 6 && ! strncmp( e, "&apos;", 6 ) ) { result.append( '\'' ); i += 5; }
+            else result.append( '&' );
+        }
+        return result;
+    }
+
+    // Parses name='value' pairs between p and end
+    void parseAttributes( const char *p, const char *end, INDIStreamParser::Attributes *attributes ) {
+        while ( p < end ) {
+            while ( p < end && isspace( (unsigned char) *p ) )
+                ++p;
+            const char *name = p;
+            while ( p < end && *p != '=' && ! isspace( (unsigned char) *p ) )
+                ++p;
+            const char *nameEnd = p;
+            while ( p < end && ( *p == '=' || isspace( (unsigned char) *p ) ) )
+                ++p;
+            if ( p >= end || ( *p != '\'' && *p != '"' ) )
+                return;
+            char quote = *p++;
+            const char *value = p;
+            while ( p < end && *p != quote )
+                ++p;
+            if ( nameEnd > name )
+                attributes->insert( QByteArray( name, nameEnd - name ), unescape( value, p - value ) );
+            ++p;
+        }
+    }
+}
+
+INDIStreamParser::INDIStreamParser()
+{
+    reset();
+}
+
+void INDIStreamParser::reset()
+{
+    m_State = Outside;
+    m_Buffer.clear();
+    m_Pos = 0;
+    m_Depth = 0;
+    m_Message = Message();
+    m_Member = Member();
+    m_InBLOB = false;
+    m_Bits = 0;
+    m_NBits = 0;
+    m_Messages.clear();
+}
+
+void INDIStreamParser::feed( const QByteArray &data )
+{
+    // Most reads end on a message boundary, then the chunk is used without a copy
+    if ( m_Pos == m_Buffer.size() )
+    {
+        m_Buffer = data;
+        m_Pos = 0;
+    }
+    else
+        m_Buffer.append( data );
+
+    const char *buffer = m_Buffer.constData();
+    const int size = m_Buffer.size();
+
+    while ( m_Pos < size )
+    {
+        if ( buffer[ m_Pos ] == '<' )
+        {
+            int end = findTagEnd( m_Pos + 1 );
+            // The rest of the tag is in the next chunk
+            if ( end < 0 )
+                break;
+            handleTag( buffer + m_Pos + 1, end - m_Pos - 1 );
+            m_Pos = end + 1;
+        }
+        else
+        {
+            const char *lt = (const char *) memchr( buffer + m_Pos, '<', size - m_Pos );
+            int stop = lt ? lt - buffer : size;
+            handleText( buffer + m_Pos, stop - m_Pos );
+            m_Pos = stop;
+        }
+    }
+
+    // Only a partial tag is left over
+    if ( m_Pos == size )
+    {
+        m_Buffer.clear();
+        m_Pos = 0;
+    }
+    else if ( m_Pos > 0 )
+    {
+        m_Buffer = m_Buffer.mid( m_Pos );
+        m_Pos = 0;
+    }
+}
+
+int INDIStreamParser::findTagEnd( int from ) const
+{
+    const char *buffer = m_Buffer.constData();
+    const int size = m_Buffer.size();
+    char quote = 0;
+
+    // A '>' may appear in an attribute value
+    for ( int i = from; i < size; ++i )
+    {
+        char c = buffer[ i ];
+        if ( quote )
+        {
+            if ( c == quote )
+                quote = 0;
+        }
+        else if ( c == '\'' || c == '"' )
+            quote = c;
+        else if ( c == '>' )
+            return i;
+    }
+    return -1;
+}
+
+void INDIStreamParser::handleTag( const char *tag, int length )
+{
+    if ( length <= 0 )
+        return;
+
+    // Processing instructions and comments
+    if ( tag[ 0 ] == '?' || tag[ 0 ] == '!' )
+    {
+        if ( m_State == InElement )
+            m_Message.xml.append( '<' ).append( tag, length ).append( '>' );
+        return;
+    }
+
+    bool closing = ( tag[ 0 ] == '/' );
+    bool empty = ! closing && ( tag[ length - 1 ] == '/' );
+    const char *p = closing ? tag + 1 : tag;
+    const char *end = tag + length - ( empty ? 1 : 0 );
+    const char *nameEnd = p;
+    while ( nameEnd < end && ! isspace( (unsigned char) *nameEnd ) )
+        ++nameEnd;
+
+    switch ( m_State )
+    {
+    case Outside:
+        if ( closing )
+        {
+            kDebug() << "INDI stream: stray closing tag" << QByteArray( tag, length );
+            return;
+        }
+
+        m_Message = Message();
+        m_Message.tag = QByteArray( p, nameEnd - p );
+
+        if ( m_Message.tag.startsWith( "set" ) && m_Message.tag.endsWith( "Vector" ) )
+        {
+            m_Message.kind = Message::Vector;
+            parseAttributes( nameEnd, end, &m_Message.attributes );
+            if ( empty )
+                finishMessage();
+            else
+                m_State = InVector;
+        }
+        else
+        {
+            m_Message.kind = Message::Element;
+            m_Message.xml.append( '<' ).append( tag, length ).append( '>' );
+            if ( empty )
+                finishMessage();
+            else
+            {
+                m_Depth = 1;
+                m_State = InElement;
+            }
+        }
+        break;
+
+    case InElement:
+        m_Message.xml.append( '<' ).append( tag, length ).append( '>' );
+        if ( closing )
+        {
+            if ( --m_Depth == 0 )
+                finishMessage();
+        }
+        else if ( ! empty )
+            ++m_Depth;
+        break;
+
+    case InVector:
+        // Members do not nest, so this closes the vector
+        if ( closing )
+        {
+            finishMessage();
+            return;
+        }
+
+        m_Member = Member();
+        m_Member.tag = QByteArray( p, nameEnd - p );
+        parseAttributes( nameEnd, end, &m_Member.attributes );
+
+        m_InBLOB = ( m_Member.tag == "oneBLOB" );
+        if ( m_InBLOB )
+        {
+            m_Bits = 0;
+            m_NBits = 0;
+            // The size is that of the decoded data, unless it is compressed
+            if ( ! m_Member.attributes.value( "format" ).contains( ".z" ) )
+                m_Member.value.reserve( m_Member.attributes.value( "size" ).toInt() );
+        }
+
+        if ( empty )
+            finishMember();
+        else
+            m_State = InMember;
+        break;
+
+    case InMember:
+        if ( closing )
+            finishMember();
+        break;
+    }
+}
+
+void INDIStreamParser::handleText( const char *text, int length )
+{
+    switch ( m_State )
+    {
+    case InElement:
+        m_Message.xml.append( text, length );
+        break;
+
+    case InMember:
+        if ( m_InBLOB )
+            decodeBase64( text, length );
+        else
+            m_Member.value.append( text, length );
+        break;
+
+    default:
+        break;
+    }
+}
+
+void INDIStreamParser::decodeBase64( const char *text, int length )
+{
+    int old = m_Member.value.size();
+    m_Member.value.resize( old + ( length / 4 + 1 ) * 3 );
+    uchar *begin = (uchar *) m_Member.value.data();
+    uchar *out = begin + old;
+
+    quint32 bits = m_Bits;
+    int n = m_NBits;
+    for ( int i = 0; i < length; ++i )
+    {
+        signed char v = BASE64[ (uchar) text[ i ] ];
+        if ( v < 0 )
+        {
+            if ( v == BAD )
+                m_Member.badBase64 = true;
+            continue;
+        }
+
+        bits = ( bits << 6 ) | v;
+        if ( ++n == 4 )
+        {
+            out[ 0 ] = bits >> 16;
+            out[ 1 ] = bits >> 8;
+            out[ 2 ] = bits;
+            out += 3;
+            bits = 0;
+            n = 0;
+        }
+    }
+
+    m_Bits = bits;
+    m_NBits = n;
+    m_Member.value.resize( out - begin );
+}
+
+void INDIStreamParser::finishMember()
+{
+    if ( m_InBLOB )
+    {
+        // The last group, shortened by the padding
+        if ( m_NBits == 1 )
+            m_Member.badBase64 = true;
+        else if ( m_NBits == 2 )
+            m_Member.value.append( char( m_Bits >> 4 ) );
+        else if ( m_NBits == 3 )
+            m_Member.value.append( char( m_Bits >> 10 ) ).append( char( m_Bits >> 2 ) );
+        m_NBits = 0;
+        m_Bits = 0;
+        m_InBLOB = false;
+    }
+    else
+    {
+        QByteArray text = m_Member.value.trimmed();
+        m_Member.value = unescape( text.constData(), text.size() );
+    }
+
+    m_Message.members.append( m_Member );
+    m_Member = Member();
+    m_State = InVector;
+}
+
+void INDIStreamParser::finishMessage()
+{
+    m_Messages.enqueue( m_Message );
+    m_Message = Message();
+    m_State = Outside;
+}
@@ -0,0 +1,139 @@
+/*  INDI Stream Parser
+    Copyright (C) 2026 KStars Developers (kstars-devel@kde.org)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    2026-10-17	Incremental parser of the XML stream sent by indiserver.
+ */
+
+#ifndef INDISTREAMPARSER_H_
+#define INDISTREAMPARSER_H_
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QString>
+
+/**
+ *@class INDIStreamParser
+ *Incremental parser of the XML stream sent by indiserver.
+ *
+ *The parser is fed the raw bytes read from the socket, in chunks of any
+ *size, and queues the top level elements as they complete.
+ *
+ *The set*Vector messages, which make up nearly all of the traffic, are
+ *parsed in a flat form: the attributes of the vector and of each of its
+ *members, and the content of each member. No element tree is built, and
+ *the base64 content of the BLOBs is decoded as it arrives, so an image is
+ *never held in memory in its encoded form.
+ *
+ *Any other element (def*Vector, message, delProperty...) is queued as its
+ *raw XML, to be handed to LilXML.
+ */
+class INDIStreamParser
+{
+public:
+    typedef QHash<QByteArray, QByteArray> Attributes;
+
+    /**
+     *@class INDIStreamParser::Member
+     *One member of a set*Vector: oneText, oneNumber, oneSwitch, oneLight or oneBLOB.
+     */
+    class Member {
+    public:
+        Member() : badBase64( false ) {}
+
+        /** @return the value of the attribute, or an empty string if there is none */
+        QString attribute( const char *name ) const { return QString::fromUtf8( attributes.value( name ) ); }
+
+        /** @return true if the member has the attribute */
+        bool hasAttribute( const char *name ) const { return attributes.contains( name ); }
+
+        /** @return the content, without leading and trailing white space */
+        QString text() const { return QString::fromUtf8( value ); }
+
+        QByteArray tag;
+        Attributes attributes;
+        QByteArray value;       // Content of the member; for a oneBLOB, the decoded bytes
+        bool badBase64;         // The oneBLOB content is not valid base64
+    };
+
+    /**
+     *@class INDIStreamParser::Message
+     *A complete top level element.
+     */
+    class Message {
+    public:
+        enum Kind { Vector, Element };
+
+        Message() : kind( Element ) {}
+
+        /** @return the value of the attribute, or an empty string if there is none */
+        QString attribute( const char *name ) const { return QString::fromUtf8( attributes.value( name ) ); }
+
+        /** @return true if the message has the attribute */
+        bool hasAttribute( const char *name ) const { return attributes.contains( name ); }
+
+        Kind kind;
+        QByteArray tag;
+        Attributes attributes;  // Vector only
+        QList<Member> members;  // Vector only
+        QByteArray xml;         // Element only: the raw XML
+    };
+
+    INDIStreamParser();
+
+    /**
+     *@short Parse the next chunk of the stream
+     */
+    void feed( const QByteArray &data );
+
+    /** @return true if complete messages are waiting */
+    inline bool hasMessages() const { return ! m_Messages.isEmpty(); }
+
+    /** @return the oldest complete message, removing it from the queue */
+    inline Message takeMessage() { return m_Messages.dequeue(); }
+
+    /**
+     *@short Drop the partial and the queued messages, e.g. after a reconnection
+     */
+    void reset();
+
+private:
+    enum State { Outside, InElement, InVector, InMember };
+
+    /** @short Handle the tag between '<' and '>', of the given length */
+    void handleTag( const char *tag, int length );
+
+    /** @short Handle content, which may be cut anywhere */
+    void handleText( const char *text, int length );
+
+    /** @short Close the current member */
+    void finishMember();
+
+    /** @short Queue the current message */
+    void finishMessage();
+
+    /** @short Decode base64 into the current member */
+    void decodeBase64( const char *text, int length );
+
+    /** @return the index of the '>' closing the tag which starts at from, or -1 */
+    int findTagEnd( int from ) const;
+
+    State m_State;
+    QByteArray m_Buffer;        // Bytes not consumed yet
+    int m_Pos;                  // First byte of m_Buffer not consumed
+    int m_Depth;                // Depth of the raw element
+    Message m_Message;          // Message being parsed
+    Member m_Member;            // Member being parsed
+    bool m_InBLOB;              // The member is a oneBLOB
+    quint32 m_Bits;             // Pending base64 bits
+    int m_NBits;                // Number of pending base64 characters
+    QQueue<Message> m_Messages;
+};
+
+#endif
@@ -0,0 +1,167 @@
+/*  INDI Stream Parser test
+    Copyright (C) 2026 KStars Developers (kstars-devel@kde.org)
+
+    This application is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public
+    License as published by the Free Software Foundation; either
+    version 2 of the License, or (at your option) any later version.
+
+    2026-10-17	Replay of a recorded session into LilXML and INDIStreamParser.
+ */
+
+#include <stdio.h>
+
+#include <lilxml.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include "indistreamparser.h"
+
+
+/******************************************************************************
+ * Replays a recorded INDI session through a local TCP connection, standing in
+ * for indiserver, once into LilXML fed one character at a time, as
+ * DeviceManager used to do, and once into INDIStreamParser. Both must find
+ * the same number of messages; the throughput of each is printed.
+ *
+ * Usage: test-indistreamparser session.xml
+ *****************************************************************************/
+
+namespace {
+    // Chunk size of the replay, about what a socket read returns
+    const int REPLAY_CHUNK = 16384;
+    // Size of the LilXML error buffer
+    const int LILXML_ERRMSG_SIZE = 1024;
+
+    // Takes the chunks read from the replay socket
+    class ReplayConsumer {
+    public:
+        ReplayConsumer() : messages( 0 ) {}
+        virtual ~ReplayConsumer() {}
+        virtual void consume( const QByteArray &chunk ) = 0;
+        int messages;
+    };
+
+    class LilXMLConsumer : public ReplayConsumer {
+    public:
+        LilXMLConsumer() : parser( newLilXML() ) {}
+        ~LilXMLConsumer() { delLilXML( parser ); }
+        void consume( const QByteArray &chunk ) {
+            char errmsg[ LILXML_ERRMSG_SIZE ];
+            for ( int i = 0; i < chunk.size(); ++i ) {
+                XMLEle *root = readXMLEle( parser, chunk.at( i ), errmsg );
+                if ( root ) {
+                    ++messages;
+                    delXMLEle( root );
+                }
+            }
+        }
+        LilXML *parser;
+    };
+
+    class StreamConsumer : public ReplayConsumer {
+    public:
+        void consume( const QByteArray &chunk ) {
+            parser.feed( chunk );
+            while ( parser.hasMessages() ) {
+                parser.takeMessage();
+                ++messages;
+            }
+        }
+        INDIStreamParser parser;
+    };
+
+    // Sends the session through a local TCP connection and hands what is
+    // read to the consumer.
+    // Returns the time spent in the consumer (ns), or -1 if the replay failed.
+    qint64 replay( const QByteArray &session, ReplayConsumer *consumer ) {
+        QTcpServer server;
+        if ( ! server.listen( QHostAddress::LocalHost ) )
+            return -1;
+
+        QTcpSocket client;
+        client.connectToHost( QHostAddress::LocalHost, server.serverPort() );
+        if ( ! client.waitForConnected( 1000 ) || ! server.waitForNewConnection( 1000 ) )
+            return -1;
+        QTcpSocket *indiserver = server.nextPendingConnection();
+
+        QElapsedTimer timer;
+        qint64 elapsed = 0;
+        int sent = 0, received = 0;
+        while ( received < session.size() ) {
+            if ( sent < session.size() ) {
+                int n = qMin( REPLAY_CHUNK, session.size() - sent );
+                indiserver->write( session.constData() + sent, n );
+                indiserver->waitForBytesWritten( 1000 );
+                sent += n;
+            }
+            if ( client.bytesAvailable() == 0 && ! client.waitForReadyRead( 1000 ) )
+                break;
+
+            QByteArray chunk = client.readAll();
+            received += chunk.size();
+            // Only the parsing is timed, not the socket
+            timer.start();
+            consumer->consume( chunk );
+            elapsed += timer.nsecsElapsed();
+        }
+
+        delete indiserver;
+        return ( received == session.size() ) ? elapsed : -1;
+    }
+}
+
+int main( int argc, char **argv )
+{
+    QCoreApplication app( argc, argv );
+
+    if ( argc < 2 )
+    {
+        fprintf( stderr, "Usage: %s session.xml\n", argv[0] );
+        return 2;
+    }
+
+    QFile file( argv[1] );
+    if ( ! file.open( QIODevice::ReadOnly ) )
+    {
+        fprintf( stderr, "Unable to open %s\n", argv[1] );
+        return 2;
+    }
+
+    QByteArray session = file.readAll();
+    printf( "%s: %d bytes\n", argv[1], session.size() );
+
+    LilXMLConsumer lilxml;
+    StreamConsumer stream;
+    const char *names[2] = { "LilXML", "Stream parser" };
+    ReplayConsumer *consumers[2] = { &lilxml, &stream };
+    int errors = 0;
+
+    for ( int i = 0; i < 2; ++i )
+    {
+        qint64 elapsed = replay( session, consumers[ i ] );
+        if ( elapsed < 0 )
+        {
+            printf( "%s: replay failed\n", names[ i ] );
+            ++errors;
+            continue;
+        }
+
+        double ms = elapsed / 1.0e6;
+        double rate = elapsed > 0 ? session.size() / 1.048576 * 1.0e3 / elapsed : 0.0;
+        printf( "%s: %d messages in %.3f ms (%.1f MB/s)\n", names[ i ], consumers[ i ]->messages, ms, rate );
+    }
+
+    if ( lilxml.messages != stream.messages )
+    {
+        printf( "The parsers disagree on the number of messages\n" );
+        ++errors;
+    }
+
+    return errors ? 1 : 0;
+}
@@ -35,6 +35,7 @@
 #include "dialogs/finddialog.h"
 #include "observinglist.h"
 #include "oal/execute.h"
+#include "skycomponents/starblockfactory.h"
 
 #include "kstarsadaptor.h"
 
@@ -53,7 +54,7 @@ KStars::KStars( bool doSplash, bool clockrun, const QString &startdate ) :
         colorActionMenu(0), fovActionMenu(0),
         AAVSODialog(0), findDialog(0), obsList(0),
         execute(0),
-        avt(0), wut(0), skycal(0),
+        avt(0), wut(0), skycal(0), satpasses(0),
         sb(0), pv(0), jmt(0), fm(0), astrocalc(0), indimenu(0), indidriver(0), indiseq(0),
         DialogIsObsolete(false), StartClockRunning( clockrun ),
         StartDateString( startdate )
@@ -188,6 +189,9 @@ void KStars::applyConfig( bool doApplyFocus ) {
     //Geographic location
     data()->setLocationFromOptions();
 
+    //Memory of the star cache
+    StarBlockFactory::Instance()->setMaxBytes( (quint64) Options::starCacheSize() * 1048576 );
+
     //Focus
     if ( doApplyFocus ) {
         SkyObject *fo = data()->objectNamed( Options::focusObject() );
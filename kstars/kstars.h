@@ -45,6 +45,7 @@ class LCGenerator;
 class WUTDialog;
 class AstroCalc;
 class SkyCalendar;
+class SatellitePasses;
 class ScriptBuilder;
 class PlanetViewer;
 class JMoonTool;
@@ -248,6 +249,47 @@ public Q_SLOTS:
      */
     QString getOption( const QString &name );
 
+    /**DBUS interface function.
+     * @return statistics of the cache that holds the stars loaded from the
+     * deep star catalogs, as space-separated name=value pairs: hits, misses,
+     * evictions, blocks, bytesResident, bytesAllocated and bytesLimit.
+     */
+    Q_SCRIPTABLE QString getStarCacheStatistics();
+
+    /**DBUS interface function.
+     * Predict the passes of the satellites of all the loaded TLE groups
+     * above the current geographic location.
+     * @param start the local date and time where the search starts, in ISO format
+     * @param days the length of the search, in days. It must be positive,
+     * and is limited to 30 days.
+     * @return one line per pass, sorted by rise time, with the tab-separated
+     * fields: name, rise time (UT), rise azimuth, culmination time (UT),
+     * maximum altitude, set time (UT), set azimuth and visibility (1 or 0).
+     */
+    Q_SCRIPTABLE QString getSatellitePasses( const QString &start, double days );
+
+    /**DBUS interface function.
+     * List the names of the objects with a word starting with the text,
+     * or the names closest to it if there is none.
+     * @param text the start of a name, or a misspelt name
+     * @return the names, one per line
+     */
+    Q_SCRIPTABLE QString findObjectNames( const QString &text );
+
+    /**DBUS interface function.
+     * Turn the frame profiler on or off.  Turning it on drops the
+     * samples collected so far.
+     * @param on true to time the parts of each frame of the sky map
+     */
+    Q_SCRIPTABLE Q_NOREPLY void setFrameProfiling( bool on );
+
+    /**DBUS interface function.
+     * @return the time spent in each part of the last frames of the sky
+     * map: the components, the time update stages, JIT updates, labels and
+     * painter calls, with their histograms
+     */
+    Q_SCRIPTABLE QString getFrameProfile();
+
     /**DBUS interface function.  Read config file.
      * This function is useful for restoring the user settings from the config file,
      * after having modified the settings in memory.
@@ -489,6 +531,9 @@ private slots:
     /** action slot: open Sky Calendar tool */
     void slotCalendar();
 
+    /** action slot: open Satellite Passes tool */
+    void slotSatellitePasses();
+
     /** action slot: open the glossary */
     void slotGlossary();
 
@@ -625,6 +670,7 @@ private:
     AltVsTime *avt;
     WUTDialog *wut;
     SkyCalendar *skycal;
+    SatellitePasses *satpasses;
     ScriptBuilder *sb;
     PlanetViewer *pv;
     JMoonTool *jmt;
@@ -69,6 +69,7 @@
 #include "tools/altvstime.h"
 #include "tools/wutdialog.h"
 #include "tools/skycalendar.h"
+#include "tools/satellitepasses.h"
 #include "tools/scriptbuilder.h"
 #include "tools/planetviewer.h"
 #include "tools/jmoontool.h"
@@ -267,6 +268,11 @@ void KStars::slotCalendar() {
     skycal->show();
 }
 
+void KStars::slotSatellitePasses() {
+    if ( ! satpasses ) satpasses = new SatellitePasses(this);
+    satpasses->show();
+}
+
 void KStars::slotGlossary(){
     // 	GlossaryDialog *dlg = new GlossaryDialog( this, true );
     // 	QString glossaryfile =data()->stdDirs->findResource( "data", "kstars/glossary.xml" );
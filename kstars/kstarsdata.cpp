@@ -32,6 +32,7 @@
 #include "dms.h"
 #include "fov.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "ksutils.h"
 #include "ksfilereader.h"
 #include "ksnumbers.h"
@@ -116,7 +117,8 @@ KStarsData::KStarsData() :
     locale( new KLocale( "kstars" ) ),
     m_preUpdateID(0),        m_updateID(0),
     m_preUpdateNumID(0),     m_updateNumID(0),
-    m_preUpdateNum( J2000 ), m_updateNum( J2000 )
+    m_preUpdateNum( J2000 ), m_updateNum( J2000 ),
+    m_updatePipeline( &m_updateNum )
 {
     TypeName[0] = i18n( "star" );
     TypeName[1] = i18n( "star" );
@@ -227,17 +229,20 @@ void KStarsData::updateTime( GeoLocation *geo, SkyMap *skymap, const bool automa
         LastNumUpdate = ut().djd();
         m_preUpdateNumID++;
         m_preUpdateNum = KSNumbers( num );
+        FrameProfiler::Timer t( "Update time: precession" );
         skyComposite()->update( &num );
     }
 
     if ( fabs( ut().djd() - LastPlanetUpdate.djd() ) > 0.01 ) {
         LastPlanetUpdate = ut().djd();
+        FrameProfiler::Timer t( "Update time: planets" );
         skyComposite()->updatePlanets( &num );
     }
 
     // Moon moves ~30 arcmin/hr, so update its position every minute.
     if ( fabs( ut().djd() - LastMoonUpdate.djd() ) > 0.00069444 ) {
         LastMoonUpdate = ut();
+        FrameProfiler::Timer t( "Update time: moons" );
         skyComposite()->updateMoons( &num );
     }
 
@@ -246,7 +251,10 @@ void KStarsData::updateTime( GeoLocation *geo, SkyMap *skymap, const bool automa
     if ( fabs( ut().djd() - LastSkyUpdate.djd() ) > 0.1/Options::zoomFactor() || clock()->isManualMode() ) {
         LastSkyUpdate = ut();
         m_preUpdateID++;
-        skyComposite()->update(); //omit KSNumbers arg == just update Alt/Az coords
+        {
+            FrameProfiler::Timer t( "Update time: horizontal coordinates" );
+            skyComposite()->update(); //omit KSNumbers arg == just update Alt/Az coords
+        }
 
         //Update focus
         skymap->updateFocus();
@@ -264,6 +272,13 @@ void KStarsData::syncUpdateIDs()
     if ( m_updateNumID == m_preUpdateNumID ) return;
     m_updateNumID = m_preUpdateNumID;
     m_updateNum = KSNumbers( m_preUpdateNum );
+    m_updatePipeline.setEpoch( &m_updateNum );
+}
+
+const CoordinatePipeline* KStarsData::updatePipeline()
+{
+    m_updatePipeline.setHorizon( &LST, geo()->lat() );
+    return &m_updatePipeline;
 }
 
 unsigned int KStarsData::incUpdateID() {
@@ -28,6 +28,7 @@
 
 #include "geolocation.h"
 #include "colorscheme.h"
+#include "coordinatepipeline.h"
 #include "kstarsdatetime.h"
 #include "simclock.h"
 #include "oal/oal.h"
@@ -219,6 +220,12 @@ public:
     KSNumbers* updateNum()     { return &m_updateNum; }
     void syncUpdateIDs();
 
+    /**
+     *@return the coordinate pipeline of updateNum(), at the current LST
+     *and geographic latitude, for batched updates of SkyPoints
+     */
+    const CoordinatePipeline* updatePipeline();
+
 signals:
     /** Signal that specifies the text that should be drawn in the KStarsSplash window. */
     void progressText( const QString& );
@@ -379,6 +386,7 @@ private:
     quint32   m_preUpdateID,    m_updateID;
     quint32   m_preUpdateNumID, m_updateNumID;
     KSNumbers m_preUpdateNum,   m_updateNum;
+    CoordinatePipeline m_updatePipeline;      // Of m_updateNum
 
     static KStarsData* pinstance;
 };
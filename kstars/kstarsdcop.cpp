@@ -42,9 +42,14 @@
 #include "kstars.h"
 #include "kstarsdata.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "skyobjects/skyobject.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/starblockfactory.h"
+#include "skycomponents/satellitescomponent.h"
+#include "skycomponents/nameindex.h"
+#include "satellitepasspredictor.h"
 #include "simclock.h"
 #include "Options.h"
 
@@ -274,6 +279,76 @@ QString KStars::getOption( const QString &name ) {
     else return QString();
 }
 
+QString KStars::getStarCacheStatistics() {
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+    return QString( "hits=%1 misses=%2 evictions=%3 blocks=%4 bytesResident=%5 bytesAllocated=%6 bytesLimit=%7" )
+        .arg( factory->getHitCount() )
+        .arg( factory->getMissCount() )
+        .arg( factory->getEvictionCount() )
+        .arg( factory->getBlockCount() )
+        .arg( factory->getBytesResident() )
+        .arg( factory->getBytesAllocated() )
+        .arg( factory->getMaxBytes() );
+}
+
+QString KStars::getSatellitePasses( const QString &start, double days ) {
+    if ( ! ( days > 0.0 ) ) {
+        kWarning() << "The search for satellite passes needs a positive number of days, not" << days;
+        return QString();
+    }
+    if ( days > SatellitePassPredictor::MAX_DAYS ) {
+        kWarning() << "Searching for satellite passes over" << int( SatellitePassPredictor::MAX_DAYS ) << "days instead of" << days;
+        days = SatellitePassPredictor::MAX_DAYS;
+    }
+
+    GeoLocation *geo = data()->geo();
+    KStarsDateTime startUT = data()->ut();
+    if ( ! start.isEmpty() ) {
+        KStarsDateTime lt = KStarsDateTime::fromString( start );
+        if ( lt.isValid() )
+            startUT = geo->LTtoUT( lt );
+        else
+            kWarning() << "Could not parse date/time" << start << "; starting from the current time.";
+    }
+
+    SatellitePassPredictor predictor( geo, startUT.djd(), startUT.djd() + days );
+    QList<SatellitePass> passes = predictor.findPasses( data()->skyComposite()->satellites()->satellites() );
+
+    QString output;
+    foreach ( const SatellitePass &pass, passes ) {
+        output += QString( "%1\t%2\t%3\t%4\t%5\t%6\t%7\t%8\n" )
+                  .arg( pass.satellite->name() )
+                  .arg( KStarsDateTime( pass.riseJD ).dateTime().toString( Qt::ISODate ) )
+                  .arg( pass.riseAz, 0, 'f', 1 )
+                  .arg( KStarsDateTime( pass.culminationJD ).dateTime().toString( Qt::ISODate ) )
+                  .arg( pass.maxAlt, 0, 'f', 1 )
+                  .arg( KStarsDateTime( pass.setJD ).dateTime().toString( Qt::ISODate ) )
+                  .arg( pass.setAz, 0, 'f', 1 )
+                  .arg( pass.visible ? 1 : 0 );
+    }
+    return output;
+}
+
+QString KStars::findObjectNames( const QString &text ) {
+    NameIndex &index = data()->skyComposite()->nameIndex();
+    QStringList names = index.names( text );
+    if ( names.isEmpty() )
+        names = index.fuzzy( text );
+    return names.join( "\n" );
+}
+
+void KStars::setFrameProfiling( bool on ) {
+    FrameProfiler *profiler = FrameProfiler::Instance();
+    if ( on && ! profiler->isEnabled() )
+        profiler->reset();
+    profiler->setRequested( on );
+    map()->forceUpdate();
+}
+
+QString KStars::getFrameProfile() {
+    return FrameProfiler::Instance()->report();
+}
+
 void KStars::changeViewOption( const QString &op, const QString &val ) {
     bool bOk(false), nOk(false), dOk(false);
 
@@ -298,6 +373,7 @@ void KStars::changeViewOption( const QString &op, const QString &val ) {
     if ( op == "ShadeTimeBox"    && bOk ) Options::setShadeTimeBox(    bVal );
     if ( op == "ShadeGeoBox"     && bOk ) Options::setShadeGeoBox(     bVal );
     if ( op == "ShadeFocusBox"   && bOk ) Options::setShadeFocusBox(   bVal );
+    if ( op == "ShowFrameProfile" && bOk ) Options::setShowFrameProfile( bVal );
 
     //[View]
     // FIXME: REGRESSION
@@ -371,6 +371,8 @@ void KStars::initActions() {
         << KShortcut(Qt::CTRL+Qt::Key_U );
     actionCollection()->addAction("skycalendar", this, SLOT( slotCalendar() ) )
         << i18n("Sky Calendar...");
+    actionCollection()->addAction("satellitepasses", this, SLOT( slotSatellitePasses() ) )
+        << i18n("Satellite Passes...");
 
 //FIXME: implement glossary
 //     ka = actionCollection()->addAction("glossary");
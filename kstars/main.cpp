@@ -30,6 +30,9 @@
 #include "Options.h"
 //Added by qt3to4:
 #include <QPixmap>
+#include <QFile>
+#include <QTextStream>
+#include <QTime>
 #include <kglobal.h>
 
 #define KSTARS_VERSION "2.0.0"
@@ -40,6 +43,226 @@ static const char notice[] =
     I18N_NOOP("Some images in KStars are for non-commercial use only.  See README.images.");
 
 
+/** @return the image format matching the extension of fname, PNG if unknown */
+static const char* imageFormat( const QString &fname )
+{
+    QString ext = fname.mid( fname.lastIndexOf(".")+1 ).toLower();
+    if ( ext == "png" ) { return "PNG"; }
+    else if ( ext == "jpg" || ext == "jpeg" ) { return "JPG"; }
+    else if ( ext == "gif" ) { return "GIF"; }
+    else if ( ext == "pnm" ) { return "PNM"; }
+    else if ( ext == "bmp" ) { return "BMP"; }
+    kWarning() << i18n( "Could not parse image format of %1; assuming PNG.", fname ) ;
+    return "PNG";
+}
+
+/** @return the UT date/time given by datestring, or the current CPU time
+ *  if the string is empty or cannot be parsed. If ok is given, it is set to
+ *  false when the string cannot be parsed. */
+static KStarsDateTime parseDate( const QString &datestring, KStarsData *dat, bool *ok = 0 )
+{
+    if ( ok ) *ok = true;
+
+    KStarsDateTime kdt;
+    if ( ! datestring.isEmpty() ) {
+        if ( datestring.contains( "-" ) ) { //assume ISODate format
+            if ( datestring.contains( ":" ) ) { //also includes time
+                kdt = KDateTime::fromString( datestring, KDateTime::ISODate );
+            } else { //string probably contains date only
+                kdt.setDate( QDate::fromString( datestring, Qt::ISODate ) );
+                kdt.setTime( QTime( 0, 0, 0 ) );
+            }
+        } else { //assume Text format for date string
+            kdt = dat->geo()->LTtoUT( KDateTime::fromString( datestring, KDateTime::QtTextDate ) );
+        }
+
+        if ( ! kdt.isValid() ) {
+            if ( ok ) {
+                *ok = false;
+                return KStarsDateTime::currentUtcDateTime();
+            }
+            kWarning() << i18n( "Using CPU date/time instead." ) ;
+
+            kdt = KStarsDateTime::currentUtcDateTime();
+        }
+    } else {
+        kdt = KStarsDateTime::currentUtcDateTime();
+    }
+    return kdt;
+}
+
+/** @return the SkyMap::Projection named by s (either its name or its
+ *  numeric value), or UnknownProjection. */
+static SkyMap::Projection parseProjection( const QString &s )
+{
+    static const char* names[] = { "lambert", "azimuthalequidistant", "orthographic",
+                                   "equirectangular", "stereographic", "gnomonic" };
+    bool ok;
+    uint n = s.toUInt( &ok );
+    if ( ok )
+        return n < SkyMap::UnknownProjection ? SkyMap::Projection( n ) : SkyMap::UnknownProjection;
+    QString name = s.trimmed().toLower();
+    for ( int i = 0; i < SkyMap::UnknownProjection; ++i ) {
+        if ( name == names[i] )
+            return SkyMap::Projection( i );
+    }
+    return SkyMap::UnknownProjection;
+}
+
+/**
+ * Render every job of a batch file with a single set of loaded catalogs.
+ *
+ * Each non-empty line of the job file which does not start with '#' is a
+ * job made of nine fields separated by '|':
+ *
+ *   date | city,province,country | RA | Dec | zoom | projection | width | height | filename
+ *
+ * Empty fields fall back on the options in effect when the batch started
+ * (or the current CPU time for the date): no job inherits the location,
+ * focus, zoom, projection or size of the previous one, and the options are
+ * restored once all the jobs are rendered. RA is in hours and Dec in
+ * degrees, in any format that dms::setFromString() understands. A job
+ * whose fields cannot be parsed is not rendered and counts as failed.
+ *
+ * The jobs are rendered one after the other: SkyMap, its Projector and the
+ * SkyLabeler are singletons, and the sky components update their objects in
+ * place for the current time, so two frames can not be drawn concurrently.
+ * @return the number of jobs which failed
+ */
+static int renderBatch( const QString &jobfile, KStarsData *dat, SkyMap *map )
+{
+    QFile file( jobfile );
+    if ( ! file.open( QIODevice::ReadOnly ) ) {
+        kWarning() << i18n( "Unable to open batch file: %1", jobfile );
+        return 1;
+    }
+
+    QTextStream stream( &file );
+    int lineNumber = 0, nJobs = 0, nFailed = 0;
+    QTime t;
+    t.start();
+
+    //What the empty fields fall back on
+    const GeoLocation startGeo( *dat->geo() );
+    const double startRA = Options::focusRA(), startDec = Options::focusDec();
+    const double startZoom = Options::zoomFactor();
+    const uint startProjection = Options::projection();
+    const int startWidth = map->width(), startHeight = map->height();
+
+    while ( ! stream.atEnd() ) {
+        QString line = stream.readLine().trimmed();
+        ++lineNumber;
+        if ( line.isEmpty() || line.startsWith( '#' ) )
+            continue;
+
+        QStringList fields = line.split( '|' );
+        for ( int i = 0; i < fields.size(); ++i )
+            fields[i] = fields[i].trimmed();
+        if ( fields.size() != 9 || fields[8].isEmpty() ) {
+            kWarning() << i18n( "Skipping malformed job on line %1 of %2", lineNumber, jobfile );
+            ++nFailed;
+            continue;
+        }
+        ++nJobs;
+
+        //Start from the options of the batch, not those of the previous job
+        dat->setLocation( startGeo );
+        map->setZoomFactor( startZoom );
+        Options::setProjection( startProjection );
+
+        //Location
+        if ( ! fields[1].isEmpty() ) {
+            QStringList place = fields[1].split( ',' );
+            while ( place.size() < 3 )
+                place.append( QString() );
+            GeoLocation *geo = dat->locationNamed( place[0].trimmed(), place[1].trimmed(), place[2].trimmed() );
+            if ( ! geo ) {
+                kWarning() << i18n( "Unknown location %1 on line %2 of %3", fields[1], lineNumber, jobfile );
+                ++nFailed;
+                continue;
+            }
+            dat->setLocation( *geo );
+        }
+
+        //Time
+        bool ok = true;
+        KStarsDateTime kdt = parseDate( fields[0], dat, &ok );
+        if ( ! ok ) {
+            kWarning() << i18n( "Unable to parse date on line %1 of %2", lineNumber, jobfile );
+            ++nFailed;
+            continue;
+        }
+        dat->clock()->setUTC( kdt );
+
+        //Focus
+        //SkyMap::setFocus() stores the focus of each job in the options
+        dms ra( startRA * 15.0 ), dec( startDec );
+        if ( ( ! fields[2].isEmpty() && ! ra.setFromString( fields[2], false ) )
+             || ( ! fields[3].isEmpty() && ! dec.setFromString( fields[3], true ) ) ) {
+            kWarning() << i18n( "Unable to parse coordinates on line %1 of %2", lineNumber, jobfile );
+            ++nFailed;
+            continue;
+        }
+
+        //Zoom and projection
+        if ( ! fields[4].isEmpty() ) {
+            double zoom = fields[4].toDouble( &ok );
+            if ( ok )
+                map->setZoomFactor( zoom );
+        }
+        if ( ok && ! fields[5].isEmpty() ) {
+            SkyMap::Projection proj = parseProjection( fields[5] );
+            ok = ( proj != SkyMap::UnknownProjection );
+            if ( ok )
+                Options::setProjection( proj );
+        }
+
+        //Image size
+        int w = startWidth, h = startHeight;
+        if ( ok && ! fields[6].isEmpty() ) w = fields[6].toInt( &ok );
+        if ( ok && ! fields[7].isEmpty() ) h = fields[7].toInt( &ok );
+        if ( ! ok || w <= 0 || h <= 0 ) {
+            kWarning() << i18n( "Unable to parse zoom, projection or size on line %1 of %2", lineNumber, jobfile );
+            ++nFailed;
+            continue;
+        }
+        map->resize( w, h );
+
+        dat->setFullTimeUpdate();
+        dat->updateTime( dat->geo(), map );
+
+        SkyPoint dest( ra, dec );
+        map->setDestination( dest );
+        map->destination()->EquatorialToHorizontal( dat->lst(), dat->geo()->lat() );
+        map->setFocus( map->destination() );
+        map->focus()->EquatorialToHorizontal( dat->lst(), dat->geo()->lat() );
+
+        qApp->processEvents();
+        QPixmap sky( w, h );
+        map->setupProjector();
+        map->exportSkyImage( &sky );
+
+        const QString &fname = fields[8];
+        if ( ! sky.save( fname, imageFormat( fname ) ) ) {
+            kWarning() << i18n( "Unable to save image: %1 ", fname ) ;
+            ++nFailed;
+        }
+        else kDebug() << i18n( "Saved to file: %1", fname );
+    }
+
+    //Leave the options as they were before the batch
+    dat->setLocation( startGeo );
+    map->setZoomFactor( startZoom );
+    Options::setProjection( startProjection );
+    Options::setFocusRA( startRA );
+    Options::setFocusDec( startDec );
+    map->resize( startWidth, startHeight );
+
+    kDebug() << "Rendered" << nJobs << "jobs in" << t.elapsed() << "ms," << nFailed << "failed";
+    return nFailed;
+}
+
+
 int main(int argc, char *argv[])
 {
     KAboutData aboutData( "kstars", 0, ki18n("KStars"),
@@ -62,6 +285,7 @@ int main(int argc, char *argv[])
 
     KCmdLineOptions options;
     options.add("!dump", ki18n( "Dump sky image to file" ));
+    options.add("batch ", ki18n( "Render all the sky images described in a job file" ));
     options.add("script ", ki18n( "Script to execute" ));
     options.add("width ", ki18n( "Width of sky image" ), "640");
     options.add("height ", ki18n( "Height of sky image" ), "480");
@@ -77,15 +301,8 @@ int main(int argc, char *argv[])
         kDebug() << i18n( "Dumping sky image" );
 
         //parse filename and image format
-        const char* format = "PNG";
         QString fname = args->getOption( "filename" );
-        QString ext = fname.mid( fname.lastIndexOf(".")+1 );
-        if ( ext.toLower() == "png" ) { format = "PNG"; }
-        else if ( ext.toLower() == "jpg" || ext.toLower() == "jpeg" ) { format = "JPG"; }
-        else if ( ext.toLower() == "gif" ) { format = "GIF"; }
-        else if ( ext.toLower() == "pnm" ) { format = "PNM"; }
-        else if ( ext.toLower() == "bmp" ) { format = "BMP"; }
-        else { kWarning() << i18n( "Could not parse image format of %1; assuming PNG.", fname ) ; }
+        const char* format = imageFormat( fname );
 
         //parse width and height
         bool ok(false);
@@ -111,28 +328,7 @@ int main(int argc, char *argv[])
 
         //set clock now that we have a location:
         //Check to see if user provided a date/time string.  If not, use current CPU time
-        QString datestring = args->getOption( "date" );
-        KStarsDateTime kdt;
-        if ( ! datestring.isEmpty() ) {
-            if ( datestring.contains( "-" ) ) { //assume ISODate format
-                if ( datestring.contains( ":" ) ) { //also includes time
-                    kdt = KDateTime::fromString( datestring, KDateTime::ISODate );
-                } else { //string probably contains date only
-                    kdt.setDate( QDate::fromString( datestring, Qt::ISODate ) );
-                    kdt.setTime( QTime( 0, 0, 0 ) );
-                }
-            } else { //assume Text format for date string
-                kdt = dat->geo()->LTtoUT( KDateTime::fromString( datestring, KDateTime::QtTextDate ) );
-            }
-
-            if ( ! kdt.isValid() ) {
-                kWarning() << i18n( "Using CPU date/time instead." ) ;
-
-                kdt = KStarsDateTime::currentUtcDateTime();
-            }
-        } else {
-            kdt = KStarsDateTime::currentUtcDateTime();
-        }
+        KStarsDateTime kdt = parseDate( args->getOption( "date" ), dat );
         dat->clock()->setUTC( kdt );
 
         KSNumbers num( dat->ut().djd() );
@@ -174,6 +370,29 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if ( args->isSet( "batch" ) ) {
+        kDebug() << i18n( "Rendering sky images in batch mode" );
+
+        //Load the catalogs only once for all the jobs
+        KStarsData *dat = KStarsData::Create();
+        QObject::connect( dat, SIGNAL( progressText(QString) ), dat, SLOT( slotConsoleMessage(QString) ) );
+        dat->initialize();
+        dat->setLocationFromOptions();
+        dat->colorScheme()->loadFromConfig();
+
+        SkyMap *map = SkyMap::Create();
+        bool ok(false);
+        int w = args->getOption( "width" ).toInt( &ok );
+        int h = ok ? args->getOption( "height" ).toInt( &ok ) : 0;
+        if ( ok ) map->resize( w, h );
+
+        int nFailed = renderBatch( args->getOption( "batch" ), dat, map );
+
+        delete map;
+        delete dat;
+        return nFailed ? 1 : 0;
+    }
+
     //start up normally in GUI mode
 
     //Try to parse the given date string
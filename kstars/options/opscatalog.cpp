@@ -253,7 +253,7 @@ void OpsCatalog::slotApply() {
     // it's needed when using horizontal coordinates
     ksw->data()->setFullTimeUpdate();
     ksw->updateTime();
-    ksw->map()->forceUpdate();
+    ksw->map()->forceFullUpdate();
 }
 
 void OpsCatalog::slotCancel() {
@@ -40,6 +40,12 @@ double EquirectangularProjector::radius() const
     return 1.0;
 }
 
+double EquirectangularProjector::fieldRadius() const
+{
+    //Distances on the screen are not distances on the sky in this projection
+    return 180.0;
+}
+
 Vector2f EquirectangularProjector::toScreenVec(const SkyPoint* o, bool oRefract, bool* onVisibleHemisphere) const
 {
     double Y, dX;
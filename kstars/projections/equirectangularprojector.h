@@ -30,6 +30,7 @@ public:
     EquirectangularProjector(const ViewParams& p);
     virtual SkyMap::Projection type() const;
     virtual double radius() const;
+    virtual double fieldRadius() const;
     virtual bool unusablePoint( const QPointF& p) const;
     virtual Vector2f toScreenVec(const SkyPoint* o, bool oRefract = true, bool* onVisibleHemisphere = 0) const;
     virtual SkyPoint fromScreen(const QPointF& p, dms* LST, const dms* lat) const;
@@ -90,6 +90,15 @@ double Projector::fov() const
     return m_fov;
 }
 
+double Projector::fieldRadius() const
+{
+    //The center-to-corner distance, in radians
+    double r = 0.5*sqrt( m_vp.width*m_vp.width + m_vp.height*m_vp.height )/m_vp.zoomFactor;
+    if( r >= radius() )
+        return 180.0;
+    return projectionL( r )/dms::DegToRad;
+}
+
 QPointF Projector::toScreen(const SkyPoint* o, bool oRefract, bool* onVisibleHemisphere) const
 {
     return KSUtils::vecToPoint( toScreenVec(o, oRefract, onVisibleHemisphere) );
@@ -65,6 +65,11 @@ public:
     /** Return the FOV of this projection */
     double fov() const;
 
+    /** Return the radius, in degrees, of the smallest circle around the focus
+        that contains every point of the sky that can appear in the window,
+        or 180 if any point of the sky may appear. */
+    virtual double fieldRadius() const;
+
     /**Check if the current point on screen is a valid point on the sky. This is needed
         *to avoid a crash of the program if the user clicks on a point outside the sky (the
         *corners of the sky map at the lowest zoom level are the invalid points).
@@ -0,0 +1,174 @@
+/***************************************************************************
+                          satellitepasspredictor.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "satellitepasspredictor.h"
+
+#include <math.h>
+
+#include <QtAlgorithms>
+#include <QtConcurrentMap>
+
+#include "geolocation.h"
+
+namespace {
+    // Step of the coarse search, in days (one minute)
+    const double GRID_STEP = 1.0 / 1440.0;
+    // Precision of the refined times, in days (one second)
+    const double TIME_PRECISION = 1.0 / 86400.0;
+
+    bool riseEarlierThan( const SatellitePass &p1, const SatellitePass &p2 ) {
+        return p1.riseJD < p2.riseJD;
+    }
+
+    // Finds the passes of one satellite, for QtConcurrent
+    struct PassFinder {
+        typedef QList<SatellitePass> result_type;
+
+        explicit PassFinder( const SatellitePassPredictor *p ) : predictor( p ) {}
+
+        QList<SatellitePass> operator()( Satellite *sat ) const { return predictor->findPasses( sat ); }
+
+        const SatellitePassPredictor *predictor;
+    };
+}
+
+SatellitePassPredictor::SatellitePassPredictor( GeoLocation *geo, double startJD, double stopJD ) :
+    m_geo( geo ),
+    m_startJD( startJD ),
+    m_stopJD( qBound( startJD, stopJD, startJD + MAX_DAYS ) )
+{
+    int n = int( ceil( ( m_stopJD - m_startJD ) / GRID_STEP ) ) + 1;
+    m_gridJD.reserve( n );
+    m_grid.reserve( n );
+    for ( int i = 0; i < n; ++i ) {
+        double jd = qMin( m_startJD + i * GRID_STEP, m_stopJD );
+        m_gridJD.append( jd );
+        m_grid.append( Satellite::Environment( jd, m_geo ) );
+    }
+}
+
+double SatellitePassPredictor::altitude( Satellite *probe, double jd ) const {
+    // Interpolate between the environments of the grid, which were computed
+    // on the calling thread: the location and the date classes are not used here
+    int i = qBound( 0, int( ( jd - m_startJD ) / GRID_STEP ), m_grid.size() - 1 );
+    int j = qMin( i + 1, m_grid.size() - 1 );
+    probe->updatePos( Satellite::Environment( m_grid[i], m_grid[j], jd ) );
+    return probe->alt().Degrees();
+}
+
+double SatellitePassPredictor::findCrossing( Satellite *probe, double jd1, double jd2 ) const {
+    bool up1 = altitude( probe, jd1 ) >= 0.0;
+    while ( jd2 - jd1 > TIME_PRECISION ) {
+        double mid = 0.5 * ( jd1 + jd2 );
+        if ( ( altitude( probe, mid ) >= 0.0 ) == up1 )
+            jd1 = mid;
+        else
+            jd2 = mid;
+    }
+    return 0.5 * ( jd1 + jd2 );
+}
+
+double SatellitePassPredictor::findCulmination( Satellite *probe, double jd1, double jd2 ) const {
+    const double ratio = 0.5 * ( sqrt( 5.0 ) - 1.0 );
+    double a = jd2 - ratio * ( jd2 - jd1 );
+    double b = jd1 + ratio * ( jd2 - jd1 );
+    double altA = altitude( probe, a );
+    double altB = altitude( probe, b );
+    while ( jd2 - jd1 > TIME_PRECISION ) {
+        if ( altA > altB ) {
+            jd2 = b;
+            b = a;  altB = altA;
+            a = jd2 - ratio * ( jd2 - jd1 );
+            altA = altitude( probe, a );
+        } else {
+            jd1 = a;
+            a = b;  altA = altB;
+            b = jd1 + ratio * ( jd2 - jd1 );
+            altB = altitude( probe, b );
+        }
+    }
+    return 0.5 * ( jd1 + jd2 );
+}
+
+QList<SatellitePass> SatellitePassPredictor::findPasses( Satellite *sat ) const {
+    QList<SatellitePass> passes;
+    if ( m_grid.isEmpty() )
+        return passes;
+
+    // Work on a copy, the satellite itself may be drawn meanwhile
+    Satellite probe( *sat );
+    if ( ! probe.updatePos( m_grid[0] ) )
+        return passes;  // Decayed, or bad elements
+
+    SatellitePass pass;
+    bool up = false;
+    int best = 0;
+    double bestAlt = -90.0;
+
+    for ( int i = 0; i < m_grid.size(); ++i ) {
+        probe.updatePos( m_grid[i] );
+        double alt = probe.alt().Degrees();
+
+        if ( alt >= 0.0 ) {
+            if ( ! up ) {
+                pass = SatellitePass();
+                pass.satellite = sat;
+                pass.riseJD = ( i == 0 ) ? m_gridJD[0] : findCrossing( &probe, m_gridJD[i-1], m_gridJD[i] );
+                pass.riseAz = probe.az().Degrees();
+                bestAlt = -90.0;
+                up = true;
+                probe.updatePos( m_grid[i] );
+            }
+            if ( probe.isVisible() )
+                pass.visible = true;
+            if ( alt > bestAlt ) {
+                bestAlt = alt;
+                best = i;
+            }
+        }
+
+        bool last = ( i == m_grid.size() - 1 );
+        if ( up && ( alt < 0.0 || last ) ) {
+            pass.setJD = ( alt < 0.0 ) ? findCrossing( &probe, m_gridJD[i-1], m_gridJD[i] ) : m_gridJD[i];
+            pass.setAz = probe.az().Degrees();
+
+            // The highest altitude is within one step of the best sample
+            double jd1 = qMax( pass.riseJD, m_gridJD[ qMax( best - 1, 0 ) ] );
+            double jd2 = qMin( pass.setJD, m_gridJD[ qMin( best + 1, m_grid.size() - 1 ) ] );
+            pass.culminationJD = findCulmination( &probe, jd1, jd2 );
+            pass.maxAlt = altitude( &probe, pass.culminationJD );
+            if ( probe.isVisible() )
+                pass.visible = true;
+
+            passes.append( pass );
+            up = false;
+        }
+    }
+
+    return passes;
+}
+
+QList<SatellitePass> SatellitePassPredictor::findPasses( const QList<Satellite*> &satellites ) const {
+    QList< QList<SatellitePass> > results =
+        QtConcurrent::blockingMapped< QList< QList<SatellitePass> > >( satellites, PassFinder( this ) );
+
+    QList<SatellitePass> passes;
+    foreach ( const QList<SatellitePass> &list, results )
+        passes += list;
+    qStableSort( passes.begin(), passes.end(), riseEarlierThan );
+    return passes;
+}
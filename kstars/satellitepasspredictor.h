@@ -0,0 +1,108 @@
+/***************************************************************************
+                          satellitepasspredictor.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SATELLITEPASSPREDICTOR_H
+#define SATELLITEPASSPREDICTOR_H
+
+#include <QList>
+#include <QVector>
+
+#include "skyobjects/satellite.h"
+
+class GeoLocation;
+
+/**
+    *@class SatellitePass
+    *A pass of a satellite above the horizon of an observer.
+    *@author KStars Developers
+    *@version 1.0
+    */
+class SatellitePass
+{
+public:
+    SatellitePass() : satellite( 0 ), riseJD( 0. ), culminationJD( 0. ), setJD( 0. ),
+                      maxAlt( 0. ), riseAz( 0. ), setAz( 0. ), visible( false ) {}
+
+    Satellite *satellite;       // The satellite (not a copy)
+    double riseJD;              // Rise time, or start of the search range if already up
+    double culminationJD;       // Time of the highest altitude
+    double setJD;               // Set time, or end of the search range if still up
+    double maxAlt;              // Highest altitude (degrees)
+    double riseAz;              // Azimuth at rise (degrees)
+    double setAz;               // Azimuth at set (degrees)
+    bool visible;               // True if the satellite is visible (sunlit, in a dark sky) during the pass
+};
+
+/**
+    *@class SatellitePassPredictor
+    *Finds the passes of satellites above the horizon of an observer in a
+    *time range.
+    *
+    *The altitude of each satellite is sampled on a coarse time grid, whose
+    *environments (sidereal time, observer and Sun positions) are computed
+    *once and shared by all the satellites. The rise and set times are then
+    *refined by bisection and the culmination by a golden section search.
+    *Satellites are processed in parallel on private copies, so the
+    *satellites shown on the sky map are not modified.
+    *@note Passes shorter than the grid step may be missed.
+    *@note The search range is limited to MAX_DAYS, the grid takes about
+    *200 kB a day.
+    *@author KStars Developers
+    *@version 1.0
+    */
+class SatellitePassPredictor
+{
+public:
+    /**
+     *@short Constructor
+     *@param geo the location of the observer
+     *@param startJD start of the search range (UT)
+     *@param stopJD end of the search range (UT), at most MAX_DAYS after startJD
+     */
+    SatellitePassPredictor( GeoLocation *geo, double startJD, double stopJD );
+
+    /** The longest search range, in days */
+    enum { MAX_DAYS = 30 };
+
+    /**
+     *@return the passes of one satellite, in chronological order
+     */
+    QList<SatellitePass> findPasses( Satellite *sat ) const;
+
+    /**
+     *@return the passes of all the given satellites, sorted by rise time.
+     *The satellites are processed in parallel.
+     */
+    QList<SatellitePass> findPasses( const QList<Satellite*> &satellites ) const;
+
+private:
+    /** @return the altitude of the satellite at time jd, in degrees */
+    double altitude( Satellite *probe, double jd ) const;
+
+    /** @return the time where the altitude crosses the horizon between jd1 and jd2 */
+    double findCrossing( Satellite *probe, double jd1, double jd2 ) const;
+
+    /** @return the time of the highest altitude between jd1 and jd2 */
+    double findCulmination( Satellite *probe, double jd1, double jd2 ) const;
+
+    GeoLocation *m_geo;
+    double m_startJD, m_stopJD;
+    QVector<double> m_gridJD;
+    QVector<Satellite::Environment> m_grid;
+};
+
+#endif
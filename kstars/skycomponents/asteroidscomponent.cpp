@@ -98,8 +98,11 @@ void AsteroidsComponent::loadData()
     emitProgressText( i18n("Loading asteroids") );
 
     // Clear lists
+    foreach ( SkyObject *o, m_ObjectList )
+        nearestIndex().remove( o );
     m_ObjectList.clear();
     objectNames( SkyObject::ASTEROID ).clear();
+    nameIndex().removeType( SkyObject::ASTEROID );
 
     while( fileReader.hasMoreLines() ) {
         line = fileReader.readLine();
@@ -162,11 +165,18 @@ void AsteroidsComponent::loadData()
 
         //Add name to the list of object names
         objectNames(SkyObject::ASTEROID).append( name );
+        // Numbered asteroids are also found by their full designation, e.g. "1 Ceres"
+        nameIndex().insert( ast );
+        nameIndex().insert( full_name, ast );
+        nearestIndex().insert( ast, this );
     }
 }
 
 void AsteroidsComponent::draw( SkyPainter *skyp )
 {
+    // The asteroids too faint to be drawn are not found under the mouse either
+    nearestIndex().setMagLimit( this, Options::magLimitAsteroid() );
+
     if ( ! selected() ) return;
 
     bool hideLabels =  ! Options::showAsteroidNames() ||
@@ -95,8 +95,11 @@ void CometsComponent::loadData() {
     if(!fileReader.open( "comets.dat" )) return;
     emitProgressText( i18n("Loading comets") );
     // Clear lists
+    foreach ( SkyObject *o, m_ObjectList )
+        nearestIndex().remove( o );
     m_ObjectList.clear();
     objectNames( SkyObject::COMET ).clear();
+    nameIndex().removeType( SkyObject::COMET );
     
     /*if ( KSUtils::openDataFile( file, "comets.dat" ) ) {
         emitProgressText( i18n("Loading comets") );
@@ -216,6 +219,8 @@ void CometsComponent::loadData() {
 
 		//Add *short* name to the list of object names
 		objectNames( SkyObject::COMET ).append( com->name() );
+		nameIndex().insert( com );
+		nearestIndex().insert( com, this );
     }
 }
 
@@ -18,8 +18,10 @@
 #include "constellationboundarylines.h"
 
 #include <stdio.h>
+#include <math.h>
 
 #include <QPen>
+#include <QtAlgorithms>
 #include <kstandarddirs.h>
 
 #include <kdebug.h>
@@ -41,6 +43,56 @@
 
 #include "skypainter.h"
 
+namespace {
+    // Size of the cells of the constellation table: 2 minutes of RA by half a degree
+    const int raCells  = 720;
+    const int decCells = 360;
+    const double raStep  = 24.0 / raCells;
+    const double decStep = 180.0 / decCells;
+
+    inline int cellOf( double ra, double dec ) {
+        int col = int( ra / raStep );
+        int row = int( ( dec + 90.0 ) / decStep );
+        col = col < 0 ? 0 : ( col >= raCells ? raCells - 1 : col );
+        row = row < 0 ? 0 : ( row >= decCells ? decCells - 1 : row );
+        return row * raCells + col;
+    }
+
+    // Add the polygon to the cells touched by the segment (a, b), in hours and
+    // degrees, and to the cells within a small margin of it
+    void markSegment( QVector< QVector<quint8> > &cells, const QPointF &a, const QPointF &b, quint8 poly ) {
+        const double eps = 1e-6;
+        double x0 = a.x() / raStep, y0 = ( a.y() + 90.0 ) / decStep;
+        double x1 = b.x() / raStep, y1 = ( b.y() + 90.0 ) / decStep;
+        if ( x0 > x1 ) {
+            qSwap( x0, x1 );
+            qSwap( y0, y1 );
+        }
+
+        // Column by column, the rows between the ends of the part of the segment in it
+        for ( int c = int( floor( x0 - eps ) ); c <= int( floor( x1 + eps ) ); ++c ) {
+            double xa = qBound( x0, double( c ), x1 );
+            double xb = qBound( x0, double( c + 1 ), x1 );
+            double ya = y0, yb = y1;
+            if ( x1 - x0 > eps ) {
+                ya = y0 + ( y1 - y0 ) * ( xa - x0 ) / ( x1 - x0 );
+                yb = y0 + ( y1 - y0 ) * ( xb - x0 ) / ( x1 - x0 );
+            }
+            if ( ya > yb )
+                qSwap( ya, yb );
+
+            int col = ( c % raCells + raCells ) % raCells;   // Polygons which wrap have RA < 0
+            int r0 = qMax( 0, int( floor( ya - eps ) ) );
+            int r1 = qMin( decCells - 1, int( floor( yb + eps ) ) );
+            for ( int r = r0; r <= r1; ++r ) {
+                QVector<quint8> &polys = cells[ r * raCells + col ];
+                if ( ! polys.contains( poly ) )
+                    polys.append( poly );
+            }
+        }
+    }
+}
+
 ConstellationBoundaryLines::ConstellationBoundaryLines( SkyComposite *parent )
         : NoPrecessIndex( parent, i18n("Constellation Boundaries") )
 {
@@ -143,6 +195,8 @@ ConstellationBoundaryLines::ConstellationBoundaryLines( SkyComposite *parent )
         appendLine( lineList );
     if( polyList )
         appendPoly( polyList, idxFile, verbose );
+
+    buildCellTable();
 }
 
 bool ConstellationBoundaryLines::selected()
@@ -159,6 +213,8 @@ void ConstellationBoundaryLines::preDraw( SkyPainter* skyp )
 
 void ConstellationBoundaryLines::appendPoly( PolyList* polyList, KSFileReader* file, int debug)
 {
+    m_polyLists.append( polyList );
+
     if ( ! file || debug == -1)
         return appendPoly( polyList, debug );
 
@@ -189,9 +245,139 @@ void ConstellationBoundaryLines::appendPoly( PolyList* polyList, int debug)
         printf("PolyList: %3d: %d\n", ++m_polyIndexCnt, indexHash.size() );
 }
 
+void ConstellationBoundaryLines::buildCellTable()
+{
+    // The polygons are numbered with a quint8
+    if ( m_polyLists.isEmpty() || m_polyLists.size() > 255 )
+        return;
+
+    // 1. The polygons whose boundaries cross each cell
+    QVector< QVector<quint8> > crossing( raCells * decCells );
+    for ( int i = 0; i < m_polyLists.size(); i++ ) {
+        const QPolygonF *poly = m_polyLists[ i ]->poly();
+        for ( int j = 0; j < poly->size(); j++ )
+            markSegment( crossing, poly->at( j ), poly->at( ( j + 1 ) % poly->size() ), i );
+    }
+
+    // 2. The cells crossed by no boundary make up regions inside a single
+    // constellation: look up one cell of each region, then fill the region
+    const int unknown = -1, boundary = -2, outside = -3;
+    QVector<int> single( raCells * decCells, unknown );
+    for ( int cell = 0; cell < single.size(); cell++ ) {
+        if ( ! crossing[ cell ].isEmpty() )
+            single[ cell ] = boundary;
+    }
+
+    QVector<int> stack;
+    for ( int seed = 0; seed < single.size(); seed++ ) {
+        if ( single[ seed ] != unknown )
+            continue;
+
+        SkyPoint center( ( seed % raCells + 0.5 ) * raStep, ( seed / raCells + 0.5 ) * decStep - 90.0 );
+        PolyList *polyList = searchContainingPoly( &center );
+        int value = polyList ? m_polyLists.indexOf( polyList ) : outside;
+
+        single[ seed ] = value;
+        stack.append( seed );
+        while ( ! stack.isEmpty() ) {
+            int cell = stack.last();
+            stack.pop_back();
+            int row = cell / raCells, col = cell % raCells;
+            int next[ 4 ] = { row * raCells + ( col + 1 ) % raCells,
+                              row * raCells + ( col + raCells - 1 ) % raCells,
+                              row > 0 ? cell - raCells : -1,
+                              row < decCells - 1 ? cell + raCells : -1 };
+            for ( int k = 0; k < 4; k++ ) {
+                if ( next[ k ] >= 0 && single[ next[ k ] ] == unknown ) {
+                    single[ next[ k ] ] = value;
+                    stack.append( next[ k ] );
+                }
+            }
+        }
+    }
+
+    // 3. The table. A boundary cell may also hold the constellation of its
+    // neighbours, in case a shared boundary is not quite the same in both
+    // polygons. Cells with no candidate are searched in the sky mesh.
+    QHash<QByteArray, int> offsets;
+    m_cellTable.resize( raCells * decCells );
+    for ( int cell = 0; cell < single.size(); cell++ ) {
+        if ( single[ cell ] >= 0 ) {
+            m_cellTable[ cell ] = single[ cell ];
+            continue;
+        }
+
+        QVector<quint8> polys = crossing[ cell ];
+        if ( single[ cell ] == boundary ) {
+            int row = cell / raCells, col = cell % raCells;
+            int next[ 4 ] = { row * raCells + ( col + 1 ) % raCells,
+                              row * raCells + ( col + raCells - 1 ) % raCells,
+                              row > 0 ? cell - raCells : -1,
+                              row < decCells - 1 ? cell + raCells : -1 };
+            for ( int k = 0; k < 4; k++ ) {
+                if ( next[ k ] >= 0 && single[ next[ k ] ] >= 0 && ! polys.contains( quint8( single[ next[ k ] ] ) ) )
+                    polys.append( quint8( single[ next[ k ] ] ) );
+            }
+        }
+        else {
+            polys.clear();
+        }
+        qSort( polys );
+
+        // Most boundary cells share their candidates with many others
+        QByteArray key( (const char*) polys.constData(), polys.size() );
+        QHash<QByteArray, int>::const_iterator iter = offsets.constFind( key );
+        int offset;
+        if ( iter != offsets.constEnd() ) {
+            offset = iter.value();
+        }
+        else {
+            offset = m_cellPolys.size();
+            m_cellPolys.append( quint8( polys.size() ) );
+            m_cellPolys += polys;
+            offsets.insert( key, offset );
+        }
+        m_cellTable[ cell ] = -1 - offset;
+    }
+
+    kDebug() << "Constellation table:" << m_cellTable.size() << "cells," << offsets.size() << "sets of boundaries";
+}
+
 PolyList* ConstellationBoundaryLines::ContainingPoly( SkyPoint *p )
 {
-    //printf("called ContainingPoly(p)\n");
+    if ( m_cellTable.isEmpty() )
+        return searchContainingPoly( p );
+
+    int value = m_cellTable[ cellOf( p->ra().Hours(), p->dec().Degrees() ) ];
+    if ( value >= 0 )
+        return m_polyLists[ value ];
+
+    // The cell is crossed by boundaries: only test the polygons crossing it
+    QPointF point( p->ra().Hours(), p->dec().Degrees() );
+    QPointF wrapPoint( p->ra().Hours() - 24.0, p->dec().Degrees() );
+    bool wrapRA = p->ra().Hours() > 12.0;
+
+    int offset = -1 - value;
+    int count = m_cellPolys[ offset ];
+    for ( int i = 1; i <= count; i++ ) {
+        PolyList* polyList = m_polyLists[ m_cellPolys[ offset + i ] ];
+        const QPolygonF* poly = polyList->poly();
+        if ( wrapRA && polyList->wrapRA() ) {
+            if ( poly->containsPoint( wrapPoint, Qt::OddEvenFill ) )
+                return polyList;
+        }
+        else {
+            if ( poly->containsPoint( point, Qt::OddEvenFill ) )
+                return polyList;
+        }
+    }
+
+    return searchContainingPoly( p );
+}
+
+PolyList* ConstellationBoundaryLines::searchContainingPoly( SkyPoint *p )
+{
+    //printf("called searchContainingPoly(p)\n");
 
     // we save the pointers in a hash because most often there is only one
     // constellation and we can avoid doing the expensive boundary calculations
@@ -205,8 +391,10 @@ PolyList* ConstellationBoundaryLines::ContainingPoly( SkyPoint *p )
     //printf("\n");
 
     // the boundaries don't precess so we use index() not aperture()
-    m_skyMesh->index( p, 1.0, IN_CONSTELL_BUF );
-    MeshIterator region( m_skyMesh, IN_CONSTELL_BUF );
+    // in a buffer of our own, so that it can be called from any thread
+    MeshBuffer result( m_skyMesh );
+    m_skyMesh->index( p, 1.0, &result );
+    MeshIterator region( &result );
     while ( region.hasNext() ) {
 
         Trixel trixel = region.next();
@@ -258,17 +446,43 @@ PolyList* ConstellationBoundaryLines::ContainingPoly( SkyPoint *p )
 // start here.  (Some of them may not be needed (or working)).
 //-------------------------------------------------------------------
 
+QString ConstellationBoundaryLines::displayName( PolyList *polyList )
+{
+    return ( Options::useLocalConstellNames() ?
+             i18nc( "Constellation name (optional)", polyList->name().toUpper().toLocal8Bit().data() ) :
+             polyList->name() );
+}
+
 QString ConstellationBoundaryLines::constellationName( SkyPoint *p )
 {
     PolyList *polyList = ContainingPoly( p );
-    if ( polyList ) {
-        return ( Options::useLocalConstellNames() ?
-                 i18nc( "Constellation name (optional)", polyList->name().toUpper().toLocal8Bit().data() ) :
-                 polyList->name() );
-    }
+    if ( polyList )
+        return displayName( polyList );
     return i18n("Unknown");
 }
 
+QStringList ConstellationBoundaryLines::constellationNames( const QList<SkyPoint*> &points )
+{
+    // Each name is only translated once
+    QHash<PolyList*, QString> names;
+    QString unknown = i18n("Unknown");
+
+    QStringList result;
+    result.reserve( points.size() );
+    foreach ( SkyPoint *p, points ) {
+        PolyList *polyList = ContainingPoly( p );
+        if ( ! polyList ) {
+            result.append( unknown );
+            continue;
+        }
+        QHash<PolyList*, QString>::const_iterator iter = names.constFind( polyList );
+        if ( iter == names.constEnd() )
+            iter = names.insert( polyList, displayName( polyList ) );
+        result.append( iter.value() );
+    }
+    return result;
+}
+
 const QPolygonF* ConstellationBoundaryLines::constellationPoly( SkyPoint *p )
 {
     PolyList *polyList = ContainingPoly( p );
@@ -22,6 +22,8 @@
 
 #include <QHash>
 #include <QPolygonF>
+#include <QStringList>
+#include <QVector>
 
 class PolyList;
 class ConstellationBoundary;
@@ -54,8 +56,18 @@ public:
      */
     ConstellationBoundaryLines( SkyComposite *parent );
 
+    /**@return the name of the constellation containing the point,
+     * or "Unknown"
+     */
     QString constellationName( SkyPoint *p );
 
+    /**@short Batch version of constellationName(), e.g. to tag all the
+     * objects of a catalog.
+     * @return the names of the constellations containing the points, in
+     * the same order
+     */
+    QStringList constellationNames( const QList<SkyPoint*> &points );
+
     const QPolygonF* constellationPoly( SkyPoint *p );
 
     virtual bool selected();
@@ -70,11 +82,37 @@ private:
      */
     void appendPoly( PolyList* polyList, KSFileReader* file, int debug);
 
+    /* @short returns the boundary polygon containing the point. Most
+     * points are looked up in the cell table; the others are tested
+     * against the few polygons crossing their cell.
+     */
     PolyList* ContainingPoly( SkyPoint *p );
 
+    /* @short returns the boundary polygon containing the point, testing
+     * the polygons of the trixels around it in the sky mesh.
+     */
+    PolyList* searchContainingPoly( SkyPoint *p );
+
+    /* @short fills the cell table, once the boundaries are loaded.
+     */
+    void buildCellTable();
+
+    /* @short returns the translated name of a constellation if the
+     * user wants local names
+     */
+    QString displayName( PolyList *polyList );
+
     SkyMesh*   m_skyMesh;
     PolyIndex  m_polyIndex;
     int        m_polyIndexCnt;
+
+    // The sky is cut into cells of fixed RA and Dec. A cell inside one
+    // constellation holds the index of its polygon in m_polyLists. A cell
+    // crossed by boundaries holds -1 - the offset in m_cellPolys of the
+    // polygons crossing it: their number, followed by their indices.
+    QVector<PolyList*> m_polyLists;
+    QVector<int>       m_cellTable;
+    QVector<quint8>    m_cellPolys;
 };
 
 
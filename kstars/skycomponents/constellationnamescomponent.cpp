@@ -85,6 +85,7 @@ ConstellationNamesComponent::ConstellationNamesComponent(SkyComposite *parent, C
 
             //Add name to the list of object names
             objectNames(SkyObject::CONSTELLATION).append( name );
+            nameIndex().insert( o );
         }
     }
 }
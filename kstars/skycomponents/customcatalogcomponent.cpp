@@ -19,6 +19,7 @@
 
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QPixmap>
 #include <QTextStream>
 #include <kdebug.h>
@@ -56,12 +57,29 @@ void CustomCatalogComponent::loadData() {
     //(otherwise, the file will not successfully open)
     if ( m_Filename.at(0)=='~' )
         m_Filename = QDir::homePath() + m_Filename.mid( 1, m_Filename.length() );
+
+    //Use the compiled copy of the catalog, unless the file changed since it was written
+    DeepSkyCatalogCache cache( QFileInfo( m_Filename ).absoluteFilePath() );
+    if ( cache.load() && cache.metadata().size() == 6 ) {
+        const QStringList &header = cache.metadata();
+        m_catName     = header.at(0);
+        m_catPrefix   = header.at(1);
+        m_catColor    = header.at(2);
+        m_catEpoch    = header.at(3).toFloat();
+        m_catFluxFreq = header.at(4);
+        m_catFluxUnit = header.at(5);
+        foreach ( const DeepSkyCatalogCache::Entry &entry, cache.entries() )
+            appendObject( entry );
+        return;
+    }
+
     QFile ccFile( m_Filename );
 
     if ( ccFile.open( QIODevice::ReadOnly ) ) {
         int iStart(0); //the line number of the first non-header line
         QStringList errs; //list of error messages
         QStringList Columns; //list of data column descriptors in the header
+        QVector<DeepSkyCatalogCache::Entry> entries; //parsed objects, for the compiled catalog
 
         QTextStream stream( &ccFile );
         QStringList lines = stream.readAll().split( '\n', QString::SkipEmptyParts );
@@ -96,7 +114,7 @@ void CustomCatalogComponent::loadData() {
                 }
 
                 if ( d.size() == Columns.size() ) {
-                    processCustomDataLine( i, d, Columns, m_Showerrs, errs );
+                    processCustomDataLine( i, d, Columns, m_Showerrs, errs, entries );
                 } else {
                     if ( m_Showerrs ) errs.append( i18n( "Line %1 does not contain %2 fields.  Skipping it.", i, Columns.size() ) );
                 }
@@ -110,10 +128,17 @@ void CustomCatalogComponent::loadData() {
                                  i18n( "To accept the file (ignoring unparsed lines), press Accept." ) );
                 if ( KMessageBox::warningContinueCancelList( 0, message, errs,
                         i18n( "Some Lines in File Were Invalid" ), KGuiItem( i18n( "Accept" ) ) ) != KMessageBox::Continue ) {
-                    m_ObjectList.clear();
+                    // Drop the objects from the indexes too, as the catalog is deleted
+                    clear();
                     return ;
                 }
             }
+
+            //The catalog was accepted, skip the parsing next time
+            QStringList header;
+            header << m_catName << m_catPrefix << m_catColor << QString::number( m_catEpoch )
+                   << m_catFluxFreq << m_catFluxUnit;
+            cache.save( entries, header );
         } else {
             if ( m_Showerrs ) {
                 QString message( i18n( "No lines could be parsed from the specified file, see error messages below." ) );
@@ -335,7 +360,34 @@ bool CustomCatalogComponent::parseCustomDataHeader( const QStringList &lines, QS
     }
 }
 
-bool CustomCatalogComponent::processCustomDataLine(int lnum, const QStringList &d, const QStringList &Columns, bool showerrs, QStringList &errs )
+void CustomCatalogComponent::appendObject( const DeepSkyCatalogCache::Entry &entry )
+{
+    if ( entry.type == 0 ) { //Add a star
+        StarObject *o = new StarObject( dms( entry.ra ), dms( entry.dec ), entry.mag, entry.longname );
+        m_ObjectList.append( o );
+        nameIndex().insert( o );
+        nearestIndex().insert( o, this, 0.5 );
+    } else { //Add a deep-sky object
+        DeepSkyObject *o = new DeepSkyObject( entry.type, dms( entry.ra ), dms( entry.dec ), entry.mag,
+                                              entry.name, QString(), entry.longname, m_catPrefix,
+                                              entry.a, entry.b, entry.pa );
+        o->setFlux( entry.flux );
+        o->setCustomCatalog(this);
+
+        m_ObjectList.append( o );
+
+        //Add name to the list of object names
+        if ( ! entry.name.isEmpty() )
+            objectNames( entry.type ).append( entry.name );
+        nameIndex().insert( o );
+        nearestIndex().insert( o, this, 0.5 );
+    }
+    if ( ! entry.longname.isEmpty() && entry.longname != entry.name )
+        objectNames( entry.type ).append( entry.longname );
+}
+
+bool CustomCatalogComponent::processCustomDataLine(int lnum, const QStringList &d, const QStringList &Columns, bool showerrs, QStringList &errs,
+                                                   QVector<DeepSkyCatalogCache::Entry> &entries )
 {
 
     //object data
@@ -444,23 +496,20 @@ bool CustomCatalogComponent::processCustomDataLine(int lnum, const QStringList &
         }
     }
 
-    if ( iType == 0 ) { //Add a star
-        StarObject *o = new StarObject( RA, Dec, mag, lname );
-        m_ObjectList.append( o );
-    } else { //Add a deep-sky object
-        DeepSkyObject *o = new DeepSkyObject( iType, RA, Dec, mag,
-                                              name, QString(), lname, m_catPrefix, a, b, PA );
-        o->setFlux(flux);
-        o->setCustomCatalog(this);
-
-        m_ObjectList.append( o );
-
-        //Add name to the list of object names
-        if ( ! name.isEmpty() )
-            objectNames(iType).append( name );
-    }
-    if ( ! lname.isEmpty() && lname != name )
-        objectNames(iType).append( lname );
+    DeepSkyCatalogCache::Entry entry;
+    entry.type = iType;
+    entry.ra = RA.Degrees();
+    entry.dec = Dec.Degrees();
+    entry.mag = mag;
+    entry.a = a;
+    entry.b = b;
+    entry.pa = PA;
+    entry.flux = flux;
+    entry.name = name;
+    entry.longname = lname;
+
+    appendObject( entry );
+    entries.append( entry );
 
     return true;
 }
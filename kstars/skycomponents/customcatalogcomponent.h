@@ -20,6 +20,7 @@
 
 
 #include "listcomponent.h"
+#include "deepskycatalogcache.h"
 #include "Options.h"
 
 class CustomCatalog;
@@ -77,6 +78,11 @@ private:
     /** @short Load data into custom catalog */
     void loadData();
 
+    /**
+     *@short Create the object of a catalog entry and add it to the list
+     */
+    void appendObject( const DeepSkyCatalogCache::Entry &entry );
+
     /**@short Read data for existing custom catalogs from disk
      * @return true if catalog data was successfully read
      */
@@ -105,9 +111,11 @@ private:
     	*@p objList reference to the QList of SkyObjects to which we will add the parsed object
     	*@p showerrs if true, parse errors will be logged and reported
     	*@p errs reference to the string list containing the parse errors encountered
+    	*@p entries list the parsed object is appended to, for the compiled catalog
     	*/
     bool processCustomDataLine(int lnum, const QStringList &d, const QStringList &Columns,
-                               bool showerrs, QStringList &errs);
+                               bool showerrs, QStringList &errs,
+                               QVector<DeepSkyCatalogCache::Entry> &entries);
 
     /**
     	*@short Read metadata about the catalog from its header
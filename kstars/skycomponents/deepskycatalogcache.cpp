@@ -0,0 +1,271 @@
+/***************************************************************************
+                 deepskycatalogcache.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "deepskycatalogcache.h"
+
+#include <string.h>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+#include <kdebug.h>
+#include <kstandarddirs.h>
+
+#include "skymesh.h"
+
+namespace {
+    const char MAGIC[8] = { 'K', 'S', 'D', 'S', 'O', 'B', 'I', 'N' };
+    const quint32 VERSION = 1;
+    const quint32 BYTE_ORDER_MARK = 0x01020304;
+
+    struct FileHeader {
+        char magic[8];
+        quint32 version;
+        quint32 byteOrder;
+        qint64 sourceSize;
+        qint64 sourceTime;
+        qint32 meshLevel;
+        quint32 nRecords;
+        quint32 nMetadata;
+        quint32 nChars;
+    };
+
+    struct StringRef {
+        quint32 offset;
+        quint32 length;
+    };
+
+    struct Record {
+        double ra, dec, pa;
+        float mag, a, b, flux;
+        qint32 pgc, ugc;
+        quint32 trixel;
+        quint8 type, hasName, pad[2];
+        StringRef name, name2, longname, catalog;
+    };
+
+    // Collects the strings of the file, as UTF-16
+    class StringTable {
+    public:
+        StringRef add( const QString &s ) {
+            StringRef ref;
+            ref.offset = size();
+            ref.length = s.length();
+            m_chars.append( reinterpret_cast<const char*>( s.utf16() ), s.length() * sizeof(ushort) );
+            return ref;
+        }
+        quint32 size() const { return m_chars.size() / sizeof(ushort); }
+        const QByteArray& data() const { return m_chars; }
+    private:
+        QByteArray m_chars;
+    };
+
+    // Returns false if the reference points outside of the string table
+    bool readString( const ushort *chars, quint32 nChars, const StringRef &ref, QString *s ) {
+        if ( ref.offset > nChars || ref.length > nChars - ref.offset )
+            return false;
+        *s = QString::fromUtf16( chars + ref.offset, ref.length );
+        return true;
+    }
+
+    int meshLevel() {
+        SkyMesh *mesh = SkyMesh::Instance();
+        return mesh ? mesh->level() : -1;
+    }
+}
+
+DeepSkyCatalogCache::DeepSkyCatalogCache( const QString &sourceFile ) :
+    m_SourceFile( sourceFile )
+{}
+
+QString DeepSkyCatalogCache::cacheFile() const {
+    // Custom catalogs may share a file name, so tell them apart by their full path
+    QFileInfo source( m_SourceFile );
+    QString name = QString( "catalogcache/%1-%2.bin" )
+                   .arg( qHash( source.absoluteFilePath() ), 8, 16, QChar( '0' ) )
+                   .arg( source.fileName() );
+    return KStandardDirs::locateLocal( "appdata", name );
+}
+
+bool DeepSkyCatalogCache::load() {
+    m_Entries.clear();
+    m_Metadata.clear();
+
+    if ( m_SourceFile.isEmpty() || ! QFile::exists( m_SourceFile ) )
+        return false;
+
+    QFile file( cacheFile() );
+    if ( ! file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    qint64 size = file.size();
+    QByteArray buffer;
+    const char *data = reinterpret_cast<const char*>( file.map( 0, size ) );
+    if ( ! data ) {
+        buffer = file.readAll();
+        data = buffer.constData();
+        size = buffer.size();
+    }
+
+    if ( ! parse( data, size ) ) {
+        m_Entries.clear();
+        m_Metadata.clear();
+        return false;
+    }
+    return true;
+}
+
+bool DeepSkyCatalogCache::parse( const char *data, qint64 size ) {
+    FileHeader header;
+    if ( size < qint64( sizeof( FileHeader ) ) )
+        return false;
+    memcpy( &header, data, sizeof( FileHeader ) );
+
+    QFileInfo source( m_SourceFile );
+    if ( memcmp( header.magic, MAGIC, sizeof( MAGIC ) ) != 0
+         || header.version != VERSION
+         || header.byteOrder != BYTE_ORDER_MARK
+         || header.sourceSize != source.size()
+         || header.sourceTime != qint64( source.lastModified().toTime_t() )
+         || header.meshLevel != meshLevel() ) {
+        kDebug() << "Compiled catalog for" << m_SourceFile << "is stale, reparsing it";
+        return false;
+    }
+
+    qint64 recordsSize  = qint64( header.nRecords ) * sizeof( Record );
+    qint64 metadataSize = qint64( header.nMetadata ) * sizeof( StringRef );
+    qint64 charsSize    = qint64( header.nChars ) * sizeof( ushort );
+    if ( size != qint64( sizeof( FileHeader ) ) + recordsSize + metadataSize + charsSize ) {
+        kWarning() << "Compiled catalog" << cacheFile() << "is truncated";
+        return false;
+    }
+
+    const char *records = data + sizeof( FileHeader );
+    const char *metadata = records + recordsSize;
+    const ushort *chars = reinterpret_cast<const ushort*>( metadata + metadataSize );
+    const quint32 nChars = header.nChars;
+
+    bool ok = true;
+
+    m_Metadata.reserve( header.nMetadata );
+    for ( quint32 i = 0; i < header.nMetadata; ++i ) {
+        StringRef ref;
+        memcpy( &ref, metadata + i * sizeof( StringRef ), sizeof( StringRef ) );
+        QString s;
+        ok = readString( chars, nChars, ref, &s ) && ok;
+        m_Metadata.append( s );
+    }
+
+    m_Entries.resize( header.nRecords );
+    Entry *entry = m_Entries.data();
+    for ( quint32 i = 0; i < header.nRecords; ++i, ++entry ) {
+        Record r;
+        memcpy( &r, records + i * sizeof( Record ), sizeof( Record ) );
+        entry->type     = r.type;
+        entry->ra       = r.ra;
+        entry->dec      = r.dec;
+        entry->pa       = r.pa;
+        entry->mag      = r.mag;
+        entry->a        = r.a;
+        entry->b        = r.b;
+        entry->flux     = r.flux;
+        entry->pgc      = r.pgc;
+        entry->ugc      = r.ugc;
+        entry->trixel   = r.trixel;
+        entry->hasName  = r.hasName;
+        ok = readString( chars, nChars, r.name, &entry->name ) && ok;
+        ok = readString( chars, nChars, r.name2, &entry->name2 ) && ok;
+        ok = readString( chars, nChars, r.longname, &entry->longname ) && ok;
+        ok = readString( chars, nChars, r.catalog, &entry->catalog ) && ok;
+    }
+
+    if ( ! ok )
+        kWarning() << "Compiled catalog" << cacheFile() << "has invalid strings";
+    return ok;
+}
+
+bool DeepSkyCatalogCache::save( const QVector<Entry> &entries, const QStringList &metadata ) const {
+    QFileInfo source( m_SourceFile );
+    if ( ! source.exists() )
+        return false;
+
+    StringTable strings;
+
+    QByteArray records;
+    records.resize( entries.size() * sizeof( Record ) );
+    char *out = records.data();
+    foreach ( const Entry &entry, entries ) {
+        Record r;
+        memset( &r, 0, sizeof( Record ) );
+        r.ra       = entry.ra;
+        r.dec      = entry.dec;
+        r.pa       = entry.pa;
+        r.mag      = entry.mag;
+        r.a        = entry.a;
+        r.b        = entry.b;
+        r.flux     = entry.flux;
+        r.pgc      = entry.pgc;
+        r.ugc      = entry.ugc;
+        r.trixel   = entry.trixel;
+        r.type     = entry.type;
+        r.hasName  = entry.hasName;
+        r.name     = strings.add( entry.name );
+        r.name2    = strings.add( entry.name2 );
+        r.longname = strings.add( entry.longname );
+        r.catalog  = strings.add( entry.catalog );
+        memcpy( out, &r, sizeof( Record ) );
+        out += sizeof( Record );
+    }
+
+    QByteArray metadataRefs;
+    foreach ( const QString &s, metadata ) {
+        StringRef ref = strings.add( s );
+        metadataRefs.append( reinterpret_cast<const char*>( &ref ), sizeof( StringRef ) );
+    }
+
+    FileHeader header;
+    memset( &header, 0, sizeof( FileHeader ) );
+    memcpy( header.magic, MAGIC, sizeof( MAGIC ) );
+    header.version    = VERSION;
+    header.byteOrder  = BYTE_ORDER_MARK;
+    header.sourceSize = source.size();
+    header.sourceTime = source.lastModified().toTime_t();
+    header.meshLevel  = meshLevel();
+    header.nRecords   = entries.size();
+    header.nMetadata  = metadata.size();
+    header.nChars     = strings.size();
+
+    QFile file( cacheFile() );
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        kWarning() << "Could not write the compiled catalog" << file.fileName();
+        return false;
+    }
+
+    bool ok = file.write( reinterpret_cast<const char*>( &header ), sizeof( FileHeader ) ) == qint64( sizeof( FileHeader ) )
+              && file.write( records ) == records.size()
+              && file.write( metadataRefs ) == metadataRefs.size()
+              && file.write( strings.data() ) == strings.data().size();
+    file.close();
+
+    if ( ! ok ) {
+        kWarning() << "Could not write the compiled catalog" << file.fileName();
+        file.remove();
+    }
+    return ok;
+}
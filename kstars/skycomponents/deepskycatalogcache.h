@@ -0,0 +1,118 @@
+/***************************************************************************
+                 deepskycatalogcache.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef DEEPSKYCATALOGCACHE_H
+#define DEEPSKYCATALOGCACHE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "typedef.h"
+
+/**
+ *@class DeepSkyCatalogCache
+ *Compiled binary copy of a text deep-sky catalog.
+ *
+ *The text catalogs (ngcic.dat, custom catalogs) are slow to parse. The first
+ *time a catalog is loaded, the parsed entries are written to a binary file in
+ *the local data directory, together with the size and modification time of
+ *the text file. Later loads map that file (or read it in one go if it cannot
+ *be mapped) and copy the fixed-size records out of it. The cache is ignored,
+ *and rewritten by the caller, whenever the text file changes, the mesh level
+ *changes or the format version is bumped.
+ *
+ *Each entry stores the trixel it belongs to, so the trixel indexes can be
+ *rebuilt without querying the sky mesh, and whether its name should go into
+ *the name hash.
+ *
+ *File layout (native byte order):
+ *@li a header: magic, version, byte order mark, source size and time, mesh
+ *level, and the number of records, metadata strings and characters;
+ *@li the records;
+ *@li the metadata string references;
+ *@li the UTF-16 string table referenced by the records and the metadata.
+ *@author KStars Developers
+ *@version 1.0
+ */
+class DeepSkyCatalogCache
+{
+public:
+    /**
+     *@class DeepSkyCatalogCache::Entry
+     *One catalog object, as read from the text catalog.
+     */
+    class Entry {
+    public:
+        Entry() : type( 0 ), ra( 0. ), dec( 0. ), pa( 0. ), mag( 0.f ), a( 0.f ), b( 0.f ), flux( 0.f ),
+                  pgc( 0 ), ugc( 0 ), trixel( 0 ), hasName( true ) {}
+
+        int type;                   // SkyObject type
+        double ra, dec;             // Catalog coordinates (degrees)
+        double pa;                  // Position angle (degrees)
+        float mag;                  // Magnitude
+        float a, b;                 // Major and minor axes (arcminutes)
+        float flux;                 // Integrated flux (custom catalogs)
+        int pgc, ugc;               // PGC and UGC numbers
+        Trixel trixel;              // Trixel of the catalog position
+        bool hasName;               // False if the object has no name of its own
+        QString name, name2, longname, catalog;
+    };
+
+    /**
+     *@short Constructor
+     *@param sourceFile full path of the text catalog
+     */
+    explicit DeepSkyCatalogCache( const QString &sourceFile );
+
+    /**
+     *@return the full path of the binary file caching sourceFile
+     */
+    QString cacheFile() const;
+
+    /**
+     *@short Load the cached entries and metadata
+     *@return false if the cache is missing, stale or invalid. In that case
+     *the text catalog must be parsed, and save() called with the result.
+     */
+    bool load();
+
+    /**
+     *@short Write the cache file
+     *@param entries the entries parsed from the text catalog
+     *@param metadata any strings the catalog needs besides its entries
+     *(e.g. the header of a custom catalog)
+     *@return true if the file was written
+     */
+    bool save( const QVector<Entry> &entries, const QStringList &metadata = QStringList() ) const;
+
+    /** @return the entries read by load() */
+    inline const QVector<Entry>& entries() const { return m_Entries; }
+
+    /** @return the metadata read by load() */
+    inline const QStringList& metadata() const { return m_Metadata; }
+
+private:
+    /** @short Parse the cache file contents, of the given size */
+    bool parse( const char *data, qint64 size );
+
+    QString m_SourceFile;
+    QVector<Entry> m_Entries;
+    QStringList m_Metadata;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "ksfilereader.h"
 #include "kstarsdata.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "skylabel.h"
 #include "skylabeler.h"
 #include "Options.h"
@@ -62,16 +63,26 @@ void DeepSkyComponent::update( KSNumbers* )
 
 void DeepSkyComponent::loadData()
 {
-    KStarsData* data = KStarsData::Instance();
     //Check whether we need to concatenate a plit NGC/IC catalog
     //(i.e., if user has downloaded the Steinicke catalog)
     mergeSplitFiles();
 
+    //Use the compiled copy of the catalog, unless ngcic.dat changed since it was written
+    DeepSkyCatalogCache cache( KStandardDirs::locate( "appdata", "ngcic.dat" ) );
+    if ( cache.load() ) {
+        foreach ( const DeepSkyCatalogCache::Entry &entry, cache.entries() )
+            appendObject( entry );
+        return;
+    }
+
     KSFileReader fileReader;
     if ( ! fileReader.open( "ngcic.dat" ) ) return;
 
     fileReader.setProgress( i18n("Loading NGC/IC objects"), 13444, 10 );
 
+    QVector<DeepSkyCatalogCache::Entry> entries;
+    entries.reserve( 13444 );
+
     while ( fileReader.hasMoreLines() ) {
         QString line, con, ss, name, name2, longname;
         QString cat, cat2, sgn;
@@ -171,59 +182,92 @@ void DeepSkyComponent::loadData()
         }
         else {
             if ( ! longname.isEmpty() ) name = longname;
-            else {
-                hasName = false;
-                name = i18n( "Unnamed Object" );
-            }
+            else hasName = false;
         }
 
-        // create new deepskyobject
-        DeepSkyObject *o = 0;
         if ( type==0 ) type = 1; //Make sure we use CATALOG_STAR, not STAR
-        o = new DeepSkyObject( type, r, d, mag, name, name2, longname, cat, a, b, pa, pgc, ugc );
-        o->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-
-        // Add the name(s) to the nameHash for fast lookup -jbb
-        if ( hasName) {
-            nameHash[ name.toLower() ] = o;
-            if ( ! longname.isEmpty() ) nameHash[ longname.toLower() ] = o;
-            if ( ! name2.isEmpty() ) nameHash[ name2.toLower() ] = o;
-        }
 
-        Trixel trixel = m_skyMesh->index(o);
+        DeepSkyCatalogCache::Entry entry;
+        entry.type = type;
+        entry.ra = r.Degrees();
+        entry.dec = d.Degrees();
+        entry.mag = mag;
+        entry.a = a;
+        entry.b = b;
+        entry.pa = pa;
+        entry.pgc = pgc;
+        entry.ugc = ugc;
+        entry.hasName = hasName;
+        entry.name = name;
+        entry.name2 = name2;
+        entry.longname = longname;
+        entry.catalog = cat;
+
+        SkyPoint p( r, d );
+        entry.trixel = m_skyMesh->index( &p );
+
+        appendObject( entry );
+        entries.append( entry );
 
-        //Assign object to general DeepSkyObjects list,
-        //and a secondary list based on its catalog.
-        m_DeepSkyList.append( o );
-        appendIndex( o, &m_DeepSkyIndex, trixel );
+        fileReader.showProgress();
+    }
 
-        if ( o->isCatalogM()) {
-            m_MessierList.append( o );
-            appendIndex( o, &m_MessierIndex, trixel );
-        }
-        else if (o->isCatalogNGC() ) {
-            m_NGCList.append( o );
-            appendIndex( o, &m_NGCIndex, trixel );
-        }
-        else if ( o->isCatalogIC() ) {
-            m_ICList.append( o );
-            appendIndex( o, &m_ICIndex, trixel );
-        }
-        else {
-            m_OtherList.append( o );
-            appendIndex( o, &m_OtherIndex, trixel );
-        }
+    cache.save( entries );
+}
 
-        //Add name to the list of object names
-        if ( ! name.isEmpty() )
-            objectNames(type).append( name );
+DeepSkyObject* DeepSkyComponent::appendObject( const DeepSkyCatalogCache::Entry &entry )
+{
+    //Objects without a name of their own get a translated placeholder, which
+    //is not stored in the compiled catalog
+    QString name = entry.hasName ? entry.name : i18n( "Unnamed Object" );
+
+    // create new deepskyobject
+    DeepSkyObject *o = new DeepSkyObject( entry.type, dms( entry.ra ), dms( entry.dec ), entry.mag,
+                                          name, entry.name2, entry.longname, entry.catalog,
+                                          entry.a, entry.b, entry.pa, entry.pgc, entry.ugc );
+
+    // Add the name(s) to the nameHash for fast lookup -jbb
+    if ( entry.hasName ) {
+        nameHash[ name.toLower() ] = o;
+        if ( ! entry.longname.isEmpty() ) nameHash[ entry.longname.toLower() ] = o;
+        if ( ! entry.name2.isEmpty() ) nameHash[ entry.name2.toLower() ] = o;
+    }
 
-        //Add long name to the list of object names
-        if ( ! longname.isEmpty() && longname != name )
-            objectNames(type).append( longname );
+    //Assign object to general DeepSkyObjects list,
+    //and a secondary list based on its catalog.
+    m_DeepSkyList.append( o );
+    appendIndex( o, &m_DeepSkyIndex, entry.trixel );
 
-        fileReader.showProgress();
+    if ( o->isCatalogM()) {
+        m_MessierList.append( o );
+        appendIndex( o, &m_MessierIndex, entry.trixel );
+    }
+    else if (o->isCatalogNGC() ) {
+        m_NGCList.append( o );
+        appendIndex( o, &m_NGCIndex, entry.trixel );
+    }
+    else if ( o->isCatalogIC() ) {
+        m_ICList.append( o );
+        appendIndex( o, &m_ICIndex, entry.trixel );
     }
+    else {
+        m_OtherList.append( o );
+        appendIndex( o, &m_OtherIndex, entry.trixel );
+    }
+
+    //Add name to the list of object names
+    if ( ! name.isEmpty() )
+        objectNames( entry.type ).append( name );
+
+    //Add long name to the list of object names
+    if ( ! entry.longname.isEmpty() && entry.longname != name )
+        objectNames( entry.type ).append( entry.longname );
+
+    //The index also has the alternate name, e.g. the NGC number of a Messier object
+    nameIndex().insert( o );
+    nearestIndex().insert( o, this );
+
+    return o;
 }
 
 void DeepSkyComponent::mergeSplitFiles() {
@@ -288,6 +332,11 @@ void DeepSkyComponent::appendIndex( DeepSkyObject *o, DeepSkyIndex* dsIndex, Tri
 
 void DeepSkyComponent::draw( SkyPainter *skyp )
 {
+    // The labels are kept until the next draw: drawLabels() may be
+    // called again over a cached drawing of the objects
+    for ( int i = 0; i <= MAX_LINENUMBER_MAG; i++ )
+        m_labelList[ i ]->clear();
+
     if ( ! selected() ) return;
 
     bool drawFlag;
@@ -352,25 +401,39 @@ void DeepSkyComponent::drawDeepSkyCatalog( SkyPainter *skyp, bool drawObject,
     //DrawID drawID = m_skyMesh->drawID();
     MeshIterator region( m_skyMesh, DRAW_BUF );
 
+    // JIT update of the visible objects: those of a new epoch through the
+    // coordinate pipeline at once, the others only to the horizon
+    QVector<DeepSkyList*> visible;
+    QVector<SkyPoint*> moved, turned;
     while ( region.hasNext() ) {
-
-        Trixel trixel = region.next();
-        DeepSkyList* dsList = dsIndex->value( trixel );
+        DeepSkyList* dsList = dsIndex->value( region.next() );
         if ( dsList == 0 ) continue;
+        visible.append( dsList );
+        for (int j = 0; j < dsList->size(); j++ ) {
+            DeepSkyObject *obj = dsList->at( j );
+            if ( obj->updateID == updateID ) continue;
+            obj->updateID = updateID;
+            if ( obj->updateNumID != updateNumID ) {
+                obj->updateNumID = updateNumID;
+                moved.append( obj );
+            } else
+                turned.append( obj );
+        }
+    }
+    if ( ! moved.isEmpty() || ! turned.isEmpty() ) {
+        FrameProfiler::Timer t( "JIT update: deep sky objects" );
+        const CoordinatePipeline *pipeline = data->updatePipeline();
+        pipeline->updateCoords( moved.constData(), moved.size() );
+        pipeline->updateHorizontal( turned.constData(), turned.size() );
+    }
+
+    foreach ( DeepSkyList* dsList, visible ) {
         for (int j = 0; j < dsList->size(); j++ ) {
             DeepSkyObject *obj = dsList->at( j );
 
             //if ( obj->drawID == drawID ) continue;  // only draw each line once
             //obj->drawID = drawID;
 
-            if ( obj->updateID != updateID ) {
-                obj->updateID = updateID;
-                if ( obj->updateNumID != updateNumID) {
-                    obj->updateCoords( data->updateNum() );
-                }
-                obj->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-            }
-
             float mag = obj->mag();
             float size = obj->a() * dms::PI * Options::zoomFactor() / 10800.0;
 
@@ -414,7 +477,6 @@ void DeepSkyComponent::drawLabels()
         for ( int j = 0; j < list->size(); j++ ) {
             labeler->drawNameLabel(list->at(j).obj, list->at(j).o);
         }
-        list->clear();
     }
 
 }
@@ -440,123 +502,6 @@ void DeepSkyComponent::objectsInArea( QList<SkyObject*>& list, const SkyRegion&
 }
 
 
-//we multiply each catalog's smallest angular distance by the
-//following factors before selecting the final nearest object:
-// IC catalog = 0.8
-// NGC catalog = 0.5
-// "other" catalog = 0.4
-// Messier object = 0.25
-SkyObject* DeepSkyComponent::objectNearest( SkyPoint *p, double &maxrad ) {
-
-    if ( ! selected() ) return 0;
-
-    SkyObject *oTry = 0;
-    SkyObject *oBest = 0;
-    double rTry = maxrad;
-    double rBest = maxrad;
-    double r;
-    DeepSkyList* dsList;
-    SkyObject* obj;
-
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
-    while ( region.hasNext() ) {
-        dsList = m_ICIndex[ region.next() ];
-        if ( ! dsList ) continue;
-        for (int i=0; i < dsList->size(); ++i) {
-            obj = dsList->at( i );
-            r = obj->angularDistanceTo( p ).Degrees();
-            if ( r < rTry ) {
-                rTry = r;
-                oTry = obj;
-            }
-        }
-    }
-
-    rTry *= 0.8;
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    rTry = maxrad;
-    region.reset();
-    while ( region.hasNext() ) {
-        dsList = m_NGCIndex[ region.next() ];
-        if ( ! dsList ) continue;
-        for (int i=0; i < dsList->size(); ++i) {
-            obj = dsList->at( i );
-            r = obj->angularDistanceTo( p ).Degrees();
-            if ( r < rTry ) {
-                rTry = r;
-                oTry = obj;
-            }
-        }
-    }
-
-    rTry *= 0.6;
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    rTry = maxrad;
-
-    region.reset();
-    while ( region.hasNext() ) {
-        dsList = m_OtherIndex[ region.next() ];
-        if ( ! dsList ) continue;
-        for (int i=0; i < dsList->size(); ++i) {
-            obj = dsList->at( i );
-            r = obj->angularDistanceTo( p ).Degrees();
-            if ( r < rTry ) {
-                rTry = r;
-                oTry = obj;
-            }
-        }
-    }
-
-    rTry *= 0.6;
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    rTry = maxrad;
-
-    region.reset();
-    while ( region.hasNext() ) {
-        dsList = m_MessierIndex[ region.next() ];
-        if ( ! dsList ) continue;
-        for (int i=0; i < dsList->size(); ++i) {
-            obj = dsList->at( i );
-            r = obj->angularDistanceTo( p ).Degrees();
-            if ( r < rTry ) {
-                rTry = r;
-                oTry = obj;
-            }
-        }
-    }
-
-    // -jbb: this is the template of the non-indexed way
-    //
-    //foreach ( SkyObject *o, m_MessierList ) {
-    //	r = o->angularDistanceTo( p ).Degrees();
-    //	if ( r < rTry ) {
-    //		rTry = r;
-    //		oTry = o;
-    //	}
-    //}
-
-    rTry *= 0.5;
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    maxrad = rBest;
-    return oBest;
-}
-
 void DeepSkyComponent::clearList(QList<DeepSkyObject*>& list) {
     while( !list.isEmpty() ) {
         SkyObject *o = list.takeFirst();
@@ -23,6 +23,7 @@
 #include <QObject>
 #include "skycomponent.h"
 #include "skylabel.h"
+#include "deepskycatalogcache.h"
 
 #define NNGCFILES 14
 
@@ -100,8 +101,6 @@ public:
      */
     virtual void objectsInArea( QList<SkyObject*>& list, const SkyRegion& region );
 
-    virtual SkyObject* objectNearest( SkyPoint *p, double &maxrad );
-
     const QList<DeepSkyObject*>& objectList() const { return m_DeepSkyList; }
 
     void clear();
@@ -136,9 +135,18 @@ private:
      * @li 71-75    UGC Catalog number [int] can be blank
      * @li 77-END   Common name [string] can be blank
      * @return true if data file is successfully read.
+     * @note The parsed objects are also written to a compiled catalog,
+     * which is used instead of ngcic.dat as long as ngcic.dat is unchanged.
+     * @see DeepSkyCatalogCache
      */
     void loadData();
 
+    /**
+     *@short Create the deep-sky object of a catalog entry, and add it to the
+     *lists, trixel indexes and name lookups.
+     */
+    DeepSkyObject* appendObject( const DeepSkyCatalogCache::Entry &entry );
+
     void clearList(QList<DeepSkyObject*>& list);
 
     void mergeSplitFiles();
@@ -18,6 +18,7 @@
 #include "deepstarcomponent.h"
 
 #include <QPixmap>
+#include <QTime>
 
 #include <QRectF>
 #include <QFontMetricsF>
@@ -26,6 +27,7 @@
 #include "Options.h"
 #include "kstarsdata.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "skyobjects/starobject.h"
 #include "skymesh.h"
 #include "binfilehelper.h"
@@ -38,6 +40,23 @@
 #include <kde_file.h>
 #include "byteorder.h"
 
+namespace {
+    // Fills cone with the J2000 unit vector of p, whose coordinates are given
+    // for the current epoch, and the cosine of radius (in degrees)
+    void toJ2000Cone( const SkyPoint &p, double radius, float *cone ) {
+        SkyPoint p0( p.ra(), p.dec() );
+        p0.apparentCoord( KStarsData::Instance()->updateNum()->julianDay(), J2000 );
+
+        double sinRa, cosRa, sinDec, cosDec;
+        p0.ra().SinCos( sinRa, cosRa );
+        p0.dec().SinCos( sinDec, cosDec );
+        cone[0] = cosDec * cosRa;
+        cone[1] = cosDec * sinRa;
+        cone[2] = sinDec;
+        cone[3] = ( radius >= 180.0 ) ? -2.0 : cos( radius * dms::DegToRad );
+    }
+}
+
 DeepStarComponent::DeepStarComponent( SkyComposite *parent, QString fileName, float trigMag, bool staticstars ) :
     ListComponent(parent),
     m_reindexNum( J2000 ),
@@ -55,12 +74,16 @@ DeepStarComponent::DeepStarComponent( SkyComposite *parent, QString fileName, fl
 
 bool DeepStarComponent::loadStaticStars() {
     FILE *dataFile;
+    const char *record;
+    QTime t;
 
     if( !staticStars )
         return true;
     if( !fileOpened )
         return false;
 
+    t.start();
+
     dataFile = starReader.getFileHandle();
     rewind( dataFile );
 
@@ -69,25 +92,27 @@ bool DeepStarComponent::loadStaticStars() {
         return false;
     }
 
-    if( starReader.guessRecordSize() != 16 && starReader.guessRecordSize() != 32 ) {
+    const int recordSize = starReader.guessRecordSize();
+    if( recordSize != 16 && recordSize != 32 ) {
         kDebug() << "Cannot understand catalog file " << dataFileName << endl;
         return false;
     }
 
-    KDE_fseek(dataFile, starReader.getDataOffset(), SEEK_SET);
+    if( !( record = starReader.mapData() ) ) {
+        kDebug() << "Could not map catalog file " << dataFileName << " into memory" << endl;
+        return false;
+    }
+
+    const bool swapBytes = starReader.getByteSwap();
 
     qint16 faintmag;
     quint8 htm_level;
-    quint16 t_MSpT;
 
-    fread( &faintmag, 2, 1, dataFile );
-    if( starReader.getByteSwap() )
+    // The data region begins with the faint magnitude, the HTM level and the (unused) MSpT
+    memcpy( &faintmag, record, 2 );
+    if( swapBytes )
         faintmag = bswap_16( faintmag );
-    fread( &htm_level, 1, 1, dataFile );
-    fread( &t_MSpT, 2, 1, dataFile ); // Unused
-    if( starReader.getByteSwap() )
-        faintmag = bswap_16( faintmag );
-
+    htm_level = record[ 2 ];
 
     // TODO: Read the multiplying factor from the dataFile
     m_FaintMagnitude = faintmag / 100.0;
@@ -95,6 +120,7 @@ bool DeepStarComponent::loadStaticStars() {
     if( htm_level != m_skyMesh->level() )
         kDebug() << "WARNING: HTM Level in shallow star data file and HTM Level in m_skyMesh do not match. EXPECT TROUBLE" << endl;
 
+    KStarsData* data = KStarsData::Instance();
     for(Trixel i = 0; i < m_skyMesh->size(); ++i) {
 
         Trixel trixel = i;
@@ -102,44 +128,52 @@ bool DeepStarComponent::loadStaticStars() {
         if( !SB )
             kDebug() << "ERROR: Could not allocate new StarBlock to hold shallow unnamed stars for trixel " << trixel << endl;
         m_starBlockList.at( trixel )->setStaticBlock( SB );
-        
-        for(unsigned long j = 0; j < (unsigned long) starReader.getRecordCount(i); ++j) {
-            bool fread_success;
-            if( starReader.guessRecordSize() == 32 )
-                fread_success = fread( &stardata, sizeof( starData ), 1, dataFile );
-            else if( starReader.guessRecordSize() == 16 )
-                fread_success = fread( &deepstardata, sizeof( deepStarData ), 1, dataFile );
-
-            if( !fread_success ) {
-                kDebug() << "ERROR: Could not read starData structure for star #" << j << " under trixel #" << trixel << endl;
-            }
 
-            /* Swap Bytes when required */            
-            if( starReader.getByteSwap() ) {
-                if( starReader.guessRecordSize() == 32 )
-                    byteSwap( &stardata );
-                else
-                    byteSwap( &deepstardata );
-            }
+        record = starReader.getRecordPointer( i );
+        for(unsigned long j = 0; j < (unsigned long) starReader.getRecordCount(i); ++j, record += recordSize) {
+
+            // Records are used in place, unless they need to be aligned or byte swapped
+            const bool copy = swapBytes || ( reinterpret_cast<quintptr>( record ) & 3 );
 
-            /* Initialize star with data just read. */
+            /* Initialize star with data from the file. */
             StarObject* star;
-            if( starReader.guessRecordSize() == 32 )
-                star = SB->addStar( stardata );
-            else
-                star = SB->addStar( deepstardata );
+            if( recordSize == 32 ) {
+                const starData *sd = reinterpret_cast<const starData *>( record );
+                if( copy ) {
+                    memcpy( &stardata, record, sizeof( starData ) );
+                    if( swapBytes )
+                        byteSwap( &stardata );
+                    sd = &stardata;
+                }
+                star = SB->addStar( *sd );
+            }
+            else {
+                const deepStarData *dsd = reinterpret_cast<const deepStarData *>( record );
+                if( copy ) {
+                    memcpy( &deepstardata, record, sizeof( deepStarData ) );
+                    if( swapBytes )
+                        byteSwap( &deepstardata );
+                    dsd = &deepstardata;
+                }
+                star = SB->addStar( *dsd );
+            }
             
             if( star ) {
-                KStarsData* data = KStarsData::Instance();
                 star->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
                 if( star->getHDIndex() != 0 )
                     m_CatalogNumber.insert( star->getHDIndex(), star );
+                // The static stars stay in memory, so they can be indexed once
+                nearestIndex().insert( star, this );
             } else {
                 kDebug() << "CODE ERROR: More unnamed static stars in trixel " << trixel << " than we allocated space for!" << endl;
             }
         }
     }
 
+    starReader.unmapData();
+
+    kDebug() << "Loaded static stars from" << dataFileName << "in" << t.elapsed() << "ms";
+
     return true;
 }
 
@@ -173,7 +207,6 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
 
     SkyMap *map = SkyMap::Instance();
     KStarsData* data = KStarsData::Instance();
-    UpdateID updateID = data->updateID();
 
     //FIXME_FOV -- maybe not clamp like that...
     float radius = map->projector()->fov();
@@ -195,6 +228,8 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     // TODO: Enable hiding of faint stars
 
     float maglim = StarComponent::zoomMagnitudeLimit();
+    if( staticStars )
+        nearestIndex().setMagLimit( this, maglim );
 
     if( maglim < triggerMag )
         return;
@@ -206,6 +241,15 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     SkyPoint* focus = map->focus();
     m_skyMesh->aperture( focus, radius + 1.0, DRAW_BUF ); // divide by 2 for testing
 
+    // Stars outside these cones are off screen or under the ground, and are
+    // skipped without being updated. Both have the same safety margin as the
+    // aperture, and the ground cone matches the -1 degree cutoff of
+    // Projector::checkVisibility()
+    float viewCone[4], groundCone[4];
+    toJ2000Cone( *focus, map->projector()->fieldRadius() + 1.0, viewCone );
+    toJ2000Cone( SkyPoint( *data->lst(), *data->geo()->lat() ),
+                 ( Options::showHorizon() && Options::showGround() ) ? 92.0 : 180.0, groundCone );
+
     MeshIterator region(m_skyMesh, DRAW_BUF);
 
     magLim = maglim;
@@ -213,17 +257,11 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
     StarBlockFactory *m_StarBlockFactory = StarBlockFactory::Instance();
     //    m_StarBlockFactory->drawID = m_skyMesh->drawID();
     //    kDebug() << "Mesh size = " << m_skyMesh->size() << "; drawID = " << m_skyMesh->drawID();
-    QTime t;
+    FrameProfiler::Timer laps;
     int nTrixels = 0;
 
-    t_dynamicLoad = 0;
-    t_updateCache = 0;
-    t_drawUnnamed = 0;
-
     visibleStarCount = 0;
 
-    t.start();
-
     // Mark used blocks in the LRU Cache. Not required for static stars
     if( !staticStars ) {
         while( region.hasNext() ) {
@@ -242,10 +280,13 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
                     
             }
         }
-        t_updateCache = t.restart();
+        laps.lap( "Stars: LRU cache" );
         region.reset();
     }
 
+    // The stars to draw are gathered first, so that their JIT update is
+    // timed once for the whole loop
+    QVector<StarObject*> drawList;
     while ( region.hasNext() ) {
         ++nTrixels;
         Trixel currentRegion = region.next();
@@ -260,7 +301,7 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
                      << currentRegion << " !"<< endl;
 	}
 
-        t_dynamicLoad += t.restart();
+        laps.lap( "Stars: dynamic load" );
 
         //        kDebug() << "Drawing SBL for trixel " << currentRegion << ", SBL has " 
         //                 <<  m_starBlockList[ currentRegion ]->getBlockCount() << " blocks" << endl;
@@ -268,6 +309,14 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
             StarBlock *block = m_starBlockList.at( currentRegion )->block( i );
             //            kDebug() << "---> Drawing stars from block " << i << " of trixel " << 
             //                currentRegion << ". SB has " << block->getStarCount() << " stars" << endl;
+            if( m_visible.size() < block->getStarCount() )
+                m_visible.resize( block->getStarCount() );
+            if( block->cull( viewCone, groundCone, m_visible.data() ) == 0 ) {
+                if( block->getFaintMag() > maglim )
+                    break;
+                continue;
+            }
+
             for( int j = 0; j < block->getStarCount(); j++ ) {
 
                 StarObject *curStar = block->star( j );
@@ -275,24 +324,33 @@ void DeepStarComponent::draw( SkyPainter *skyp ) {
                 //                kDebug() << "We claim that he's from trixel " << currentRegion 
                 //<< ", and indexStar says he's from " << m_skyMesh->indexStar( curStar );
 
-                if ( curStar->updateID != updateID )
-                    curStar->JITupdate( data );
-
                 float mag = curStar->mag();
 
                 if ( mag > maglim || ( hideFaintStars && mag > hideStarsMag ) )
                     break;
 
-                if( skyp->drawPointSource(curStar, mag, curStar->spchar() ) )
-                    visibleStarCount++;
+                if( !m_visible[ j ] )
+                    continue;
+
+                drawList.append( curStar );
             }
         }
 
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
         //        verifySBLIntegrity();        
-        t_drawUnnamed += t.restart();
+        laps.lap( "Stars: culling" );
+
+    }
+
+    StarComponent::JITupdate( drawList.constData(), drawList.size() );
+    laps.lap( "JIT update: stars" );
 
+    for ( int i = 0; i < drawList.size(); ++i ) {
+        StarObject *curStar = drawList[ i ];
+        if( skyp->drawPointSource( curStar, curStar->mag(), curStar->spchar() ) )
+            visibleStarCount++;
     }
+    laps.lap( "Stars: unnamed stars" );
     m_skyMesh->inDraw( false );
 
 }
@@ -414,9 +472,10 @@ bool DeepStarComponent::starsInAperture( QList<StarObject *> &list, const SkyPoi
     Q_ASSERT( center.ra0().Degrees() >= 0.0 );
     Q_ASSERT( center.dec0().Degrees() <= 90.0 );
 
-    m_skyMesh->intersect( center.ra0().Degrees(), center.dec0().Degrees(), radius, (BufNum) OBJ_NEAREST_BUF );
+    MeshBuffer result( m_skyMesh );
+    m_skyMesh->intersect( center.ra0().Degrees(), center.dec0().Degrees(), radius, &result );
 
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
+    MeshIterator region( &result );
 
     if( maglim < -28 )
         maglim = m_FaintMagnitude;
@@ -442,6 +501,27 @@ bool DeepStarComponent::starsInAperture( QList<StarObject *> &list, const SkyPoi
     return true;
 }
 
+void DeepStarComponent::prefetch( const SkyPoint *center, double radius )
+{
+    if( !fileOpened || staticStars )
+        return;
+
+    float maglim = StarComponent::zoomMagnitudeLimit();
+    if( maglim < triggerMag )
+        return;
+
+    // A buffer of our own: the shared ones belong to the queries of the sky map
+    MeshBuffer result( m_skyMesh );
+    m_skyMesh->index( center, radius + 1.0, &result );
+
+    MeshIterator region( &result );
+    while ( region.hasNext() ) {
+        StarBlockList *sbl = m_starBlockList.at( region.next() );
+        if( sbl->getFaintMag() < maglim )
+            sbl->prefetch();
+    }
+}
+
 void DeepStarComponent::byteSwap( deepStarData *stardata ) {
     stardata->RA = bswap_32( stardata->RA );
     stardata->Dec = bswap_32( stardata->Dec );
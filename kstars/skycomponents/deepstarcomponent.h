@@ -110,6 +110,14 @@ public:
      */
     bool starsInAperture( QList<StarObject*> &list, const SkyPoint &center, float radius, float maglim=-29 );
 
+    /**
+     *@short Read ahead, in the background, the stars that draw() would need
+     * to load if the sky map was centered on the given point
+     *@p center The point that is expected to be the focus soon
+     *@p radius The radius of the field of view, in degrees
+     */
+    void prefetch( const SkyPoint *center, double radius );
+
 
     // TODO: Find the right place for this method
     static void byteSwap( deepStarData *stardata );
@@ -131,12 +139,8 @@ private:
     unsigned long  visibleStarCount;
     quint16        MSpT;             // Maximum number of stars in any given trixel
 
-    // Time keeping variables
-    long unsigned  t_dynamicLoad;
-    long unsigned  t_drawUnnamed;
-    long unsigned  t_updateCache;
-
     QVector< StarBlockList *> m_starBlockList;
+    QVector<quint8> m_visible;       // Result of StarBlock::cull() for the block being drawn
     QHash<int, StarObject *> m_CatalogNumber;
 
     bool           staticStars;
@@ -74,9 +74,16 @@ void HighPMStarList::reindex( KSNumbers *num, StarIndex* starIndex )
 
     int cnt(0);
 
+    QVector<StarObject*> stars( m_stars.size() );
+    QVector<Trixel> trixels( m_stars.size() );
+    for ( int i = 0; i < m_stars.size(); i++ ) {
+        stars[ i ] = m_stars.at( i )->star;
+    }
+    m_skyMesh->indexStars( stars.constData(), stars.size(), trixels.data() );
+
     for ( int i = 0; i < m_stars.size(); i++ ) {
         HighPMStar* HPStar = m_stars.at( i );
-        Trixel trixel = m_skyMesh->indexStar( HPStar->star );
+        Trixel trixel = trixels[ i ];
         if ( trixel == HPStar->trixel ) continue;
         cnt++;
         StarObject* star = HPStar->star;
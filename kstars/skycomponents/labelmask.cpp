@@ -0,0 +1,146 @@
+/***************************************************************************
+                  labelmask.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "labelmask.h"
+
+namespace {
+    // Bits first to last of a word, 0 <= first <= last < 64
+    inline quint64 wordMask( int first, int last ) {
+        quint64 high = ( last == 63 ) ? ~Q_UINT64_C( 0 ) : ( ( Q_UINT64_C( 1 ) << ( last + 1 ) ) - 1 );
+        return high & ~( ( Q_UINT64_C( 1 ) << first ) - 1 );
+    }
+
+    inline int bitCount( quint64 w ) {
+        int n = 0;
+        for ( ; w; ++n )
+            w &= w - 1;
+        return n;
+    }
+
+    inline bool isSet( const quint64 *row, int c ) {
+        return row[ c >> 6 ] & ( Q_UINT64_C( 1 ) << ( c & 63 ) );
+    }
+
+    // Marks the cells c0 to c1 of a strip, c0 <= c1
+    void setCells( quint64 *row, int c0, int c1 ) {
+        int w0 = c0 >> 6, w1 = c1 >> 6;
+        if ( w0 == w1 ) {
+            row[ w0 ] |= wordMask( c0 & 63, c1 & 63 );
+            return;
+        }
+        row[ w0 ] |= wordMask( c0 & 63, 63 );
+        for ( int w = w0 + 1; w < w1; ++w )
+            row[ w ] = ~Q_UINT64_C( 0 );
+        row[ w1 ] |= wordMask( 0, c1 & 63 );
+    }
+}
+
+LabelMask::LabelMask() :
+    m_width( 0 ), m_strips( 0 ), m_wordsPerStrip( 0 ), m_gapCells( 0 )
+{}
+
+void LabelMask::reset( int width, int strips, int minGap ) {
+    if ( width < 1 ) width = 1;
+    if ( strips < 1 ) strips = 1;
+
+    m_width  = width;
+    m_strips = strips;
+    m_gapCells = qMax( minGap, 0 ) / CELL_WIDTH;
+    m_wordsPerStrip = ( ( width + CELL_WIDTH - 1 ) / CELL_WIDTH + 63 ) / 64;
+
+    // Only grows, so that a frame of the same size allocates nothing
+    int size = m_wordsPerStrip * m_strips;
+    if ( m_bits.size() < size )
+        m_bits.resize( size );
+    m_bits.fill( 0 );
+}
+
+bool LabelMask::toCells( const Region &r, int *c0, int *c1, int *y0, int *y1 ) const {
+    if ( r.maxX < 0 || r.minX >= m_width || r.maxY < 0 || r.minY >= m_strips || m_strips == 0 )
+        return false;
+
+    *c0 = qMax( r.minX, 0 ) / CELL_WIDTH;
+    *c1 = qMin( r.maxX, m_width - 1 ) / CELL_WIDTH;
+    *y0 = qMax( r.minY, 0 );
+    *y1 = qMin( r.maxY, m_strips - 1 );
+    return true;
+}
+
+bool LabelMask::isFree( const Region &r ) const {
+    int c0, c1, y0, y1;
+    if ( ! toCells( r, &c0, &c1, &y0, &y1 ) )
+        return true;
+
+    int w0 = c0 >> 6, w1 = c1 >> 6;
+    quint64 first = wordMask( c0 & 63, w0 == w1 ? c1 & 63 : 63 );
+    quint64 last  = wordMask( 0, c1 & 63 );
+
+    for ( int y = y0; y <= y1; ++y ) {
+        const quint64 *row = m_bits.constData() + y * m_wordsPerStrip;
+        if ( row[ w0 ] & first )
+            return false;
+        if ( w1 > w0 ) {
+            for ( int w = w0 + 1; w < w1; ++w )
+                if ( row[ w ] )
+                    return false;
+            if ( row[ w1 ] & last )
+                return false;
+        }
+    }
+    return true;
+}
+
+bool LabelMask::mark( const Region &r ) {
+    if ( ! isFree( r ) )
+        return false;
+
+    int c0, c1, y0, y1;
+    if ( ! toCells( r, &c0, &c1, &y0, &y1 ) )
+        return true;
+
+    const int lastCell = ( m_width - 1 ) / CELL_WIDTH;
+    for ( int y = y0; y <= y1; ++y ) {
+        quint64 *row = m_bits.data() + y * m_wordsPerStrip;
+        int from = c0, to = c1;
+
+        // Close the gaps narrower than m_gapCells to the nearest marked
+        // cells, so that no label squeezes in between later
+        for ( int c = c0 - 1; c >= 0 && c > c0 - m_gapCells; --c ) {
+            if ( isSet( row, c ) ) {
+                from = c;
+                break;
+            }
+        }
+        for ( int c = c1 + 1; c <= lastCell && c < c1 + m_gapCells; ++c ) {
+            if ( isSet( row, c ) ) {
+                to = c;
+                break;
+            }
+        }
+
+        setCells( row, from, to );
+    }
+    return true;
+}
+
+int LabelMask::markedCells() const {
+    int n = 0;
+    int size = m_wordsPerStrip * m_strips;
+    for ( int i = 0; i < size; ++i )
+        n += bitCount( m_bits[ i ] );
+    return n;
+}
@@ -0,0 +1,108 @@
+/***************************************************************************
+                   labelmask.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef LABELMASK_H
+#define LABELMASK_H
+
+#include <QVector>
+
+/**
+ *@class LabelMask
+ *
+ *The virtual screen of the SkyLabeler, as an occupancy bitmap.
+ *
+ *The screen is cut into cells: horizontal strips of the height the labeler
+ *chooses, and columns of CELL_WIDTH pixels. Each cell is one bit, set if a
+ *label covers any part of it. A row of cells is an array of 64 bit words, so
+ *testing or marking the cells under a label takes a couple of word
+ *operations per strip, whatever the number of labels already placed. The
+ *bitmap is allocated once and only cleared between frames.
+ *
+ *@short Occupancy bitmap used to keep labels from overlapping
+ *@version 1.0
+ */
+
+class LabelMask {
+
+ public:
+
+    /** Width of a cell in pixels */
+    static const int CELL_WIDTH = 4;
+
+    /**
+     *@short A region of the virtual screen: pixels minX to maxX of strips
+     *minY to maxY, both inclusive
+     */
+    struct Region {
+        int minX, maxX;
+        int minY, maxY;
+    };
+
+    /**
+     *Constructor. The mask is empty until reset() is called.
+     */
+    LabelMask();
+
+    /**
+     *@short  Clear the mask, resizing it to the screen
+     *@param  width   Width of the screen in pixels
+     *@param  strips  Number of strips
+     *@param  minGap  Narrowest gap left between two regions of a strip, in pixels
+     */
+    void reset( int width, int strips, int minGap = 0 );
+
+    /**
+     *@short  Mark a region, unless it overlaps a region marked before
+     *
+     *The parts of the region outside of the screen are ignored. On each
+     *strip, a gap narrower than minGap between the region and a region
+     *marked before is marked too, so that it stays empty.
+     *@return true if the region was free and is now marked
+     */
+    bool mark( const Region &r );
+
+    /**
+     *@return true if no cell of the region is marked
+     */
+    bool isFree( const Region &r ) const;
+
+    /**
+     *@return the number of marked cells
+     */
+    int markedCells() const;
+
+    /**
+     *@return the memory used by the bitmap, in bytes
+     */
+    int byteSize() const { return m_bits.size() * sizeof( quint64 ); }
+
+ private:
+
+    /**
+     *@short  Clip a region to the screen and convert it to cells
+     *@return false if the region is entirely off the screen
+     */
+    bool toCells( const Region &r, int *c0, int *c1, int *y0, int *y1 ) const;
+
+    QVector<quint64> m_bits;     // The strips one after the other
+    int m_width;                 // Width of the screen in pixels
+    int m_strips;
+    int m_wordsPerStrip;
+    int m_gapCells;              // Gaps of fewer cells are closed by mark()
+};
+
+#endif
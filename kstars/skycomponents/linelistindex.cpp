@@ -42,6 +42,7 @@
 #include "kstarsdata.h"
 #include "skyobjects/skyobject.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 #include "skymesh.h"
 #include "linelist.h"
@@ -82,6 +83,7 @@ void LineListIndex::appendLine( LineList* lineList, int debug)
     }
 
     m_listList.append( lineList);
+    m_visibleLines.serial = 0;
 }
 
 void LineListIndex::appendPoly(LineList* lineList, int debug)
@@ -99,6 +101,7 @@ void LineListIndex::appendPoly(LineList* lineList, int debug)
         }
         m_polyIndex->value( trixel )->append( lineList );
     }
+    m_visiblePolys.serial = 0;
 }
 
 void LineListIndex::appendBoth(LineList* lineList, int debug)
@@ -124,6 +127,7 @@ void LineListIndex::reindexLines()
         delete listList;
     }
     delete oldIndex;
+    m_visibleLines.serial = 0;
 }
 
 
@@ -133,17 +137,12 @@ void LineListIndex::JITupdate( LineList* lineList )
     lineList->updateID = data->updateID();
     SkyList* points = lineList->points();
 
+    const CoordinatePipeline *pipeline = data->updatePipeline();
     if ( lineList->updateNumID != data->updateNumID() ) {
         lineList->updateNumID = data->updateNumID();
-        KSNumbers* num = data->updateNum();
-        for (int i = 0; i < points->size(); i++ ) {
-            points->at( i )->updateCoords( num );
-        }
-    }
-
-    for (int i = 0; i < points->size(); i++ ) {
-        points->at( i )->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-    }
+        pipeline->updateCoords( points->constData(), points->size() );
+    } else
+        pipeline->updateHorizontal( points->constData(), points->size() );
 }
 
 
@@ -168,57 +167,86 @@ SkipList* LineListIndex::skipList( LineList *lineList )
     return 0;
 }
 
-void LineListIndex::drawLines( SkyPainter *skyp )
+void LineListIndex::countTrixel( LineListHash* index, VisibleSet* visible, Trixel trixel, int delta )
 {
-    DrawID   drawID   = skyMesh()->drawID();
-    UpdateID updateID = KStarsData::Instance()->updateID();
+    LineListList* lineListList = index->value( trixel );
+    if ( lineListList == 0 )
+        return;
 
-    MeshIterator region( skyMesh(), drawBuffer() );
+    for (int i = 0; i < lineListList->size(); i++) {
+        LineList* lineList = lineListList->at( i );
+        QHash<LineList*, int>::iterator it = visible->count.find( lineList );
+        if ( it == visible->count.end() )
+            it = visible->count.insert( lineList, 0 );
+        *it += delta;
+        if ( *it <= 0 )
+            visible->count.erase( it );
+    }
+}
 
-    while ( region.hasNext() ) {
-        LineListList* lineListList = m_lineIndex->value( region.next() );
-        if ( lineListList == 0 )
-            continue;
+void LineListIndex::updateVisible( LineListHash* index, VisibleSet* visible )
+{
+    MeshBufNum_t bufNum = drawBuffer();
+    unsigned int serial = skyMesh()->apertureSerial( bufNum );
+    if ( serial == visible->serial )
+        return;
 
-        for (int i = 0; i < lineListList->size(); i++) {
-            LineList* lineList = lineListList->at( i );
+    if ( visible->serial != 0 && serial == visible->serial + 1 ) {
+        // A pan: only the edges of the aperture changed
+        const QVector<Trixel>& entering = skyMesh()->enteringTrixels( bufNum );
+        const QVector<Trixel>& leaving  = skyMesh()->leavingTrixels( bufNum );
+        for ( int i = 0; i < entering.size(); i++ )
+            countTrixel( index, visible, entering[ i ], 1 );
+        for ( int i = 0; i < leaving.size(); i++ )
+            countTrixel( index, visible, leaving[ i ], -1 );
+    }
+    else {
+        const QVector<Trixel>& trixels = skyMesh()->apertureTrixels( bufNum );
+        visible->count.clear();
+        for ( int i = 0; i < trixels.size(); i++ )
+            countTrixel( index, visible, trixels[ i ], 1 );
+    }
+    visible->serial = serial;
+}
 
-            if ( lineList->drawID == drawID )
-                continue;
-            lineList->drawID = drawID;
+void LineListIndex::drawLines( SkyPainter *skyp )
+{
+    UpdateID updateID = KStarsData::Instance()->updateID();
 
-            if ( lineList->updateID != updateID )
-                JITupdate( lineList );
+    updateVisible( m_lineIndex, &m_visibleLines );
 
-            skyp->drawSkyPolyline(lineList, skipList(lineList), label() );
+    QHash<LineList*, int>::const_iterator it;
+    {
+        FrameProfiler::Timer t( "JIT update: lines" );
+        for ( it = m_visibleLines.count.constBegin(); it != m_visibleLines.count.constEnd(); ++it ) {
+            if ( it.key()->updateID != updateID )
+                JITupdate( it.key() );
         }
     }
+
+    for ( it = m_visibleLines.count.constBegin(); it != m_visibleLines.count.constEnd(); ++it ) {
+        LineList* lineList = it.key();
+        skyp->drawSkyPolyline(lineList, skipList(lineList), label() );
+    }
 }
 
 void LineListIndex::drawFilled( SkyPainter *skyp )
 {
-    DrawID drawID     = skyMesh()->drawID();
     UpdateID updateID = KStarsData::Instance()->updateID();
 
-    MeshIterator region( skyMesh(), drawBuffer() );
-    while ( region.hasNext() ) {
-
-        LineListList* lineListList =  m_polyIndex->value( region.next() );
-        if ( lineListList == 0 ) continue;
+    updateVisible( m_polyIndex, &m_visiblePolys );
 
-        for (int i = 0; i < lineListList->size(); i++) {
-            LineList* lineList = lineListList->at( i );
-
-            // draw each Linelist at most once
-            if ( lineList->drawID == drawID ) continue;
-            lineList->drawID = drawID;
-
-            if ( lineList->updateID != updateID )
-                JITupdate( lineList );
-
-            skyp->drawSkyPolygon(lineList);
+    QHash<LineList*, int>::const_iterator it;
+    {
+        FrameProfiler::Timer t( "JIT update: lines" );
+        for ( it = m_visiblePolys.count.constBegin(); it != m_visiblePolys.count.constEnd(); ++it ) {
+            if ( it.key()->updateID != updateID )
+                JITupdate( it.key() );
         }
     }
+
+    for ( it = m_visiblePolys.count.constBegin(); it != m_visiblePolys.count.constEnd(); ++it )
+        skyp->drawSkyPolygon( it.key() );
 }
 
 void LineListIndex::intro()
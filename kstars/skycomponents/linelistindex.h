@@ -148,6 +148,26 @@ protected:
     virtual LineListLabel* label() {return 0;};
     
 private:
+    /* @short The LineLists covering the trixels of the aperture of the draw
+     * buffer, kept from one frame to the next.
+     */
+    struct VisibleSet {
+        VisibleSet() : serial( 0 ) {}
+
+        unsigned int serial;            // SkyMesh::apertureSerial() of the set, 0 if stale
+        QHash<LineList*, int> count;    // Number of trixels of the aperture covering each LineList
+    };
+
+    /* @short brings the set up to date with the last aperture of the draw
+     * buffer: only the trixels which entered or left the aperture since the
+     * last update are looked up, unless the set is stale.
+     */
+    void updateVisible( LineListHash* index, VisibleSet* visible );
+
+    /* @short adds delta to the count of each LineList covering the trixel
+     */
+    void countTrixel( LineListHash* index, VisibleSet* visible, Trixel trixel, int delta );
+
     QString      m_name;
 
     SkyMesh*      m_skyMesh;
@@ -155,6 +175,9 @@ private:
     LineListHash* m_polyIndex;
 
     LineListList  m_listList;
+
+    VisibleSet    m_visibleLines;
+    VisibleSet    m_visiblePolys;
 };
 
 #endif
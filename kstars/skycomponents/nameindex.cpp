@@ -0,0 +1,264 @@
+/***************************************************************************
+                  nameindex.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "nameindex.h"
+
+#include <QPair>
+#include <QtAlgorithms>
+
+#include "skyobjects/skyobject.h"
+
+namespace {
+    // The order SkyMapComposite::findByName() used to search the components in
+    quint8 typeRank( int type ) {
+        switch ( type ) {
+        case SkyObject::PLANET:
+        case SkyObject::MOON:
+        case SkyObject::COMET:
+        case SkyObject::ASTEROID:
+            return 0;
+        case SkyObject::CATALOG_STAR:
+            return 2;
+        case SkyObject::CONSTELLATION:
+            return 3;
+        case SkyObject::STAR:
+            return 4;
+        default:
+            return 1;
+        }
+    }
+
+    inline bool isWordChar( const QChar &c ) {
+        return c.isLetterOrNumber();
+    }
+
+    // Levenshtein distance, or limit + 1 as soon as it is known to exceed limit
+    int editDistance( const QString &a, const QString &b, int limit ) {
+        int n = a.size(), m = b.size();
+        if ( qAbs( n - m ) > limit )
+            return limit + 1;
+
+        QVector<int> prev( m + 1 ), cur( m + 1 );
+        for ( int j = 0; j <= m; ++j )
+            prev[ j ] = j;
+
+        for ( int i = 1; i <= n; ++i ) {
+            cur[ 0 ] = i;
+            int rowMin = i;
+            for ( int j = 1; j <= m; ++j ) {
+                int d = prev[ j - 1 ] + ( a[ i - 1 ] == b[ j - 1 ] ? 0 : 1 );
+                d = qMin( d, prev[ j ] + 1 );
+                d = qMin( d, cur[ j - 1 ] + 1 );
+                cur[ j ] = d;
+                rowMin = qMin( rowMin, d );
+            }
+            if ( rowMin > limit )
+                return limit + 1;
+            prev.swap( cur );
+        }
+        return prev[ m ];
+    }
+}
+
+bool NameIndex::Entry::operator<( const Entry &e ) const {
+    int c = key.compare( e.key );
+    if ( c != 0 )
+        return c < 0;
+    if ( full != e.full )
+        return full;
+    return rank < e.rank;
+}
+
+NameIndex::NameIndex() :
+    m_sorted( true )
+{}
+
+QString NameIndex::normalize( const QString &name ) {
+    QString key;
+    key.reserve( name.size() );
+    for ( int i = 0; i < name.size(); ++i ) {
+        if ( isWordChar( name[ i ] ) )
+            key += name[ i ].toLower();
+    }
+    return key;
+}
+
+void NameIndex::insert( const QString &name, SkyObject *obj ) {
+    if ( ! obj || name.isEmpty() )
+        return;
+
+    // The address of a removed object may come back with a new object
+    if ( m_removed.contains( obj ) )
+        purge();
+
+    Entry e;
+    e.name = name;
+    e.obj  = obj;
+    e.type = obj->type();
+    e.rank = typeRank( e.type );
+
+    // Index the name from the start of each of its words; the first one is the whole name
+    e.full = true;
+    for ( int i = 0; i < name.size(); ++i ) {
+        if ( ! isWordChar( name[ i ] ) || ( i > 0 && isWordChar( name[ i - 1 ] ) ) )
+            continue;
+        e.key = normalize( name.mid( i ) );
+        m_entries.append( e );
+        e.full = false;
+    }
+
+    m_sorted = false;
+}
+
+void NameIndex::insert( SkyObject *obj ) {
+    if ( ! obj )
+        return;
+
+    // name() and longname() return a placeholder for an unnamed object
+    QString name = obj->hasName() ? obj->name() : QString();
+    QString longname = obj->hasLongName() ? obj->longname() : QString();
+
+    insert( name, obj );
+    if ( longname != name )
+        insert( longname, obj );
+    if ( obj->name2() != name && obj->name2() != longname )
+        insert( obj->name2(), obj );
+}
+
+void NameIndex::remove( const SkyObject *obj ) {
+    // Removing every object of a catalog one by one must stay linear, so
+    // the entries are dropped on the next query
+    if ( obj )
+        m_removed.insert( obj );
+}
+
+void NameIndex::removeType( int type ) {
+    int j = 0;
+    for ( int i = 0; i < m_entries.size(); ++i ) {
+        if ( m_entries[ i ].type != type )
+            m_entries[ j++ ] = m_entries[ i ];
+    }
+    m_entries.resize( j );
+}
+
+void NameIndex::purge() {
+    if ( m_removed.isEmpty() )
+        return;
+
+    int j = 0;
+    for ( int i = 0; i < m_entries.size(); ++i ) {
+        if ( ! m_removed.contains( m_entries[ i ].obj ) )
+            m_entries[ j++ ] = m_entries[ i ];
+    }
+    m_entries.resize( j );
+    m_removed.clear();
+}
+
+void NameIndex::update() {
+    purge();
+    if ( ! m_sorted ) {
+        qSort( m_entries.begin(), m_entries.end() );
+        m_sorted = true;
+    }
+}
+
+int NameIndex::lowerBound( const QString &key ) const {
+    int lo = 0, hi = m_entries.size();
+    while ( lo < hi ) {
+        int mid = ( lo + hi ) / 2;
+        if ( m_entries[ mid ].key < key )
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+SkyObject* NameIndex::find( const QString &name ) {
+    QString key = normalize( name );
+    if ( key.isEmpty() )
+        return 0;
+
+    update();
+
+    SkyObject *best = 0;
+    for ( int i = lowerBound( key ); i < m_entries.size(); ++i ) {
+        const Entry &e = m_entries[ i ];
+        if ( e.key != key || ! e.full )
+            break;
+        if ( QString::compare( e.name, name, Qt::CaseInsensitive ) == 0 )
+            return e.obj;
+        if ( ! best )
+            best = e.obj;
+    }
+    return best;
+}
+
+QStringList NameIndex::names( const QString &prefix, qint64 types ) {
+    update();
+
+    QString key = normalize( prefix );
+    QSet<QString> seen;
+    QStringList result;
+
+    for ( int i = lowerBound( key ); i < m_entries.size(); ++i ) {
+        const Entry &e = m_entries[ i ];
+        if ( ! e.key.startsWith( key ) )
+            break;
+        // With no prefix, the whole names are enough
+        if ( key.isEmpty() && ! e.full )
+            continue;
+        if ( ! ( ( types >> e.type ) & 1 ) || seen.contains( e.name ) )
+            continue;
+        seen.insert( e.name );
+        result.append( e.name );
+    }
+
+    result.sort();
+    return result;
+}
+
+QStringList NameIndex::fuzzy( const QString &text, int maxDistance, qint64 types, int maxResults ) {
+    QString key = normalize( text );
+    if ( key.isEmpty() )
+        return QStringList();
+
+    update();
+
+    QList< QPair<int, QString> > matches;
+    QSet<QString> seen;
+    QString first = key.left( 1 );
+
+    for ( int i = lowerBound( first ); i < m_entries.size(); ++i ) {
+        const Entry &e = m_entries[ i ];
+        if ( ! e.key.startsWith( first ) )
+            break;
+        if ( ! e.full || ! ( ( types >> e.type ) & 1 ) || seen.contains( e.name ) )
+            continue;
+        int d = editDistance( key, e.key, maxDistance );
+        if ( d <= maxDistance ) {
+            seen.insert( e.name );
+            matches.append( qMakePair( d, e.name ) );
+        }
+    }
+
+    qSort( matches );
+    QStringList result;
+    for ( int i = 0; i < matches.size() && i < maxResults; ++i )
+        result.append( matches[ i ].second );
+    return result;
+}
@@ -0,0 +1,150 @@
+/***************************************************************************
+                   nameindex.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NAMEINDEX_H
+#define NAMEINDEX_H
+
+#include <QVector>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+class SkyObject;
+
+/**
+ *@class NameIndex
+ *
+ *One index of the names of all the objects of the sky map: the names, long
+ *names and alternate names of the objects, and aliases such as HD numbers,
+ *Bayer designations or numbered asteroid names.
+ *
+ *Names are compared in a normalised form: lower case, with everything but
+ *letters and digits removed, so that "M31", "m 31" and "M 31" are the same
+ *name. The index is a sorted array of these keys, so that an exact or a
+ *prefix query is a binary search. Every word of a name is indexed too:
+ *"galaxy" lists the Andromeda Galaxy, and "halley" lists 1P/Halley.
+ *
+ *The components add names while they load, in any order. The array is
+ *sorted on the first query after a change.
+ *
+ *@short Index of object names for exact, prefix and fuzzy lookups
+ *@version 1.0
+ */
+
+class NameIndex {
+
+ public:
+
+    /** Type mask selecting all the object types */
+    static const qint64 AllTypes = -1;
+
+    /**
+     *@return the type mask selecting one object type
+     *@param type a SkyObject::TYPE
+     */
+    static inline qint64 typeMask( int type ) { return qint64( 1 ) << type; }
+
+    /**
+     *Constructor
+     */
+    NameIndex();
+
+    /**
+     *@short  Add a name of an object. Empty names are ignored.
+     */
+    void insert( const QString &name, SkyObject *obj );
+
+    /**
+     *@short  Add the name, long name and alternate name of an object
+     */
+    void insert( SkyObject *obj );
+
+    /**
+     *@short  Remove all the names of an object
+     *
+     *The object may be deleted right after; it is never dereferenced again.
+     */
+    void remove( const SkyObject *obj );
+
+    /**
+     *@short  Remove the names of all the objects of a type, e.g. before
+     *the comets are reloaded
+     */
+    void removeType( int type );
+
+    /**
+     *@return the object with this name, or 0. Among objects with the same
+     *normalised name, an exact case-insensitive match is preferred, then
+     *solar system objects, deep sky objects, and stars last.
+     */
+    SkyObject* find( const QString &name );
+
+    /**
+     *@return the names which have a word starting with the prefix, sorted and
+     *without duplicates. An empty prefix returns all the names.
+     *@param prefix the start of the name or of one of its words
+     *@param types a mask of the object types to return
+     */
+    QStringList names( const QString &prefix, qint64 types = AllTypes );
+
+    /**
+     *@return the names closest to the text, which start with the same
+     *character and are at most maxDistance edits away, closest first.
+     *@param text the misspelt name
+     *@param maxDistance the largest edit distance accepted
+     *@param types a mask of the object types to return
+     *@param maxResults the largest number of names returned
+     */
+    QStringList fuzzy( const QString &text, int maxDistance = 2,
+                       qint64 types = AllTypes, int maxResults = 20 );
+
+    /** @return the number of keys in the index */
+    int size() const { return m_entries.size(); }
+
+    /**
+     *@return the normalised form of a name: lower case letters and digits
+     */
+    static QString normalize( const QString &name );
+
+ private:
+
+    struct Entry {
+        QString key;            // Normalised name, or the end of it from a word start
+        QString name;           // The name as displayed
+        SkyObject *obj;
+        quint8 type;
+        quint8 rank;            // Order of preference of the objects with the same name
+        bool full;              // key is the whole name, not the end of it
+
+        bool operator<( const Entry &e ) const;
+    };
+
+    /** @short Sort the array and drop the removed objects, if needed */
+    void update();
+
+    /** @short Drop the entries of the removed objects now */
+    void purge();
+
+    /** @return the first entry whose key is not less than key */
+    int lowerBound( const QString &key ) const;
+
+    QVector<Entry> m_entries;
+    QSet<const SkyObject*> m_removed;
+    bool m_sorted;
+};
+
+#endif
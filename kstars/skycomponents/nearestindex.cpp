@@ -0,0 +1,344 @@
+/***************************************************************************
+                  nearestindex.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "nearestindex.h"
+
+#include <cmath>
+#include <float.h>
+
+#include "kstarsdata.h"
+#include "ksnumbers.h"
+#include "skycomposite.h"
+#include "skyobjects/skyobject.h"
+#include "skyobjects/starobject.h"
+#include "skyobjects/deepskyobject.h"
+
+namespace {
+    // Cells along each axis of the grids
+    const int fixedResolution  = 64;
+    const int movingResolution = 32;
+
+    // The J2000 position of a fixed object and its current position differ
+    // by nutation and aberration, less than this, in degrees
+    const double fixedSlack = 0.02;
+
+    inline bool isMoving( int type ) {
+        return type == SkyObject::PLANET || type == SkyObject::MOON ||
+               type == SkyObject::ASTEROID || type == SkyObject::COMET;
+    }
+
+    inline void toXYZ( double ra, double dec, double &x, double &y, double &z ) {
+        double sinRa, cosRa, sinDec, cosDec;
+        sinRa = sin( ra );  cosRa = cos( ra );
+        sinDec = sin( dec ); cosDec = cos( dec );
+        x = cosDec * cosRa;
+        y = cosDec * sinRa;
+        z = sinDec;
+    }
+
+    inline int cellOf( float v, int resolution ) {
+        int i = int( ( v + 1.0 ) * 0.5 * resolution );
+        return i < 0 ? 0 : ( i >= resolution ? resolution - 1 : i );
+    }
+
+    // The angle subtended by a chord of the unit sphere, in degrees
+    inline double chordToDegrees( double chord ) {
+        return chord >= 2.0 ? 180.0 : 2.0 * asin( 0.5 * chord ) / dms::DegToRad;
+    }
+
+    inline double degreesToChord( double degrees ) {
+        return degrees >= 180.0 ? 2.0 : 2.0 * sin( 0.5 * degrees * dms::DegToRad );
+    }
+}
+
+struct NearestIndex::Query {
+    const SkyPoint *point;
+    double maxrad;
+    int k;
+    qint64 types;
+    QVector<bool> enabled;              // Of each source
+    QList<Hit> hits;
+
+    // The score an object must beat to be kept
+    inline double bound() const { return hits.size() < k ? maxrad : hits.last().score; }
+
+    void add( SkyObject *obj, double distance, double score ) {
+        if ( score >= bound() )
+            return;
+        int i = hits.size();
+        while ( i > 0 && hits[ i - 1 ].score > score )
+            --i;
+        Hit h;
+        h.obj = obj;
+        h.distance = distance;
+        h.score = score;
+        hits.insert( i, h );
+        if ( hits.size() > k )
+            hits.removeLast();
+    }
+};
+
+NearestIndex::NearestIndex() :
+    m_fixed( fixedResolution ), m_moving( movingResolution ), m_maxProperMotion( 0.0 )
+{}
+
+float NearestIndex::weight( const SkyObject *obj ) {
+    int type = obj->type();
+    if ( type == SkyObject::STAR || type == SkyObject::CATALOG_STAR )
+        return obj->mag() < 4.0 ? 0.75 : 1.0;
+    if ( isMoving( type ) )
+        return 0.25;
+
+    const DeepSkyObject *dso = dynamic_cast<const DeepSkyObject*>( obj );
+    if ( ! dso )
+        return 1.0;
+    if ( dso->isCatalogM() )
+        return 0.5;
+    if ( dso->isCatalogNGC() )
+        return 0.6;
+    if ( dso->isCatalogIC() )
+        return 0.8;
+    return 0.6;
+}
+
+int NearestIndex::sourceIndex( SkyComponent *source ) {
+    QHash<SkyComponent*, int>::const_iterator it = m_sourceIndex.constFind( source );
+    if ( it != m_sourceIndex.constEnd() )
+        return it.value();
+
+    int index = m_sources.size();
+    m_sources.append( source );
+    m_magLimits.append( FLT_MAX );
+    m_sourceIndex.insert( source, index );
+    return index;
+}
+
+void NearestIndex::insert( SkyObject *obj, SkyComponent *source, float weight ) {
+    if ( ! obj )
+        return;
+
+    // The address of a removed object may come back with a new object
+    if ( m_removed.contains( obj ) )
+        purge();
+
+    Entry e;
+    e.obj    = obj;
+    e.type   = obj->type();
+    e.mag    = obj->mag();
+    e.weight = weight < 0.0 ? NearestIndex::weight( obj ) : weight;
+    e.source = sourceIndex( source );
+
+    // The moving bodies are placed again each time their grid is sorted
+    bool moving = isMoving( e.type );
+    double x, y, z;
+    if ( moving )
+        toXYZ( obj->ra().radians(), obj->dec().radians(), x, y, z );
+    else
+        toXYZ( obj->ra0().radians(), obj->dec0().radians(), x, y, z );
+    e.x = x;  e.y = y;  e.z = z;
+
+    Grid &grid = moving ? m_moving : m_fixed;
+    if ( ! moving ) {
+        // Stars drift away from their J2000 position by their proper motion
+        if ( e.type == SkyObject::STAR || e.type == SkyObject::CATALOG_STAR ) {
+            StarObject *star = dynamic_cast<StarObject*>( obj );
+            if ( star )
+                m_maxProperMotion = qMax( m_maxProperMotion, star->pmMagnitude() );
+        }
+    }
+
+    if ( grid.entries.isEmpty() || e.weight < grid.minWeight )
+        grid.minWeight = e.weight;
+    grid.entries.append( e );
+    grid.sorted = false;
+}
+
+void NearestIndex::remove( const SkyObject *obj ) {
+    if ( obj )
+        m_removed.insert( obj );
+}
+
+void NearestIndex::setMagLimit( SkyComponent *source, float mag ) {
+    m_magLimits[ sourceIndex( source ) ] = mag;
+}
+
+void NearestIndex::purge() {
+    Grid *grids[] = { &m_fixed, &m_moving };
+    for ( int g = 0; g < 2; ++g ) {
+        QVector<Entry> &entries = grids[ g ]->entries;
+        int kept = 0;
+        for ( int i = 0; i < entries.size(); ++i ) {
+            if ( ! m_removed.contains( entries[ i ].obj ) )
+                entries[ kept++ ] = entries[ i ];
+        }
+        if ( kept != entries.size() ) {
+            entries.resize( kept );
+            grids[ g ]->sorted = false;
+        }
+    }
+    m_removed.clear();
+}
+
+void NearestIndex::sort( Grid &grid, bool moving ) {
+    const int res = grid.resolution;
+    QVector<Entry> &entries = grid.entries;
+
+    // The moving bodies are indexed where they are now, with their magnitude now
+    if ( moving ) {
+        for ( int i = 0; i < entries.size(); ++i ) {
+            Entry &e = entries[ i ];
+            double x, y, z;
+            toXYZ( e.obj->ra().radians(), e.obj->dec().radians(), x, y, z );
+            e.x = x;  e.y = y;  e.z = z;
+            e.mag = e.obj->mag();
+        }
+    }
+
+    // Counting sort by cell
+    QVector<int> cells( entries.size() );
+    grid.cellStart.fill( 0, res * res * res + 1 );
+    grid.minWeight = 1.0;
+    for ( int i = 0; i < entries.size(); ++i ) {
+        const Entry &e = entries[ i ];
+        cells[ i ] = ( cellOf( e.x, res ) * res + cellOf( e.y, res ) ) * res + cellOf( e.z, res );
+        ++grid.cellStart[ cells[ i ] + 1 ];
+        grid.minWeight = qMin( grid.minWeight, e.weight );
+    }
+    for ( int c = 0; c < res * res * res; ++c )
+        grid.cellStart[ c + 1 ] += grid.cellStart[ c ];
+
+    QVector<int> next( grid.cellStart );
+    QVector<Entry> sorted( entries.size() );
+    for ( int i = 0; i < entries.size(); ++i )
+        sorted[ next[ cells[ i ] ]++ ] = entries[ i ];
+    entries.swap( sorted );
+
+    grid.sorted = true;
+}
+
+void NearestIndex::update() {
+    if ( ! m_removed.isEmpty() )
+        purge();
+    if ( ! m_fixed.sorted )
+        sort( m_fixed, false );
+    if ( ! m_moving.sorted )
+        sort( m_moving, true );
+}
+
+bool NearestIndex::isSelected( SkyComponent *source ) {
+    for ( SkyComponent *c = source; c; c = c->parent() ) {
+        if ( ! c->selected() )
+            return false;
+    }
+    return true;
+}
+
+void NearestIndex::search( const Grid &grid, double x, double y, double z, double slack, Query &query ) const {
+    if ( grid.entries.isEmpty() )
+        return;
+
+    const int res = grid.resolution;
+    const double cellSize = 2.0 / res;
+    const double maxChord = degreesToChord( query.maxrad + slack );
+    const double maxChord2 = maxChord * maxChord;
+    const int ci = cellOf( x, res ), cj = cellOf( y, res ), ck = cellOf( z, res );
+
+    for ( int s = 0; s < res; ++s ) {
+        // Every cell of shell s is at least (s - 1) cells away from the point
+        if ( s > 1 ) {
+            double nearest = ( s - 1 ) * cellSize;
+            if ( nearest > maxChord )
+                break;
+            if ( grid.minWeight * ( chordToDegrees( nearest ) - slack ) >= query.bound() )
+                break;
+        }
+
+        for ( int i = ci - s; i <= ci + s; ++i ) {
+            if ( i < 0 || i >= res )
+                continue;
+            for ( int j = cj - s; j <= cj + s; ++j ) {
+                if ( j < 0 || j >= res )
+                    continue;
+                // Inside the shell, only its two faces along z
+                bool face = qAbs( i - ci ) == s || qAbs( j - cj ) == s;
+                int kStep = ( face || s == 0 ) ? 1 : 2 * s;
+                for ( int k = ck - s; k <= ck + s; k += kStep ) {
+                    if ( k < 0 || k >= res )
+                        continue;
+                    int cell = ( i * res + j ) * res + k;
+                    int end = grid.cellStart[ cell + 1 ];
+                    for ( int n = grid.cellStart[ cell ]; n < end; ++n ) {
+                        const Entry &e = grid.entries[ n ];
+                        if ( ! ( query.types & typeMask( e.type ) ) || ! query.enabled[ e.source ] ||
+                             e.mag > m_magLimits[ e.source ] )
+                            continue;
+
+                        double dx = e.x - x, dy = e.y - y, dz = e.z - z;
+                        if ( dx * dx + dy * dy + dz * dz > maxChord2 )
+                            continue;
+
+                        // The index position is only approximate: use the current one
+                        double r = e.obj->angularDistanceTo( query.point ).Degrees();
+                        if ( r < query.maxrad )
+                            query.add( e.obj, r, r * e.weight );
+                    }
+                }
+            }
+        }
+    }
+}
+
+QList<NearestIndex::Hit> NearestIndex::nearest( const SkyPoint *p, double maxrad, int k, qint64 types ) {
+    QList<Hit> none;
+    if ( k < 1 || maxrad <= 0.0 )
+        return none;
+
+    update();
+
+    Query query;
+    query.point  = p;
+    query.maxrad = qMin( maxrad, 180.0 );
+    query.k      = k;
+    query.types  = types;
+    query.enabled.resize( m_sources.size() );
+    for ( int i = 0; i < m_sources.size(); ++i )
+        query.enabled[ i ] = isSelected( m_sources[ i ] );
+
+    double x, y, z;
+    toXYZ( p->ra().radians(), p->dec().radians(), x, y, z );
+    search( m_moving, x, y, z, 0.0, query );
+
+    // The fixed objects are indexed by their J2000 position
+    KSNumbers *num = KStarsData::Instance()->updateNum();
+    SkyPoint p0( p->ra(), p->dec() );
+    p0.apparentCoord( num->julianDay(), J2000 );
+    double years = fabs( double( num->julianDay() - J2000 ) ) / 365.25;
+    double slack = fixedSlack + m_maxProperMotion * years / 3.6e6;
+
+    toXYZ( p0.ra().radians(), p0.dec().radians(), x, y, z );
+    search( m_fixed, x, y, z, slack, query );
+
+    return query.hits;
+}
+
+SkyObject* NearestIndex::nearest( const SkyPoint *p, double &maxrad, qint64 types ) {
+    QList<Hit> hits = nearest( p, maxrad, 1, types );
+    if ( hits.isEmpty() )
+        return 0;
+    maxrad = hits.first().score;
+    return hits.first().obj;
+}
@@ -0,0 +1,195 @@
+/***************************************************************************
+                  nearestindex.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef NEARESTINDEX_H
+#define NEARESTINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QVector>
+
+class SkyComponent;
+class SkyObject;
+class SkyPoint;
+
+/**
+ *@class NearestIndex
+ *
+ *One spatial index of the objects of the sky map, to find the objects
+ *nearest a point of the sky: the object under the mouse, or the k nearest
+ *objects of some types.
+ *
+ *The objects are kept as unit vectors in two sorted 3D grids. A grid splits
+ *[-1, 1]^3 into cubic cells; the objects of a cell are contiguous, and a
+ *table holds the first object of each cell. The fixed objects (stars, deep sky
+ *objects, custom catalogs) are indexed by their J2000 position, once. The
+ *solar system bodies are indexed by their current position; their grid is
+ *sorted again on the first query after they have moved.
+ *
+ *A query visits the cells in shells of growing distance around the cell of
+ *the point, and stops as soon as no object of the next shell can beat the
+ *k-th best one, so that its cost depends on the number of objects near the
+ *point and not on the size of the catalogs.
+ *
+ *The distances are weighted, so that some objects win over closer ones: see
+ *weight(). Each object belongs to a source component; it is only found while
+ *the source and its parents are selected(), and if it is not fainter than the
+ *magnitude limit of the source.
+ *
+ *@short Index of object positions for nearest-neighbour lookups
+ *@version 1.0
+ */
+
+class NearestIndex {
+
+ public:
+
+    /** Type mask selecting all the object types */
+    static const qint64 AllTypes = -1;
+
+    /**
+     *@return the type mask selecting one object type
+     *@param type a SkyObject::TYPE
+     */
+    static inline qint64 typeMask( int type ) { return qint64( 1 ) << type; }
+
+    /**
+     *@class NearestIndex::Hit
+     *An object found by a query.
+     */
+    class Hit {
+    public:
+        SkyObject *obj;
+        double distance;        // Angular distance to the point, in degrees
+        double score;           // Weighted distance, by which the hits are sorted
+    };
+
+    /**
+     *Constructor
+     */
+    NearestIndex();
+
+    /**
+     *@short  Add an object
+     *@param obj the object. Planets, moons, asteroids and comets are moving
+     *bodies, the others are indexed by their J2000 position.
+     *@param source the component the object belongs to
+     *@param weight the factor applied to the distance of the object; if
+     *negative, the default weight of the object
+     */
+    void insert( SkyObject *obj, SkyComponent *source, float weight = -1.0 );
+
+    /**
+     *@short  Remove an object
+     *
+     *The object may be deleted right after; it is never dereferenced again.
+     */
+    void remove( const SkyObject *obj );
+
+    /**
+     *@short  Set the faintest magnitude of the objects found from a source,
+     *e.g. the magnitude limit of the stars drawn at the current zoom
+     */
+    void setMagLimit( SkyComponent *source, float mag );
+
+    /**
+     *@short  Note that the moving bodies have new positions
+     */
+    inline void invalidateMoving() { m_moving.sorted = false; }
+
+    /**
+     *@return the objects nearest a point, nearest first by weighted distance
+     *@param p the point
+     *@param maxrad the largest distance to the point, in degrees
+     *@param k the largest number of objects returned
+     *@param types a mask of the object types to return
+     */
+    QList<Hit> nearest( const SkyPoint *p, double maxrad, int k = 1, qint64 types = AllTypes );
+
+    /**
+     *@return the object nearest a point by weighted distance, or 0
+     *@param p the point
+     *@param maxrad the largest distance to the point, in degrees. The
+     *weighted distance of the object is returned through it.
+     *@param types a mask of the object types to return
+     */
+    SkyObject* nearest( const SkyPoint *p, double &maxrad, qint64 types = AllTypes );
+
+    /** @return the number of objects in the index */
+    int size() const { return m_fixed.entries.size() + m_moving.entries.size(); }
+
+    /**
+     *@return the default weight of an object: 0.75 for stars brighter than
+     *4th mag, 0.5 for Messier objects, 0.6 for NGC and other deep sky
+     *objects, 0.8 for IC objects, 0.25 for solar system bodies, and 1.0
+     *for the rest
+     */
+    static float weight( const SkyObject *obj );
+
+ private:
+
+    struct Entry {
+        float x, y, z;          // Unit vector
+        float weight;
+        float mag;
+        SkyObject *obj;
+        quint16 source;         // Index in m_sources
+        quint8 type;
+    };
+
+    struct Grid {
+        Grid( int res ) : resolution( res ), minWeight( 1.0 ), sorted( true ) {}
+
+        int resolution;         // Cells along each axis
+        QVector<Entry> entries; // Sorted by cell
+        QVector<int> cellStart; // First entry of each cell, and the number of entries last
+        float minWeight;
+        bool sorted;
+    };
+
+    /** @short Best hits of a query, sorted */
+    struct Query;
+
+    /** @short Drop the removed objects and sort the grids, if needed */
+    void update();
+
+    /** @short Drop the entries of the removed objects now */
+    void purge();
+
+    /** @short Sort the entries of a grid by cell, and fill its table */
+    static void sort( Grid &grid, bool moving );
+
+    /** @short Visit the cells of a grid in shells around the unit vector (x, y, z) */
+    void search( const Grid &grid, double x, double y, double z, double slack, Query &query ) const;
+
+    /** @return the index of a source in m_sources, which is added if needed */
+    int sourceIndex( SkyComponent *source );
+
+    /** @return true if the source and its parents are selected */
+    static bool isSelected( SkyComponent *source );
+
+    Grid m_fixed;
+    Grid m_moving;
+    QVector<SkyComponent*> m_sources;
+    QVector<float> m_magLimits;             // Of each source
+    QHash<SkyComponent*, int> m_sourceIndex;
+    QSet<const SkyObject*> m_removed;
+    double m_maxProperMotion;               // Of the fixed stars, in mas/yr
+};
+
+#endif
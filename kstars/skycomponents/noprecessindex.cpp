@@ -31,7 +31,5 @@ void NoPrecessIndex::JITupdate( LineList* lineList )
     KStarsData *data = KStarsData::Instance();
     lineList->updateID = data->updateID();
     SkyList* points = lineList->points();
-    for (int i = 0; i < points->size(); i++ ) {
-        points->at( i )->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
-    }
+    data->updatePipeline()->updateHorizontal( points->constData(), points->size() );
 }
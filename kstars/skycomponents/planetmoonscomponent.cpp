@@ -53,8 +53,11 @@ PlanetMoonsComponent::PlanetMoonsComponent( SkyComposite *p,
     delete pmoons;
     pmoons = new JupiterMoons();
     int nmoons = pmoons->nMoons();
-    for ( int i=0; i<nmoons; ++i ) 
+    for ( int i=0; i<nmoons; ++i ) {
         objectNames(SkyObject::MOON).append( pmoons->name(i) );
+        nameIndex().insert( pmoons->moon(i) );
+        nearestIndex().insert( pmoons->moon(i), this );
+    }
 }
 
 PlanetMoonsComponent::~PlanetMoonsComponent()
@@ -20,6 +20,7 @@
 #include <QStringList>
 #include <QObject>
 #include <QProgressDialog>
+#include <QtConcurrentMap>
 
 #include <kjob.h>
 #include <kio/job.h>
@@ -35,6 +36,23 @@
 #include "skylabeler.h"
 #include "kstarsdata.h"
 
+namespace {
+    // Below this number of satellites, the cost of dispatching the
+    // propagation to the thread pool is higher than the propagation itself
+    const int MIN_PARALLEL_SATELLITES = 64;
+
+    // Propagates satellites to the instant of an environment
+    struct SatellitePropagator {
+        typedef void result_type;
+
+        explicit SatellitePropagator( const Satellite::Environment &e ) : env( e ) {}
+
+        void operator()( Satellite *sat ) const { sat->updatePos( env ); }
+
+        Satellite::Environment env;
+    };
+}
+
 SatellitesComponent::SatellitesComponent( SkyComposite *parent ) :
     SkyComponent( parent )
 {
@@ -71,8 +89,25 @@ void SatellitesComponent::update( KSNumbers * )
     if( ! selected() )
         return;
     
+    // Take the time and location once for all the satellites
+    SatellitePropagator propagate( Satellite::currentEnvironment() );
+
+    m_propagated.clear();
     foreach( SatelliteGroup *group, m_groups ) {
-        group->updateSatellitesPos();
+        for ( int i=0; i<group->size(); i++ ) {
+            Satellite *sat = group->at( i );
+            if ( sat->selected() )
+                m_propagated.append( sat );
+        }
+    }
+
+    // Each satellite only writes its own position, and the draw pass only
+    // starts once they are all done.
+    if ( m_propagated.size() < MIN_PARALLEL_SATELLITES ) {
+        foreach( Satellite *sat, m_propagated )
+            propagate( sat );
+    } else {
+        QtConcurrent::blockingMap( m_propagated, propagate );
     }
 }
 
@@ -140,6 +175,14 @@ QList<SatelliteGroup*> SatellitesComponent::groups()
     return m_groups;
 }
 
+QList<Satellite*> SatellitesComponent::satellites()
+{
+    QList<Satellite*> list;
+    foreach ( SatelliteGroup *group, m_groups )
+        list += *group;
+    return list;
+}
+
 Satellite* SatellitesComponent::findSatellite( QString name )
 {
     foreach ( SatelliteGroup *group, m_groups ) {
@@ -19,6 +19,7 @@
 #define SATELLITESCOMPONENT_H
 
 #include <QList>
+#include <QVector>
 
 #include <kio/job.h>
 
@@ -74,6 +75,11 @@ public:
      */
     QList<SatelliteGroup*> groups();
 
+    /**
+     *@return The list of the satellites of all groups
+     */
+    QList<Satellite*> satellites();
+
     /**
      *Search a satellite by name.
      *@param name The name of the satellite
@@ -100,6 +106,7 @@ protected:
 
 private:
     QList<SatelliteGroup*> m_groups;    // List of all groups
+    QVector<Satellite*> m_propagated;   // Selected satellites, propagated by update()
     KIO::Job *m_downloadJob;
 };
 
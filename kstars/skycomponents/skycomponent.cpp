@@ -23,6 +23,8 @@
 #include "Options.h"
 #include "ksnumbers.h"
 #include "skyobjects/skyobject.h"
+#include "nameindex.h"
+#include "nearestindex.h"
 
 SkyComponent::SkyComponent( SkyComposite *parent ) :
     m_parent( parent )
@@ -55,6 +57,14 @@ QHash<int, QStringList>& SkyComponent::getObjectNames() {
     return parent()->objectNames();
 }
 
+NameIndex& SkyComponent::getNameIndex() {
+    return parent()->nameIndex();
+}
+
+NearestIndex& SkyComponent::getNearestIndex() {
+    return parent()->nearestIndex();
+}
+
 void SkyComponent::removeFromNames(const SkyObject* obj) {
     QStringList& names = getObjectNames()[obj->type()];
     int i;
@@ -65,4 +75,7 @@ void SkyComponent::removeFromNames(const SkyObject* obj) {
     i = names.indexOf( obj->longname() );
     if ( i >= 0 )
         names.removeAt( i );
+
+    nameIndex().remove( obj );
+    nearestIndex().remove( obj );
 }
@@ -29,6 +29,8 @@ class SkyObject;
 class SkyPoint;
 class SkyComposite;
 class SkyPainter;
+class NameIndex;
+class NearestIndex;
 
 /**
  * @class SkyComponent
@@ -128,13 +130,26 @@ public:
 
     inline QStringList& objectNames(int type) { return getObjectNames()[type]; }
 
+    /** @return the index of the names of all the objects, shared by the whole sky map */
+    inline NameIndex& nameIndex() { return getNameIndex(); }
+
+    /** @return the index of the positions of the objects, shared by the whole sky map */
+    inline NearestIndex& nearestIndex() { return getNearestIndex(); }
+
 protected:
+    /** Remove an object from the lists of names and from the indexes of the sky map */
     void removeFromNames(const SkyObject* obj);
 
 private:
     /** */
     virtual QHash<int, QStringList>& getObjectNames();
 
+    /** */
+    virtual NameIndex& getNameIndex();
+
+    /** */
+    virtual NearestIndex& getNearestIndex();
+
     // Disallow copying and assignement
     SkyComponent(const SkyComponent&);
     SkyComponent& operator= (const SkyComponent&);
@@ -21,24 +21,18 @@
 
 #include <QPainter>
 #include <QPixmap>
+#include <QtAlgorithms>
 
 #include "Options.h"
 #include "kstarsdata.h"   // MINZOOM
 #include "skymap.h"
 #include "projections/projector.h"
 
-//---------------------------------------------------------------------------//
-// A Little data container class
-//---------------------------------------------------------------------------//
-
-typedef struct LabelRun
+// Labels of the brightest objects get placed first
+static bool brighterLabel( const SkyLabel& a, const SkyLabel& b )
 {
-    LabelRun(int s, int e) : start(s), end(e) {}
-    int start;
-    int end;
-
-} LabelRun;
-
+    return a.obj->mag() < b.obj->mag();
+}
 
 //----- Now for the main event ----------------------------------------------//
 
@@ -77,30 +71,25 @@ double SkyLabeler::ZoomOffset()
 //----- Constructor ---------------------------------------------------------//
 
 SkyLabeler::SkyLabeler() :
+        m_maxX(0),
         m_maxY(0),
         m_size(0),
         m_fontMetrics( QFont() ),
         m_picture(-1),
+        m_staticActive( false ),
+        m_pictureHeight( 0 ),
         labelList( NUM_LABEL_TYPES ),
         m_proj(0)
 {
     m_errors = 0;
-    m_minDeltaX = 30;    // when to merge two adjacent regions
     m_yDensity  = 1.0;   // controls vertical resolution
 
-    m_marks = m_hits = m_misses = m_elements = 0;
+    m_marks = m_hits = m_misses = 0;
 }
 
 
 SkyLabeler::~SkyLabeler()
 {
-    for (int y = 0; y < screenRows.size(); y++ ) {
-        LabelRow* row = screenRows[y];
-        for ( int i = 0; i < row->size(); i++) {
-            delete row->at(i);
-        }
-        delete row;
-    }
 }
 
 bool SkyLabeler::drawGuideLabel( QPointF& o, const QString& text, double angle )
@@ -213,20 +202,16 @@ void SkyLabeler::reset( SkyMap* skyMap )
     // ----- Set up Projector ---
     m_proj = skyMap->projector();
     // ----- Set up Painter -----
-    if( m_p.isActive() )
-        m_p.end();
-    m_picture = QPicture();
-    m_p.begin(&m_picture);
-    //This works around BUG 10496 in Qt
-    m_p.drawPoint( 0, 0 );
-    m_p.drawPoint( skyMap->width() + 1, skyMap->height() + 1);
+    m_staticActive = false;
+    m_maxX = skyMap->width();
+    m_pictureHeight = skyMap->height();
+    beginPicture();
     // ----- Set up Zoom Dependent Font -----
 
     m_stdFont = QFont( m_p.font() );
     setZoomFont();
     m_skyFont = m_p.font();
     m_fontMetrics = QFontMetrics( m_skyFont );
-    m_minDeltaX = (int) m_fontMetrics.width("MMMMM");
 
     // ----- Set up Zoom Dependent Offset -----
     m_offset = SkyLabeler::ZoomOffset();
@@ -237,35 +222,15 @@ void SkyLabeler::reset( SkyMap* skyMap )
     int maxY = int( skyMap->height() / m_yScale );
     if ( maxY < 1 ) maxY = 1;                         // prevents a crash below?
 
-    int m_maxX = skyMap->width();
+    m_maxY = maxY;
     m_size = (maxY + 1) * m_maxX;
 
-    // Resize if needed:
-    if ( maxY > m_maxY ) {
-        screenRows.resize( m_maxY );
-        for ( int y = m_maxY; y <= maxY; y++) {
-            screenRows.append( new LabelRow() );
-        }
-        //printf("resize: %d -> %d, size:%d\n", m_maxY, maxY, screenRows.size());
-    }
-
-    // Clear all pre-existing rows as needed
-
-    int minMaxY = (maxY < m_maxY) ? maxY : m_maxY;
-
-    for (int y = 0; y <= minMaxY; y++) {
-        LabelRow* row = screenRows[y];
-        for ( int i = 0; i < row->size(); i++) {
-            delete row->at(i);
-        }
-        row->clear();
-    }
-
-    // never decrease m_maxY:
-    if ( m_maxY < maxY ) m_maxY = maxY;
+    // The mask keeps its memory from one frame to the next. Labels are
+    // kept at least "MMMMM" apart on a strip.
+    m_mask.reset( m_maxX, maxY + 1, m_fontMetrics.width( "MMMMM" ) );
 
     // reset the counters
-    m_marks = m_hits = m_misses = m_elements = 0;
+    m_marks = m_hits = m_misses = 0;
 
     //----- Clear out labelList -----
     for (int i = 0; i < labelList.size(); i++) {
@@ -273,6 +238,42 @@ void SkyLabeler::reset( SkyMap* skyMap )
     }
 }
 
+void SkyLabeler::beginPicture()
+{
+    if( m_p.isActive() )
+        m_p.end();
+    m_picture = QPicture();
+    m_p.begin(&m_picture);
+    //This works around BUG 10496 in Qt
+    m_p.drawPoint( 0, 0 );
+    m_p.drawPoint( m_maxX + 1, m_pictureHeight + 1);
+}
+
+void SkyLabeler::saveStaticLabels()
+{
+    // The labels drawn so far go to their own picture, and the painter
+    // starts over on a new one with the same font and pen
+    m_staticFont = m_p.font();
+    m_staticPen = m_p.pen();
+
+    m_p.end();
+    m_staticPicture = m_picture;
+    m_staticMask = m_mask;
+
+    beginPicture();
+    m_p.setFont( m_staticFont );
+    m_p.setPen( m_staticPen );
+    m_staticActive = true;
+}
+
+void SkyLabeler::restoreStaticLabels()
+{
+    m_mask = m_staticMask;
+    setFont( m_staticFont );
+    m_p.setPen( m_staticPen );
+    m_staticActive = true;
+}
+
 void SkyLabeler::draw(QPainter& p)
 {
     //FIXME: need a better soln. Apparently starting a painter
@@ -280,16 +281,14 @@ void SkyLabeler::draw(QPainter& p)
     // But it's not like that's something that should be in the docs, right?
     // No, that's definitely better to leave to people to figure out on their own.
     if( m_p.isActive() ) { m_p.end(); }
+
+    if ( m_staticActive )
+        m_staticPicture.play(&p);
     m_picture.play(&p); //can't replay while it's being painted on
                         //this is also undocumented btw.
     //m_p.begin(&m_picture);
 }
 
-// We use Run Length Encoding to hold the information instead of an array of
-// chars.  This is both faster and smaller but the code is more complicated.
-//
-// This code is easy to break and hard to fix.
-
 bool SkyLabeler::markText( const QPointF& p, const QString& text )
 {
 
@@ -344,99 +343,22 @@ bool SkyLabeler::markRegion( qreal left, qreal right, qreal top, qreal bot )
         minY = temp;
     }
 
-    // check to see if we overlap any existing label
-    // We must check all rows before we start marking
-    for (int y = minY; y <= maxY; y++ ) {
-        LabelRow* row = screenRows[ y ];
-        int i;
-        for ( i = 0; i < row->size(); i++) {
-            if ( row->at( i )->end < minX ) continue;  // skip past these
-            if ( row->at( i )->start > maxX ) break;
-            m_misses++;
-            return false;
-        }
+    LabelMask::Region region;
+    region.minX = minX;
+    region.maxX = maxX;
+    region.minY = minY;
+    region.maxY = maxY;
+
+    // check to see if we overlap any existing label, and mark the region
+    // if we don't
+    if ( ! m_mask.mark( region ) ) {
+        m_misses++;
+        return false;
     }
 
     m_hits++;
     m_marks += (maxX - minX + 1) * (maxY - minY + 1);
 
-    // Okay, there was no overlap so let's insert the current rectangle into
-    // screenRows.
-
-    for ( int y = minY; y <= maxY; y++ ) {
-        LabelRow* row = screenRows[ y ];
-
-        // Simplest case: an empty row
-        if ( row->size() < 1 ) {
-            row->append( new LabelRun( minX, maxX ) );
-            m_elements++;
-            continue;
-        }
-
-        // Find out our place in the universe (or row).
-        // H'mm.  Maybe we could cache these numbers above.
-        int i;
-        for ( i = 0; i < row->size(); i++ ) {
-            if ( row->at(i)->end >= minX ) break;
-        }
-
-        // i now points to first label PAST ours
-
-        // if we are first, append or merge at start of list
-        if ( i == 0 ) {
-            if ( row->at(0)->start - maxX < m_minDeltaX ) {
-                row->at(0)->start = minX;
-            }
-            else {
-                row->insert( 0, new LabelRun(minX, maxX) );
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we are past the last label, merge or append at end
-        else if ( i == row->size() ) {
-            if ( minX - row->at(i-1)->end < m_minDeltaX ) {
-                row->at(i-1)->end = maxX;
-            }
-            else {
-                row->append( new LabelRun(minX, maxX) );
-                m_elements++;
-            }
-            continue;
-        }
-
-        // if we got here, we must insert or merge the new label
-        //  between [i-1] and [i]
-
-        bool mergeHead = ( minX - row->at(i-1)->end < m_minDeltaX );
-        bool mergeTail = ( row->at(i)->start - maxX < m_minDeltaX );
-
-        // double merge => combine all 3 into one
-        if ( mergeHead && mergeTail ) {
-            row->at(i-1)->end = row->at(i)->end;
-            delete row->at( i );
-            row->removeAt( i );
-            m_elements--;
-        }
-
-        // Merge label with [i-1]
-        else if ( mergeHead ) {
-            row->at(i-1)->end = maxX;
-        }
-
-        // Merge label with [i]
-        else if ( mergeTail ) {
-            row->at(i)->start = minX;
-        }
-
-        // insert between the two
-        else {
-            row->insert( i, new LabelRun( minX, maxX) );
-            m_elements++;
-        }
-    }
-
     return true;
 }
 
@@ -482,7 +404,8 @@ void SkyLabeler::drawQueuedLabels()
 
 void SkyLabeler::drawQueuedLabelsType( SkyLabeler::label_t type )
 {
-    LabelList list = labelList[ type ];
+    LabelList& list = labelList[ type ];
+    qStableSort( list.begin(), list.end(), brighterLabel );
     for ( int i = 0; i < list.size(); i ++ ) {
         drawNameLabel( list.at(i).obj, list.at(i).o );
     }
@@ -534,8 +457,8 @@ void SkyLabeler::printInfo()
     printf("  hits=%d  misses=%d  ratio=%.1f%%\n", m_hits, m_misses, hitRatio());
     printf("  yScale=%.1f yDensity=%.1f maxY=%d\n", m_yScale, m_yDensity, m_maxY );
 
-    printf("  screenRows=%d elements=%d virtualSize=%.1f Kbytes\n",
-           screenRows.size(), m_elements, float(m_size) / 1024.0 );
+    printf("  mask: %d cells marked, %.1f Kbytes\n",
+           m_mask.markedCells(), float( m_mask.byteSize() ) / 1024.0 );
 
     return;
 
@@ -553,25 +476,6 @@ void SkyLabeler::printInfo()
     for ( int i = 0; i < NUM_LABEL_TYPES; i++ ) {
         printf("  %20ss: %d\n", labelName[ i ], labelList[ i ].size() );
     }
-
-    // Check for errors in the data structure
-    for (int y = 0; y <= m_maxY; y++) {
-        LabelRow* row = screenRows[y];
-        int size = row->size();
-        if ( size < 2 ) continue;
-
-        bool error = false;
-        for (int i = 1; i < size; i++) {
-            if ( row->at(i-1)->end > row->at(i)->start ) error = true;
-        }
-        if ( ! error ) continue;
-
-        printf("ERROR: %3d: ", y );
-        for (int i=0; i < row->size(); i++) {
-            printf("(%d, %d) ", row->at(i)->start, row->at(i)->end );
-        }
-        printf("\n");
-    }
 }
 
 void SkyLabeler::incDensity()
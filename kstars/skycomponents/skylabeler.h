@@ -26,15 +26,12 @@
 #include <QFont>
 
 #include "skylabel.h"
+#include "labelmask.h"
 
 class QString;
 class QPointF;
 class SkyMap;
 class Projector;
-struct LabelRun;
-
-typedef QList<LabelRun*>	LabelRow;
-typedef QVector<LabelRow*>  ScreenRows;
 
 
 /**
@@ -49,21 +46,14 @@ typedef QVector<LabelRow*>  ScreenRows;
  * and return true.
  *
  * Since we need to check for overlap for every label every time it is
- * potentially drawn on the screen, efficiency is essential.  So instead of
- * having a 2-dimensional array of boolean values we use Run Length Encoding
- * and store the virtual array in a QVector of QLists.  Each element of the
- * vector, a LabelRow, corresponds to a horizontal strip of pixels on the actual
- * screen.  How many vertical pixels are in each strip is controlled by
- * m_yDensity.  The higher the density, the fewer vertical pixels per strip and
- * hence a larger number of strips are needed to cover the screen.  As
- * m_yDensity increases so does the density of the strips.
- *
- * The information in the X-dimension is completed run length encoded. A
- * consecutive run of pixels in one strip that are covered by one or more labels
- * is stored in a LabelRun object that merely stores the start pixel and the end
- * pixel.  A LabelRow is a list of LabelRun's stored in ascending order.  This
- * saves a lot of space over an explicit array and it also makes checking for
- * overlaps faster and even makes inserting new overlaps faster on average.
+ * potentially drawn on the screen, efficiency is essential.  The virtual
+ * screen is a LabelMask: an occupancy bitmap with one bit per cell, where a
+ * cell is LabelMask::CELL_WIDTH pixels wide and one horizontal strip high.
+ * How many vertical pixels are in each strip is controlled by m_yDensity.
+ * The higher the density, the fewer vertical pixels per strip and hence a
+ * larger number of strips are needed to cover the screen.  Testing and
+ * marking a label takes a few word operations per strip, however many
+ * labels are already on the screen, and nothing is allocated per label.
  *
  * Synopsis:
  *
@@ -90,7 +80,8 @@ typedef QVector<LabelRow*>  ScreenRows;
  * Each type of label has its own buffer which lets us control the font and
  * color as well as the priority.  The priority is now manually set in the
  * draw() routine by adjusting the order in which the various buffers get
- * drawn.
+ * drawn.  Within a buffer, the labels of the brightest objects are placed
+ * first, like the magnitude sorted labels of the stars and deep sky objects.
  *
  * Finally, even though this code was written to be very efficient, we might
  * want to take some care in how many labels we throw at it.  Sending it
@@ -172,6 +163,20 @@ public:
      */
     void draw(QPainter& p);
 
+    /**
+     * @short keep the labels drawn since reset(), and the regions they
+     * marked, as the labels of the static layers of the sky map. They are
+     * drawn by draw() until the next reset().
+     */
+    void saveStaticLabels();
+
+    /**
+     * @short after a reset(), bring back the labels kept by the last
+     * saveStaticLabels(), when the static layers are not drawn again, with
+     * the font and pen they left. The sky map must not have moved since.
+     */
+    void restoreStaticLabels();
+
     //----- Font Setting -----//
 
     /**
@@ -265,7 +270,8 @@ public:
 
     /**
      * @short a convenience routine that draws all the labels from a single
-     * buffer.  Currently this is only called from within draw() above.
+     * buffer, brightest objects first.  Currently this is only called from
+     * within draw() above.
      */
     void drawQueuedLabelsType( SkyLabeler::label_t type );
 
@@ -332,17 +338,21 @@ public:
     int marks() { return m_marks; }
 
 private:
-    ScreenRows screenRows;
+    /**
+     * @short start the painter on a new, empty picture
+     */
+    void beginPicture();
+
+    LabelMask m_mask;
+    LabelMask m_staticMask;     // Regions of the labels of the static layers
 
     int m_maxX;
     int m_maxY;
     int m_size;
-    int m_minDeltaX;
 
     int m_marks;
     int m_hits;
     int m_misses;
-    int m_elements;
     int m_errors;
 
     qreal  m_yDensity;
@@ -354,6 +364,11 @@ private:
 
     QPainter m_p;
     QPicture m_picture;
+    QPicture m_staticPicture;   // Labels of the static layers
+    QFont    m_staticFont;      // Font and pen left by the static layers
+    QPen     m_staticPen;
+    bool     m_staticActive;
+    int      m_pictureHeight;
 
     QVector<LabelList>   labelList;
 
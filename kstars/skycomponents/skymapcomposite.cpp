@@ -23,6 +23,7 @@
 #include "Options.h"
 #include "kstarsdata.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "skyobjects/starobject.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/ksplanet.h"
@@ -54,7 +55,7 @@
 #include "typedef.h"
 
 SkyMapComposite::SkyMapComposite(SkyComposite *parent ) :
-        SkyComposite(parent), m_reindexNum( J2000 )
+        SkyComposite(parent), m_reindexNum( J2000 ), m_staticGeneration( 0 ), m_staticPending( false )
 {
     m_skyLabeler = SkyLabeler::Instance();
 
@@ -140,16 +141,20 @@ void SkyMapComposite::update(KSNumbers *num )
     m_Satellites->update( num );
     //14. Horizon
     m_Horizon->update( num );
+
+    m_NearestIndex.invalidateMoving();
 }
 
 void SkyMapComposite::updatePlanets(KSNumbers *num )
 {
     m_SolarSystem->updatePlanets( num );
+    m_NearestIndex.invalidateMoving();
 }
 
 void SkyMapComposite::updateMoons(KSNumbers *num )
 {
     m_SolarSystem->updateMoons( num );
+    m_NearestIndex.invalidateMoving();
 }
 
 //Reimplement draw function so that we have control over the order of
@@ -160,11 +165,18 @@ void SkyMapComposite::updateMoons(KSNumbers *num )
 //should appear "behind" others should be drawn first.
 void SkyMapComposite::draw( SkyPainter *skyp )
 {
-    QTime t;
-    t.start();
+    if ( drawStatic( skyp ) )
+        drawDynamic( skyp );
+}
+
+bool SkyMapComposite::drawStatic( SkyPainter *skyp )
+{
     SkyMap *map = SkyMap::Instance();
     KStarsData *data = KStarsData::Instance();
 
+    // Each lap adds the time since the previous one to a section of the profile
+    FrameProfiler::Timer laps;
+
     // We delay one draw cycle before re-indexing
     // we MUST ensure CLines do not get re-indexed while we use DRAW_BUF
     // so we do it here.
@@ -185,7 +197,7 @@ void SkyMapComposite::draw( SkyPainter *skyp )
 
     if ( m_skyMesh->inDraw() ) {
         printf("Warning: aborting concurrent SkyMapComposite::draw()\n");
-        return;
+        return false;
     }
 
     m_skyMesh->inDraw( true );
@@ -196,6 +208,7 @@ void SkyMapComposite::draw( SkyPainter *skyp )
     if ( Options::showGrid() || Options::showCBounds() || Options::showEquator() ) {
         m_skyMesh->index( focus, radius + 1.0, NO_PRECESS_BUF );
     }
+    laps.lap( "Aperture" );
 
     // clear marks from old labels and prep fonts
     m_skyLabeler->reset( map );
@@ -205,48 +218,99 @@ void SkyMapComposite::draw( SkyPainter *skyp )
     // FIXME: REGRESSION. Labeler now know nothing about infoboxes
     // map->infoBoxes()->reserveBoxes( psky );
 
-    if( KStars::Instance() ) {
-        const QList<SkyObject*> obsList = KStars::Instance()->observingList()->sessionList();
-        if( Options::obsListText() )
-            foreach( SkyObject* obj, obsList ) {
-                SkyLabeler::AddLabel( obj, SkyLabeler::RUDE_LABEL );
-            }
-    }
-        
-
     m_MilkyWay->draw( skyp );
+    laps.lap( "Milky Way" );
 
     m_CoordinateGrid->draw( skyp );
+    laps.lap( "Coordinate grid" );
 
     // Draw constellation boundary lines only if we draw western constellations
     if ( m_Cultures->current() == "Western" )
         m_CBoundLines->draw( skyp );
+    laps.lap( "Constellation boundaries" );
 
     m_CLines->draw( skyp );
+    laps.lap( "Constellation lines" );
 
     m_Equator->draw( skyp );
+    laps.lap( "Equator" );
 
     m_Ecliptic->draw( skyp );
+    laps.lap( "Ecliptic" );
 
     m_DeepSky->draw( skyp );
+    laps.lap( "Deep sky objects" );
 
     m_CustomCatalogs->draw( skyp );
+    laps.lap( "Custom catalogs" );
 
     m_Stars->draw( skyp );
+    laps.lap( "Stars" );
+
+    // The guide labels placed so far belong to the static layers
+    m_skyLabeler->saveStaticLabels();
+
+    m_skyMesh->inDraw( false );
+
+    // -jbb uncomment these to see trixel outlines:
+    //
+    //psky.setPen(  QPen( QBrush( QColor( "yellow" ) ), 1, Qt::SolidLine ) );
+    //m_skyMesh->draw( psky, OBJ_NEAREST_BUF );
+
+    //psky.setPen( QPen( QBrush( QColor( "green" ) ), 1, Qt::SolidLine ) );
+    //m_skyMesh->draw( psky, NO_PRECESS_BUF );
+
+    ++m_staticGeneration;
+    m_staticPending = true;
+    return true;
+}
+
+void SkyMapComposite::drawDynamic( SkyPainter *skyp )
+{
+    SkyMap *map = SkyMap::Instance();
+    KStarsData *data = KStarsData::Instance();
+
+    FrameProfiler::Timer laps;
+
+    // Over static layers drawn in an earlier frame, start from the labels they placed
+    if ( ! m_staticPending ) {
+        data->syncUpdateIDs();
+        m_skyLabeler->reset( map );
+        m_skyLabeler->restoreStaticLabels();
+        m_skyLabeler->useStdFont();
+        laps.lap( "Labels: reset" );
+    }
+    m_staticPending = false;
+
+    if( KStars::Instance() ) {
+        const QList<SkyObject*> obsList = KStars::Instance()->observingList()->sessionList();
+        if( Options::obsListText() )
+            foreach( SkyObject* obj, obsList ) {
+                SkyLabeler::AddLabel( obj, SkyLabeler::RUDE_LABEL );
+            }
+    }
 
     m_SolarSystem->drawTrails( skyp );
     m_SolarSystem->draw( skyp );
+    laps.lap( "Solar system" );
     
     m_Satellites->draw( skyp );
+    laps.lap( "Satellites" );
 
     m_Horizon->draw( skyp );
+    laps.lap( "Horizon" );
 
     map->drawObjectLabels( labelObjects() );
+    laps.lap( "Labels: objects" );
 
     m_skyLabeler->drawQueuedLabels();
+    laps.lap( "Labels: queued" );
     m_CNames->draw( skyp );
+    laps.lap( "Labels: constellations" );
     m_Stars->drawLabels();
+    laps.lap( "Labels: stars" );
     m_DeepSky->drawLabels();
+    laps.lap( "Labels: deep sky objects" );
 
     m_ObservingList->pen = QPen( QColor(data->colorScheme()->colorNamed( "ObsListColor" )), 1. );
     if( KStars::Instance() && !m_ObservingList->list )
@@ -258,19 +322,9 @@ void SkyMapComposite::draw( SkyPainter *skyp )
 
     m_StarHopRouteList->pen = QPen( QColor(data->colorScheme()->colorNamed( "StarHopRouteColor" )), 1. );
     m_StarHopRouteList->draw( skyp );
-
-    m_skyMesh->inDraw( false );
-
-    //kDebug() << QString("draw took %1 ms").arg( t.elapsed() );
-
-    // -jbb uncomment these to see trixel outlines:
-    //
-    //psky.setPen(  QPen( QBrush( QColor( "yellow" ) ), 1, Qt::SolidLine ) );
-    //m_skyMesh->draw( psky, OBJ_NEAREST_BUF );
-
-    //psky.setPen( QPen( QBrush( QColor( "green" ) ), 1, Qt::SolidLine ) );
-    //m_skyMesh->draw( psky, NO_PRECESS_BUF );
+    laps.lap( "Observing list and flags" );
 }
+
 //Select nearest object to the given skypoint, but give preference
 //to certain object types.
 //we multiply each object type's smallest angular distance by the
@@ -283,6 +337,7 @@ void SkyMapComposite::draw( SkyPainter *skyp )
 // Messier object = 0.5
 // custom object = 0.5
 // Solar system = 0.25
+//The factors are given to the objects when they are added to the NearestIndex.
 SkyObject* SkyMapComposite::objectNearest( SkyPoint *p, double &maxrad ) {
     double rTry = maxrad;
     double rBest = maxrad;
@@ -290,42 +345,11 @@ SkyObject* SkyMapComposite::objectNearest( SkyPoint *p, double &maxrad ) {
     SkyObject *oBest = 0;
 
     //printf("%.1f %.1f\n", p->ra().Degrees(), p->dec().Degrees() );
-    m_skyMesh->aperture( p, maxrad + 1.0, OBJ_NEAREST_BUF);
+    oBest = m_NearestIndex.nearest( p, rBest );
 
-    oBest = m_Stars->objectNearest( p, rBest );
-    //reduce rBest by 0.75 for stars brighter than 4th mag
-    if ( oBest && oBest->mag() < 4.0 ) rBest *= 0.75;
-
-    // TODO: Add support for deep star catalogs
-
-    //m_DeepSky internally discriminates among deepsky catalogs
-    //and renormalizes rTry
-    oTry = m_DeepSky->objectNearest( p, rTry );
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    for( int i = 0; i < m_DeepStars.size(); ++i ) {
-      rTry = maxrad;
-      oTry = m_DeepStars.at( i )->objectNearest( p, rTry );
-      if( rTry < rBest ) {
-	rBest = rTry;
-	oBest = oTry;
-      }
-    }
-
-    rTry = maxrad;
-    oTry = m_CustomCatalogs->objectNearest( p, rTry );
-    rTry *= 0.5;
-    if ( rTry < rBest ) {
-        rBest = rTry;
-        oBest = oTry;
-    }
-
-    rTry = maxrad;
-    oTry = m_SolarSystem->objectNearest( p, rTry );
-    rTry *= 0.25;
+    //The stars of the deep star catalogs come and go with the zoom,
+    //so they are not indexed
+    oTry = m_Stars->objectNearest( p, rTry );
     if ( rTry < rBest ) {
         rBest = rTry;
         oBest = oTry;
@@ -346,17 +370,22 @@ SkyObject* SkyMapComposite::objectNearest( SkyPoint *p, double &maxrad ) {
 
 SkyObject* SkyMapComposite::starNearest( SkyPoint *p, double &maxrad ) {
     double rtry = maxrad;
+    double rbest = maxrad;
     SkyObject *star = 0;
+    SkyObject *oTry = 0;
 
-    m_skyMesh->aperture( p, maxrad + 1.0, OBJ_NEAREST_BUF);
+    // The stars of the custom catalogs are left out, as they always were
+    star = m_NearestIndex.nearest( p, rbest, NearestIndex::typeMask( SkyObject::STAR ) );
 
-    star = m_Stars->objectNearest( p, rtry );
+    oTry = m_Stars->objectNearest( p, rtry );
     //reduce rBest by 0.75 for stars brighter than 4th mag
-    if ( star && star->mag() < 4.0 ) rtry *= 0.75;
-
-    // TODO: Add Deep Star Catalog support
+    if ( oTry && oTry->mag() < 4.0 ) rtry *= 0.75;
+    if ( rtry < rbest ) {
+        rbest = rtry;
+        star = oTry;
+    }
 
-    maxrad = rtry;
+    maxrad = rbest;
     return star;
 }
 
@@ -378,6 +407,14 @@ QHash<int, QStringList>& SkyMapComposite::getObjectNames() {
     return m_ObjectNames;
 }
 
+NameIndex& SkyMapComposite::getNameIndex() {
+    return m_NameIndex;
+}
+
+NearestIndex& SkyMapComposite::getNearestIndex() {
+    return m_NearestIndex;
+}
+
 QList<SkyObject*> SkyMapComposite::findObjectsInArea( const SkyPoint& p1, const SkyPoint& p2 )
 {
     const SkyRegion& region = m_skyMesh->skyRegion( p1, p2 );
@@ -392,23 +429,9 @@ QList<SkyObject*> SkyMapComposite::findObjectsInArea( const SkyPoint& p1, const
 }
 
 SkyObject* SkyMapComposite::findByName( const QString &name ) {
-    //We search the children in an "intelligent" order (most-used
-    //object types first), in order to avoid wasting too much time
-    //looking for a match.  The most important part of this ordering
-    //is that stars should be last (because the stars list is so long)
-    SkyObject *o = 0;
-    o = m_SolarSystem->findByName( name );
-    if ( o ) return o;
-    o = m_DeepSky->findByName( name );
-    if ( o ) return o;
-    o = m_CustomCatalogs->findByName( name );
-    if ( o ) return o;
-    o = m_CNames->findByName( name );
-    if ( o ) return o;
-    o = m_Stars->findByName( name );
-    if ( o ) return o;
-
-    return 0;
+    //Every component adds the names of its objects to the index while
+    //loading, so there is no need to search the children
+    return m_NameIndex.find( name );
 }
 
 
@@ -22,6 +22,8 @@
 
 #include "skycomposite.h"
 #include "ksnumbers.h"
+#include "nameindex.h"
+#include "nearestindex.h"
 
 class SkyMesh;
 class SkyLabeler;
@@ -112,8 +114,37 @@ public:
     	*/
     virtual void draw( SkyPainter *skyp );
 
+    /**
+    	*@short Draw the static layers: the components which only move when
+    	*the focus, the zoom or the time change (stars, deep sky objects,
+    	*grids, constellation lines...). The labels they place are kept by
+    	*the SkyLabeler, so that drawDynamic() can be called again on a copy
+    	*of this drawing without drawing the static layers again.
+    	*@p skyp the painter to draw with
+    	*@return false if the draw was aborted
+    	*/
+    bool drawStatic( SkyPainter *skyp );
+
+    /**
+    	*@short Draw the dynamic layers on top of the static ones: solar
+    	*system, satellites, horizon, observing list and flags, then all the
+    	*object labels.
+    	*@p skyp the painter to draw with
+    	*/
+    void drawDynamic( SkyPainter *skyp );
+
+    /**
+    	*@return a number which changes each time the static layers are
+    	*drawn, so that a cached drawing of them can be known to be stale
+    	*/
+    inline unsigned int staticGeneration() const { return m_staticGeneration; }
+
     /**
       *@return the object nearest a given point in the sky.
+      *
+      *The objects are looked up in the NearestIndex, except the satellites
+      *and the stars of the deep star catalogs loaded on demand, which are
+      *searched by their components.
       *@param p The point to find an object near
       *@param maxrad The maximum search radius, in Degrees
 			*@note the angular separation to the matched object is returned 
@@ -135,9 +166,9 @@ public:
     	*a SkyObject whose name matches the argument.
     	*
     	*The objects' primary, secondary and long-form names will 
-    	*all be checked for a match.
-    	*@note Overloaded from SkyComposite.  In this version, we search 
-    	*the most likely object classes first to be more efficient.
+    	*all be checked for a match, as well as aliases such as HD numbers.
+    	*@note Overloaded from SkyComposite.  In this version, the name is
+    	*looked up in the name index instead of searching the children.
     	*@p name the name to be matched
     	*@return a pointer to the SkyObject whose name matches
     	*the argument, or a NULL pointer if no match was found.
@@ -197,6 +228,8 @@ signals:
 
 private:
     virtual QHash<int, QStringList>& getObjectNames();
+    virtual NameIndex& getNameIndex();
+    virtual NearestIndex& getNearestIndex();
     
     CultureList                 *m_Cultures;
     ConstellationBoundaryLines  *m_CBoundLines;
@@ -220,11 +253,15 @@ private:
     SkyLabeler*             m_skyLabeler;
 
     KSNumbers               m_reindexNum;
+    unsigned int            m_staticGeneration;
+    bool                    m_staticPending;    // drawStatic() was called since the last drawDynamic()
 
     QList<DeepStarComponent *> m_DeepStars;
 
     QList<SkyObject*>       m_LabeledObjects;
     QHash<int, QStringList> m_ObjectNames;
+    NameIndex               m_NameIndex;
+    NearestIndex            m_NearestIndex;
     QHash<QString, QString> m_ConstellationNames;
 };
 
@@ -19,9 +19,11 @@
 #include "skyobjects/skypoint.h"
 #include "skyobjects/starobject.h"
 #include "ksnumbers.h"
+#include "coordinatepipeline.h"
 
 #include <QHash>
 #include <QPolygonF>
+#include <QtAlgorithms>
 #include <QPointF>
 
 // these are just for the draw routine:
@@ -56,7 +58,7 @@ SkyMesh* SkyMesh::Instance( int level )
 
 SkyMesh::SkyMesh( int level) :
         HTMesh(level, level, NUM_MESH_BUF),
-        m_drawID(0), m_KSNumbers( 0 )
+        m_drawID(0), m_KSNumbers( 0 ), m_apertures( NUM_MESH_BUF )
 {
     errLimit = HTMesh::size() / 4;
     m_zoomedInPercent = 25;
@@ -66,23 +68,34 @@ SkyMesh::SkyMesh( int level) :
 void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
 {
     KStarsData* data = KStarsData::Instance();
-    // FIXME: simple copying leads to incorrect results because RA0 && dec0 are both zero sometimes
-    SkyPoint p1( p0->ra(), p0->dec() );
     long double now = data->updateNum()->julianDay();
-    p1.apparentCoord( now, J2000 );
-
-    if ( radius == 1.0 ) {
-        printf("\n ra0 = %8.4f   dec0 = %8.4f\n", p0->ra().Degrees(), p0->dec().Degrees() );
-        printf(" ra1 = %8.4f   dec1 = %8.4f\n", p1.ra().Degrees(), p1.dec().Degrees() );
+    ApertureCache &cache = m_apertures[ bufNum ];
+
+    // The reverse precession is only redone when the focus or the epoch change
+    if ( p0->ra().Degrees() != cache.focusRa || p0->dec().Degrees() != cache.focusDec || now != cache.jd ) {
+        // FIXME: simple copying leads to incorrect results because RA0 && dec0 are both zero sometimes
+        SkyPoint p1( p0->ra(), p0->dec() );
+        p1.apparentCoord( now, J2000 );
+
+        if ( radius == 1.0 ) {
+            printf("\n ra0 = %8.4f   dec0 = %8.4f\n", p0->ra().Degrees(), p0->dec().Degrees() );
+            printf(" ra1 = %8.4f   dec1 = %8.4f\n", p1.ra().Degrees(), p1.dec().Degrees() );
+
+            SkyPoint p2 = p1;
+            p2.updateCoords( data->updateNum() );
+            printf(" ra2 = %8.4f  dec2 = %8.4f\n", p2.ra().Degrees(), p2.dec().Degrees() );
+            printf("p0 - p1 = %6.4f degrees\n", p0->angularDistanceTo( &p1 ).Degrees() );
+            printf("p0 - p2 = %6.4f degrees\n", p0->angularDistanceTo( &p2 ).Degrees() );
+        }
 
-        SkyPoint p2 = p1;
-        p2.updateCoords( data->updateNum() );
-        printf(" ra2 = %8.4f  dec2 = %8.4f\n", p2.ra().Degrees(), p2.dec().Degrees() );
-        printf("p0 - p1 = %6.4f degrees\n", p0->angularDistanceTo( &p1 ).Degrees() );
-        printf("p0 - p2 = %6.4f degrees\n", p0->angularDistanceTo( &p2 ).Degrees() );
+        cache.focusRa  = p0->ra().Degrees();
+        cache.focusDec = p0->dec().Degrees();
+        cache.jd       = now;
+        cache.centerRa  = p1.ra().Degrees();
+        cache.centerDec = p1.dec().Degrees();
     }
 
-    HTMesh::intersect( p1.ra().Degrees(), p1.dec().Degrees(), radius, (BufNum) bufNum);
+    cachedIntersect( bufNum, cache.centerRa, cache.centerDec, radius );
     m_drawID++;
 
     return;
@@ -90,6 +103,68 @@ void SkyMesh::aperture(SkyPoint *p0, double radius, MeshBufNum_t bufNum)
         printf("Warining: overlapping buffer: %d\n", bufNum);
 }
 
+void SkyMesh::cachedIntersect( MeshBufNum_t bufNum, double ra, double dec, double radius )
+{
+    ApertureCache &cache = m_apertures[ bufNum ];
+    MeshBuffer *buffer = meshBuffer( bufNum );
+
+    // The last intersection was made with a margin of cache.slack around
+    // the aperture, so it covers any aperture of the same radius whose
+    // center is within cache.slack of its center
+    if ( cache.serial && radius == cache.radius ) {
+        double d2r = dms::DegToRad;
+        double cosDist = sin( dec * d2r ) * sin( cache.meshDec * d2r ) +
+                         cos( dec * d2r ) * cos( cache.meshDec * d2r ) * cos( ( ra - cache.meshRa ) * d2r );
+        if ( cosDist >= cos( cache.slack * d2r ) ) {
+            // The buffer may have been used by other queries since
+            buffer->reset();
+            for ( int i = 0; i < cache.trixels.size(); ++i )
+                buffer->append( cache.trixels[ i ] );
+            return;
+        }
+    }
+
+    // The margin is a fraction of a trixel, and of the aperture
+    double edge = 90.0 / ( 1 << level() );
+    cache.slack = qMin( 0.1 * radius, 0.25 * edge );
+    cache.radius = radius;
+    cache.meshRa = ra;
+    cache.meshDec = dec;
+    HTMesh::intersect( ra, dec, radius + cache.slack, (BufNum) bufNum );
+
+    QVector<Trixel> trixels( buffer->size() );
+    for ( int i = 0; i < trixels.size(); ++i )
+        trixels[ i ] = buffer->buffer()[ i ];
+    qSort( trixels );
+
+    // Both lists are sorted, so one pass finds the trixels entering and leaving
+    cache.entering.clear();
+    cache.leaving.clear();
+    int i = 0, j = 0;
+    while ( i < trixels.size() || j < cache.trixels.size() ) {
+        if ( j == cache.trixels.size() || ( i < trixels.size() && trixels[ i ] < cache.trixels[ j ] ) )
+            cache.entering.append( trixels[ i++ ] );
+        else if ( i == trixels.size() || cache.trixels[ j ] < trixels[ i ] )
+            cache.leaving.append( cache.trixels[ j++ ] );
+        else {
+            ++i;
+            ++j;
+        }
+    }
+
+    cache.trixels = trixels;
+    ++cache.serial;
+}
+
+void SkyMesh::aperture( const SkyPoint *p0, double radius, MeshBuffer *result ) const
+{
+    SkyPoint p1( p0->ra(), p0->dec() );
+    long double now = KStarsData::Instance()->updateNum()->julianDay();
+    p1.apparentCoord( now, J2000 );
+
+    HTMesh::intersect( p1.ra().Degrees(), p1.dec().Degrees(), radius, result );
+}
+
 bool SkyMesh::isZoomedIn( int percent )
 {
     if ( ! percent ) percent = m_zoomedInPercent;
@@ -108,6 +183,14 @@ Trixel SkyMesh::indexStar( StarObject *star )
     return HTMesh::index( ra, dec );
 }
 
+void SkyMesh::indexStars( StarObject *const *stars, int n, Trixel *trixels )
+{
+    QVector<double> ra( n ), dec( n );
+    CoordinatePipeline::indexCoords( stars, n, &m_KSNumbers, ra.data(), dec.data() );
+    for ( int i = 0; i < n; i++ )
+        trixels[ i ] = HTMesh::index( ra[ i ], dec[ i ] );
+}
+
 void SkyMesh::indexStar( StarObject* star1, StarObject* star2 )
 {
     double ra1, ra2, dec1, dec2;
@@ -119,13 +202,24 @@ void SkyMesh::indexStar( StarObject* star1, StarObject* star2 )
 
 void SkyMesh::index(const SkyPoint *p, double radius, MeshBufNum_t bufNum )
 {
-    HTMesh::intersect( p->ra().Degrees(), p->dec().Degrees(), radius, (BufNum) bufNum );
+    cachedIntersect( bufNum, p->ra().Degrees(), p->dec().Degrees(), radius );
 
     return;
     if ( m_inDraw && bufNum != DRAW_BUF )
         printf("Warining: overlapping buffer: %d\n", bufNum);
 }
 
+void SkyMesh::index( const SkyPoint *p, double radius, MeshBuffer *result ) const
+{
+    HTMesh::intersect( p->ra().Degrees(), p->dec().Degrees(), radius, result );
+}
+
+void SkyMesh::index( const SkyPoint* p1, const SkyPoint* p2, MeshBuffer *result ) const
+{
+    HTMesh::intersect( p1->ra0().Degrees(), p1->dec0().Degrees(),
+                       p2->ra0().Degrees(), p2->dec0().Degrees(), result );
+}
+
 void SkyMesh::index( const SkyPoint* p1, const SkyPoint* p2 )
 {
     HTMesh::intersect( p1->ra0().Degrees(), p1->dec0().Degrees(),
@@ -292,6 +386,38 @@ const IndexHash& SkyMesh::indexPoly( SkyList *points )
     return indexHash;
 }
 
+void SkyMesh::indexPoly( const SkyList *points, IndexHash *result ) const
+{
+    if (points->size() < 3) return;
+
+    MeshBuffer buffer( this );
+    const SkyPoint* startP = points->first();
+
+    int end = points->size() - 2;
+    for( int p = 1; p <= end; p+= 2 ) {
+        const SkyPoint *p1 = points->at(p);
+        const SkyPoint *p2 = points->at(p+1);
+
+        if ( p == end ) {
+            HTMesh::intersect( startP->ra0().Degrees(), startP->dec0().Degrees(),
+                               p1->ra0().Degrees(), p1->dec0().Degrees(),
+                               p2->ra0().Degrees(), p2->dec0().Degrees(), &buffer );
+        }
+        else {
+            const SkyPoint *p3 = points->at(p+2);
+            HTMesh::intersect( startP->ra0().Degrees(), startP->dec0().Degrees(),
+                               p1->ra0().Degrees(), p1->dec0().Degrees(),
+                               p2->ra0().Degrees(), p2->dec0().Degrees(),
+                               p3->ra0().Degrees(), p3->dec0().Degrees(), &buffer );
+        }
+
+        MeshIterator region( &buffer );
+        while ( region.hasNext() ) {
+            result->insert( region.next(), true );
+        }
+    }
+}
+
 const IndexHash& SkyMesh::indexPoly( const QPolygonF* points )
 {
     indexHash.clear();
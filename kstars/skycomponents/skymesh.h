@@ -22,6 +22,7 @@
 #include <QHash>
 #include <QList>
 #include <QObject>
+#include <QVector>
 
 #include <QPainter>
 
@@ -88,6 +89,13 @@ enum MeshBufNum_t {
  * The MeshIterator has its own bool hasNext(), int next(), and int size()
  * methods for iterating through the integer indices of the found trixels or
  * for just getting the total number of found trixels.
+ *
+ * The routines above store their results in buffers shared by all the users
+ * of the mesh, so they can only be used from the GUI thread, one query at a
+ * time per buffer.  The const routines which take a MeshBuffer* instead store
+ * their results in a buffer owned by the caller: they can be used at any time
+ * from any thread, e.g. by tools which search the sky while it is drawn.
+ * Iterate over their results with a MeshIterator( result ).
  */
 
 class SkyMesh : public HTMesh
@@ -135,6 +143,46 @@ public:
      */
     void aperture( SkyPoint *center, double radius, MeshBufNum_t bufNum=DRAW_BUF );
 
+    //----- Aperture cache -----
+    // aperture() and index( center, radius, bufNum ) keep the trixels they
+    // found for each buffer.  The intersection is made with a small margin
+    // around the circle, and reused as long as the center stays within the
+    // margin and the radius does not change, so small pans and repeated
+    // calls in the same frame cost a copy of the trixels.  Each new
+    // intersection gets a new serial number, and the trixels which entered
+    // and left the set since the previous one are kept, so that per-trixel
+    // work can be updated instead of redone from scratch.
+
+    /* @return the serial number of the last intersection made for the
+     * buffer, 0 if there was none.
+     */
+    unsigned int apertureSerial( MeshBufNum_t bufNum ) const { return m_apertures[ bufNum ].serial; }
+
+    /* @return the trixels of the last intersection made for the buffer,
+     * sorted.
+     */
+    const QVector<Trixel>& apertureTrixels( MeshBufNum_t bufNum ) const { return m_apertures[ bufNum ].trixels; }
+
+    /* @return the trixels of the last intersection made for the buffer
+     * which were not in the previous one.
+     */
+    const QVector<Trixel>& enteringTrixels( MeshBufNum_t bufNum ) const { return m_apertures[ bufNum ].entering; }
+
+    /* @return the trixels of the previous intersection made for the buffer
+     * which are not in the last one.
+     */
+    const QVector<Trixel>& leavingTrixels( MeshBufNum_t bufNum ) const { return m_apertures[ bufNum ].leaving; }
+
+    /**
+     *@short reentrant version of aperture(): finds the trixels that cover
+     * the circular aperture, after the reverse precession correction of the
+     * center.  The drawID is not incremented.
+     *@param center Center of the aperture
+     *@param radius Radius of the aperture in degrees
+     *@param result Buffer for the trixels, created for this mesh
+     */
+    void aperture( const SkyPoint *center, double radius, MeshBuffer *result ) const;
+
     /* @short returns the index of the trixel containing p.
      */
     Trixel index( const SkyPoint *p );
@@ -168,6 +216,11 @@ public:
      */
     Trixel indexStar( StarObject *star );
 
+    /* @short fills trixels with the trixel of each star, as indexStar()
+     * would, moving all the stars through the coordinate pipeline at once.
+     */
+    void indexStars( StarObject *const *stars, int n, Trixel *trixels );
+
     /* @short fills the default buffer with all the trixels needed to cover
      * the line connecting the two stars.
      */
@@ -204,11 +257,21 @@ public:
      */
     void index( const SkyPoint *center, double radius, MeshBufNum_t bufNum=DRAW_BUF );
 
+    /* @short reentrant version of the above.  The trixels are stored in
+     * result.
+     */
+    void index( const SkyPoint *center, double radius, MeshBuffer *result ) const;
+
     /* @short finds the indices of the trixels covering the line segment
      * connecting p1 and p2.
      */
     void index( const SkyPoint* p1, const SkyPoint* p2 );
 
+    /* @short reentrant version of the above.  The trixels are stored in
+     * result.
+     */
+    void index( const SkyPoint* p1, const SkyPoint* p2, MeshBuffer *result ) const;
+
     /* @short finds the indices of the trixels covering the triangle
      * specified by vertices: p1, p2, and p3.
      */
@@ -262,6 +325,11 @@ public:
      */
     const IndexHash& indexPoly( const QPolygonF* points );
 
+    /* @short reentrant version of indexPoly( SkyList* ): the trixel indices
+     * are added to the caller's result hash, which is not cleared first.
+     */
+    void indexPoly( const SkyList* points, IndexHash *result ) const;
+
     /* @short Returns the debug level.  This is used as a global debug level
      * for LineListIndex and its subclasses.
      */
@@ -302,6 +370,28 @@ public:
     void inDraw( bool inDraw ) { m_inDraw = inDraw; }
 
 private:
+    /* @short The trixels found by aperture() and index( center, radius ) for
+     * one buffer
+     */
+    struct ApertureCache {
+        ApertureCache() : focusRa( -1.0 ), focusDec( 0.0 ), jd( 0.0 ), radius( -1.0 ), serial( 0 ) {}
+
+        double focusRa, focusDec;       // Focus of the last aperture() call
+        long double jd;                 // and its epoch
+        double centerRa, centerDec;     // The focus, reverse precessed
+        double radius;                  // Radius of the last intersection, without the margin
+        double slack;                   // and its margin
+        double meshRa, meshDec;         // Center of the last intersection
+        unsigned int serial;
+        QVector<Trixel> trixels;        // Sorted
+        QVector<Trixel> entering, leaving;
+    };
+
+    /* @short fills the buffer with the trixels covering the circle, reusing
+     * the last intersection made for the buffer if it covers the circle.
+     */
+    void cachedIntersect( MeshBufNum_t bufNum, double ra, double dec, double radius );
+
     DrawID m_drawID;
     int    errLimit;
     int    m_debug;
@@ -311,6 +401,7 @@ private:
     int         m_zoomedInPercent;
 
     bool        m_inDraw;
+    QVector<ApertureCache> m_apertures;
     static int defaultLevel;
     static QMap<int, SkyMesh *> pinstances;
 };
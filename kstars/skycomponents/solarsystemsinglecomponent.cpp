@@ -43,6 +43,8 @@ SolarSystemSingleComponent::SolarSystemSingleComponent(SolarSystemComposite *par
         objectNames(m_Planet->type()).append( m_Planet->name() );
     if ( ! m_Planet->longname().isEmpty() && m_Planet->longname() != m_Planet->name() )
         objectNames(m_Planet->type()).append( m_Planet->longname() );
+    nameIndex().insert( m_Planet );
+    nearestIndex().insert( m_Planet, this );
 }
 
 SolarSystemSingleComponent::~SolarSystemSingleComponent()
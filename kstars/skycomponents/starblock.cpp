@@ -32,7 +32,10 @@ StarBlock::StarBlock( int nstars ) :
     next(0),
     drawID(0),
     nStars(0),
-    stars(nstars, StarObject())
+    stars(nstars, StarObject()),
+    posX(nstars),
+    posY(nstars),
+    posZ(nstars)
 { }
 
 
@@ -56,9 +59,10 @@ StarObject* StarBlock::addStar(const starData& data)
 {
     if(isFull())
         return 0;
-    StarObject& star = stars[nStars++];
+    StarObject& star = stars[nStars];
     
     star.init(&data);
+    setPosition( nStars++ );
     if( star.mag() > faintMag )
         faintMag = star.mag();
     if( star.mag() < brightMag )
@@ -70,12 +74,40 @@ StarObject* StarBlock::addStar(const deepStarData& data)
 {
     if(isFull())
         return 0;
-    StarObject& star = stars[nStars++];
+    StarObject& star = stars[nStars];
     
     star.init(&data);
+    setPosition( nStars++ );
     if( star.mag() > faintMag )
         faintMag = star.mag();
     if( star.mag() < brightMag )
         brightMag = star.mag();
     return &star;
 }
+
+void StarBlock::setPosition( int i )
+{
+    double sinRa, cosRa, sinDec, cosDec;
+    stars[i].ra0().SinCos( sinRa, cosRa );
+    stars[i].dec0().SinCos( sinDec, cosDec );
+    posX[i] = cosDec * cosRa;
+    posY[i] = cosDec * sinRa;
+    posZ[i] = sinDec;
+}
+
+int StarBlock::cull( const float *view, const float *ground, quint8 *visible ) const
+{
+    const float *x = posX.constData();
+    const float *y = posY.constData();
+    const float *z = posZ.constData();
+    int count = 0;
+
+    // Kept free of branches so that the compiler can vectorize it
+    for( int i = 0; i < nStars; ++i ) {
+        float v = x[i] * view[0] + y[i] * view[1] + z[i] * view[2];
+        float g = x[i] * ground[0] + y[i] * ground[1] + z[i] * ground[2];
+        visible[i] = ( v >= view[3] ) & ( g >= ground[3] );
+        count += visible[i];
+    }
+    return count;
+}
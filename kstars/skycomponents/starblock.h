@@ -114,6 +114,21 @@ public:
      */
     void reset();
 
+    /**
+     *@short  Find the stars of this block that may be visible
+     *
+     *Tests the J2000 unit vectors of all the stars in the block against two cones
+     *in a single pass over packed arrays, which is much cheaper than updating and
+     *projecting every star. Cones are given as the J2000 unit vector (x, y, z) of
+     *their axis, followed by the cosine of their radius.
+     *
+     *@param  view     Cone that covers the sky map
+     *@param  ground   Cone that covers the part of the sky above the ground
+     *@param  visible  Array of at least getStarCount() entries, set to 1 for every star that lies in both cones
+     *@return The number of stars that lie in both cones
+     */
+    int cull( const float *view, const float *ground, quint8 *visible ) const;
+
     float faintMag;
     float brightMag;
     StarBlockList *parent;
@@ -130,6 +145,11 @@ public:
     int nStars;
     /** Array of stars. */
     QVector<StarObject> stars;
+    /** J2000 unit vectors of the stars, kept apart from the stars for cull() */
+    QVector<float> posX, posY, posZ;
+
+    /** Store the J2000 unit vector of the i-th star */
+    void setPosition( int i );
 };
 
 #endif
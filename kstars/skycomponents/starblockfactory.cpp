@@ -16,14 +16,14 @@
  ***************************************************************************/
 
 #include "starblockfactory.h"
+#include "starblockprefetcher.h"
+#include "skyobjects/starobject.h"
+#include "Options.h"
 
 // TODO: Remove later
 #include <stdio.h>
 #include <kdebug.h>
 
-// TODO: Implement a better way of deciding this
-#define DEFAULT_NCACHE 12
-
 StarBlockFactory *StarBlockFactory::pInstance = 0;
 
 StarBlockFactory *StarBlockFactory::Instance() {
@@ -37,60 +37,103 @@ StarBlockFactory::StarBlockFactory() {
     last = NULL;
     nBlocks = 0;
     drawID = 0;
-    nCache = DEFAULT_NCACHE;
+    maxBytes = (quint64) Options::starCacheSize() * 1048576;
+    freeBlocks = NULL;
+    nHits = nMisses = nEvictions = 0;
+    blockPrefetcher = NULL;
 }
 
 
-StarBlockFactory::StarBlockFactory( int nblocks ) {
+StarBlockFactory::StarBlockFactory( quint64 maxbytes ) {
     first = NULL;
     last = NULL;
     nBlocks = 0;
     drawID = 0;
-    nCache = nblocks;
+    maxBytes = maxbytes;
+    freeBlocks = NULL;
+    nHits = nMisses = nEvictions = 0;
+    blockPrefetcher = NULL;
 }
 
 StarBlockFactory::~StarBlockFactory() {
+    delete blockPrefetcher;
     deleteBlocks( nBlocks );
+    freeSlabs();
     if( pInstance )
         pInstance = 0;
 }
 
+quint64 StarBlockFactory::blockSize() {
+    // StarBlocks are created with the default capacity of 100 stars
+    return sizeof( StarBlock ) + 100 * ( sizeof( StarObject ) + 3 * sizeof( float ) );
+}
+
 StarBlock *StarBlockFactory::getBlock() {
     StarBlock *freeBlock = NULL;
-    if( nBlocks < nCache ) {
-        freeBlock = new StarBlock;
-        if( freeBlock ) {
-            ++nBlocks;
-            return freeBlock;
-        }
-    }
-    if( last && ( last->drawID != drawID || last->drawID == 0 ) ) {
+
+    ++nMisses;
+
+    // Recycle the least recently used block if we have used up our memory
+    // and it was not drawn in this draw cycle
+    if( getBytesResident() >= maxBytes && last && ( last->drawID != drawID || last->drawID == 0 ) ) {
         //        kDebug() << "Recycling block with drawID =" << last->drawID << "and current drawID =" << drawID;
         if( last->parent->block( last->parent->getBlockCount() - 1 ) != last )
             kDebug() << "ERROR: Goof up here!";
-        freeBlock = last;
-        last = last->prev;
-        if( last )
-            last->next = NULL;
-        if( freeBlock == first )
-            first = NULL;
-        freeBlock->reset();
-        freeBlock->prev = NULL;
-        freeBlock->next = NULL;
-        return freeBlock;
+        freeLast();
+    }
+
+    if( !freeBlocks ) {
+        StarBlock *slab = new StarBlock[ BLOCKS_PER_SLAB ];
+        slabs.append( slab );
+        for( int i = BLOCKS_PER_SLAB - 1; i >= 0; --i ) {
+            slab[i].next = freeBlocks;
+            freeBlocks = &slab[i];
+        }
     }
-    freeBlock = new StarBlock;
-    if( freeBlock )
-        ++nBlocks;
+
+    freeBlock = freeBlocks;
+    freeBlocks = freeBlock->next;
+    freeBlock->prev = NULL;
+    freeBlock->next = NULL;
+    ++nBlocks;
     return freeBlock;
 }
 
+void StarBlockFactory::freeLast() {
+    StarBlock *freeBlock = last;
+    last = last->prev;
+    if( last )
+        last->next = NULL;
+    if( freeBlock == first )
+        first = NULL;
+    freeBlock->reset();
+    freeBlock->prev = NULL;
+    freeBlock->next = freeBlocks;
+    freeBlocks = freeBlock;
+    --nBlocks;
+    ++nEvictions;
+}
+
+void StarBlockFactory::freeSlabs() {
+    if( nBlocks > 0 ) {
+        kDebug() << "ERROR: Trying to release StarBlock slabs while" << nBlocks << "blocks are in use";
+        return;
+    }
+    foreach( StarBlock *slab, slabs )
+        delete [] slab;
+    slabs.clear();
+    freeBlocks = NULL;
+}
+
 bool StarBlockFactory::markFirst( StarBlock *block ) {
 
     if( !block )
         return false;
 
     //    fprintf(stderr, "markFirst()!\n");
+    if( block->drawID != drawID && block->getStarCount() > 0 )
+        ++nHits;
+
     if( !first ) {
         //        kDebug() << "INFO: Linking in first block" << endl;
         last = first = block;
@@ -141,6 +184,9 @@ bool StarBlockFactory::markNext( StarBlock *after, StarBlock *block ) {
         return false;
     }
 
+    if( block->drawID != drawID && block->getStarCount() > 0 )
+        ++nHits;
+
     if( block->prev == after ) { // Block is already after 'after'
         block->drawID = drawID;
         return true;
@@ -230,26 +276,36 @@ bool StarBlockFactory::groupMove( StarBlock *start, const int nblocks ) {
 
 int StarBlockFactory::deleteBlocks( int nblocks ) {
     int i;
-    StarBlock *temp;
 
     i = 0;
     while( last != NULL && i != nblocks ) {
-        temp = last->prev;
-        delete last;
-        last = temp;
+        freeLast();
         i++;
     }   
-    if( last )
-        last->next = NULL;
-    else
-        first = NULL;
 
     kDebug() << nblocks << "StarBlocks freed from StarBlockFactory" << endl;
 
-    nBlocks -= i;
+    if( nBlocks == 0 )
+        freeSlabs();
     return i;
 }
 
+void StarBlockFactory::setMaxBytes( quint64 maxbytes ) {
+    int i = 0;
+
+    maxBytes = maxbytes;
+    while( getBytesResident() > maxBytes && last != NULL && ( last->drawID != drawID || last->drawID == 0 ) ) {
+        freeLast();
+        i++;
+    }
+
+    if( i )
+        kDebug() << i << "StarBlocks freed to fit the star cache in" << maxBytes << "bytes";
+
+    if( nBlocks == 0 )
+        freeSlabs();
+}
+
 void StarBlockFactory::printStructure() {
 
     StarBlock *cur;
@@ -276,24 +332,24 @@ void StarBlockFactory::printStructure() {
     }while( cur != last );
 }
 
+StarBlockPrefetcher *StarBlockFactory::getPrefetcher() {
+    if( !blockPrefetcher )
+        blockPrefetcher = new StarBlockPrefetcher();
+    return blockPrefetcher;
+}
+
 int StarBlockFactory::freeUnused() {
     int i;
-    StarBlock *temp;
 
     i = 0;
     while( last != NULL && last->drawID < drawID && i != nBlocks ) {
-        temp = last->prev;
-        delete last;
-        last = temp;
+        freeLast();
         i++;
     }   
-    if( last )
-        last->next = NULL;
-    else
-        first = NULL;
 
     kDebug() << i << "StarBlocks freed from StarBlockFactory" << endl;
 
-    nBlocks -= i;
+    if( nBlocks == 0 )
+        freeSlabs();
     return i;
 }
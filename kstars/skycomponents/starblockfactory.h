@@ -18,12 +18,22 @@
 #ifndef STARBLOCKFACTORY_H
 #define STARBLOCKFACTORY_H
 
+#include <QList>
+
 #include "typedef.h"
 #include "starblock.h"
 
+class StarBlockPrefetcher;
+
 /**
  *@class StarBlockFactory
  *
+ *StarBlocks are allocated in slabs of contiguous blocks, and blocks that are
+ *given back to the factory go to a free list, so that getting a block is
+ *usually just a list pop. New slabs are allocated till the memory used by
+ *the blocks in the cache reaches Options::starCacheSize(); after that, the
+ *least recently used blocks are recycled.
+ *
  *@short A factory that creates StarBlocks and recycles them in an LRU Cache
  *@author Akarsh Simha
  *@version 0.1
@@ -79,6 +89,36 @@ class StarBlockFactory {
      */
     inline int getBlockCount() { return nBlocks; }
 
+    /**
+     *@return Number of times a block that was already loaded was used again
+     */
+    inline quint64 getHitCount() { return nHits; }
+
+    /**
+     *@return Number of times a block had to be handed out for loading stars
+     */
+    inline quint64 getMissCount() { return nMisses; }
+
+    /**
+     *@return Number of loaded blocks that were recycled or freed to make room
+     */
+    inline quint64 getEvictionCount() { return nEvictions; }
+
+    /**
+     *@return Memory used by the StarBlocks that hold stars, in bytes
+     */
+    inline quint64 getBytesResident() { return (quint64) nBlocks * blockSize(); }
+
+    /**
+     *@return Memory allocated for StarBlocks, including free ones, in bytes
+     */
+    inline quint64 getBytesAllocated() { return (quint64) slabs.size() * BLOCKS_PER_SLAB * blockSize(); }
+
+    /**
+     *@return Memory the cache may use for blocks, as set by setMaxBytes(), in bytes
+     */
+    inline quint64 getMaxBytes() { return maxBytes; }
+
     /**
      *@short  Frees all StarBlocks that are in the cache
      *@return The number of StarBlocks freed
@@ -91,11 +131,27 @@ class StarBlockFactory {
      */
     int freeUnused();
 
+    /**
+     *@short  Changes the memory the cache may use for blocks
+     *
+     *If the cache now holds more than maxbytes, the least recently used
+     *blocks that are not drawn in this draw cycle are freed right away.
+     *
+     *@param  maxbytes  Memory to use for blocks, in bytes
+     */
+    void setMaxBytes( quint64 maxbytes );
+
     /**
      *@short  Prints the structure of the cache, for debugging
      */
     void printStructure();
 
+    /**
+     *@short  Returns the background thread that reads catalog data ahead of the draw loop
+     *@return The StarBlockPrefetcher of this factory, created on first use
+     */
+    StarBlockPrefetcher *getPrefetcher();
+
     quint32 drawID;            // A number identifying the current draw cycle
 
  private:
@@ -108,22 +164,47 @@ class StarBlockFactory {
 
     /**
      * Constructor
-     *@short Creates a cache containing N blocks
-     *@param nblocks  Number of blocks to allocate
+     *@short Creates a cache that may use the given memory
+     *@param maxbytes  Memory to use for blocks, in bytes
      */
-    StarBlockFactory( int nblocks );
+    StarBlockFactory( quint64 maxbytes );
 
     /**
-     *@short  Deletes the N least recently used blocks
+     *@short  Frees the N least recently used blocks
      *
-     *@param  nblocks  Number of blocks to delete
-     *@return Number of blocks successfully deleted
+     *The blocks are reset and go back to the free list. The slabs are
+     *released once no block is in use.
+     *
+     *@param  nblocks  Number of blocks to free
+     *@return Number of blocks successfully freed
      */
     int deleteBlocks( int nblocks );
 
+    /**
+     *@short  Detaches the least recently used block and puts it on the free list
+     */
+    void freeLast();
+
+    /**
+     *@short  Releases all slabs. Only to be called when no block is in use
+     */
+    void freeSlabs();
+
+    /**
+     *@return Memory used by one StarBlock and its stars, in bytes
+     */
+    static quint64 blockSize();
+
+    enum { BLOCKS_PER_SLAB = 32 };
+
     StarBlock *first, *last;   // Pointers to the beginning and end of the linked list
     int nBlocks;               // Number of blocks we currently have in the cache
-    int nCache;                // Number of blocks to start recycling cached blocks at
+    quint64 maxBytes;          // Memory to use for blocks before recycling cached blocks
+    QList<StarBlock *> slabs;  // Arrays of BLOCKS_PER_SLAB blocks each
+    StarBlock *freeBlocks;     // Blocks that hold no stars, linked through StarBlock::next
+
+    quint64 nHits, nMisses, nEvictions; // Statistics of the cache
+    StarBlockPrefetcher *blockPrefetcher; // Reads catalog data ahead of time, NULL till first used
 
     static StarBlockFactory *pInstance;
 
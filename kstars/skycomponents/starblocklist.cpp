@@ -18,6 +18,7 @@
 #include "starblocklist.h"
 #include "binfilehelper.h"
 #include "starblockfactory.h"
+#include "starblockprefetcher.h"
 #include "skyobjects/stardata.h"
 #include "skyobjects/deepstardata.h"
 #include "starcomponent.h"
@@ -28,6 +29,7 @@ StarBlockList::StarBlockList( Trixel tr, DeepStarComponent *parent ) {
     trixel = tr;
     nStars = 0;
     readOffset = 0;
+    prefetchOffset = 0;
     faintMag = -5.0;
     nBlocks = 0;
     this->parent = parent;
@@ -52,6 +54,9 @@ int StarBlockList::releaseBlock( StarBlock *block ) {
         nStars -= block->getStarCount();
 
         readOffset -= parent->getStarReader()->guessRecordSize() * block->getStarCount();
+        // The released stars may have left the page cache: warm them again
+        if( prefetchOffset > readOffset )
+            prefetchOffset = readOffset;
 	if( nBlocks <= 0 )
 	  faintMag = -5.0;
 	else
@@ -148,6 +153,28 @@ bool StarBlockList::fillToMag( float maglim ) {
     return ( ( maglim < faintMag ) ? true : false );
 }
 
+// Largest region of a trixel that is read ahead in one go
+#define MAX_PREFETCH_BYTES 65536
+
+void StarBlockList::prefetch() {
+    BinFileHelper *dSReader = parent->getStarReader();
+
+    if( staticStars || !dSReader->getFileHandle() )
+        return;
+
+    long start = ( readOffset > 0 ) ? readOffset : dSReader->getOffset( trixel );
+    if( prefetchOffset > start )
+        start = prefetchOffset;
+    long end = dSReader->getOffset( trixel ) + dSReader->getRecordCount( trixel ) * dSReader->guessRecordSize();
+    if( end - start > MAX_PREFETCH_BYTES )
+        end = start + MAX_PREFETCH_BYTES;
+    if( end <= start )
+        return;
+
+    StarBlockFactory::Instance()->getPrefetcher()->request( dSReader->getFilePath(), start, end - start );
+    prefetchOffset = end;
+}
+
 void StarBlockList::setStaticBlock( StarBlock *block ) {
     if( !block )
         return;
@@ -61,6 +61,12 @@ class StarBlockList {
      */
     bool fillToMag( float maglim );
 
+    /**
+     *@short Asks the StarBlockFactory's prefetcher to read the stars of this trixel
+     *that have not been loaded yet, so that a later fillToMag() finds them in memory
+     */
+    void prefetch();
+
     /**
      *@short Sets the first StarBlock in the list to point to the given StarBlock
      *
@@ -115,6 +121,7 @@ class StarBlockList {
     Trixel trixel;
     unsigned long nStars;
     long readOffset;
+    long prefetchOffset;
     float faintMag;
     QList < StarBlock *> blocks;
     unsigned int nBlocks;
@@ -0,0 +1,96 @@
+/***************************************************************************
+              starblockprefetcher.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "starblockprefetcher.h"
+
+#include <QFile>
+#include <QByteArray>
+#include <QMutexLocker>
+
+// Requests beyond this are for parts of the sky we have already moved past
+#define MAX_PENDING_REQUESTS 4096
+
+StarBlockPrefetcher::StarBlockPrefetcher() :
+    m_stop( false )
+{
+    setPriority( QThread::LowPriority );
+}
+
+StarBlockPrefetcher::~StarBlockPrefetcher() {
+    m_mutex.lock();
+    m_stop = true;
+    m_queue.clear();
+    m_requestAdded.wakeOne();
+    m_mutex.unlock();
+    wait();
+}
+
+void StarBlockPrefetcher::request( const QString &fileName, qint64 offset, qint64 length ) {
+    if( length <= 0 )
+        return;
+
+    QMutexLocker locker( &m_mutex );
+    Request r;
+    r.fileName = fileName;
+    r.offset = offset;
+    r.length = length;
+    m_queue.enqueue( r );
+    while( m_queue.size() > MAX_PENDING_REQUESTS )
+        m_queue.dequeue();
+
+    if( !isRunning() )
+        start( QThread::LowPriority );
+    m_requestAdded.wakeOne();
+}
+
+void StarBlockPrefetcher::clear() {
+    QMutexLocker locker( &m_mutex );
+    m_queue.clear();
+}
+
+void StarBlockPrefetcher::run() {
+    QByteArray buffer;
+
+    forever {
+        m_mutex.lock();
+        while( m_queue.isEmpty() && !m_stop )
+            m_requestAdded.wait( &m_mutex );
+        if( m_stop ) {
+            m_mutex.unlock();
+            break;
+        }
+        Request r = m_queue.dequeue();
+        m_mutex.unlock();
+
+        QFile *file = m_files.value( r.fileName, NULL );
+        if( !file ) {
+            file = new QFile( r.fileName );
+            if( !file->open( QIODevice::ReadOnly ) ) {
+                delete file;
+                continue;
+            }
+            m_files.insert( r.fileName, file );
+        }
+
+        buffer.resize( r.length );
+        if( file->seek( r.offset ) )
+            file->read( buffer.data(), r.length );
+    }
+
+    qDeleteAll( m_files );
+    m_files.clear();
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+               starblockprefetcher.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef STARBLOCKPREFETCHER_H
+#define STARBLOCKPREFETCHER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QHash>
+#include <QString>
+
+class QFile;
+
+/**
+ *@class StarBlockPrefetcher
+ *
+ *Reads regions of the deep star catalogs in a background thread, ahead of
+ *the draw loop. The data read is thrown away: the point is to bring it into
+ *the operating system's file cache, so that StarBlockList::fillToMag(), which
+ *still runs in the GUI thread, does not have to wait for the disk when the
+ *map is panned into an area that has not been loaded yet.
+ *
+ *The prefetcher does not touch any StarBlock or StarBlockList, so no locking
+ *is needed anywhere else.
+ *
+ *@short Reads star catalog data ahead of time in a background thread
+ *@version 1.0
+ */
+
+class StarBlockPrefetcher : public QThread {
+
+ public:
+
+    /**
+     *Constructor
+     */
+    StarBlockPrefetcher();
+
+    /**
+     *Destructor
+     *Stops the thread, dropping all pending requests
+     */
+    ~StarBlockPrefetcher();
+
+    /**
+     *@short  Queue a region of a catalog file to be read
+     *
+     *The thread is started on the first request. If too many requests are
+     *pending, the oldest ones are dropped, since they belong to a part of
+     *the sky that we have probably moved away from.
+     *
+     *@param  fileName  Full path of the catalog file
+     *@param  offset    Offset of the region in the file
+     *@param  length    Length of the region in bytes
+     */
+    void request( const QString &fileName, qint64 offset, qint64 length );
+
+    /**
+     *@short  Drop all pending requests
+     */
+    void clear();
+
+ protected:
+
+    void run();
+
+ private:
+
+    struct Request {
+        QString fileName;
+        qint64 offset;
+        qint64 length;
+    };
+
+    QMutex m_mutex;                   // Guards m_queue and m_stop
+    QWaitCondition m_requestAdded;
+    QQueue<Request> m_queue;
+    bool m_stop;
+
+    QHash<QString, QFile *> m_files;  // Files opened by the thread, used only from run()
+};
+
+#endif
@@ -17,11 +17,14 @@
 
 #include "starcomponent.h"
 
+#include <QTime>
+
 #include <kglobal.h>
 
 #include "Options.h"
 #include "kstarsdata.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 #include "skyobjects/starobject.h"
 #include "skyqpainter.h"
 #include "skypainter.h"
@@ -33,6 +36,7 @@
 
 #include "binfilehelper.h"
 #include "starblockfactory.h"
+#include "starhopper.h"
 
 #include "projections/projector.h"
 
@@ -77,7 +81,11 @@ StarComponent::StarComponent(SkyComposite *parent )
 }
 
 StarComponent::~StarComponent() {
-    // Empty
+    // The star hopping graph points to our stars
+    StarHopper::clearCache();
+    // The named stars live in m_StaticBlocks, so ListComponent must not delete them one by one
+    m_ObjectList.clear();
+    qDeleteAll( m_StaticBlocks );
 }
 
 StarComponent *StarComponent::Create( SkyComposite *parent ) {
@@ -167,10 +175,14 @@ void StarComponent::reindexAll( KSNumbers *num )
 
     // re-populate it from the objectList
     int size = m_ObjectList.size();
+    QVector<StarObject*> stars( size );
+    QVector<Trixel> trixels( size );
+    for ( int i = 0; i < size; i++ ) {
+        stars[ i ] = (StarObject*) m_ObjectList[ i ];
+    }
+    m_skyMesh->indexStars( stars.constData(), size, trixels.data() );
     for ( int i = 0; i < size; i++ ) {
-        StarObject* star = (StarObject*) m_ObjectList[ i ];
-        Trixel trixel = m_skyMesh->indexStar( star );
-        m_starIndex->at( trixel )->append( star );
+        m_starIndex->at( trixels[ i ] )->append( stars[ i ] );
     }
 
     // Let everyone else know we have re-indexed to num
@@ -226,8 +238,39 @@ float StarComponent::zoomMagnitudeLimit() {
     return 3.5 + 3.7*( lgz - lgmin ) + 2.222*log10( static_cast<float>(Options::starDensity()) );
 }
 
+void StarComponent::JITupdate( StarObject *const *stars, int n )
+{
+    KStarsData *data = KStarsData::Instance();
+    UpdateID updateID = data->updateID();
+    UpdateID updateNumID = data->updateNumID();
+
+    // The stars of a new epoch are moved at once, the others only turned
+    // to the horizon
+    QVector<StarObject*> moved;
+    QVector<SkyPoint*> turned;
+    for ( int i = 0; i < n; ++i ) {
+        StarObject *star = stars[ i ];
+        if ( star->updateID == updateID ) continue;
+        star->updateID = updateID;
+        if ( star->updateNumID != updateNumID ) {
+            star->updateNumID = updateNumID;
+            moved.append( star );
+        } else
+            turned.append( star );
+    }
+
+    const CoordinatePipeline *pipeline = data->updatePipeline();
+    pipeline->updateStars( moved.constData(), moved.size() );
+    pipeline->updateHorizontal( turned.constData(), turned.size() );
+}
+
 void StarComponent::draw( SkyPainter *skyp )
 {
+    // The labels are kept until the next draw: drawLabels() may be
+    // called again over a cached drawing of the stars
+    for ( int i = 0; i <= MAX_LINENUMBER_MAG; i++ )
+        m_labelList[ i ]->clear();
+
     if( !selected() )
         return;
 
@@ -250,6 +293,7 @@ void StarComponent::draw( SkyPainter *skyp )
 
     double maglim;
     m_zoomMagLimit = maglim = zoomMagnitudeLimit();
+    nearestIndex().setMagLimit( this, maglim );
 
     double labelMagLim = Options::starLabelDensity() / 5.0;
     labelMagLim += ( 12.0 - labelMagLim ) * ( lgz - lgmin) / (lgmax - lgmin );
@@ -281,6 +325,9 @@ void StarComponent::draw( SkyPainter *skyp )
 
     int nTrixels = 0;
 
+    // The stars to draw are gathered first, so that their JIT update is
+    // timed once for the whole loop
+    QVector<StarObject*> drawList;
     while( region.hasNext() ) {
         ++nTrixels;
         Trixel currentRegion = region.next();
@@ -290,23 +337,31 @@ void StarComponent::draw( SkyPainter *skyp )
             if( !curStar )
                 continue;
             
-            if ( curStar->updateID != updateID )
-                curStar->JITupdate( data );
-            
             float mag = curStar->mag();
             
             // break loop if maglim is reached
             if ( mag > maglim || ( hideFaintStars && curStar->mag() > hideStarsMag ) )
                 break;
-                 
-            bool drawn = skyp->drawPointSource( curStar, mag, curStar->spchar() );
 
-            //FIXME_SKYPAINTER: find a better way to do this.
-            if ( drawn && !(m_hideLabels || mag > labelMagLim) )
-                addLabel( proj->toScreen(curStar), curStar );
+            drawList.append( curStar );
         }
     }
 
+    {
+        FrameProfiler::Timer t( "JIT update: stars" );
+        JITupdate( drawList.constData(), drawList.size() );
+    }
+
+    for ( int i = 0; i < drawList.size(); ++i ) {
+        StarObject *curStar = drawList[ i ];
+        float mag = curStar->mag();
+        bool drawn = skyp->drawPointSource( curStar, mag, curStar->spchar() );
+
+        //FIXME_SKYPAINTER: find a better way to do this.
+        if ( drawn && !(m_hideLabels || mag > labelMagLim) )
+            addLabel( proj->toScreen(curStar), curStar );
+    }
+
     // Draw focusStar if not null
     if( focusStar ) {
         if ( focusStar->updateID != updateID )
@@ -346,7 +401,6 @@ void StarComponent::drawLabels()
         for ( int j = 0; j < list->size(); j++ ) {
             labeler->drawNameLabel( list->at(j).obj, list->at(j).o );
         }
-        list->clear();
     }
 
 }
@@ -356,27 +410,29 @@ bool StarComponent::loadStaticData()
     // We break from Qt / KDE API and use traditional file handling here, to obtain speed.
     // We also avoid C++ constructors for the same reason.
     KStarsData* data = KStarsData::Instance();
-    FILE *dataFile, *nameFile;
     bool swapBytes = false;
     BinFileHelper dataReader, nameReader;
     QString name, gname, visibleName;
-    StarObject plainStarTemplate;
     StarObject *star;
+    const char *record, *nameRecord, *nameEnd;
+    QTime t;
 
     if(starsLoaded)
         return true;
 
+    t.start();
+
     // prepare to index stars to this date
     m_skyMesh->setKSNumbers( &m_reindexNum );
         
     /* Open the data files */
     // TODO: Maybe we don't want to hardcode the filename?
-    if((dataFile = dataReader.openFile("namedstars.dat")) == NULL) {
+    if(dataReader.openFile("namedstars.dat") == NULL) {
         kDebug() << "Could not open data file namedstars.dat" << endl;
         return false;
     }
 
-    if(!(nameFile = nameReader.openFile("starnames.dat"))) {
+    if(!nameReader.openFile("starnames.dat")) {
         kDebug() << "Could not open data file starnames.dat" << endl;
         return false;
     }
@@ -390,25 +446,25 @@ bool StarComponent::loadStaticData()
         kDebug() << "Error reading starnames.dat header : " << nameReader.getErrorNumber() << " : " << nameReader.getError() << endl;
         return false;
     }
-    KDE_fseek(nameFile, nameReader.getDataOffset(), SEEK_SET);
+
+    // Both files are walked straight through in memory instead of fread()-ing every record
+    if( !( record = dataReader.mapData() ) || !( nameRecord = nameReader.mapData() ) ) {
+        kDebug() << "Could not map the star data files into memory" << endl;
+        return false;
+    }
+    nameEnd = nameRecord + nameReader.getMappedSize();
     swapBytes = dataReader.getByteSwap();
 
     long int nstars = 0;
 
-    KDE_fseek(dataFile, dataReader.getDataOffset(), SEEK_SET);
-
     qint16 faintmag;
     quint8 htm_level;
-    quint16 t_MSpT;
 
-    fread( &faintmag, 2, 1, dataFile );
+    // The data region begins with the faint magnitude, the HTM level and the (unused) MSpT
+    memcpy( &faintmag, record, 2 );
     if( swapBytes )
         faintmag = bswap_16( faintmag );
-    fread( &htm_level, 1, 1, dataFile );
-    fread( &t_MSpT, 2, 1, dataFile ); // Unused
-    if( swapBytes )
-        faintmag = bswap_16( faintmag );
-
+    htm_level = record[ 2 ];
 
     if( faintmag / 100.0 > m_FaintMagnitude )
         m_FaintMagnitude = faintmag / 100.0;
@@ -419,21 +475,35 @@ bool StarComponent::loadStaticData()
     for(int i = 0; i < m_skyMesh -> size(); ++i) {
 
         Trixel trixel = i;// = ( ( i >= 256 ) ? ( i - 256 ) : ( i + 256 ) );
-        for(unsigned long j = 0; j < (unsigned long)dataReader.getRecordCount(i); ++j) {
-            bool named = false;
-            if(!fread(&stardata, sizeof(starData), 1, dataFile)){
-                kDebug() << "FILE FORMAT ERROR: Could not read starData structure for star #" << j << " under trixel #" << trixel << endl;
+        unsigned int nrecs = dataReader.getRecordCount( i );
+        if( nrecs == 0 )
+            continue;
+
+        // All the stars of a trixel are constructed in one contiguous block
+        StarBlock *SB = new StarBlock( nrecs );
+        m_StaticBlocks.append( SB );
+
+        record = dataReader.getRecordPointer( i );
+        for(unsigned long j = 0; j < nrecs; ++j, record += sizeof( starData )) {
+            const starData *sd = reinterpret_cast<const starData *>( record );
+
+            /* Copy and swap bytes only when required */
+            if( swapBytes || ( reinterpret_cast<quintptr>( record ) & 3 ) ) {
+                memcpy( &stardata, record, sizeof( starData ) );
+                if( swapBytes )
+                    byteSwap( &stardata );
+                sd = &stardata;
             }
 
-            /* Swap Bytes when required */            
-            if(swapBytes)
-                byteSwap( &stardata );
-
-            if(stardata.flags & 0x01) {
-                /* Named Star - Read the nameFile */
+            if(sd->flags & 0x01) {
+                /* Named Star - Read the name record */
                 visibleName = "";
-                if(!fread(&starname, sizeof( starName ), 1, nameFile))
-                    kDebug() << "ERROR: fread() call on nameFile failed in trixel " << trixel << " star " << j << endl;
+                if( nameRecord + sizeof( starName ) > nameEnd ) {
+                    kDebug() << "ERROR: starnames.dat has fewer names than namedstars.dat has named stars" << endl;
+                    break;
+                }
+                memcpy( &starname, nameRecord, sizeof( starName ) );
+                nameRecord += sizeof( starName );
                 name = QByteArray(starname.longName, 32);
                 gname = QByteArray(starname.bayerName, 8);
                 if ( ! gname.isEmpty() && gname.at(0) != '.')
@@ -444,14 +514,16 @@ bool StarComponent::loadStaticData()
                 }
                 else
                     name = i18n("star");
-                named = true;
             }
             else
                 kDebug() << "ERROR: Named star file contains unnamed stars! Expect trouble." << endl;
 
-            /* Create the new StarObject */
-            star = new StarObject;
-            star->init( &stardata );
+            /* Initialize the next StarObject of the block */
+            star = SB->addStar( *sd );
+            if( !star ) {
+                kDebug() << "ERROR: Star block of trixel " << trixel << " is full" << endl;
+                break;
+            }
             star->setNames( name, visibleName );
             star->EquatorialToHorizontal( data->lst(), data->geo()->lat() );
             ++nstars;
@@ -464,8 +536,18 @@ bool StarComponent::loadStaticData()
             if ( ! gname.isEmpty() && gname != name ) {
                 objectNames(SkyObject::STAR).append( star -> gname(false) );
             }
+
+            // Also index the abbreviated Bayer name ("alp CMa") and the HD number
+            if ( name != i18n("star") )
+                nameIndex().insert( name, star );
+            nameIndex().insert( star->name2(), star );
+            if ( ! gname.isEmpty() && gname != name )
+                nameIndex().insert( star->gname(false), star );
+            if ( star->getHDIndex() != 0 )
+                nameIndex().insert( QString( "HD %1" ).arg( star->getHDIndex() ), star );
                 
             m_ObjectList.append( star );
+            nearestIndex().insert( star, this );
                 
             m_starIndex->at( trixel )->append( star );
             double pm = star->pmMagnitude();
@@ -483,6 +565,8 @@ bool StarComponent::loadStaticData()
     dataReader.closeFile();
     nameReader.closeFile();
 
+    kDebug() << "Loaded" << nstars << "named stars in" << t.elapsed() << "ms";
+
     starsLoaded = true;
     return true;
 
@@ -556,47 +640,27 @@ SkyObject *StarComponent::findByHDIndex( int HDnum ) {
     return 0;
 }
 
-// This uses the main star index for looking up nearby stars but then
-// filters out objects with the generic name "star".  We could easily
-// build an index for just the named stars which would make this go
-// much faster still.  -jbb
+// The named stars and the static unnamed stars are found through the
+// NearestIndex of the sky map. Only the stars of the deep star catalogs,
+// which are read from disk as the zoom changes, are looked up here.
 //
 SkyObject* StarComponent::objectNearest( SkyPoint *p, double &maxrad )
 {
     SkyObject *oBest = 0;
-
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
-
-    while ( region.hasNext() ) {
-        Trixel currentRegion = region.next();
-        StarList* starList = m_starIndex->at( currentRegion );
-        for (int i=0; i < starList->size(); ++i) {
-            StarObject* star =  starList->at( i );
-            if( !star ) continue;
-            if ( star->mag() > m_zoomMagLimit ) continue;
-            
-            double r = star->angularDistanceTo( p ).Degrees();
-            if ( r < maxrad ) {
-                oBest = star;
-                maxrad = r;
-            }
-        }
-    }
-
-    // Check up with our Deep Star Components too!
-    double rTry, rBest;
     SkyObject *oTry;
-    rBest = maxrad;
-    rTry  = maxrad;
+    double rTry = maxrad;
+
     for( int i = 0; i < m_DeepStarComponents.size(); ++i ) {
-        oTry = m_DeepStarComponents.at( i )->objectNearest( p, rTry );
-        // TODO: Should we multiply rBest by a factor < 1, so that we give higher priority to named stars?
-        if( rTry < rBest ) {
-            rBest = rTry;
+        DeepStarComponent *component = m_DeepStarComponents.at( i );
+        if( component->hasStaticStars() )
+            continue;
+        oTry = component->objectNearest( p, rTry );
+        // TODO: Should we multiply rTry by a factor < 1, so that we give higher priority to named stars?
+        if( oTry ) {
             oBest = oTry;
+            maxrad = rTry;
         }
     }
-    maxrad = rBest;
 
     return oBest;
 }
@@ -607,9 +671,11 @@ void StarComponent::starsInAperture( QList<StarObject*> &list, const SkyPoint &c
     Q_ASSERT( center.ra0().Degrees() >= 0.0 );
     Q_ASSERT( center.dec0().Degrees() <= 90.0 );
 
-    m_skyMesh->intersect( center.ra0().Degrees(), center.dec0().Degrees(), radius, (BufNum) OBJ_NEAREST_BUF );
+    // Our own buffer, as tools may search while the sky is drawn
+    MeshBuffer result( m_skyMesh );
+    m_skyMesh->intersect( center.ra0().Degrees(), center.dec0().Degrees(), radius, &result );
 
-    MeshIterator region( m_skyMesh, OBJ_NEAREST_BUF );
+    MeshIterator region( &result );
 
     if( maglim < -28 )
         maglim = m_FaintMagnitude;
@@ -632,6 +698,13 @@ void StarComponent::starsInAperture( QList<StarObject*> &list, const SkyPoint &c
     }
 }
 
+void StarComponent::prefetch( const SkyPoint *center, double radius )
+{
+    for( int i =0; i < m_DeepStarComponents.size(); ++i ) {
+        m_DeepStarComponents.at( i )->prefetch( center, radius );
+    }
+}
+
 void StarComponent::byteSwap( starData *stardata ) {
     stardata->RA = bswap_32( stardata->RA );
     stardata->Dec = bswap_32( stardata->Dec );
@@ -87,6 +87,12 @@ public:
 
     static float zoomMagnitudeLimit();
 
+    /**
+     *@short JIT update of many stars at once, through the coordinate
+     *pipeline. The stars already updated in this draw cycle are skipped.
+     */
+    static void JITupdate( StarObject *const *stars, int n );
+
     virtual SkyObject* objectNearest(SkyPoint *p, double &maxrad );
 
     virtual SkyObject* findStarByGenetiveName( const QString name );
@@ -139,6 +145,15 @@ public:
      */
     void starsInAperture( QList<StarObject*> &list, const SkyPoint &center, float radius, float maglim=-29 );
 
+    /**
+     *@short Let the deep star catalogs read ahead the stars around a point
+     * that is expected to become the focus soon, e.g. during a slew.
+     *@p center The expected focus
+     *@p radius The radius of the field of view, in degrees
+     *@see DeepStarComponent::prefetch()
+     */
+    void prefetch( const SkyPoint *center, double radius );
+
 
     // TODO: Make byteSwap a template method and put it in byteorder.h
     // It should ideally handle 32-bit, 16-bit fields and starData and
@@ -186,6 +201,8 @@ private:
 
     StarBlockFactory *m_StarBlockFactory;
 
+    QVector<StarBlock*> m_StaticBlocks;  // Hold the named stars, one block per trixel
+
     QVector<HighPMStarList*> m_highPMStars;
     QHash<QString, SkyObject*> m_genName;
     QHash<int, StarObject*> m_HDHash;
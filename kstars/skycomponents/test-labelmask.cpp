@@ -0,0 +1,243 @@
+/***************************************************************************
+                     test-labelmask.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QVector>
+
+#include "labelmask.h"
+
+
+/******************************************************************************
+ * Test of LabelMask, the virtual screen of SkyLabeler. Random frames of labels
+ * are placed into the mask; no label it accepts may overlap a label accepted
+ * before, and the gaps narrower than the minimum gap must be closed. The same
+ * frames are then placed into the run lists SkyLabeler used before the mask,
+ * and the time taken by each is printed.
+ *****************************************************************************/
+
+typedef LabelMask::Region Region;
+
+static const int WIDTH   = 1280;
+static const int STRIPS  = 90;
+static const int MIN_GAP = 50;      // "MMMMM" in a 10 pt font
+static const int FRAMES  = 100;
+static const int LABELS  = 2000;    // per frame
+static const int PASSES  = 20;
+
+// The run length engine of the old SkyLabeler: a sorted list of the marked
+// runs of each strip, merged when closer than minDeltaX
+struct LabelRun {
+    LabelRun( int s, int e ) : start( s ), end( e ) {}
+    int start;
+    int end;
+};
+
+class RunMask {
+public:
+    RunMask( int minDeltaX ) : m_minDeltaX( minDeltaX ) {}
+    ~RunMask() { clear(); }
+
+    void reset( int strips ) {
+        clear();
+        m_rows.resize( strips );
+    }
+
+    bool mark( const Region &r ) {
+        for ( int y = r.minY; y <= r.maxY; y++ ) {
+            const QList<LabelRun*> &row = m_rows[ y ];
+            for ( int i = 0; i < row.size(); i++ ) {
+                if ( row.at( i )->end < r.minX ) continue;
+                if ( row.at( i )->start > r.maxX ) break;
+                return false;
+            }
+        }
+
+        for ( int y = r.minY; y <= r.maxY; y++ ) {
+            QList<LabelRun*> &row = m_rows[ y ];
+            int i;
+            for ( i = 0; i < row.size(); i++ ) {
+                if ( row.at( i )->end >= r.minX ) break;
+            }
+
+            if ( row.isEmpty() )
+                row.append( new LabelRun( r.minX, r.maxX ) );
+            else if ( i == 0 ) {
+                if ( row.at( 0 )->start - r.maxX < m_minDeltaX )
+                    row.at( 0 )->start = r.minX;
+                else
+                    row.insert( 0, new LabelRun( r.minX, r.maxX ) );
+            }
+            else if ( i == row.size() ) {
+                if ( r.minX - row.at( i-1 )->end < m_minDeltaX )
+                    row.at( i-1 )->end = r.maxX;
+                else
+                    row.append( new LabelRun( r.minX, r.maxX ) );
+            }
+            else {
+                bool mergeHead = ( r.minX - row.at( i-1 )->end < m_minDeltaX );
+                bool mergeTail = ( row.at( i )->start - r.maxX < m_minDeltaX );
+                if ( mergeHead && mergeTail ) {
+                    row.at( i-1 )->end = row.at( i )->end;
+                    delete row.takeAt( i );
+                }
+                else if ( mergeHead )
+                    row.at( i-1 )->end = r.maxX;
+                else if ( mergeTail )
+                    row.at( i )->start = r.minX;
+                else
+                    row.insert( i, new LabelRun( r.minX, r.maxX ) );
+            }
+        }
+        return true;
+    }
+
+private:
+    void clear() {
+        for ( int y = 0; y < m_rows.size(); y++ ) {
+            qDeleteAll( m_rows[ y ] );
+            m_rows[ y ].clear();
+        }
+    }
+
+    QVector< QList<LabelRun*> > m_rows;
+    int m_minDeltaX;
+};
+
+static Region region( int minX, int maxX, int minY, int maxY )
+{
+    Region r;
+    r.minX = minX;
+    r.maxX = maxX;
+    r.minY = minY;
+    r.maxY = maxY;
+    return r;
+}
+
+static bool overlap( const Region &a, const Region &b )
+{
+    return a.minX <= b.maxX && b.minX <= a.maxX && a.minY <= b.maxY && b.minY <= a.maxY;
+}
+
+// A label may not squeeze between two labels closer than the minimum gap,
+// but fits between labels further apart
+static int testGap()
+{
+    int errors = 0;
+    LabelMask mask;
+    mask.reset( WIDTH, STRIPS, MIN_GAP );
+
+    mask.mark( region( 100, 139, 10, 10 ) );
+    mask.mark( region( 160, 199, 10, 10 ) );
+    if ( mask.mark( region( 145, 154, 10, 10 ) ) ) {
+        printf( "A label was placed in a gap narrower than %d pixels\n", MIN_GAP );
+        ++errors;
+    }
+
+    mask.mark( region( 400, 439, 20, 20 ) );
+    mask.mark( region( 600, 639, 20, 20 ) );
+    if ( ! mask.mark( region( 500, 539, 20, 20 ) ) ) {
+        printf( "A label was refused in a gap wider than %d pixels\n", MIN_GAP );
+        ++errors;
+    }
+
+    // Gaps are closed strip by strip only
+    if ( ! mask.mark( region( 145, 154, 11, 11 ) ) ) {
+        printf( "A gap was closed on the wrong strip\n" );
+        ++errors;
+    }
+    return errors;
+}
+
+static QVector<Region> randomFrame()
+{
+    QVector<Region> frame;
+    frame.reserve( LABELS );
+    for ( int i = 0; i < LABELS; ++i ) {
+        int width = 20 + rand() % 100;
+        int height = 1 + rand() % 2;
+        int x = rand() % ( WIDTH - width );
+        int y = rand() % ( STRIPS - height );
+        frame.append( region( x, x + width - 1, y, y + height - 1 ) );
+    }
+    return frame;
+}
+
+int main()
+{
+    srand( 1 );
+    int errors = testGap();
+
+    QList< QVector<Region> > frames;
+    for ( int i = 0; i < FRAMES; ++i )
+        frames.append( randomFrame() );
+
+    // Every label the mask accepts must be free, by brute force
+    LabelMask mask;
+    int placed = 0;
+    foreach ( const QVector<Region> &frame, frames ) {
+        mask.reset( WIDTH, STRIPS, MIN_GAP );
+        QVector<Region> accepted;
+        foreach ( const Region &r, frame ) {
+            if ( ! mask.mark( r ) )
+                continue;
+            foreach ( const Region &a, accepted ) {
+                if ( overlap( a, r ) ) {
+                    ++errors;
+                    break;
+                }
+            }
+            accepted.append( r );
+        }
+        placed += accepted.size();
+    }
+    printf( "%d frames of %d labels, %d placed, %d overlapping\n", FRAMES, LABELS, placed, errors );
+
+    QElapsedTimer timer;
+    RunMask runs( MIN_GAP );
+    int runPlaced = 0;
+    timer.start();
+    for ( int pass = 0; pass < PASSES; ++pass ) {
+        runPlaced = 0;
+        foreach ( const QVector<Region> &frame, frames ) {
+            runs.reset( STRIPS );
+            foreach ( const Region &r, frame )
+                runPlaced += runs.mark( r );
+        }
+    }
+    qint64 runTime = timer.nsecsElapsed();
+
+    int maskPlaced = 0;
+    timer.restart();
+    for ( int pass = 0; pass < PASSES; ++pass ) {
+        maskPlaced = 0;
+        foreach ( const QVector<Region> &frame, frames ) {
+            mask.reset( WIDTH, STRIPS, MIN_GAP );
+            foreach ( const Region &r, frame )
+                maskPlaced += mask.mark( r );
+        }
+    }
+    qint64 maskTime = timer.nsecsElapsed();
+
+    printf( "run lists: %.3f ms per frame, %d labels placed\n", runTime / 1.0e6 / ( PASSES * FRAMES ), runPlaced );
+    printf( "bitmap:    %.3f ms per frame, %d labels placed\n", maskTime / 1.0e6 / ( PASSES * FRAMES ), maskPlaced );
+
+    return errors ? 1 : 0;
+}
@@ -51,6 +51,7 @@
 #include "skyobjects/skyobject.h"
 #include "skyobjects/ksplanetbase.h"
 #include "skycomponents/skymapcomposite.h"
+#include "skycomponents/starcomponent.h"
 #include "widgets/infoboxwidget.h"
 #include "projections/projector.h"
 #include "projections/lambertprojector.h"
@@ -776,6 +777,23 @@ void SkyMap::updateFocus() {
     }
 }
 
+void SkyMap::prefetchStars( double dX, double dY ) {
+    StarComponent *stars = StarComponent::Instance();
+    if ( !stars )
+        return;
+
+    SkyPoint p;
+    if ( Options::useAltAz() ) {
+        p.setAlt( qBound( -90.0, focus()->alt().Degrees() + dY, 90.0 ) );
+        p.setAz( dms( focus()->az().Degrees() + dX ).reduce() );
+        p.HorizontalToEquatorial( data->lst(), data->geo()->lat() );
+    } else {
+        p.set( dms( focus()->ra().Degrees() + dX ).reduce(),
+               dms( qBound( -90.0, focus()->dec().Degrees() + dY, 90.0 ) ) );
+    }
+    stars->prefetch( &p, projector()->fov() );
+}
+
 void SkyMap::slewFocus() {
     //Don't slew if the mouse button is pressed
     //Also, no animated slews if the Manual Clock is active
@@ -803,12 +821,19 @@ void SkyMap::slewFocus() {
             }
             double step  = 0.5;
             double r  = r0;
+
+            //Start reading the stars around the destination while we slew
+            prefetchStars( dX, dY );
+
             while ( r > step ) {
                 //DEBUG
                 kDebug() << step << ": " << r << ": " << r0 << endl;
                 double fX = dX / r;
                 double fY = dY / r;
 
+                //Read ahead the stars a few steps further along the slew
+                prefetchStars( qMin( 4.0*maxstep, r )*fX, qMin( 4.0*maxstep, r )*fY );
+
                 if ( Options::useAltAz() ) {
                     focus()->setAlt( focus()->alt().Degrees() + fY*step );
                     focus()->setAz( dms( focus()->az().Degrees() + fX*step ).reduce() );
@@ -919,6 +944,12 @@ void SkyMap::forceUpdate( bool now )
     
 }
 
+void SkyMap::forceFullUpdate( bool now )
+{
+    dynamic_cast<SkyMapDrawAbstract *>(m_SkyMapDraw)->invalidateCache();
+    forceUpdate( now );
+}
+
 float SkyMap::fov() {
      float diagonalPixels = sqrt(static_cast<double>( width() * width() + height() * height() ));
      return diagonalPixels / ( 2 * Options::zoomFactor() * dms::DegToRad );
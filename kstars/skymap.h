@@ -286,6 +286,14 @@ public slots:
      */
     void forceUpdateNow() { forceUpdate( true ); }
 
+    /**@short Like forceUpdate(), but the cached drawing of the static layers
+     * of the sky (stars, deep-sky objects, lines and grids) is dropped too.
+     * Use it when these layers change in a way the cache cannot see, e.g.
+     * when a catalog is loaded.
+     * @param now if true, paintEvent() is run immediately.  Otherwise, it is added to the event queue
+     */
+    void forceFullUpdate( bool now=false );
+
     /** Toggle visibility of geo infobox */
     void slotToggleGeoBox(bool);
 
@@ -548,6 +556,12 @@ private:
 
     void beginRulerMode( bool starHopRuler ); // TODO: Add docs
 
+    /** Ask the star catalogs to read ahead the stars around the point
+     * displaced from the focus by (dX, dY) degrees, in the current
+     * coordinate system. Used to look ahead along a slew.
+     */
+    void prefetchStars( double dX, double dY );
+
 
 #ifdef HAVE_XPLANET
     /**
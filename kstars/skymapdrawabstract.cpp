@@ -41,6 +41,7 @@
 #include "skycomponents/skylabeler.h"
 #include "skycomponents/skymapcomposite.h"
 #include "skyqpainter.h"
+#include "frameprofiler.h"
 #include "projections/projector.h"
 #include "projections/lambertprojector.h"
 
@@ -56,8 +57,6 @@
 
 SkyMapDrawAbstract::SkyMapDrawAbstract( SkyMap *sm ) : 
     m_KStarsData( KStarsData::Instance() ), m_SkyMap( sm ) {
-    m_fpstime.start();
-    m_framecount = 0;
 }
 
 void SkyMapDrawAbstract::drawOverlays( QPainter& p ) {
@@ -65,7 +64,10 @@ void SkyMapDrawAbstract::drawOverlays( QPainter& p ) {
         return;
 
     //draw labels
-    SkyLabeler::Instance()->draw(p);
+    {
+        FrameProfiler::Timer t( "Labels: paint" );
+        SkyLabeler::Instance()->draw(p);
+    }
 
     //draw FOV symbol
     foreach( FOV* fov, m_KStarsData->getVisibleFOVs() ) {
@@ -83,6 +85,9 @@ void SkyMapDrawAbstract::drawOverlays( QPainter& p ) {
         m_SkyMap->updateAngleRuler();
         drawAngleRuler( p );
     }
+
+    if ( Options::showFrameProfile() )
+        FrameProfiler::Instance()->drawOverlay( p );
 }
 
 void SkyMapDrawAbstract::drawAngleRuler( QPainter &p ) {
@@ -327,14 +332,3 @@ void SkyMapDrawAbstract::exportSkyImage( QPaintDevice *pd ) {
     drawOverlays( p );
     p.end();
 }
-
-void SkyMapDrawAbstract::calculateFPS()
-{
-    if(m_framecount == 25) {
-        float sec = m_fpstime.elapsed()/1000.;
-        // kDebug() << "FPS " << m_framecount/sec;
-        m_framecount = 0;
-        m_fpstime.restart();
-    }
-    ++m_framecount;
-}
@@ -47,8 +47,7 @@ class SkyMapDrawAbstract {
  public:
 
     /**
-     *@short Constructor that sets data and m_SkyMap, and initializes
-     * the FPS counters.
+     *@short Constructor that sets data and m_SkyMap.
      */
     SkyMapDrawAbstract( SkyMap *sm );
 
@@ -67,6 +66,11 @@ class SkyMapDrawAbstract {
     	*/
     void drawOverlays( QPainter& p );
 
+    /**@short Drop any cached drawing of the sky, so that the next full
+     * update draws everything again. Does nothing unless the subclass caches.
+     */
+    virtual void invalidateCache() { }
+
     /**Draw symbols at the position of each Telescope currently being controlled by KStars.
     	*@note The shape of the Telescope symbol is currently a hard-coded bullseye.
     	*@param psky reference to the QPainter on which to draw (this should be the Sky pixmap). 
@@ -130,12 +134,6 @@ class SkyMapDrawAbstract {
 
     KStarsData *m_KStarsData;
     SkyMap *m_SkyMap;
-
-    /** Calculate FPS and dump result to stderr using kDebug */
-    void calculateFPS();
-private:
-    int m_framecount;     // To count FPS
-    QTime m_fpstime;
 };
 
 #endif
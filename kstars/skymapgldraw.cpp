@@ -19,6 +19,7 @@
 #include "skyglpainter.h"
 #include "skymapgldraw.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 
 SkyMapGLDraw::SkyMapGLDraw( SkyMap *sm ) :
@@ -46,8 +47,8 @@ void SkyMapGLDraw::paintEvent( QPaintEvent *event )
 {
     QPainter p;
     p.begin(this);
+    FrameProfiler::Instance()->beginFrame();
     p.beginNativePainting();
-    calculateFPS();
     m_SkyMap->setupProjector();
     makeCurrent();
 
@@ -64,4 +65,5 @@ void SkyMapGLDraw::paintEvent( QPaintEvent *event )
     p.endNativePainting();
     drawOverlays(p);
     p.end();
+    FrameProfiler::Instance()->endFrame();
 }
@@ -18,13 +18,72 @@
 #include "skyqpainter.h"
 #include "skymapqdraw.h"
 #include "skymap.h"
+#include "frameprofiler.h"
+#include "kstarsdata.h"
+#include "colorscheme.h"
+#include "Options.h"
 
-SkyMapQDraw::SkyMapQDraw( SkyMap *sm ) : QWidget( sm ), SkyMapDrawAbstract( sm ) {
+#include <QDataStream>
+
+SkyMapQDraw::SkyMapQDraw( SkyMap *sm ) : QWidget( sm ), SkyMapDrawAbstract( sm ),
+    m_StaticGeneration( 0 ), m_StaticValid( false )
+{
     m_SkyPixmap = new QPixmap( width(), height() );
+    m_StaticPixmap = new QPixmap( width(), height() );
+
+    // Options which are not part of staticLayersKey() (e.g. the sky
+    // culture or the fonts) reach the map through the config dialog
+    connect( Options::self(), SIGNAL( configChanged() ), this, SLOT( invalidateCache() ) );
 }
 
 SkyMapQDraw::~SkyMapQDraw() {
     delete m_SkyPixmap;
+    delete m_StaticPixmap;
+}
+
+void SkyMapQDraw::invalidateCache() {
+    m_StaticValid = false;
+}
+
+QByteArray SkyMapQDraw::staticLayersKey() const {
+    QByteArray key;
+    QDataStream out( &key, QIODevice::WriteOnly );
+
+    out << width() << height() << m_SkyMap->isSlewing();
+
+    SkyPoint *focus = m_SkyMap->focus();
+    out << focus->ra().Degrees() << focus->dec().Degrees()
+        << focus->alt().Degrees() << focus->az().Degrees()
+        << Options::zoomFactor();
+
+    out << m_KStarsData->lst()->Degrees() << double( m_KStarsData->ut().djd() )
+        << m_KStarsData->geo()->lat()->Degrees() << m_KStarsData->geo()->lng()->Degrees();
+
+    // The options read by the static layers. The others take effect
+    // through invalidateCache()
+    out << Options::useAltAz() << Options::projection() << Options::useRefraction()
+        << Options::useAntialias() << Options::hideOnSlew()
+        << Options::showGround() << Options::showHorizon()
+        << Options::showMilkyWay() << Options::fillMilkyWay() << Options::hideMilkyWay()
+        << Options::showGrid() << Options::hideGrid()
+        << Options::showCBounds() << Options::hideCBounds()
+        << Options::showCLines() << Options::hideCLines()
+        << Options::showEquator() << Options::showEcliptic()
+        << Options::showDeepSky() << Options::showMessier() << Options::showMessierImages()
+        << Options::showNGC() << Options::showIC() << Options::showOther()
+        << Options::hideMessier() << Options::hideNGC() << Options::hideIC() << Options::hideOther()
+        << Options::showDeepSkyNames() << Options::showDeepSkyMagnitudes()
+        << Options::deepSkyLabelDensity()
+        << Options::magLimitDrawDeepSky() << Options::magLimitDrawDeepSkyZoomOut()
+        << Options::showCatalog()
+        << Options::showStars() << Options::hideStars() << Options::starDensity()
+        << Options::magLimitHideStar() << Options::magLimitDrawStarZoomOut()
+        << Options::showStarNames() << Options::showStarMagnitudes()
+        << Options::starLabelDensity();
+
+    out << m_KStarsData->colorScheme()->generation();
+
+    return key;
 }
 
 void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
@@ -34,7 +93,6 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     //use update() to trigger this "short" paint event; to force a full "recompute"
     //of the skymap, use forceUpdate().
 
-    calculateFPS();
     if (!m_SkyMap->computeSkymap)
         {
             QPainter p;
@@ -46,18 +104,39 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
             return ; // exit because the pixmap is repainted and that's all what we want
         }
 
+    // Only the full redraws are profiled as frames
+    FrameProfiler::Instance()->beginFrame();
+
     // FIXME: used to to notify infobox about possible change of object coordinates
     // Not elegant at all. Should find better option
     m_SkyMap->showFocusCoords();
     m_SkyMap->setupProjector();
     
+    SkyMapComposite *composite = m_KStarsData->skyComposite();
+
+    // The static layers are drawn again only if something they depend on
+    // has changed, or if the composite was drawn elsewhere since (e.g. for
+    // an export), which left its labels and update IDs for that drawing
+    QByteArray key = staticLayersKey();
+    if ( ! m_StaticValid || key != m_StaticKey || composite->staticGeneration() != m_StaticGeneration ) {
+        SkyQPainter pstatic( this, m_StaticPixmap );
+        pstatic.begin();
+        pstatic.drawSkyBackground();
+        m_StaticValid = composite->drawStatic( &pstatic );
+        pstatic.end();
+
+        m_StaticKey = key;
+        m_StaticGeneration = composite->staticGeneration();
+    }
+
     SkyQPainter psky(this, m_SkyPixmap); 
     //FIXME: we may want to move this into the components.
     psky.begin();
     
-    //Draw all sky elements
-    psky.drawSkyBackground();
-    m_KStarsData->skyComposite()->draw( &psky );
+    //Draw the dynamic sky elements over the static ones
+    psky.drawPixmap( 0, 0, *m_StaticPixmap );
+    if ( m_StaticValid )
+        composite->drawDynamic( &psky );
     //Finish up
     psky.end();
     
@@ -67,6 +146,8 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
     psky2.drawPixmap( 0, 0, *m_SkyPixmap );
     drawOverlays(psky2);
     psky2.end();
+
+    FrameProfiler::Instance()->endFrame();
     
     m_SkyMap->computeSkymap = false;	// use forceUpdate() to compute new skymap else old pixmap will be shown
 
@@ -75,4 +156,7 @@ void SkyMapQDraw::paintEvent( QPaintEvent *event ) {
 void SkyMapQDraw::resizeEvent( QResizeEvent *e ) {
     delete m_SkyPixmap;
     m_SkyPixmap = new QPixmap( width(), height() );
+    delete m_StaticPixmap;
+    m_StaticPixmap = new QPixmap( width(), height() );
+    m_StaticValid = false;
 }
@@ -21,6 +21,7 @@
 #include "skymapdrawabstract.h"
 
 #include<QWidget>
+#include<QByteArray>
 
 /**
  *@short This class draws the SkyMap using native QPainter. It
@@ -44,6 +45,12 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract {
      */
     ~SkyMapQDraw();
 
+ public slots:
+    /**
+     *@short Drop the cached drawing of the static layers
+     */
+    virtual void invalidateCache();
+
  protected:
 
     virtual void paintEvent( QPaintEvent *e );
@@ -51,6 +58,21 @@ class SkyMapQDraw : public QWidget, public SkyMapDrawAbstract {
     virtual void resizeEvent( QResizeEvent *e );
 
     QPixmap *m_SkyPixmap;
+
+ private:
+
+    /**
+     *@return a fingerprint of everything the static layers of the sky
+     *depend on: the size of the map, the focus, the zoom, the time and
+     *location, the options read by the layers and the generation of the
+     *color scheme. The cached static layers are drawn again when it changes.
+     */
+    QByteArray staticLayersKey() const;
+
+    QPixmap *m_StaticPixmap;            // Background and static layers of the sky
+    QByteArray m_StaticKey;             // staticLayersKey() when m_StaticPixmap was drawn
+    unsigned int m_StaticGeneration;    // SkyMapComposite::staticGeneration() after it was drawn
+    bool m_StaticValid;
     
 };
 
@@ -0,0 +1,214 @@
+/***************************************************************************
+                          ksephemeris.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "ksephemeris.h"
+
+#include <math.h>
+
+#include <kdebug.h>
+#include <klocale.h>
+
+#include "ksnumbers.h"
+#include "kstarsdata.h"
+#include "kstarsdatetime.h"
+#include "geolocation.h"
+#include "ksplanetbase.h"
+#include "ksplanet.h"
+
+KSEphemeris::KSEphemeris( const KSPlanetBase *body, const GeoLocation *geo, double span, int order ) :
+    m_geo( geo ),
+    m_span( span > 0 ? span : defaultSpan( body ) ),
+    m_order( qBound( 2, order, int( MAX_ORDER ) ) )
+{
+    m_body = static_cast<KSPlanetBase*>( body->clone() );
+    m_body->clearTrail();
+    m_earth = new KSPlanet( I18N_NOOP( "Earth" ), QString(), QColor( "white" ), 12756.28 /*diameter in km*/ );
+}
+
+KSEphemeris::~KSEphemeris() {
+    clear();
+    delete m_body;
+    delete m_earth;
+}
+
+void KSEphemeris::clear() {
+    qDeleteAll( m_segments );
+    m_segments.clear();
+}
+
+double KSEphemeris::defaultSpan( const KSPlanetBase *body ) {
+    switch ( body->type() ) {
+        case SkyObject::MOON:
+        case SkyObject::COMET:
+        case SkyObject::ASTEROID:
+            return 8.0;
+        default:
+            break;
+    }
+    if ( body->name() == i18n( "Mercury" ) )
+        return 16.0;
+    if ( body->name() == i18n( "Sun" ) || body->name() == i18n( "Venus" ) )
+        return 32.0;
+    if ( body->name() == i18n( "Mars" ) )
+        return 64.0;
+    return 128.0;
+}
+
+SkyPoint KSEphemeris::directPosition( long double jd ) {
+    KSNumbers num( jd );
+    m_earth->findPosition( &num );
+    if ( m_geo ) {
+        KStarsDateTime t( jd );
+        dms LST = m_geo->GSTtoLST( t.gst() );
+        m_body->findPosition( &num, m_geo->lat(), &LST, m_earth );
+    } else {
+        m_body->findPosition( &num, 0, 0, m_earth );
+    }
+    // findPosition() appends to the trail of bodies which have one
+    if ( m_body->hasTrail() )
+        m_body->clearTrail();
+    return SkyPoint( m_body->ra(), m_body->dec() );
+}
+
+SkyPoint KSEphemeris::geocentricPosition( long double jd, double *rearth ) {
+    KSNumbers num( jd );
+    m_earth->findPosition( &num );
+    m_body->findPosition( &num, 0, 0, m_earth );
+    if ( m_body->hasTrail() )
+        m_body->clearTrail();
+    *rearth = m_body->rearth();
+    return SkyPoint( m_body->ra(), m_body->dec() );
+}
+
+void KSEphemeris::localize( SkyPoint *p, double rearth, long double jd ) const {
+    KStarsDateTime t( jd );
+    dms LST = m_geo->GSTtoLST( t.gst() );
+
+    double rsinp, rcosp, u, sinHA, cosHA, sinDec, cosDec, D;
+    double r = rearth * AU_KM; //distance from Earth, in km
+    u = atan( 0.996647*tan( m_geo->lat()->radians() ) );
+    rsinp = 0.996647*sin( u );
+    rcosp = cos( u );
+    dms HA( LST.Degrees() - p->ra().Degrees() );
+    HA.SinCos( sinHA, cosHA );
+    p->dec().SinCos( sinDec, cosDec );
+
+    D = atan2( rcosp*sinHA, r*cosDec/6378.14 - rcosp*cosHA );
+    dms ra;
+    ra.setRadians( p->ra().radians() - D );
+    p->setRA( ra );
+
+    double cosHA2 = cos( dms( LST.Degrees() - p->ra().Degrees() ).radians() );
+    dms dec;
+    dec.setRadians( atan( cosHA2*( r*sinDec/6378.14 - rsinp )/( r*cosDec*cosHA/6378.14 - rcosp ) ) );
+    p->setDec( dec );
+}
+
+const KSEphemeris::Segment *KSEphemeris::segment( qint64 index ) {
+    QHash<qint64, Segment*>::const_iterator it = m_segments.constFind( index );
+    if ( it != m_segments.constEnd() )
+        return it.value();
+
+    // Keep the memory bounded for very long searches
+    if ( m_segments.size() >= MAX_SEGMENTS )
+        clear();
+
+    // Sample the body at the Chebyshev nodes of the span
+    const int n = m_order + 1;
+    const long double mid  = ( index + 0.5L ) * m_span;
+    const double      half = 0.5 * m_span;
+    double f[4][ MAX_ORDER + 1 ];
+    for ( int k = 0; k < n; ++k ) {
+        double x = cos( dms::PI * ( k + 0.5 ) / n );
+        SkyPoint p = geocentricPosition( mid + half * x, &f[3][k] );
+        double sinRA, cosRA, sinDec, cosDec;
+        p.ra().SinCos( sinRA, cosRA );
+        p.dec().SinCos( sinDec, cosDec );
+        f[0][k] = cosDec * cosRA;
+        f[1][k] = cosDec * sinRA;
+        f[2][k] = sinDec;
+    }
+
+    // c_j = 2/n * sum_k f(x_k) T_j(x_k)
+    Segment *s = new Segment;
+    for ( int j = 0; j < n; ++j ) {
+        double c[4] = { 0.0, 0.0, 0.0, 0.0 };
+        for ( int k = 0; k < n; ++k ) {
+            double Tj = cos( dms::PI * j * ( k + 0.5 ) / n );
+            for ( int i = 0; i < 4; ++i )
+                c[i] += f[i][k] * Tj;
+        }
+        for ( int i = 0; i < 4; ++i )
+            s->coeff[i][j] = 2.0 * c[i] / n;
+    }
+
+    m_segments.insert( index, s );
+    return s;
+}
+
+SkyPoint KSEphemeris::position( long double jd ) {
+    qint64 index = qint64( floorl( jd / m_span ) );
+    const Segment *s = segment( index );
+
+    // Reduce the date to [-1, 1] in the span and use Clenshaw's recurrence
+    const double x = double( ( jd - ( index + 0.5L ) * m_span ) / ( 0.5L * m_span ) );
+    double v[4];
+    for ( int i = 0; i < 4; ++i ) {
+        const double *c = s->coeff[i];
+        double b1 = 0.0, b2 = 0.0;
+        for ( int j = m_order; j >= 1; --j ) {
+            double b0 = 2.0 * x * b1 - b2 + c[j];
+            b2 = b1;
+            b1 = b0;
+        }
+        v[i] = x * b1 - b2 + 0.5 * c[0];
+    }
+
+    SkyPoint p;
+    double ra = atan2( v[1], v[0] );
+    if ( ra < 0.0 )
+        ra += 2.0 * dms::PI;
+    p.setRA( ra * 12.0 / dms::PI );
+    p.setDec( atan2( v[2], sqrt( v[0]*v[0] + v[1]*v[1] ) ) / dms::DegToRad );
+    if ( m_geo )
+        localize( &p, v[3], jd );
+    return p;
+}
+
+double KSEphemeris::selfTest( long double startJD, long double stopJD, int nSamples ) {
+    if ( nSamples < 1 )
+        return 0.0;
+
+    double maxError = 0.0;
+    long double worstJD = startJD;
+    // Spread the samples with an irrational offset so that they do not fall on the nodes
+    const long double step = ( stopJD - startJD ) / nSamples;
+    for ( int i = 0; i < nSamples; ++i ) {
+        long double jd = startJD + step * ( i + 0.381966L );
+        SkyPoint cached = position( jd );
+        SkyPoint direct = directPosition( jd );
+        double error = cached.angularDistanceTo( &direct ).Degrees() * 3600.0;
+        if ( error > maxError ) {
+            maxError = error;
+            worstJD  = jd;
+        }
+    }
+
+    kDebug() << "Ephemeris of" << m_body->name() << "with spans of" << m_span << "days and order" << m_order
+             << ": largest error" << maxError << "arcsec at JD" << double( worstJD );
+    return maxError;
+}
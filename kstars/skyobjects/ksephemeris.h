@@ -0,0 +1,146 @@
+/***************************************************************************
+                          ksephemeris.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef KSEPHEMERIS_H_
+#define KSEPHEMERIS_H_
+
+#include <QHash>
+
+#include "skypoint.h"
+
+class KSPlanet;
+class KSPlanetBase;
+class GeoLocation;
+
+/**
+ *@class KSEphemeris
+ *
+ *Caches the apparent position of a solar system body as Chebyshev
+ *polynomials fitted over consecutive time spans.
+ *
+ *Computing the position of a planet with the VSOP87 series (or of the
+ *Moon with the Meeus series) is expensive, and the tools which search
+ *for events over long time ranges need it for thousands of dates. The
+ *ephemeris samples the body at the Chebyshev nodes of each span the
+ *first time the span is needed, using the usual KSPlanetBase code, and
+ *then evaluates the polynomials for any date in the span.
+ *
+ *The geocentric direction of the body is fitted as a unit vector, which
+ *is smooth across the 0h/24h boundary of right ascension and at the
+ *poles, together with its distance. The correction for the position of
+ *the observer on the Earth is applied after the interpolation, so that
+ *the daily parallax of the Moon does not limit the length of the spans.
+ *
+ *Fitting a span costs order+1 full positions: the ephemeris only saves
+ *time when many more positions than that are asked for in each span.
+ *
+ *@short Chebyshev interpolated positions of a solar system body
+ *@author KStars Developers
+ *@version 1.0
+ */
+class KSEphemeris {
+public:
+    /**
+     *@short Constructor
+     *@param body The body to follow. A private copy is made, so the body
+     * itself is never modified by the ephemeris.
+     *@param geo If not NULL, positions are topocentric for this location
+     * (as given by KSPlanetBase::findPosition() with a latitude and LST),
+     * otherwise they are geocentric.
+     *@param span The length of the interval covered by each polynomial, in
+     * days. If zero or negative, defaultSpan() is used.
+     *@param order The degree of the polynomials, at most MAX_ORDER
+     */
+    explicit KSEphemeris( const KSPlanetBase *body, const GeoLocation *geo=0, double span=0, int order=12 );
+
+    ~KSEphemeris();
+
+    /**
+     *@return the position of the body at the given Julian Day,
+     * interpolated from the cached polynomials
+     */
+    SkyPoint position( long double jd );
+
+    /**
+     *@return the position of the body at the given Julian Day computed
+     * directly by the full theory of the body
+     */
+    SkyPoint directPosition( long double jd );
+
+    /**
+     *@short Check the accuracy of the interpolated positions.
+     *
+     * Compares position() with directPosition() at nSamples dates spread
+     * over the given range, offset from the Chebyshev nodes. Used by
+     * test-ksephemeris.
+     *@return the largest angular error found, in arcseconds
+     */
+    double selfTest( long double startJD, long double stopJD, int nSamples=100 );
+
+    /**@short Forget all the fitted polynomials */
+    void clear();
+
+    /**@return the span of each polynomial, in days */
+    inline double span() const { return m_span; }
+
+    /**@return the degree of the polynomials */
+    inline int order() const { return m_order; }
+
+    /**
+     *@return the longest span over which polynomials of degree 12 follow
+     * the body within a small fraction of an arcsecond: eight days for the
+     * Moon, the comets and the asteroids, two weeks to a month for the inner
+     * planets and the Sun, two months for Mars and four for the outer planets
+     */
+    static double defaultSpan( const KSPlanetBase *body );
+
+    enum { MAX_ORDER = 20 };
+
+private:
+    Q_DISABLE_COPY( KSEphemeris )
+
+    /** Coefficients of the polynomials fitting x, y, z and the distance over a span */
+    struct Segment {
+        double coeff[4][ MAX_ORDER + 1 ];
+    };
+
+    /** @return the segment with the given index, fitting it if needed */
+    const Segment *segment( qint64 index );
+
+    /**
+     *@short Compute the geocentric position of the body with the full theory
+     *@param rearth The distance of the body to the Earth is returned here, in AU
+     */
+    SkyPoint geocentricPosition( long double jd, double *rearth );
+
+    /**
+     *@short Move a geocentric position to the location of the observer,
+     * with the same correction as KSPlanetBase::localizeCoords()
+     */
+    void localize( SkyPoint *p, double rearth, long double jd ) const;
+
+    KSPlanetBase *m_body;
+    KSPlanet *m_earth;
+    const GeoLocation *m_geo;
+    double m_span;
+    int m_order;
+    QHash<qint64, Segment*> m_segments;
+
+    static const int MAX_SEGMENTS = 4096;
+};
+
+#endif
@@ -20,105 +20,161 @@
 #include <math.h>
 
 #include <QFile>
-#include <QTextStream>
 
 #include <kdebug.h>
 #include <kglobal.h>
 
 #include "ksnumbers.h"
 #include "ksutils.h"
-#include "ksfilereader.h"
 
 KSPlanet::OrbitDataManager KSPlanet::odm;
 
+double KSPlanet::OrbitSeries::sum( double T ) const {
+    const double *a = A.constData();
+    const double *b = B.constData();
+    const double *c = C.constData();
+    const int n = A.size();
+    double s = 0.0;
+    for ( int j = 0; j < n; ++j )
+        s += a[j] * cos( b[j] + c[j]*T );
+    return s;
+}
+
+void KSPlanet::OrbitSeries::sum( const double *T, int n, double *out ) const {
+    const int nterms = A.size();
+    for ( int j = 0; j < nterms; ++j ) {
+        const double a = A[j], b = B[j], c = C[j];
+        for ( int k = 0; k < n; ++k )
+            out[k] += a * cos( b + c*T[k] );
+    }
+}
+
 KSPlanet::OrbitDataColl::OrbitDataColl() {
 }
 
+double KSPlanet::OrbitDataColl::evaluate( const OBArray &series, double T ) {
+    // Horner's scheme for sum[0] + sum[1]*T + ... + sum[5]*T^5
+    double result = 0.0;
+    for ( int i = 5; i >= 0; --i )
+        result = result * T + series[i].sum( T );
+    return result;
+}
+
+void KSPlanet::OrbitDataColl::evaluate( const OBArray &series, const double *T, int n, double *out ) {
+    for ( int k = 0; k < n; ++k )
+        out[k] = 0.0;
+    for ( int i = 5; i >= 0; --i ) {
+        for ( int k = 0; k < n; ++k )
+            out[k] *= T[k];
+        series[i].sum( T, n, out );
+    }
+}
+
 KSPlanet::OrbitDataManager::OrbitDataManager() {
     //EMPTY
 }
 
-bool KSPlanet::OrbitDataManager::readOrbitData(const QString &fname,
-        QVector<OrbitData> *vector)
+KSPlanet::OrbitDataManager::~OrbitDataManager() {
+    qDeleteAll( hash );
+}
+
+bool KSPlanet::OrbitDataManager::readOrbitData( const QString &fname, OrbitSeries *series )
 {
     QFile f;
 
-    if ( KSUtils::openDataFile( f, fname ) ) {
-        KSFileReader fileReader( f ); // close file is included
-        QStringList  fields;
-        while ( fileReader.hasMoreLines() ) {
-            fields = fileReader.readLine().split( ' ', QString::SkipEmptyParts );
-
-            if ( fields.size() == 3 ) {
-                double A = fields[0].toDouble();
-                double B = fields[1].toDouble();
-                double C = fields[2].toDouble();
-                vector->append( OrbitData(A, B, C) );
-            }
-        }
-    } else {
+    if ( ! KSUtils::openDataFile( f, fname ) )
         return false;
+
+    // Read the whole file at once and tokenize it in place. Each line holds
+    // the three values A, B and C separated by blanks.
+    const QByteArray buffer = f.readAll();
+    f.close();
+    const char *p   = buffer.constData();
+    const char *end = p + buffer.size();
+    double values[3];
+    int nvalues = 0;
+    bool ok = true;
+
+    while ( p < end ) {
+        while ( p < end && ( *p == ' ' || *p == '\t' || *p == '\r' ) )
+            ++p;
+        if ( p == end || *p == '\n' ) {
+            // End of line: keep the term only if it is complete, like the old reader did
+            if ( nvalues == 3 && ok )
+                series->append( values[0], values[1], values[2] );
+            nvalues = 0;
+            ok = true;
+            ++p;
+            continue;
+        }
+        const char *token = p;
+        while ( p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n' )
+            ++p;
+        bool tokenOk;
+        double v = QByteArray::fromRawData( token, p - token ).toDouble( &tokenOk );
+        if ( nvalues < 3 )
+            values[ nvalues ] = v;
+        ok = ok && tokenOk;
+        ++nvalues;
     }
+    if ( nvalues == 3 && ok )
+        series->append( values[0], values[1], values[2] );
+
     return true;
 }
 
-bool KSPlanet::OrbitDataManager::loadData( KSPlanet::OrbitDataColl &odc, const QString &n ) {
-    QString fname, snum, line;
-    QFile f;
+const KSPlanet::OrbitDataColl* KSPlanet::OrbitDataManager::loadData( const QString &n ) {
+    QString fname, snum;
     int nCount = 0;
     QString nl = n.toLower();
 
-    if ( hash.contains( nl ) ) {
-        odc = hash[nl];
-        return true;  //orbit data already loaded
-    }
+    QHash<QString, OrbitDataColl*>::const_iterator it = hash.constFind( nl );
+    if ( it != hash.constEnd() )
+        return it.value();  //orbit data already loaded
 
     //Create a new OrbitDataColl
-    OrbitDataColl ret;
+    OrbitDataColl *ret = new OrbitDataColl;
 
     //Ecliptic Longitude
     for (int i=0; i<6; ++i) {
         snum.setNum( i );
         fname = nl + ".L" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Lon[i] ) )
+        if ( readOrbitData( fname, &ret->Lon[i] ) )
             nCount++;
     }
 
-    if ( nCount==0 ) return false;
+    if ( nCount==0 ) { delete ret; return 0; }
 
     //Ecliptic Latitude
     for (int i=0; i<6; ++i) {
         snum.setNum( i );
         fname = nl + ".B" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Lat[i] ) )
+        if ( readOrbitData( fname, &ret->Lat[i] ) )
             nCount++;
     }
 
-    if ( nCount==0 ) return false;
-
     //Heliocentric Distance
     for (int i=0; i<6; ++i) {
         snum.setNum( i );
         fname = nl + ".R" + snum + ".vsop";
-        if ( readOrbitData( fname, &ret.Dst[i] ) )
+        if ( readOrbitData( fname, &ret->Dst[i] ) )
             nCount++;
     }
 
-    if ( nCount==0 ) return false;
-
-    hash[nl] = ret;
-    odc = hash[nl];
-
-    return true;
+    hash.insert( nl, ret );
+    return ret;
 }
 
 KSPlanet::KSPlanet( const QString &s, const QString &imfile, const QColor & c, double pSize ) :
     KSPlanetBase(s, imfile, c, pSize ),
-    data_loaded(false)
+    data_loaded(false),
+    m_orbitData(0)
 { }
 
 KSPlanet::KSPlanet( int n ) 
-    : KSPlanetBase()
+    : KSPlanetBase(),
+      data_loaded(false),
+      m_orbitData(0)
 {
     switch ( n ) {
         case MERCURY:
@@ -173,23 +229,20 @@ QString KSPlanet::untranslatedName() const {
         return name();
 }
 
-//we don't need the reference to the ODC, so just give it a junk variable
 bool KSPlanet::loadData() {
-    OrbitDataColl odc;
-    return odm.loadData( odc, untranslatedName() );
+    return orbitData() != 0;
 }
 
-void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const {
-    double sum[6];
-    OrbitDataColl odc;
-    double Tpow[6];
-
-    Tpow[0] = 1.0;
-    for (int i=1; i<6; ++i) {
-        Tpow[i] = Tpow[i-1] * Tau;
-    }
+const KSPlanet::OrbitDataColl* KSPlanet::orbitData() const {
+    // Avoid looking up the name in the OrbitDataManager for every position
+    if ( ! m_orbitData )
+        m_orbitData = odm.loadData( untranslatedName() );
+    return m_orbitData;
+}
 
-    if ( ! odm.loadData( odc, untranslatedName() ) ) {
+void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const {
+    const OrbitDataColl *odc = orbitData();
+    if ( ! odc ) {
         epret.longitude = dms(0.0);
         epret.latitude  = dms(0.0);
         epret.radius    = 0.0;
@@ -198,51 +251,41 @@ void KSPlanet::calcEcliptic(double Tau, EclipticPosition &epret) const {
     }
 
     //Ecliptic Longitude
-    for (int i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Lon[i].size(); ++j) {
-            sum[i] += odc.Lon[i][j].A * cos( odc.Lon[i][j].B + odc.Lon[i][j].C*Tau );
-            /*
-            kDebug() << "sum[" << i <<"] =" << sum[i] <<
-            	" A = " << odc.Lon[i][j].A << " B = " << odc.Lon[i][j].B <<
-            	" C = " << odc.Lon[i][j].C << endl;
-            	*/
-        }
-        sum[i] *= Tpow[i];
-        //kDebug() << name() << " : sum[" << i << "] = " << sum[i];
-    }
-
-    epret.longitude.setRadians( sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5] );
+    epret.longitude.setRadians( OrbitDataColl::evaluate( odc->Lon, Tau ) );
     epret.longitude.setD( epret.longitude.reduce().Degrees() );
 
     //Compute Ecliptic Latitude
-    for (uint i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Lat[i].size(); ++j) {
-            sum[i] += odc.Lat[i][j].A * cos( odc.Lat[i][j].B + odc.Lat[i][j].C*Tau );
-        }
-        sum[i] *= Tpow[i];
-    }
-
-
-    epret.latitude.setRadians( sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5] );
+    epret.latitude.setRadians( OrbitDataColl::evaluate( odc->Lat, Tau ) );
 
     //Compute Heliocentric Distance
-    for (uint i=0; i<6; ++i) {
-        sum[i] = 0.0;
-        for (int j = 0; j < odc.Dst[i].size(); ++j) {
-            sum[i] += odc.Dst[i][j].A * cos( odc.Dst[i][j].B + odc.Dst[i][j].C*Tau );
-        }
-        sum[i] *= Tpow[i];
+    epret.radius = OrbitDataColl::evaluate( odc->Dst, Tau );
+}
+
+void KSPlanet::calcEcliptic( const double *jm, int n, EclipticPosition *ret ) const {
+    const OrbitDataColl *odc = orbitData();
+    if ( ! odc ) {
+        for ( int k = 0; k < n; ++k )
+            ret[k] = EclipticPosition();
+        kError() << "Could not get data for '" << name() << "'" << endl;
+        return;
     }
 
-    epret.radius = sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5];
+    QVector<double> sums( n );
+    double *s = sums.data();
+
+    OrbitDataColl::evaluate( odc->Lon, jm, n, s );
+    for ( int k = 0; k < n; ++k ) {
+        ret[k].longitude.setRadians( s[k] );
+        ret[k].longitude.setD( ret[k].longitude.reduce().Degrees() );
+    }
 
-    /*
-    kDebug() << name() << " pre: Lat = " << epret.latitude.toDMSString() << " Long = " <<
-    	epret.longitude.toDMSString() << " Dist = " << epret.radius << endl;
-    */
+    OrbitDataColl::evaluate( odc->Lat, jm, n, s );
+    for ( int k = 0; k < n; ++k )
+        ret[k].latitude.setRadians( s[k] );
 
+    OrbitDataColl::evaluate( odc->Dst, jm, n, s );
+    for ( int k = 0; k < n; ++k )
+        ret[k].radius = s[k];
 }
 
 bool KSPlanet::findGeocentricPosition( const KSNumbers *num, const KSPlanetBase *Earth ) {
@@ -83,6 +83,15 @@ public:
     	*/
     virtual void calcEcliptic(double jm, EclipticPosition &ret) const;
 
+    /**Calculate the heliocentric ecliptic coordinates of the planet for
+    	*many dates at once.  This is much faster than calling calcEcliptic()
+    	*for each date when the planet must be followed over a time range.
+    	*@param jm array of n dates, in Julian Millenia since J2000
+    	*@param n the number of dates
+    	*@param ret array of n positions which receives the results
+    	*/
+    void calcEcliptic( const double *jm, int n, EclipticPosition *ret ) const;
+
 protected:
 
     bool data_loaded;
@@ -95,40 +104,39 @@ protected:
     	*/
     virtual bool findGeocentricPosition( const KSNumbers *num, const KSPlanetBase *Earth=NULL );
 
-    /**@class OrbitData
-    	*This class contains doubles A,B,C which represent a single term in a planet's
-    	*positional expansion sums (each sum-term is A*COS(B+C*T)).
+    /**@class OrbitSeries
+    	*This class contains the terms of one of a planet's positional expansion
+    	*sums (each sum-term is A*COS(B+C*T)).  The A, B and C values of all the
+    	*terms are stored in three contiguous arrays, so that the sum can be
+    	*evaluated in a tight loop.
     	*@author Mark Hollomon
-    	*@version 1.0
+    	*@version 2.0
     	*/
-    class OrbitData  {
+    class OrbitSeries {
     public:
-        /**
-        	*Default constructor
-        	*/
-        OrbitData() : A(0.), B(0.), C(0.) {}
-        /**
-        	*Constructor 
-        	*@param a the A value
-        	*@param b the B value
-        	*@param c the C value
-        	*/
-        OrbitData(double a, double b, double c) : A(a), B(b), C(c) {}
+        /**Append the term a*COS(b+c*T) to the series*/
+        void append( double a, double b, double c ) { A.append( a ); B.append( b ); C.append( c ); }
+
+        /**@return the number of terms in the series*/
+        int size() const { return A.size(); }
 
-        /**
-        	*Assignment operator
+        /**@return the sum of all the terms of the series at time T*/
+        double sum( double T ) const;
+
+        /**Add the sum of all the terms of the series at each of the times T[0..n-1]
+        	*to the corresponding element of out[0..n-1].
         	*/
-        OrbitData operator= ( const OrbitData o ) { return o; }
+        void sum( const double *T, int n, double *out ) const;
 
-        double A, B, C;
+        QVector<double> A, B, C;
     };
 
-    typedef QVector<OrbitData> OBArray[6];
+    typedef OrbitSeries OBArray[6];
 
-    /**OrbitDataColl contains three groups of six QVectors.  Each QVector is a
-    	*list of OrbitData objects, representing a single sum used in computing
-    	*the planet's position.  A set of six of these vectors comprises the large
-    	*"meta-sum" which yields the planet's Longitude, Latitude, or Distance value.
+    /**OrbitDataColl contains three groups of six series.  Each series represents
+    	*a single sum used in computing the planet's position.  A set of six of these
+    	*series comprises the large "meta-sum" which yields the planet's Longitude,
+    	*Latitude, or Distance value.
     	*@author Mark Hollomon
     	*@version 1.0
     	*/
@@ -137,13 +145,23 @@ protected:
         /**Constructor*/
         OrbitDataColl();
 
+        /**@return the value of the meta-sum made of the six series at time T,
+        	*i.e. the sum over i of series[i] * T^i.
+        	*/
+        static double evaluate( const OBArray &series, double T );
+
+        /**Evaluate the meta-sum made of the six series at each of the times
+        	*T[0..n-1] and store the results in out[0..n-1].  The coefficients
+        	*are only traversed once for all the times.
+        	*/
+        static void evaluate( const OBArray &series, const double *T, int n, double *out );
+
         OBArray Lon;
         OBArray Lat;
         OBArray Dst;
     };
 
-
-    /**OrbitDataManager places the OrbitDataColl objects for all planets in a QDict
+    /**OrbitDataManager places the OrbitDataColl objects for all planets in a QHash
     	*indexed by the planets' names.  It also loads the positional data of each planet
     	*from disk.
     	*@author Mark Hollomon
@@ -154,32 +172,41 @@ protected:
         /**Constructor*/
         OrbitDataManager();
 
+        /**Destructor*/
+        ~OrbitDataManager();
+
         /**Load orbital data for a planet from disk.
         	*The data is stored on disk in a series of files named 
         	*"name.[LBR][0...5].vsop", where "L"=Longitude data, "B"=Latitude data,
-        	*and R=Radius data.
+        	*and R=Radius data.  The data of each planet are only read once.
         	*@param n the name of the planet whose data is to be loaded from disk.
-        	*@param odc reference to the OrbitDataColl containing the planet's orbital data.
-        	*@return true if data successfully loaded
+        	*@return pointer to the OrbitDataColl containing the planet's orbital data,
+        	*which remains valid for the lifetime of the program, or NULL if the data
+        	*could not be loaded.
         	*/
-        bool loadData( OrbitDataColl &odc, const QString &n);
+        const OrbitDataColl* loadData( const QString &n );
 
     private:
-        /**Read a single orbital data file from disk into an OrbitData vector.
+        /**Read a single orbital data file from disk into an OrbitSeries.
         *The data files are named "name.[LBR][0...5].vsop", where 
         *"L"=Longitude data, "B"=Latitude data, and R=Radius data.
         *@param fname the filename to be read.
-        *@param vector pointer to the OrbitData vector to be filled with these data.
+        *@param series pointer to the OrbitSeries to be filled with these data.
         */
-        bool readOrbitData(const QString &fname, QVector<KSPlanet::OrbitData> *vector);
+        bool readOrbitData( const QString &fname, OrbitSeries *series );
 
-        QHash<QString, OrbitDataColl> hash;
+        QHash<QString, OrbitDataColl*> hash;
     };
 
     static OrbitDataManager odm;
 
 private:
     virtual void findMagnitude(const KSNumbers*);
+
+    /**@return the orbital data of this planet, which are looked up the first time only*/
+    const OrbitDataColl* orbitData() const;
+
+    mutable const OrbitDataColl *m_orbitData;
 };
 
 #endif
@@ -35,8 +35,7 @@ KSSun* KSSun::clone() const
 }
 
 bool KSSun::loadData() {
-    OrbitDataColl odc;
-    return (odm.loadData(odc, "earth") != 0);
+    return odm.loadData( "earth" ) != 0;
 }
 
 // We don't need to do anything here
@@ -67,57 +66,22 @@ bool KSSun::findGeocentricPosition( const KSNumbers *num, const KSPlanetBase *Ea
         setRearth( Earth->rsun() );
 
     } else {
-        double sum[6];
         dms EarthLong, EarthLat; //heliocentric coords of Earth
-        OrbitDataColl odc;
         double T = num->julianMillenia(); //Julian millenia since J2000
-        double Tpow[6];
 
-        Tpow[0] = 1.0;
-        for (int i=1; i<6; ++i) {
-            Tpow[i] = Tpow[i-1] * T;
-        }
         //First, find heliocentric coordinates
-
-        if ( ! odm.loadData(odc, "earth") ) return false;
+        const OrbitDataColl *odc = odm.loadData( "earth" );
+        if ( ! odc ) return false;
 
         //Ecliptic Longitude
-        for (int i=0; i<6; ++i) {
-            sum[i] = 0.0;
-            for (int j = 0; j < odc.Lon[i].size(); ++j) {
-                sum[i] += odc.Lon[i][j].A * cos( odc.Lon[i][j].B + odc.Lon[i][j].C*T );
-            }
-            sum[i] *= Tpow[i];
-            //kDebug() << name() << " : sum[" << i << "] = " << sum[i];
-        }
-
-        EarthLong.setRadians( sum[0] + sum[1] + sum[2] +
-                              sum[3] + sum[4] + sum[5] );
+        EarthLong.setRadians( OrbitDataColl::evaluate( odc->Lon, T ) );
         EarthLong = EarthLong.reduce();
 
         //Compute Ecliptic Latitude
-        for (int i=0; i<6; ++i) {
-            sum[i] = 0.0;
-            for (int j = 0; j < odc.Lat[i].size(); ++j) {
-                sum[i] += odc.Lat[i][j].A * cos( odc.Lat[i][j].B + odc.Lat[i][j].C*T );
-            }
-            sum[i] *= Tpow[i];
-        }
-
-
-        EarthLat.setRadians( sum[0] + sum[1] + sum[2] + sum[3] +
-                             sum[4] + sum[5] );
+        EarthLat.setRadians( OrbitDataColl::evaluate( odc->Lat, T ) );
 
         //Compute Heliocentric Distance
-        for (int i=0; i<6; ++i) {
-            sum[i] = 0.0;
-            for (int j = 0; j < odc.Dst[i].size(); ++j) {
-                sum[i] += odc.Dst[i][j].A * cos( odc.Dst[i][j].B + odc.Dst[i][j].C*T );
-            }
-            sum[i] *= Tpow[i];
-        }
-
-        ep.radius = sum[0] + sum[1] + sum[2] + sum[3] + sum[4] + sum[5];
+        ep.radius = OrbitDataColl::evaluate( odc->Dst, T );
         setRearth( ep.radius );
 
         setEcLong( (EarthLong + dms(180.0)).reduce() );
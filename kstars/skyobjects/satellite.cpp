@@ -22,9 +22,7 @@
 #include <kdebug.h>
 
 #include "kstarsdata.h"
-#include "ksplanetbase.h"
-#include "skymapcomposite.h"
-#include "kssun.h"
+#include "kstarsdatetime.h"
 #include "Options.h"
 #include "kspopupmenu.h"
 
@@ -644,16 +642,112 @@ void Satellite::init()
     }
 }
 
-void Satellite::updatePos()
+Satellite::Environment::Environment( double julianDay, GeoLocation *geo )
 {
-    KStarsData *data = KStarsData::Instance();
-    sgp4( ( data->clock()->utc().djd() - m_tle_jd ) * MINPD );
+    jd  = julianDay;
+    lat = *geo->lat();
+    lst = geo->GSTtoLST( KStarsDateTime( jd ).gst() );
+
+    // Observer ECI position
+    sinlat = sin( lat.radians() );
+    coslat = cos( lat.radians() );
+    double thetageo = geo->LMST( jd );
+    sintheta = sin( thetageo );
+    costheta = cos( thetageo );
+    double c = 1.0 / sqrt( 1.0 + F * ( F - 2.0 ) * sinlat * sinlat );
+    double sq = ( 1.0 - F ) * ( 1.0 - F ) * c;
+    double achcp = ( RADIUSEARTHKM * c + MEANALT) * coslat;
+    obs_posx = achcp * costheta;
+    obs_posy = achcp * sintheta;
+    obs_posz = ( RADIUSEARTHKM * sq + MEANALT ) * sinlat;
+    obs_posw = sqrt( obs_posx*obs_posx + obs_posy*obs_posy + obs_posz*obs_posz );
+
+    // Find ECI coordinates of the sun
+    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
+
+    mjd  = jd - 2415020.0;
+    year = 1900.0 + mjd / 365.25;
+    T    = ( mjd + deltaET( year ) / ( MINPD * 60.0 ) ) / 36525.0;
+    M    = DEG2RAD * ( Modulus( 358.47583 + Modulus( 35999.04975 * T, 360.0 ) - ( 0.000150 + 0.0000033 * T ) * T*T, 360.0 ) );
+    L    = DEG2RAD * ( Modulus( 279.69668 + Modulus( 36000.76892 * T, 360.0 ) + 0.0003025 * T*T, 360.0 ) );
+    e    = 0.01675104 - ( 0.0000418 + 0.000000126 * T ) * T;
+    C    = DEG2RAD * ( ( 1.919460 - ( 0.004789 + 0.000014 * T ) * T ) *
+           sin( M ) + ( 0.020094 - 0.000100 *  T) *
+           sin( 2 * M ) + 0.000293 * sin( 3 * M ) );
+    O    = DEG2RAD * ( Modulus( 259.18 - 1934.142 * T, 360.0 ) );
+    Lsa  = Modulus( L + C - DEG2RAD * ( 0.00569  -0.00479 * sin( O ) ), TWOPI );
+    nu   = Modulus( M + C, TWOPI);
+    R    = 1.0000002 * ( 1.0 - e*e ) / ( 1.0 + e * cos( nu ) );
+    eps  = DEG2RAD * ( 23.452294 - ( 0.0130125 + ( 0.00000164 - 0.000000503 * T ) * T ) * T + 0.00256 * cos( O ) );
+    R    = AU * R;
+
+    sun_posx = R * cos( Lsa );
+    sun_posy = R * sin( Lsa ) * cos( eps );
+    sun_posz = R * sin( Lsa ) * sin( eps );
+    sun_posw = R;
+
+    findSunAltitude();
+}
+
+Satellite::Environment::Environment( const Environment &e1, const Environment &e2, double julianDay )
+{
+    double f = ( e2.jd > e1.jd ) ? ( julianDay - e1.jd ) / ( e2.jd - e1.jd ) : 0.0;
+    jd  = julianDay;
+    lat = e1.lat;
+
+    // The sidereal time grows linearly; take the short way across 0h
+    double dlst = e2.lst.Degrees() - e1.lst.Degrees();
+    dlst -= 360.0 * floor( ( dlst + 180.0 ) / 360.0 );
+    lst = dms( e1.lst.Degrees() + f * dlst ).reduce();
+
+    // Observer ECI position: rotate the one of e1 around the axis of the Earth
+    sinlat = e1.sinlat;
+    coslat = e1.coslat;
+    double dtheta = atan2( e1.costheta * e2.sintheta - e1.sintheta * e2.costheta,
+                           e1.costheta * e2.costheta + e1.sintheta * e2.sintheta );
+    double sinf = sin( f * dtheta ), cosf = cos( f * dtheta );
+    sintheta = e1.sintheta * cosf + e1.costheta * sinf;
+    costheta = e1.costheta * cosf - e1.sintheta * sinf;
+    double achcp = sqrt( e1.obs_posx*e1.obs_posx + e1.obs_posy*e1.obs_posy );
+    obs_posx = achcp * costheta;
+    obs_posy = achcp * sintheta;
+    obs_posz = e1.obs_posz;
+    obs_posw = e1.obs_posw;
+
+    // ECI coordinates of the sun
+    sun_posx = e1.sun_posx + f * ( e2.sun_posx - e1.sun_posx );
+    sun_posy = e1.sun_posy + f * ( e2.sun_posy - e1.sun_posy );
+    sun_posz = e1.sun_posz + f * ( e2.sun_posz - e1.sun_posz );
+    sun_posw = e1.sun_posw + f * ( e2.sun_posw - e1.sun_posw );
+
+    findSunAltitude();
+}
+
+void Satellite::Environment::findSunAltitude()
+{
+    // Altitude of the sun seen by the observer
+    double top_z = coslat*costheta*( sun_posx - obs_posx ) + coslat*sintheta*( sun_posy - obs_posy ) + sinlat*( sun_posz - obs_posz );
+    sunAlt = arcSin( top_z / sun_posw ) / DEG2RAD;
 }
 
-int Satellite::sgp4( double tsince )
+Satellite::Environment Satellite::currentEnvironment()
 {
     KStarsData *data = KStarsData::Instance();
-    
+    return Environment( data->clock()->utc().djd(), data->geo() );
+}
+
+void Satellite::updatePos()
+{
+    updatePos( currentEnvironment() );
+}
+
+bool Satellite::updatePos( const Environment &env )
+{
+    return sgp4( ( env.jd - m_tle_jd ) * MINPD, env ) == 0;
+}
+
+int Satellite::sgp4( double tsince, const Environment &env )
+{
     int ktr;
     double am   , axnl  , aynl , betal ,  cosim , cnod  ,
            cos2u, coseo1, cosi , cosip ,  cosisq, cossu , cosu,
@@ -668,14 +762,12 @@ int Satellite::sgp4( double tsince )
            xmdf , xmx   , xmy  , nodedf, xnode  , nodep , tc  ,
            sat_posx, sat_posy , sat_posz, sat_posw, sat_velx ,
            sat_vely  , sat_velz , sinlat, obs_posx, obs_posy,
-           obs_posz, obs_posw, obs_velx, obs_vely, obs_velz,
-           coslat, thetageo, sintheta, costheta, c, sq, achcp,
+           obs_posz, obs_posw,
+           coslat, sintheta, costheta,
            vkmpersec;
 
     const double temp4 =   1.5e-12;
 
-    double jul_utc = data->clock()->utc().djd();
-
     vkmpersec = RADIUSEARTHKM * XKE / 60.0;
 
     // Update for secular gravity and atmospheric drag
@@ -1062,22 +1154,15 @@ int Satellite::sgp4( double tsince )
         return( 6 );
     }
 
-    // Observer ECI position and velocity
-    sinlat = sin( data->geo()->lat()->radians() );
-    coslat = cos( data->geo()->lat()->radians() );
-    thetageo = data->geo()->LMST( jul_utc );
-    sintheta = sin( thetageo );
-    costheta = cos( thetageo );
-    c = 1.0 / sqrt( 1.0 + F * ( F - 2.0 ) * sinlat * sinlat );
-    sq = ( 1.0 - F ) * ( 1.0 - F ) * c;
-    achcp = ( RADIUSEARTHKM * c + MEANALT) * coslat;
-    obs_posx = achcp * costheta;
-    obs_posy = achcp * sintheta;
-    obs_posz = ( RADIUSEARTHKM * sq + MEANALT ) * sinlat;
-    obs_posw = sqrt( obs_posx*obs_posx + obs_posy*sat_posy + obs_posz*obs_posz );
-    obs_velx = -MFACTOR * obs_posy;
-    obs_vely = MFACTOR * obs_posx;
-    obs_velz = 0.;
+    // Observer ECI position
+    sinlat   = env.sinlat;
+    coslat   = env.coslat;
+    sintheta = env.sintheta;
+    costheta = env.costheta;
+    obs_posx = env.obs_posx;
+    obs_posy = env.obs_posy;
+    obs_posz = env.obs_posz;
+    obs_posw = env.obs_posw;
 
     m_altitude = sat_posw - obs_posw + MEANALT;
 
@@ -1106,32 +1191,14 @@ int Satellite::sgp4( double tsince )
 
     setAz( azimut / DEG2RAD );
     setAlt( elevation / DEG2RAD );
-    HorizontalToEquatorial( data->lst(), data->geo()->lat() );
+    HorizontalToEquatorial( &env.lst, &env.lat );
 
     // is the satellite visible ?
-    // Find ECI coordinates of the sun
-    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
-
-    mjd  = jul_utc - 2415020.0;
-    year = 1900.0 + mjd / 365.25;
-    T    = ( mjd + deltaET( year ) / ( MINPD * 60.0 ) ) / 36525.0;
-    M    = DEG2RAD * ( Modulus( 358.47583 + Modulus( 35999.04975 * T, 360.0 ) - ( 0.000150 + 0.0000033 * T ) * T*T, 360.0 ) );
-    L    = DEG2RAD * ( Modulus( 279.69668 + Modulus( 36000.76892 * T, 360.0 ) + 0.0003025 * T*T, 360.0 ) );
-    e    = 0.01675104 - ( 0.0000418 + 0.000000126 * T ) * T;
-    C    = DEG2RAD * ( ( 1.919460 - ( 0.004789 + 0.000014 * T ) * T ) *
-           sin( M ) + ( 0.020094 - 0.000100 *  T) *
-           sin( 2 * M ) + 0.000293 * sin( 3 * M ) );
-    O    = DEG2RAD * ( Modulus( 259.18 - 1934.142 * T, 360.0 ) );
-    Lsa  = Modulus( L + C - DEG2RAD * ( 0.00569  -0.00479 * sin( O ) ), TWOPI );
-    nu   = Modulus( M + C, TWOPI);
-    R    = 1.0000002 * ( 1.0 - e*e ) / ( 1.0 + e * cos( nu ) );
-    eps  = DEG2RAD * ( 23.452294 - ( 0.0130125 + ( 0.00000164 - 0.000000503 * T ) * T ) * T + 0.00256 * cos( O ) );
-    R    = AU * R;
-
-    double sun_posx = R * cos( Lsa );
-    double sun_posy = R * sin( Lsa ) * cos( eps );
-    double sun_posz = R * sin( Lsa ) * sin( eps );
-    double sun_posw = R;
+    // ECI coordinates of the sun
+    double sun_posx = env.sun_posx;
+    double sun_posy = env.sun_posy;
+    double sun_posz = env.sun_posz;
+    double sun_posw = env.sun_posw;
 
     // Calculates satellite's eclipse status and depth
     double sd_sun, sd_earth, delta, depth;
@@ -1149,10 +1216,9 @@ int Satellite::sgp4( double tsince )
     double earth_w = sat_posw;
     delta = PIO2 - arcSin( ( sun_posx*earth_x + sun_posy*earth_y + sun_posz*earth_z )  / ( sun_posw*earth_w ) );
     depth = sd_earth - sd_sun - delta;
-    KSSun *sun = (KSSun*)data->skyComposite()->findByName( "Sun" );
 
     m_is_eclipsed = sd_earth >= sd_sun  &&  depth >= 0;
-    m_is_visible  = !m_is_eclipsed && sun->alt().Degrees() <= -12.0 && elevation >= 0.0;
+    m_is_visible  = !m_is_eclipsed && env.sunAlt <= -12.0 && elevation >= 0.0;
 
     return( 0 );
 }
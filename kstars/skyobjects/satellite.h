@@ -25,6 +25,7 @@
 #include "skypoint.h"
 
 class KSPopupMenu;
+class GeoLocation;
 
 /**
     *@class Satellite
@@ -45,11 +46,72 @@ public:
      */
     ~Satellite();
 
+    /**
+     *@class Environment
+     *The time and observer dependent values needed to propagate a satellite,
+     *which are shared by all the satellites propagated to the same instant.
+     *Computing them once makes Satellite::updatePos( const Environment& )
+     *independent from KStarsData, so that it can run on any thread.
+     */
+    class Environment {
+    public:
+        /**
+         *@short Constructor
+         *@param julianDay the date of the propagation (UT)
+         *@param geo the location of the observer
+         */
+        Environment( double julianDay, GeoLocation *geo );
+
+        /**
+         *@short Constructor interpolating between two environments
+         *
+         *Only uses e1 and e2, not the location nor the date classes, so
+         *it can run on any thread. The environments must be close in time
+         *(a few minutes at most) for the Sun to move in a straight line.
+         *@param e1 the environment before julianDay
+         *@param e2 the environment after julianDay
+         *@param julianDay the date of the propagation (UT)
+         */
+        Environment( const Environment &e1, const Environment &e2, double julianDay );
+
+        /**
+         *@short Default constructor, for containers. The values are undefined.
+         */
+        Environment() : jd( 0. ) {}
+
+        double jd;                          // Julian day (UT)
+        dms lat;                            // Latitude of the observer
+        dms lst;                            // Local sidereal time
+        double sinlat, coslat;
+        double sintheta, costheta;          // Local mean sidereal time
+        double obs_posx, obs_posy, obs_posz, obs_posw;  // Observer ECI position (km)
+        double sun_posx, sun_posy, sun_posz, sun_posw;  // Sun ECI position (km)
+        double sunAlt;                      // Altitude of the sun for the observer (degrees)
+
+    private:
+        /** @short Compute sunAlt from the positions of the observer and the Sun */
+        void findSunAltitude();
+    };
+
+    /**
+     *@return the environment for the current simulation time and location
+     */
+    static Environment currentEnvironment();
+
     /**
      *@short Update satellite position
      */
     void updatePos();
 
+    /**
+     *@short Update satellite position for the given environment
+     *@note This method only modifies this satellite, so several satellites
+     *can be updated concurrently.
+     *@return false if the position could not be computed (e.g. the
+     *satellite has decayed)
+     */
+    bool updatePos( const Environment &env );
+
     /**
      *@return True if the satellite is visible (above horizon, in the sunlight and sun at least 12° under horizon)
      */
@@ -94,12 +156,12 @@ private:
     /**
      *@short Compute satellite position
      */
-    int sgp4( double tsince );
+    int sgp4( double tsince, const Environment &env );
 
     /**
      *@return Arcsine of the argument
      */
-    double arcSin( double arg );
+    static double arcSin( double arg );
 
     /**
      *Provides the difference between UT (approximately the same as UTC)
@@ -107,12 +169,12 @@ private:
      *This function is based on a least squares fit of data from 1950
      *to 1991 and will need to be updated periodically.
      */
-    double deltaET( double year );
+    static double deltaET( double year );
 
     /**
      *@return arg1 mod arg2
      */
-    double Modulus(double arg1, double arg2);
+    static double Modulus(double arg1, double arg2);
 
     
     virtual void initPopupMenu( KSPopupMenu *pmenu );
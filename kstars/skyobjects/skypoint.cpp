@@ -223,9 +223,11 @@ void SkyPoint::nutate(const KSNumbers *num) {
         dms EcLong, EcLat;
         findEcliptic( num->obliquity(), EcLong, EcLat );
 
-        //Add dEcLong to the Ecliptic Longitude
+        //Add dEcLong to the Ecliptic Longitude, and return to the equator
+        //with the true obliquity (mean obliquity plus dObliq)
         dms newLong( EcLong.Degrees() + num->dEcLong() );
-        setFromEcliptic( num->obliquity(), newLong, EcLat );
+        dms trueObliq( num->obliquity()->Degrees() + num->dObliq() );
+        setFromEcliptic( &trueObliq, newLong, EcLat );
     }
 }
 
@@ -311,12 +311,18 @@ double StarObject::pmMagnitude()
 
 void StarObject::JITupdate( KStarsData* data )
 {
+    // Through the coordinate pipeline, like the stars updated at once, so
+    // that all the stars and the lines between them agree
     updateID = data->updateID();
+    const CoordinatePipeline *pipeline = data->updatePipeline();
     if ( updateNumID != data->updateNumID() ) {
-        updateCoords( data->updateNum() );
         updateNumID = data->updateNumID();
+        StarObject *star = this;
+        pipeline->updateStars( &star, 1 );
+    } else {
+        SkyPoint *point = this;
+        pipeline->updateHorizontal( &point, 1 );
     }
-    EquatorialToHorizontal( data->lst(), data->geo()->lat() );
 }
 
 QString StarObject::sptype( void ) const {
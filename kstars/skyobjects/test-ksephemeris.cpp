@@ -0,0 +1,79 @@
+/***************************************************************************
+                     test-ksephemeris.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+
+#include <QList>
+
+#include <kaboutdata.h>
+#include <kapplication.h>
+#include <kcmdlineargs.h>
+
+#include "kstarsdata.h"
+#include "kstarsdatetime.h"
+#include "geolocation.h"
+#include "skyobjects/ksephemeris.h"
+#include "skyobjects/ksplanet.h"
+#include "skyobjects/kssun.h"
+#include "skyobjects/ksmoon.h"
+
+
+/******************************************************************************
+ * Accuracy test of KSEphemeris: the Sun, the Moon and the planets are followed
+ * over two years with the default spans, geocentric and topocentric, and the
+ * interpolated positions are compared with the full theories by selfTest().
+ * The bodies need the data files and the Sun and Earth of the sky composite,
+ * so the catalogs are loaded first, as for kstars --dump.
+ *****************************************************************************/
+
+static const double TOLERANCE = 0.1;   // arcseconds
+
+static int testBody( const KSPlanetBase *body, const GeoLocation *geo, long double startJD, double days )
+{
+    KSEphemeris eph( body, geo );
+    double error = eph.selfTest( startJD, startJD + days, 2000 );
+    printf( "%-8s %s spans of %5.1f days: largest error %8.5f arcsec\n",
+            body->name().toUtf8().constData(), geo ? "topocentric," : "geocentric, ",
+            eph.span(), error );
+    return error > TOLERANCE ? 1 : 0;
+}
+
+int main( int argc, char **argv ) {
+    KAboutData aboutData( "kstars", 0, ki18n( "KStars" ), "test" );
+    KCmdLineArgs::init( argc, argv, &aboutData );
+    KApplication a;
+
+    KStarsData *dat = KStarsData::Create();
+    dat->initialize();
+    dat->setLocationFromOptions();
+
+    QList<KSPlanetBase*> bodies;
+    bodies << new KSSun() << new KSMoon();
+    for ( int i = KSPlanetBase::MERCURY; i <= KSPlanetBase::NEPTUNE; ++i )
+        bodies << new KSPlanet( i );
+
+    int errors = 0;
+    foreach ( KSPlanetBase *body, bodies ) {
+        errors += testBody( body, 0, J2000, 730.0 );
+        errors += testBody( body, dat->geo(), J2000, 730.0 );
+    }
+    printf( "%d fits out of the tolerance of %.2f arcsec\n", errors, TOLERANCE );
+
+    qDeleteAll( bodies );
+    delete dat;
+    return errors ? 1 : 0;
+}
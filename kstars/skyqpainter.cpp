@@ -24,6 +24,7 @@
 #include "kstarsdata.h"
 #include "Options.h"
 #include "skymap.h"
+#include "frameprofiler.h"
 
 #include "skycomponents/linelist.h"
 #include "skycomponents/skiplist.h"
@@ -99,6 +100,7 @@ void SkyQPainter::end()
 
 void SkyQPainter::drawSkyBackground()
 {
+    FrameProfiler::Timer t( "Painter: background" );
     //FIXME use projector
     fillRect( 0, 0, m_widget->width(), m_widget->height(), KStarsData::Instance()->colorScheme()->colorNamed( "SkyColor" ) );
 }
@@ -205,6 +207,7 @@ void SkyQPainter::initStarImages()
 
 void SkyQPainter::drawSkyLine(SkyPoint* a, SkyPoint* b)
 {
+    FrameProfiler::Timer t( "Painter: lines" );
     bool aVisible, bVisible;
     QPointF aScreen = m_proj->toScreen(a,true,&aVisible);
     QPointF bScreen = m_proj->toScreen(b,true,&bVisible);
@@ -223,6 +226,7 @@ void SkyQPainter::drawSkyLine(SkyPoint* a, SkyPoint* b)
 
 void SkyQPainter::drawSkyPolyline(LineList* list, SkipList* skipList, LineListLabel* label)
 {
+    FrameProfiler::Timer t( "Painter: polylines" );
     SkyList *points = list->points();
     bool isVisible, isVisibleLast;
     QPointF   oLast = m_proj->toScreen( points->first(), true, &isVisibleLast );
@@ -254,6 +258,7 @@ void SkyQPainter::drawSkyPolyline(LineList* list, SkipList* skipList, LineListLa
 
 void SkyQPainter::drawSkyPolygon(LineList* list)
 {
+    FrameProfiler::Timer t( "Painter: polygons" );
     SkyList *points = list->points();
     bool isVisible, isVisibleLast;
     SkyPoint* pLast = points->last();
@@ -292,6 +297,7 @@ void SkyQPainter::drawSkyPolygon(LineList* list)
 
 bool SkyQPainter::drawPlanet(KSPlanetBase* planet)
 {
+    FrameProfiler::Timer t( "Painter: planets" );
     if( !m_proj->checkVisibility(planet) ) return false;
 
     bool visible = false;
@@ -689,6 +695,7 @@ void SkyQPainter::drawFlags()
 
 void SkyQPainter::drawHorizon(bool filled, SkyPoint* labelPoint, bool* drawLabel)
 {
+    FrameProfiler::Timer t( "Painter: horizon" );
     QVector<Vector2f> ground = m_proj->groundPoly(labelPoint, drawLabel);
     if( ground.size() ) {
         QPolygonF groundPoly(ground.size());
@@ -704,6 +711,7 @@ void SkyQPainter::drawHorizon(bool filled, SkyPoint* labelPoint, bool* drawLabel
 }
 
 void SkyQPainter::drawSatellite( Satellite* sat ) {
+    FrameProfiler::Timer t( "Painter: satellites" );
     KStarsData *data = KStarsData::Instance();
     QPointF pos;
     bool visible = false;
@@ -0,0 +1,168 @@
+/***************************************************************************
+                 test-coordinatepipeline.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <kaboutdata.h>
+#include <kapplication.h>
+#include <kcmdlineargs.h>
+
+#include "Options.h"
+#include "coordinatepipeline.h"
+#include "kstarsdatetime.h" //for J2000 define
+#include "skyobjects/skypoint.h"
+#include "skyobjects/starobject.h"
+
+
+/******************************************************************************
+ * Test of CoordinatePipeline: random points and stars are updated at several
+ * epochs through the pipeline and one by one with SkyPoint::updateCoords() and
+ * StarObject::updateCoords(). Over the whole sphere, the RA/Dec, Alt/Az and
+ * star index coordinates must agree within the tolerance. The first order
+ * aberration of SkyPoint::aberrate() divides by cos(Dec), so close to the
+ * poles the bound is loosened by POLAR_TOLERANCE divided by the distance to
+ * the pole. The largest differences and the time taken by each path are
+ * printed.
+ *****************************************************************************/
+
+static const double TOLERANCE = 0.1;        // arcseconds
+// The error of the first order aberration is about 0.06 arcsec / degree of
+// distance to the pole; this leaves a margin
+static const double POLAR_TOLERANCE = 0.1;  // arcseconds * degrees
+static const int NUM_POINTS = 20000;
+
+// The angle between two directions given by their latitude and longitude, in arcseconds
+static double separation( const dms &lat1, const dms &long1, const dms &lat2, const dms &long2 )
+{
+    double sinLat1, cosLat1, sinLat2, cosLat2, sinLong1, cosLong1, sinLong2, cosLong2;
+    lat1.SinCos( sinLat1, cosLat1 );
+    lat2.SinCos( sinLat2, cosLat2 );
+    long1.SinCos( sinLong1, cosLong1 );
+    long2.SinCos( sinLong2, cosLong2 );
+    double dx = cosLat1 * cosLong1 - cosLat2 * cosLong2;
+    double dy = cosLat1 * sinLong1 - cosLat2 * sinLong2;
+    double dz = sinLat1 - sinLat2;
+    return 2.0 * asin( 0.5 * sqrt( dx * dx + dy * dy + dz * dz ) ) / dms::DegToRad * 3600.0;
+}
+
+// The largest difference allowed between the two paths at this declination, in arcseconds
+static double bound( const dms &dec )
+{
+    double polarDistance = qMax( 90.0 - fabs( dec.Degrees() ), 1.0e-6 );
+    return TOLERANCE + POLAR_TOLERANCE / polarDistance;
+}
+
+int main( int argc, char **argv ) {
+    KAboutData aboutData( "kstars", 0, ki18n( "KStars" ), "test" );
+    KCmdLineArgs::init( argc, argv, &aboutData );
+    KApplication a;
+
+    // With light bending, the pipeline hands the points to updateCoords()
+    Options::setUseRelativistic( false );
+
+    const double years[] = { 1800.0, 1950.0, 2000.5, 2100.0, 2500.0 };
+    const dms LST( 123.4 ), lat( 47.5 );
+
+    qsrand( 17 );
+    QVector<SkyPoint> reference( NUM_POINTS ), batch( NUM_POINTS );
+    QVector<StarObject> refStars( NUM_POINTS ), batchStars( NUM_POINTS );
+    QVector<SkyPoint*> points( NUM_POINTS );
+    QVector<StarObject*> stars( NUM_POINTS );
+    for ( int i = 0; i < NUM_POINTS; ++i ) {
+        // Uniform over the sphere; proper motions up to 10"/yr
+        double ra = 24.0 * qrand() / ( RAND_MAX + 1.0 );
+        double dec = asin( 2.0 * qrand() / ( RAND_MAX + 1.0 ) - 1.0 ) / dms::DegToRad;
+        double pmRA = 20000.0 * qrand() / ( RAND_MAX + 1.0 ) - 10000.0;
+        double pmDec = 20000.0 * qrand() / ( RAND_MAX + 1.0 ) - 10000.0;
+        reference[i].set( ra, dec );
+        batch[i].set( ra, dec );
+        refStars[i] = StarObject( ra, dec, 5.0, QString(), QString(), "--", pmRA, pmDec );
+        points[i] = &batch[i];
+        stars[i] = &batchStars[i];
+    }
+
+    printf( "%d points, errors in arcsec, times in ms\n", NUM_POINTS );
+    printf( "%7s %9s %9s %9s %9s %7s %9s %9s\n",
+            "Year", "RA/Dec", "Alt/Az", "Stars", "Index", "Bad", "Object", "Batch" );
+
+    int errors = 0;
+    QVector<double> ra( NUM_POINTS ), dec( NUM_POINTS ), indexRA( NUM_POINTS ), indexDec( NUM_POINTS );
+    for ( unsigned int k = 0; k < sizeof( years ) / sizeof( years[0] ); ++k ) {
+        KSNumbers num( J2000 + ( years[k] - 2000.0 ) * 365.25 );
+        CoordinatePipeline pipeline( &num );
+        pipeline.setHorizon( &LST, &lat );
+
+        // The proper motion of a star depends on its current declination
+        for ( int i = 0; i < NUM_POINTS; ++i )
+            batchStars[i] = refStars[i];
+
+        QElapsedTimer timer;
+        timer.start();
+        for ( int i = 0; i < NUM_POINTS; ++i ) {
+            reference[i].updateCoords( &num );
+            reference[i].EquatorialToHorizontal( &LST, &lat );
+        }
+        double objectTime = timer.nsecsElapsed() / 1.0e6;
+
+        timer.restart();
+        pipeline.updateCoords( points.data(), NUM_POINTS );
+        double batchTime = timer.nsecsElapsed() / 1.0e6;
+
+        CoordinatePipeline::indexCoords( stars.data(), NUM_POINTS, &num, ra.data(), dec.data() );
+        for ( int i = 0; i < NUM_POINTS; ++i ) {
+            batchStars[i].getIndexCoords( &num, &indexRA[i], &indexDec[i] );
+            refStars[i].updateCoords( &num );
+        }
+        pipeline.updateStars( stars.data(), NUM_POINTS, false );
+
+        double error = 0.0, horizontalError = 0.0, starError = 0.0, indexError = 0.0;
+        int bad = 0;
+        for ( int i = 0; i < NUM_POINTS; ++i ) {
+            const SkyPoint &r = reference[i], &b = batch[i];
+            double e = separation( r.dec(), r.ra(), b.dec(), b.ra() );
+            double h = separation( r.alt(), r.az(), b.alt(), b.az() );
+            if ( e > bound( r.dec() ) || h > bound( r.dec() ) )
+                ++bad;
+            error = qMax( error, e );
+            horizontalError = qMax( horizontalError, h );
+
+            const StarObject &rs = refStars[i], &bs = batchStars[i];
+            double s = separation( rs.dec(), rs.ra(), bs.dec(), bs.ra() );
+            if ( s > bound( rs.dec() ) )
+                ++bad;
+            starError = qMax( starError, s );
+
+            // Proper motion only, which both paths compute exactly
+            double x = separation( dms( indexDec[i] ), dms( indexRA[i] ), dms( dec[i] ), dms( ra[i] ) );
+            if ( x > TOLERANCE )
+                ++bad;
+            indexError = qMax( indexError, x );
+        }
+
+        printf( "%7.1f %9.4f %9.4f %9.4f %9.4f %7d %9.2f %9.2f%s\n",
+                years[k], error, horizontalError, starError, indexError, bad,
+                objectTime, batchTime, bad ? ": FAILED" : "" );
+        if ( bad )
+            ++errors;
+    }
+
+    return errors ? 1 : 0;
+}
@@ -24,12 +24,23 @@
 #include "skyobjects/ksplanet.h"
 #include "skyobjects/ksasteroid.h"
 #include "skyobjects/kscomet.h"
+#include "skyobjects/ksephemeris.h"
 #include "kstarsdata.h"
 
-KSConjunct::KSConjunct() {
+KSConjunct::KSConjunct() :
+    m_Ephemeris1( 0 ),
+    m_Ephemeris2( 0 ),
+    m_Interpolate1( false ),
+    m_Interpolate2( false )
+{
     geoPlace = KStarsData::Instance()->geo();
 }
 
+KSConjunct::~KSConjunct() {
+    delete m_Ephemeris1;
+    delete m_Ephemeris2;
+}
+
 void KSConjunct::setGeoLocation( GeoLocation *geo ) {
     if( geo != NULL )
         geoPlace = geo;
@@ -46,6 +57,12 @@ QMap<long double, dms> KSConjunct::findClosestApproach(SkyObject& Object1, KSPla
   double step, step0;
   int Sign, prevSign;
   opposition=_opposition;
+
+  delete m_Ephemeris1;
+  delete m_Ephemeris2;
+  KSPlanetBase *p = dynamic_cast<KSPlanetBase*>( &Object1 );
+  m_Ephemeris1 = p ? new KSEphemeris( p, geoPlace ) : 0;
+  m_Ephemeris2 = new KSEphemeris( &Object2, geoPlace );
   //  kDebug() << "Entered KSConjunct::findClosestApproach() with startJD = " << (double)startJD;
   //  kDebug() << "Initial Positional Information: \n";
   //  kDebug() << Object1.name() << ": RA = " << Object1.ra() -> toHMSString() << "; Dec = " << Object1.dec() -> toDMSString() << "\n";
@@ -64,6 +81,12 @@ QMap<long double, dms> KSConjunct::findClosestApproach(SkyObject& Object1, KSPla
       step0 = 0.25;
 
   step = step0;
+
+  // Fitting a span of an ephemeris costs order+1 full positions. Only
+  // interpolate the bodies whose spans hold many more coarse steps than
+  // that; the others are computed directly at each step.
+  m_Interpolate1 = m_Ephemeris1 && m_Ephemeris1->span() >= 2 * ( m_Ephemeris1->order() + 1 ) * step0;
+  m_Interpolate2 = m_Ephemeris2->span() >= 2 * ( m_Ephemeris2->order() + 1 ) * step0;
   
   //	kDebug() << "Initial Separation between " << Object1.name() << " and " << Object2.name() << " = " << (prevDist.toDMSString());
 
@@ -121,22 +144,19 @@ QMap<long double, dms> KSConjunct::findClosestApproach(SkyObject& Object1, KSPla
 
 dms KSConjunct::findDistance(long double jd, SkyObject *Object1, KSPlanetBase *Object2)
 {
-  KStarsDateTime t(jd);
-  KSNumbers num(jd);
   dms dist;
-
-  KSPlanet *m_Earth = new KSPlanet( I18N_NOOP( "Earth" ), QString(), QColor( "white" ), 12756.28 /*diameter in km*/ );
-  m_Earth -> findPosition( &num );
-  dms LST(geoPlace->GSTtoLST(t.gst()));
-
-  KSPlanetBase* p = dynamic_cast<KSPlanetBase*>(Object1);
-  if( p )
-      p->findPosition(&num, geoPlace->lat(), &LST, m_Earth);
-  else
+  Q_UNUSED( Object2 );
+  SkyPoint p2 = m_Interpolate2 ? m_Ephemeris2->position( jd ) : m_Ephemeris2->directPosition( jd );
+
+  if( m_Ephemeris1 ) {
+      SkyPoint p1 = m_Interpolate1 ? m_Ephemeris1->position( jd ) : m_Ephemeris1->directPosition( jd );
+      dist = p1.angularDistanceTo( &p2 );
+  } else {
+      KSNumbers num(jd);
       Object1->updateCoords( &num );
+      dist = Object1->angularDistanceTo( &p2 );
+  }
 
-  Object2->findPosition(&num, geoPlace->lat(), &LST, m_Earth);
-  dist.setRadians(Object1 -> angularDistanceTo(Object2).radians());
   if( opposition ) {
       dist.setD( 180 - dist.Degrees() );
   }
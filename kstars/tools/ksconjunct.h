@@ -32,6 +32,7 @@ class SkyObject;
 class KSNumbers;
 class KSPlanetBase;
 class KSPlanet; 
+class KSEphemeris;
 class dms;
 
 /**
@@ -55,10 +56,10 @@ class KSConjunct :public QObject {
   KSConjunct();
 
   /**
-   *Destructor.  (Empty)
+   *Destructor.
    */
 
-  ~KSConjunct() { }
+  ~KSConjunct();
 
   /**
    *@short Sets the geographic location to compute conjunctions at
@@ -129,6 +130,13 @@ class KSConjunct :public QObject {
 
   bool opposition;
   GeoLocation *geoPlace;
+
+  // Positions of the bodies during a search. m_Ephemeris1 is NULL when
+  // Object1 is not a solar system body. m_InterpolateN tells whether the
+  // positions are interpolated or computed by the full theory.
+  KSEphemeris *m_Ephemeris1;
+  KSEphemeris *m_Ephemeris2;
+  bool m_Interpolate1, m_Interpolate2;
 };
 
 #endif
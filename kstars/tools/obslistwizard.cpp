@@ -18,6 +18,8 @@
 
 #include <QVBoxLayout>
 #include <QFrame>
+#include <QHash>
+#include <QStringList>
 
 #include <knuminput.h>
 #include <kpushbutton.h>
@@ -28,6 +30,7 @@
 #include "skyobjects/skyobject.h"
 #include "skyobjects/deepskyobject.h"
 #include "skyobjects/starobject.h"
+#include "visibilityengine.h"
 #include "widgets/dmsbox.h"
 #include "widgets/magnitudespinbox.h"
 #include "skycomponents/constellationboundarylines.h"
@@ -368,8 +371,10 @@ void ObsListWizard::applyFilters( bool doBuildList )
 {
     bool filterPass = true;
     KStarsData* data = KStarsData::Instance();
-    if ( doBuildList )
-        obsList().clear();
+
+    //The objects of the selected types which pass the magnitude filter; the
+    //region and date filters are then applied to all of them at once
+    QList<SkyObject*> candidates;
 
     //We don't need to call applyRegionFilter() if no region filter is selected, *and*
     //we are just counting items (i.e., doBuildList is false)
@@ -418,14 +423,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
             ObjectCount += starIndex;
         }
         for ( int i=0; i < starIndex; ++i )
-        {
-            SkyObject *o = (SkyObject*)(starList[i]);
-            if ( needRegion ) 
-                filterPass = applyRegionFilter( o, doBuildList, !doBuildList);
-            //Filter objects visible from geo at Date if region filter passes
-            if ( olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter( o, doBuildList, !doBuildList);
-        }
+            candidates.append( (SkyObject*)(starList[i]) );
     }
 
     //Sun, Moon, Planets
@@ -440,10 +438,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             else
                 filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName("Sun"), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Sun"), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName("Sun") );
 
             if (maglimit < data->skyComposite()->findByName("Moon")->mag())
             {
@@ -453,10 +449,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             }
             else filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName("Moon"), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName("Moon"), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName("Moon") );
 
             if (maglimit < data->skyComposite()->findByName("Mercury")->mag())
             {
@@ -466,10 +460,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             }
             else
                 filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                 applyObservableFilter( data->skyComposite()->findByName(i18n( "Mercury" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Mercury" )) );
 
             if (maglimit < data->skyComposite()->findByName("Venus")->mag())
             {
@@ -480,10 +472,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             else
                 filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Venus" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Venus" )) );
 
             if (maglimit < data->skyComposite()->findByName("Mars")->mag())
             {
@@ -493,10 +483,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             }
             else
                 filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Mars" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Mars" )) );
 
             if (maglimit < data->skyComposite()->findByName("Jupiter")->mag())
             {
@@ -506,10 +494,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             }
             else
                 filterPass = true;
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Jupiter" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Jupiter" )) );
 
             if (maglimit < data->skyComposite()->findByName("Saturn")->mag())
             {
@@ -520,10 +506,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             else
                 filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Saturn" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Saturn" )) );
 
             if (maglimit < data->skyComposite()->findByName("Uranus")->mag())
             {
@@ -534,10 +518,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             else
                 filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Uranus" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Uranus" )) );
 
             if (maglimit < data->skyComposite()->findByName("Neptune")->mag())
             {
@@ -549,10 +531,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
                 filterPass = true;
 
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Neptune" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Neptune" )) );
 
             if (maglimit < data->skyComposite()->findByName("Pluto")->mag())
             {
@@ -563,10 +543,8 @@ void ObsListWizard::applyFilters( bool doBuildList )
             else
                 filterPass = true;
 
-            if ( needRegion && filterPass)
-                filterPass = applyRegionFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
-            if ( olw->SelectByDate->isChecked()  && filterPass)
-                applyObservableFilter( data->skyComposite()->findByName(i18n( "Pluto" )), doBuildList );
+            if ( filterPass )
+                candidates.append( data->skyComposite()->findByName(i18n( "Pluto" )) );
         }
 
     //Deep sky objects
@@ -626,10 +604,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
                     {
                         if ( olw->IncludeNoMag->isChecked() )
                         {
-                            if ( needRegion )
-                                filterPass = applyRegionFilter( o, doBuildList );
-                            if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
+                            candidates.append( o );
                         }
                         else if ( ! doBuildList )
                             --ObjectCount;
@@ -638,20 +613,14 @@ void ObsListWizard::applyFilters( bool doBuildList )
                     {
                         if ( o->mag() <= maglimit )
                         {
-                            if ( needRegion )
-                                filterPass = applyRegionFilter( o, doBuildList );
-                            if ( olw->SelectByDate->isChecked() && filterPass)
-                                applyObservableFilter( o, doBuildList );
+                            candidates.append( o );
                         } else if ( ! doBuildList )
                             --ObjectCount;
                     }
                 }
                 else
                 {
-                    if ( needRegion )
-                        filterPass = applyRegionFilter( o, doBuildList );
-                    if ( olw->SelectByDate->isChecked() && filterPass)
-                        applyObservableFilter( o, doBuildList );
+                    candidates.append( o );
                 }
             }
         }
@@ -662,10 +631,7 @@ void ObsListWizard::applyFilters( bool doBuildList )
     {
         foreach ( SkyObject *o, data->skyComposite()->comets() )
         {
-            if ( needRegion )
-                filterPass = applyRegionFilter( o, doBuildList );
-            if ( olw->SelectByDate->isChecked() && filterPass)
-                applyObservableFilter( o, doBuildList );
+            candidates.append( o );
         }
     }
 
@@ -679,161 +645,122 @@ void ObsListWizard::applyFilters( bool doBuildList )
                 if ( o->mag() > 90. )
                 {
                     if ( olw->IncludeNoMag->isChecked() )
-                        if ( needRegion )
-                            filterPass = applyRegionFilter( o, doBuildList );
-                        if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                        candidates.append( o );
                     else if ( ! doBuildList )
                         --ObjectCount;
                 }
                 else
                 {
                     if ( o->mag() <= maglimit )
-                        if ( needRegion )
-                            filterPass = applyRegionFilter( o, doBuildList );
-                        if ( olw->SelectByDate->isChecked() && filterPass)
-                            applyObservableFilter( o, doBuildList );
+                        candidates.append( o );
                     else if ( ! doBuildList )
                         --ObjectCount;
                 }
             }
             else
             {
-                if ( needRegion )
-                    filterPass = applyRegionFilter( o, doBuildList );
-                if ( olw->SelectByDate->isChecked() && filterPass)
-                    applyObservableFilter( o, doBuildList );
+                candidates.append( o );
             }
         }
     }
 
+    QList<SkyObject*> selected = candidates;
+    if ( needRegion )
+        selected = applyRegionFilter( selected );
+    //Filter objects visible from geo at Date
+    if ( olw->SelectByDate->isChecked() )
+        selected = applyObservableFilter( selected );
+
     //Update the object count label
     if ( doBuildList )
+    {
+        obsList() = selected;
         ObjectCount = obsList().size();
+    }
+    else
+        ObjectCount -= candidates.size() - selected.size();
 
     olw->CountLabel->setText( i18np("Your observing list currently has 1 object", "Your observing list currently has %1 objects", ObjectCount ) );
 }
 
-bool ObsListWizard::applyRegionFilter( SkyObject *o, bool doBuildList,
-                                       bool doAdjustCount )
+QList<SkyObject*> ObsListWizard::applyRegionFilter( const QList<SkyObject*> &objects )
 {
+    QList<SkyObject*> result;
+
     //select by constellation
     if ( isItemSelected( i18n("by constellation"), olw->RegionList ) )
     {
-        QString c = KStarsData::Instance()->skyComposite()->getConstellationBoundary()->constellationName( o );
-        if ( isItemSelected( c, olw->ConstellationList ) )
+        //Look up the constellations of all the objects in one pass
+        QList<SkyPoint*> points;
+        points.reserve( objects.size() );
+        foreach ( SkyObject *o, objects )
+            points.append( o );
+        QStringList names = KStarsData::Instance()->skyComposite()->getConstellationBoundary()->constellationNames( points );
+
+        QHash<QString, bool> selectedNames;
+        for ( int i = 0; i < objects.size(); ++i )
         {
-            if ( doBuildList )
-                obsList().append ( o );
-
-            return true;
+            const QString &c = names.at( i );
+            if ( ! selectedNames.contains( c ) )
+                selectedNames.insert( c, isItemSelected( c, olw->ConstellationList ) );
+            if ( selectedNames.value( c ) )
+                result.append( objects.at( i ) );
         }
-        else if ( doAdjustCount )
-        {
-            --ObjectCount;
-            return false;
-        }
-        else
-            return false;
     }
 
     //select by rectangular region
     else if ( isItemSelected( i18n("in a rectangular region"), olw->RegionList ) )
     {
-        double ra = o->ra().Hours();
-        double dec = o->dec().Degrees();
-        bool addObject = false;
-        if ( dec >= yRect1 && dec <= yRect2 ) {
-            if ( xRect1 < 0.0 ) {
-                addObject = ra >= xRect1 + 24.0 || ra <= xRect2;
-            } else {
-                addObject = ra >= xRect1 && ra <= xRect2;
-            }
-        }
-
-        if ( addObject)
+        foreach ( SkyObject *o, objects )
         {
-            if (doBuildList )
-                obsList().append( o );
-
-            return true;
-        }
-
-        else
-        {
-             if (doAdjustCount )
-            --ObjectCount;
+            double ra = o->ra().Hours();
+            double dec = o->dec().Degrees();
+            bool addObject = false;
+            if ( dec >= yRect1 && dec <= yRect2 ) {
+                if ( xRect1 < 0.0 ) {
+                    addObject = ra >= xRect1 + 24.0 || ra <= xRect2;
+                } else {
+                    addObject = ra >= xRect1 && ra <= xRect2;
+                }
+            }
 
-             return false;
+            if ( addObject )
+                result.append( o );
         }
     }
 
     //select by circular region
-    //make sure circ region data are valid
     else if ( isItemSelected( i18n("in a circular region"), olw->RegionList ) )
+    {
+        foreach ( SkyObject *o, objects )
         {
-        if ( o->angularDistanceTo( &pCirc ).Degrees() < rCirc )
-        {
-            if ( doBuildList )
-                obsList().append( o );
-
-            return true;
-        }
-        else if ( doAdjustCount )
-        {
-            --ObjectCount;
-            return false;
+            if ( o->angularDistanceTo( &pCirc ).Degrees() < rCirc )
+                result.append( o );
         }
-        else
-            return false;
     }
 
-    //No region filter, just add the object
-    else if ( doBuildList )
-    {
-        obsList().append( o );
-    }
+    //No region filter, keep all the objects
+    else
+        result = objects;
 
-    return true;
+    return result;
 }
 
-bool ObsListWizard::applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount )
+QList<SkyObject*> ObsListWizard::applyObservableFilter( const QList<SkyObject*> &objects )
 {
-    SkyPoint p = *o;
-
-    //Check altitude of object every hour from 18:00 to midnight
-    //If it's ever above 15 degrees, flag it as visible
+    //Check whether the objects are above 15 degrees between 18:00 and midnight,
+    //or between the user-selected times, if they're valid
     KStarsDateTime Evening( olw->Date->date(), QTime( 18, 0, 0 ) );
     KStarsDateTime Midnight( olw->Date->date().addDays(1), QTime( 0, 0, 0 ) );
-
-    // Or use user-selected values, if they're valid
     if (olw->timeFrom->time() < olw->timeTo->time())
     {
         Evening.setTime(olw->timeFrom->time());
         Midnight.setTime(olw->timeTo->time());
     }
 
-    bool visible = false;
-    for ( KStarsDateTime t = Evening; t < Midnight; t = t.addSecs( 3600.0 ) ) {
-        dms LST = geo->GSTtoLST( t.gst() );
-        p.EquatorialToHorizontal( &LST, geo->lat() );
-        if ( p.alt().Degrees() > 15.0 )
-        {
-            visible = true;
-            break;
-        }
-    }
-
-    if (visible )
-        return true;
-
-    if ( doAdjustCount )
-            --ObjectCount;
-    if ( doBuildList )
-            obsList().takeAt( obsList().indexOf(o) );
-
-    return false;
-
+    //One batch for all the candidates, so the fixed objects are solved in parallel
+    VisibilityEngine visibility( geo, geo->LTtoUT( Evening ).djd(), geo->LTtoUT( Midnight ).djd(), 15.0 );
+    return visibility.visibleObjects( objects );
 }
 
 #include "obslistwizard.moc"
@@ -69,9 +69,10 @@ private slots:
 private:
     void initialize();
     void applyFilters( bool doBuildList );
-    /**@return true if the object passes the filter region constraints, false otherwise.*/
-    bool applyRegionFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true );
-    bool applyObservableFilter( SkyObject *o, bool doBuildList, bool doAdjustCount=true );
+    /**@return the objects which pass the filter region constraints, in the same order.*/
+    QList<SkyObject*> applyRegionFilter( const QList<SkyObject*> &objects );
+    /**@return the objects which are observable in the window of the date filter, in the same order.*/
+    QList<SkyObject*> applyObservableFilter( const QList<SkyObject*> &objects );
 
     /**
     	*Convenience function for safely getting the selected state of a QListWidget item by name.
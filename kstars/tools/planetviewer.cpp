@@ -17,11 +17,13 @@
 #include "planetviewer.h"
 
 #include <stdlib.h> //needed for abs() on some platforms
+#include <math.h>
 
 #include <QFile>
 #include <QMouseEvent>
 #include <QVBoxLayout>
 #include <QTextStream>
+#include <QVector>
 #include <QKeyEvent>
 #include <QPaintEvent>
 
@@ -49,7 +51,8 @@ PlanetViewerUI::PlanetViewerUI( QWidget *p ) : QFrame( p ) {
 }
 
 PlanetViewer::PlanetViewer(QWidget *parent)
-        : KDialog( parent ), scale(1.0), isClockRunning(false), tmr(this)
+        : KDialog( parent ), scale(1.0), isClockRunning(false), tmr(this),
+          AheadStart(0.0), AheadStep(0.0)
 {
     KStarsData *data = KStarsData::Instance();
     pw = new PlanetViewerUI( this );
@@ -163,22 +166,68 @@ void PlanetViewer::slotCloseWindow() {
     }
 }
 
+void PlanetViewer::computeAhead() {
+    // Ten seconds of the running clock
+    const int nTicks = 100;
+
+    AheadStart = ut.djd();
+    AheadStep = scale*0.1;
+
+    QVector<double> jm( nTicks );
+    for ( int k=0; k<nTicks; ++k )
+        jm[k] = ( AheadStart + k*AheadStep - J2000 )/365250.0;
+
+    for ( unsigned int i=0; i<9; ++i ) {
+        KSPlanet *p = dynamic_cast<KSPlanet*>( PlanetList[i] );
+        if ( ! p ) continue;
+        Ahead[i].resize( nTicks );
+        p->calcEcliptic( jm.constData(), nTicks, Ahead[i].data() );
+    }
+}
+
+int PlanetViewer::aheadIndex() const {
+    if ( AheadStep == 0.0 || Ahead[0].isEmpty() )
+        return -1;
+    double k = ( ut.djd() - AheadStart )/AheadStep;
+    int index = int( floor( k + 0.5 ) );
+    if ( fabs( k - index ) > 1.0e-6 || index < 0 || index >= Ahead[0].size() )
+        return -1;
+    return index;
+}
+
 void PlanetViewer::updatePlanets() {
     KSNumbers num( ut.djd() );
     bool changed(false);
 
+    // While the clock runs, the major planets are taken from positions
+    // computed ahead for many ticks at once
+    int index = -1;
+    if ( isClockRunning ) {
+        index = aheadIndex();
+        if ( index < 0 ) {
+            computeAhead();
+            index = aheadIndex();
+        }
+    }
+
     //Check each planet to see if it needs to be updated
     for ( unsigned int i=0; i<9; ++i ) {
         if ( abs( int(ut.date().toJulianDay()) - LastUpdate[i] ) > UpdateInterval[i] ) {
             KSPlanetBase *p = PlanetList[i];
-            p->findPosition( &num );
+            EclipticPosition pos;
+            if ( index >= 0 && ! Ahead[i].isEmpty() ) {
+                pos = Ahead[i][index];
+            } else {
+                p->findPosition( &num );
+                pos = EclipticPosition( p->helEcLong(), p->helEcLat(), p->rsun() );
+            }
 
             double s, c, s2, c2;
-            p->helEcLong().SinCos( s, c );
-            p->helEcLat().SinCos( s2, c2 );
+            pos.longitude.SinCos( s, c );
+            pos.latitude.SinCos( s2, c2 );
             QList<KPlotPoint*> points = planet[i]->points();
-            points.at(0)->setX( p->rsun()*c*c2 );
-            points.at(0)->setY( p->rsun()*s*c2 );
+            points.at(0)->setX( pos.radius*c*c2 );
+            points.at(0)->setY( pos.radius*s*c2 );
 
             if ( centerPlanet() == p->name() ) {
                 QRectF dataRect = pw->map->dataRect();
@@ -29,11 +29,10 @@
 #include "pvplotwidget.h"
 #include "ui_planetviewer.h"
 #include "kstarsdatetime.h"
+#include "skyobjects/ksplanetbase.h"
 
 #define AUMAX 48
 
-class KSPlanetBase;
-
 class PlanetViewerUI : public QFrame, public Ui::PlanetViewer {
     Q_OBJECT
 public:
@@ -74,6 +73,17 @@ private slots:
 private:
     void updatePlanets();
 
+    /**@short Compute the heliocentric positions of the major planets for
+    	*the next ticks of the running clock, starting at the current date,
+    	*with one batch evaluation of their series per planet.
+    	*/
+    void computeAhead();
+
+    /**@return the index of the current date in the positions computed
+    	*by computeAhead(), or -1 if it is not one of their dates.
+    	*/
+    int aheadIndex() const;
+
     PlanetViewerUI *pw;
     KStarsDateTime ut;
     double scale;
@@ -84,6 +94,10 @@ private:
 
     QList<KSPlanetBase*> PlanetList;
 
+    // Positions of the major planets for the next ticks, empty for the others
+    QVector<EclipticPosition> Ahead[9];
+    double AheadStart, AheadStep;
+
     KPlotObject *ksun;
     KPlotObject *planet[9];
 };
@@ -0,0 +1,109 @@
+/***************************************************************************
+                          satellitepasses.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "satellitepasses.h"
+
+#include <QApplication>
+#include <QPointer>
+#include <QTreeWidgetItem>
+#include <kdebug.h>
+#include <KPushButton>
+
+#include "geolocation.h"
+#include "dialogs/locationdialog.h"
+#include "kstarsdatetime.h"
+#include "kstarsdata.h"
+#include "satellitepasspredictor.h"
+#include "skycomponents/skymapcomposite.h"
+#include "skycomponents/satellitescomponent.h"
+
+SatellitePassesUI::SatellitePassesUI( QWidget *parent )
+    : QFrame( parent )
+{
+    setupUi( this );
+}
+
+SatellitePasses::SatellitePasses( QWidget *parent )
+    : KDialog( parent )
+{
+    spUI = new SatellitePassesUI( this );
+    setMainWidget( spUI );
+
+    geo = KStarsData::Instance()->geo();
+
+    setCaption( i18n( "Satellite Passes" ) );
+    setButtons( KDialog::Close );
+    setModal( false );
+
+    spUI->LocationButton->setText( geo->fullName() );
+    spUI->StartTime->setDateTime( KStarsData::Instance()->lt().dateTime() );
+    spUI->Days->setRange( 1, SatellitePassPredictor::MAX_DAYS );
+
+    connect( spUI->ComputeButton, SIGNAL(clicked()), this, SLOT(slotCompute()) );
+    connect( spUI->LocationButton, SIGNAL(clicked()), this, SLOT(slotLocation()) );
+}
+
+SatellitePasses::~SatellitePasses() {
+}
+
+void SatellitePasses::slotCompute() {
+    spUI->PassList->clear();
+
+    KStarsDateTime startUT = geo->LTtoUT( KStarsDateTime( spUI->StartTime->dateTime() ) );
+    double startJD = startUT.djd();
+    double stopJD  = startJD + spUI->Days->value();
+
+    QApplication::setOverrideCursor( QCursor( Qt::WaitCursor ) );
+
+    SatellitePassPredictor predictor( geo, startJD, stopJD );
+    QList<SatellitePass> passes =
+        predictor.findPasses( KStarsData::Instance()->skyComposite()->satellites()->satellites() );
+
+    bool visibleOnly = spUI->VisibleOnly->isChecked();
+    foreach ( const SatellitePass &pass, passes ) {
+        if ( visibleOnly && ! pass.visible )
+            continue;
+
+        QStringList fields;
+        fields << pass.satellite->name()
+               << geo->UTtoLT( KStarsDateTime( pass.riseJD ) ).dateTime().toString( "yyyy-MM-dd hh:mm:ss" )
+               << QString::number( pass.riseAz, 'f', 0 )
+               << geo->UTtoLT( KStarsDateTime( pass.culminationJD ) ).dateTime().toString( "yyyy-MM-dd hh:mm:ss" )
+               << QString::number( pass.maxAlt, 'f', 1 )
+               << geo->UTtoLT( KStarsDateTime( pass.setJD ) ).dateTime().toString( "yyyy-MM-dd hh:mm:ss" )
+               << QString::number( pass.setAz, 'f', 0 )
+               << ( pass.visible ? i18n( "Yes" ) : i18n( "No" ) );
+        new QTreeWidgetItem( spUI->PassList, fields );
+    }
+    spUI->PassList->sortItems( 1, Qt::AscendingOrder );
+
+    QApplication::restoreOverrideCursor();
+}
+
+void SatellitePasses::slotLocation() {
+    QPointer<LocationDialog> ld = new LocationDialog( this );
+    if ( ld->exec() == QDialog::Accepted ) {
+        GeoLocation *newGeo = ld->selectedCity();
+        if ( newGeo ) {
+            geo = newGeo;
+            spUI->LocationButton->setText( geo->fullName() );
+        }
+    }
+    delete ld;
+}
+
+#include "satellitepasses.moc"
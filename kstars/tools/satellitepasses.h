@@ -0,0 +1,57 @@
+/***************************************************************************
+                          satellitepasses.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef SATELLITEPASSES_H_
+#define SATELLITEPASSES_H_
+
+#include <KDialog>
+
+#include "ui_satellitepasses.h"
+
+class GeoLocation;
+
+class SatellitePassesUI : public QFrame, public Ui::SatellitePasses {
+    Q_OBJECT
+
+public:
+    SatellitePassesUI( QWidget *p=0 );
+};
+
+/**
+ *@class SatellitePasses
+ *Tool listing the passes of the satellites of all the loaded TLE groups
+ *above a location, over a range of days.
+ *@see SatellitePassPredictor
+ */
+class SatellitePasses : public KDialog
+{
+    Q_OBJECT
+
+public:
+    SatellitePasses( QWidget *parent=0 );
+    ~SatellitePasses();
+
+public slots:
+    void slotCompute();
+    void slotLocation();
+
+private:
+    SatellitePassesUI *spUI;
+    GeoLocation *geo;
+};
+
+#endif
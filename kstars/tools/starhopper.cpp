@@ -20,107 +20,235 @@
 #include "skyobjects/skyobject.h"
 #include "skyobjects/starobject.h"
 #include "starcomponent.h"
+#include "starblockfactory.h"
 
 #include "kstarsdata.h"
 
 #include <QList>
+#include <QSet>
 
+QHash<const SkyPoint *, StarHopper::Neighbourhood> *StarHopper::graph = 0;
+float StarHopper::graphFov = 0;
+float StarHopper::graphMaglim = 0;
+quint64 StarHopper::graphEvictions = 0;
+
+namespace {
+    // The open set of the A* search: a binary min-heap on the f-score,
+    // with the position of each node so that its score can be lowered
+    // in place
+    class OpenSet {
+    public:
+        bool isEmpty() const { return heap.isEmpty(); }
+
+        // Inserts node, or lowers its f-score if it is already there
+        void push( const SkyPoint *node, double fscore ) {
+            QHash<const SkyPoint *, int>::const_iterator it = position.constFind( node );
+            int i;
+            if( it == position.constEnd() ) {
+                Item item = { node, fscore };
+                heap.append( item );
+                i = heap.size() - 1;
+            }
+            else {
+                i = it.value();
+                heap[ i ].fscore = fscore;
+            }
+            siftUp( i );
+        }
+
+        // Removes and returns the node with the lowest f-score
+        const SkyPoint *pop() {
+            const SkyPoint *node = heap.first().node;
+            position.remove( node );
+            Item last = heap.last();
+            heap.pop_back();
+            if( !heap.isEmpty() ) {
+                heap[ 0 ] = last;
+                siftDown( 0 );
+            }
+            return node;
+        }
+
+    private:
+        struct Item {
+            const SkyPoint *node;
+            double fscore;
+        };
+
+        void siftUp( int i ) {
+            Item item = heap[ i ];
+            while( i > 0 ) {
+                int parent = ( i - 1 ) / 2;
+                if( heap[ parent ].fscore <= item.fscore )
+                    break;
+                place( i, heap[ parent ] );
+                i = parent;
+            }
+            place( i, item );
+        }
+
+        void siftDown( int i ) {
+            Item item = heap[ i ];
+            int n = heap.size();
+            while( 2 * i + 1 < n ) {
+                int child = 2 * i + 1;
+                if( child + 1 < n && heap[ child + 1 ].fscore < heap[ child ].fscore )
+                    ++child;
+                if( item.fscore <= heap[ child ].fscore )
+                    break;
+                place( i, heap[ child ] );
+                i = child;
+            }
+            place( i, item );
+        }
+
+        void place( int i, const Item &item ) {
+            heap[ i ] = item;
+            position[ item.node ] = i;
+        }
+
+        QVector<Item> heap;
+        QHash<const SkyPoint *, int> position;
+    };
+}
 
 QList<const StarObject *> StarHopper::computePath( const SkyPoint &src, const SkyPoint &dest, float fov_, float maglim_ ) {
 
     fov = fov_;
     maglim = maglim_;
-    start = &src;
+
+    // The graph holds pointers to stars of the deep star catalogs,
+    // which become invalid when their blocks are recycled
+    StarBlockFactory *factory = StarBlockFactory::Instance();
+    quint64 evictions = factory->getEvictionCount();
+    if( fov != graphFov || maglim != graphMaglim || evictions != graphEvictions ) {
+        clearCache();
+        graphFov = fov;
+        graphMaglim = maglim;
+    }
+
+    // FIXME: Actually, this should be done in
+    // HorizontalToEquatorial, but we do it here because SkyPoint
+    // needs a lot of fixing to handle unprecessed and precessed,
+    // equatorial and horizontal coordinates nicely
+    SkyPoint source( src );
+    source.deprecess( KStarsData::Instance()->updateNum() );
+
+    start = &source;
     end = &dest;
+    startNeighbourhood = findNeighbourhood( start );
 
     came_from.clear();
     result_path.clear();
-    
+
+    findPath();
+
+    // Blocks recycled during this search may have invalidated
+    // neighbourhoods found before they were
+    if( factory->getEvictionCount() != evictions )
+        clearCache();
+    graphEvictions = factory->getEvictionCount();
+
+    came_from.clear();
+    startNeighbourhood = Neighbourhood();
+    return result_path;
+}
+
+void StarHopper::findPath() {
 
     // Implements the A* search algorithm
-    
-    QList<SkyPoint const *> cSet;
-    QList<SkyPoint const *> oSet;
+
+    QSet<SkyPoint const *> cSet;
+    OpenSet oSet;
     QHash<SkyPoint const *, double> g_score;
-    QHash<SkyPoint const *, double> f_score;
     QHash<SkyPoint const *, double> h_score;
- 
-    oSet.append( &src );
-    g_score[ &src ] = 0;
-    h_score[ &src ] = src.angularDistanceTo( &dest ).Degrees();
-    f_score[ &src ] = h_score[ &src ];
-    
+
+    g_score[ start ] = 0;
+    h_score[ start ] = start->angularDistanceTo( end ).Degrees();
+    oSet.push( start, h_score[ start ] );
+
+    double maxHScore = h_score[ start ] * 1.2;
+
     while( !oSet.isEmpty() ) {
-        kDebug() << "Next step";
         // Find the node with the lowest f_score value
-        SkyPoint const *curr_node = NULL;
-        double lowfscore = 1.0e8;
-        foreach( const SkyPoint *sp, oSet ) {
-            if( f_score[ sp ] < lowfscore ) {
-                lowfscore = f_score[ sp ];
-                curr_node = sp;
-            }
-        }
-        kDebug() << "Lowest fscore is " << lowfscore;
-        if( curr_node == &dest || (curr_node != &src && h_score[ curr_node ] < 0.5 * fov) ) {
+        SkyPoint const *curr_node = oSet.pop();
+        double curr_h_score = h_score[ curr_node ];
+        if( curr_node != start && curr_h_score < 0.5 * fov ) {
             // We are at destination
             reconstructPath( came_from[ curr_node ] );
             kDebug() << "Result path count: " << result_path.count();
-            return result_path;
+            return;
         }
-        
-        oSet.removeOne( curr_node );
-        cSet.append( curr_node );
+
+        cSet.insert( curr_node );
 
         // FIXME: Make sense. If current node ---> dest distance is
         // larger than src --> dest distance by more than 20%, don't
         // even bother considering it.
 
-        if( h_score[ curr_node ] > h_score[ &src ] * 1.2 )
+        if( curr_h_score > maxHScore )
             continue;
 
-        SkyPoint const *nhd_node;
-
-        // Get the list of stars that are neighbours of this node
-        QList<StarObject *> neighbors;
+        // Get the list of stars that are neighbours of this node.
+        // This is a shallow copy, the vector is shared with the graph
+        QVector<StarObject *> neighbors = neighbourhood( curr_node ).stars;
 
-        // FIXME: Actually, this should be done in
-        // HorizontalToEquatorial, but we do it here because SkyPoint
-        // needs a lot of fixing to handle unprecessed and precessed,
-        // equatorial and horizontal coordinates nicely
-        SkyPoint *CurrentNode = const_cast<SkyPoint *>(curr_node);
-        CurrentNode->deprecess( KStarsData::Instance()->updateNum() );
-        kDebug() << "Calling starsInAperture";
-        StarComponent::Instance()->starsInAperture( neighbors, *curr_node, fov, maglim );
-        kDebug() << "Choosing next node from a set of " << neighbors.count();
         // Look for the potential next node
         double curr_g_score = g_score[ curr_node ];
-        foreach( nhd_node, neighbors ) {
+        foreach( StarObject *star, neighbors ) {
+            SkyPoint const *nhd_node = star;
             if( cSet.contains( nhd_node ) )
                 continue;
-            
+
             // Compute the tentative g_score
             double tentative_g_score = curr_g_score + cost( curr_node, nhd_node );
-            bool tentative_better;
-            if( !oSet.contains( nhd_node ) ) {
-                oSet.append( nhd_node );
-                tentative_better = true;
+            QHash<SkyPoint const *, double>::iterator g = g_score.find( nhd_node );
+            if( g == g_score.end() ) {
+                h_score[ nhd_node ] = nhd_node->angularDistanceTo( end ).Degrees();
+                g = g_score.insert( nhd_node, tentative_g_score );
             }
-            else if( tentative_g_score < g_score[ nhd_node ] )
-                tentative_better = true;
+            else if( tentative_g_score < g.value() )
+                g.value() = tentative_g_score;
             else
-                tentative_better = false;
-            
-            if( tentative_better ) {
-                came_from[ nhd_node ] = curr_node;
-                g_score[ nhd_node ] = tentative_g_score;
-                h_score[ nhd_node ] = nhd_node->angularDistanceTo( &dest ).Degrees();
-                f_score[ nhd_node ] = g_score[ nhd_node ] + h_score[ nhd_node ];
-            }
+                continue;
+
+            came_from[ nhd_node ] = curr_node;
+            oSet.push( nhd_node, tentative_g_score + h_score[ nhd_node ] );
         }
     }
     kDebug() << "REGRET! Returning empty list!";
-    return QList<StarObject const *>(); // Return an empty QList
+}
+
+const StarHopper::Neighbourhood &StarHopper::neighbourhood( const SkyPoint *node ) {
+    if( node == start )
+        return startNeighbourhood;
+
+    if( !graph )
+        graph = new QHash<const SkyPoint *, Neighbourhood>;
+    QHash<const SkyPoint *, Neighbourhood>::const_iterator it = graph->constFind( node );
+    if( it == graph->constEnd() )
+        it = graph->insert( node, findNeighbourhood( node ) );
+    return it.value();
+}
+
+StarHopper::Neighbourhood StarHopper::findNeighbourhood( const SkyPoint *node ) const {
+    Neighbourhood nhd;
+
+    QList<StarObject *> neighbors;
+    StarComponent::Instance()->starsInAperture( neighbors, *node, fov, maglim );
+    nhd.stars = neighbors.toVector();
+
+    // Is this an asterism, or are there bright stars clustered nearby?
+    QList<StarObject *> localNeighbors;
+    StarComponent::Instance()->starsInAperture( localNeighbors, *node, fov/10, maglim + 1.0 );
+    nhd.densityCost = 1 - localNeighbors.count();
+
+    return nhd;
+}
+
+void StarHopper::clearCache() {
+    delete graph;
+    graph = 0;
 }
 
 void StarHopper::reconstructPath( SkyPoint const *curr_node ) {
@@ -188,14 +316,10 @@ float StarHopper::cost( const SkyPoint *curr, const SkyPoint *next ) {
     //    double distredcost = -((src->angularDistanceTo( dest ).Degrees() - next->angularDistanceTo( dest ).Degrees()) * 60 / fov)*3; // 3 "magnitudes" for 1 FOV closer
 
     // Test 5: Is this an asterism, or are there bright stars clustered nearby?
-    QList<StarObject *> localNeighbors;
-    StarComponent::Instance()->starsInAperture( localNeighbors, *curr, fov/10, maglim + 1.0 );
-    double stardensitycost = 1 - localNeighbors.count();
+    double stardensitycost = neighbourhood( curr ).densityCost;
 
     netcost = magcost /*+ speccost*/ + distcost + stardensitycost;
     if( netcost < 0 )
         netcost = 0.1; // FIXME: Heuristics aren't supposed to be entirely random. This one is.
-    kDebug() << "Mag cost: " << magcost << "; Spec Cost: " << speccost << "; Dist Cost: " << distcost << "; Net cost: " << netcost;
-
     return netcost;
 }
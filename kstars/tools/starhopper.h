@@ -25,6 +25,9 @@
  *@author Akarsh Simha
  */
 
+#include <QHash>
+#include <QVector>
+
 #include "skypoint.h"
 #include "skyobject.h"
 #include "starobject.h"
@@ -33,9 +36,32 @@ class StarHopper {
 
  public:
 
+    /**
+     *@short Computes a star hopping path from src to dest
+     *@note The neighbour graph of the stars is kept across calls, and
+     * shared by all StarHopper instances, as long as the FOV and
+     * magnitude limit do not change and no star block is recycled. The
+     * graph does not depend on the destination, so hops to different
+     * targets reuse it.
+     */
     QList<StarObject const *> computePath( const SkyPoint &src, const SkyPoint &dest, float fov_, float maglim_ );
 
+    /**
+     *@short Forget the cached neighbour graph, and free it
+     *@note Must be called before the stars it points to are deleted
+     */
+    static void clearCache();
+
  private:
+    /**
+     *@short The stars that can be reached from a node, and the star
+     * density cost of the node
+     */
+    struct Neighbourhood {
+        QVector<StarObject *> stars;
+        float densityCost;
+    };
+
     float fov;
     float maglim;
 
@@ -44,6 +70,29 @@ class StarHopper {
     SkyPoint const *end;
     QHash<const SkyPoint *, const SkyPoint *> came_from; // Used by the A* search algorithm
     QList<StarObject const *> result_path;
+    Neighbourhood startNeighbourhood;
+
+    // The neighbour graph, valid for graphFov, graphMaglim and
+    // graphEvictions. Allocated on first use, freed by clearCache()
+    static QHash<const SkyPoint *, Neighbourhood> *graph;
+    static float graphFov;
+    static float graphMaglim;
+    static quint64 graphEvictions;
+
+    /**
+     *@short The A* search proper, on the cached graph
+     */
+    void findPath();
+
+    /**
+     *@short Returns the neighbourhood of a node, from the cache if possible
+     */
+    const Neighbourhood &neighbourhood( const SkyPoint *node );
+
+    /**
+     *@short Searches the star catalog for the neighbourhood of a node
+     */
+    Neighbourhood findNeighbourhood( const SkyPoint *node ) const;
 
     /**
      *@short The cost function for hopping from current position to the a given star, in view of the final destination
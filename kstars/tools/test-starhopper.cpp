@@ -0,0 +1,86 @@
+/***************************************************************************
+                     test-starhopper.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <stdio.h>
+
+#include <QTime>
+
+#include <kaboutdata.h>
+#include <kapplication.h>
+#include <kcmdlineargs.h>
+
+#include "kstarsdata.h"
+#include "skymapcomposite.h"
+#include "starhopper.h"
+
+
+/******************************************************************************
+ * Times a few standard star hops, at the FOV and magnitude limit used by
+ * SkyMap, once with an empty neighbour graph and once with the graph left by
+ * the first search. Both searches must find the same, non empty path. The
+ * catalogs are loaded first, as for kstars --dump.
+ *****************************************************************************/
+
+static const char * const hops[][2] = {
+    { "Polaris", "M 81" },
+    { "Kaus Australis", "M 17" },
+    { "Alkaid", "M 101" }
+};
+
+int main( int argc, char **argv ) {
+    KAboutData aboutData( "kstars", 0, ki18n( "KStars" ), "test" );
+    KCmdLineArgs::init( argc, argv, &aboutData );
+    KApplication a;
+
+    KStarsData *data = KStarsData::Create();
+    data->initialize();
+
+    const float fov = 1.0;
+    const float maglim = 9.0;
+    int errors = 0;
+
+    StarHopper hopper;
+    for( unsigned int i = 0; i < sizeof( hops ) / sizeof( hops[0] ); ++i ) {
+        SkyObject *src = data->skyComposite()->findByName( hops[i][0] );
+        SkyObject *dest = data->skyComposite()->findByName( hops[i][1] );
+        if( !src || !dest ) {
+            printf( "%s -> %s: not found\n", hops[i][0], hops[i][1] );
+            ++errors;
+            continue;
+        }
+
+        QTime t;
+        StarHopper::clearCache();
+        t.start();
+        QList<const StarObject *> cold = hopper.computePath( *src, *dest, fov, maglim );
+        int coldTime = t.elapsed();
+
+        t.restart();
+        QList<const StarObject *> warm = hopper.computePath( *src, *dest, fov, maglim );
+        int warmTime = t.elapsed();
+
+        bool ok = !cold.isEmpty() && cold == warm;
+        printf( "%s -> %s: %d hops, %d ms cold, %d ms with cached graph%s\n",
+                hops[i][0], hops[i][1], cold.count(), coldTime, warmTime,
+                ok ? "" : ": FAILED" );
+        if( !ok )
+            ++errors;
+    }
+
+    delete data;
+    return errors ? 1 : 0;
+}
@@ -31,6 +31,7 @@
 #include "kstarsdata.h"
 #include "skymap.h"
 #include "ksnumbers.h"
+#include "visibilityengine.h"
 #include "simclock.h"
 #include "dialogs/detaildialog.h"
 #include "dialogs/locationdialog.h"
@@ -253,66 +254,72 @@ void WUTDialog::slotLoadList( const QString &c ) {
     if ( ! isCategoryInitialized(c) ) {
 
         if ( c == m_Categories[0] ) { //Planets
+            QList<SkyObject*> candidates;
             foreach ( const QString &name, data->skyComposite()->objectNames( SkyObject::PLANET ) ) {
                 SkyObject *o = data->skyComposite()->findByName( name );
 
-                if ( checkVisibility( o ) && o->mag() <= m_Mag )
-                    visibleObjects(c).append(o);
+                if ( o->mag() <= m_Mag )
+                    candidates.append(o);
             }
+            visibleObjects(c) = checkVisibility( candidates );
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[1] ) { //Stars
+            QList<SkyObject*> candidates;
             foreach ( SkyObject *o, data->skyComposite()->stars() )
-            if ( o->name() != i18n("star") && checkVisibility(o) && o->mag() <= m_Mag )
-                visibleObjects(c).append(o);
+            if ( o->name() != i18n("star") && o->mag() <= m_Mag )
+                candidates.append(o);
+            visibleObjects(c) = checkVisibility( candidates );
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[5] ) { //Constellations
-            foreach ( SkyObject *o, data->skyComposite()->constellationNames() )
-            if ( checkVisibility(o) )
-                visibleObjects(c).append(o);
+            visibleObjects(c) = checkVisibility( data->skyComposite()->constellationNames() );
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[6] ) { //Asteroids
+            QList<SkyObject*> candidates;
             foreach ( SkyObject *o, data->skyComposite()->asteroids() )
-            if ( checkVisibility(o) && o->name() != i18n("Pluto") && o->mag() <= m_Mag )
-                visibleObjects(c).append(o);
+            if ( o->name() != i18n("Pluto") && o->mag() <= m_Mag )
+                candidates.append(o);
+            visibleObjects(c) = checkVisibility( candidates );
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else if ( c == m_Categories[7] ) { //Comets
-            foreach ( SkyObject *o, data->skyComposite()->comets() )
-            if ( checkVisibility(o) )
-                visibleObjects(c).append(o);
+            visibleObjects(c) = checkVisibility( data->skyComposite()->comets() );
 
             m_CategoryInitialized[ c ] = true;
         }
 
         else { //all deep-sky objects, need to split clusters, nebulae and galaxies
+            QList<SkyObject*> candidates;
             foreach ( DeepSkyObject *dso, data->skyComposite()->deepSkyObjects() ) {
                 SkyObject *o = (SkyObject*)dso;
-                if ( checkVisibility(o) && o->mag() <= m_Mag ) {
-                    switch( o->type() ) {
-                    case SkyObject::OPEN_CLUSTER: //fall through
-                    case SkyObject::GLOBULAR_CLUSTER:
-                        visibleObjects(m_Categories[4]).append(o); //star clusters
-                        break;
-                    case SkyObject::GASEOUS_NEBULA: //fall through
-                    case SkyObject::PLANETARY_NEBULA: //fall through
-                    case SkyObject::SUPERNOVA_REMNANT:
-                        visibleObjects(m_Categories[2]).append(o); //nebulae
-                        break;
-                    case SkyObject::GALAXY:
-                        visibleObjects(m_Categories[3]).append(o); //galaxies
-                        break;
-                    }
+                if ( o->mag() <= m_Mag )
+                    candidates.append(o);
+            }
+
+            foreach ( SkyObject *o, checkVisibility( candidates ) ) {
+                switch( o->type() ) {
+                case SkyObject::OPEN_CLUSTER: //fall through
+                case SkyObject::GLOBULAR_CLUSTER:
+                    visibleObjects(m_Categories[4]).append(o); //star clusters
+                    break;
+                case SkyObject::GASEOUS_NEBULA: //fall through
+                case SkyObject::PLANETARY_NEBULA: //fall through
+                case SkyObject::SUPERNOVA_REMNANT:
+                    visibleObjects(m_Categories[2]).append(o); //nebulae
+                    break;
+                case SkyObject::GALAXY:
+                    visibleObjects(m_Categories[3]).append(o); //galaxies
+                    break;
                 }
             }
 
@@ -335,13 +342,9 @@ void WUTDialog::slotLoadList( const QString &c ) {
     }
 }
 
-bool WUTDialog::checkVisibility(SkyObject *o) {
-    bool visible( false );
+QList<SkyObject*> WUTDialog::checkVisibility( const QList<SkyObject*> &objects ) {
     double minAlt = 6.0; //An object is considered 'visible' if it is above horizon during civil twilight.
 
-    // reject objects that never rise
-    if (o->checkCircumpolar(geo->lat()) == true && o->alt().Degrees() <= 0) return false;
-
     //Initial values for T1, T2 assume all night option of EveningMorningBox
     KStarsDateTime T1 = Evening;
     T1.setTime( sunSetToday );
@@ -355,22 +358,8 @@ bool WUTDialog::checkVisibility(SkyObject *o) {
         T1 = T0; //midnight
     }
 
-    for ( KStarsDateTime test = T1; test < T2; test = test.addSecs(3600) ) {
-        //Need LST of the test time, expressed as a dms object.
-        KStarsDateTime ut = geo->LTtoUT( test );
-        dms LST = geo->GSTtoLST( ut.gst() );
-        SkyPoint sp = o->recomputeCoords( ut, geo );
-
-        //check altitude of object at this time.
-        sp.EquatorialToHorizontal( &LST, geo->lat() );
-
-        if ( sp.alt().Degrees() > minAlt ) {
-            visible = true;
-            break;
-        }
-    }
-
-    return visible;
+    VisibilityEngine engine( geo, geo->LTtoUT( T1 ).djd(), geo->LTtoUT( T2 ).djd(), minAlt );
+    return engine.visibleObjects( objects );
 }
 
 void WUTDialog::slotDisplayObject( const QString &name ) {
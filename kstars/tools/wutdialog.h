@@ -52,11 +52,13 @@ public:
     /**@short Destructor*/
     ~WUTDialog();
 
-    /**@short Check visibility of object
-        *@p o the object to check
-        *@return true if visible
+    /**@short Check visibility of objects
+        *@p objects the objects to check
+        *@return the objects that are above the horizon during the
+        *selected part of the night
+        *@see VisibilityEngine
         */
-    bool checkVisibility(SkyObject *o);
+    QList<SkyObject*> checkVisibility( const QList<SkyObject*> &objects );
 
 public slots:
     /**@short Determine which objects are visible, and store them in
@@ -0,0 +1,272 @@
+/***************************************************************************
+                          visibilityengine.cpp  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#include "visibilityengine.h"
+
+#include <math.h>
+
+#include <QVector>
+#include <QtConcurrentMap>
+
+#include "dms.h"
+#include "geolocation.h"
+#include "ksnumbers.h"
+#include "kstarsdatetime.h"
+#include "skyobjects/skyobject.h"
+
+namespace {
+    // Sidereal time gained per day of UT, in degrees
+    const double SIDEREAL_RATE = 360.98564736629;
+    // Interval between two computed positions of a moving body, in days
+    const double NODE_STEP = 0.25;
+    // Interval between two altitudes of a moving body, in days (ten minutes)
+    const double SAMPLE_STEP = 1.0 / 144.0;
+    // Moving bodies are followed for at least that long, to find their next events
+    const double MIN_MOVING_SPAN = 1.1;
+
+    // Reduces an angle in degrees to [-180, 180)
+    double reduce180( double angle ) {
+        angle = fmod( angle + 180.0, 360.0 );
+        if ( angle < 0.0 )
+            angle += 360.0;
+        return angle - 180.0;
+    }
+
+    // Appends the part of [begin, end] within [start, stop] to the windows, if any
+    void addWindow( ObjectVisibility &v, double begin, double end, double start, double stop ) {
+        begin = qMax( begin, start );
+        end = qMin( end, stop );
+        if ( end > begin )
+            v.windows.append( qMakePair( begin, end ) );
+    }
+
+    // Apparent positions of a moving body at regular nodes, linearly interpolated
+    class Track {
+    public:
+        Track( double startJD, int nNodes ) : ra( nNodes ), dec( nNodes ), m_startJD( startJD ) {}
+
+        void position( double jd, double *r, double *d ) const {
+            double x = ( jd - m_startJD ) / NODE_STEP;
+            int k = qBound( 0, int( x ), ra.size() - 2 );
+            double f = x - k;
+            *r = ra[ k ] + f * ( ra[ k + 1 ] - ra[ k ] );
+            *d = dec[ k ] + f * ( dec[ k + 1 ] - dec[ k ] );
+        }
+
+        QVector<double> ra, dec;   // The RA is unwrapped, so that it can be interpolated
+
+    private:
+        double m_startJD;
+    };
+
+    // Solves the fixed objects for QtConcurrent; moving ones are left for the calling thread
+    struct FixedSolver {
+        typedef ObjectVisibility result_type;
+
+        explicit FixedSolver( const VisibilityEngine *e ) : engine( e ) {}
+
+        ObjectVisibility operator()( SkyObject *o ) const {
+            if ( o->isSolarSystem() ) {
+                ObjectVisibility v;
+                v.object = o;
+                return v;
+            }
+            return engine->fixedVisibility( o );
+        }
+
+        const VisibilityEngine *engine;
+    };
+}
+
+VisibilityEngine::VisibilityEngine( const GeoLocation *geo, double startJD, double stopJD, double minAlt ) :
+    m_geo( geo ),
+    m_startJD( startJD ),
+    m_stopJD( qMax( startJD, stopJD ) ),
+    m_minAlt( minAlt )
+{
+    m_sinMinAlt = sin( minAlt * dms::DegToRad );
+    m_lat = geo->lat()->Degrees();
+    geo->lat()->SinCos( m_sinLat, m_cosLat );
+    m_startLST = geo->GSTtoLST( KStarsDateTime( m_startJD ).gst() ).Degrees();
+
+    // Fixed objects are placed at their apparent position in the middle of the range
+    m_num = new KSNumbers( 0.5 * ( m_startJD + m_stopJD ) );
+}
+
+VisibilityEngine::~VisibilityEngine() {
+    delete m_num;
+}
+
+double VisibilityEngine::lst( double jd ) const {
+    return m_startLST + SIDEREAL_RATE * ( jd - m_startJD );
+}
+
+double VisibilityEngine::altitude( double jd, double ra, double dec ) const {
+    double sinDec, cosDec;
+    sinDec = sin( dec * dms::DegToRad );
+    cosDec = cos( dec * dms::DegToRad );
+    double cosH = cos( ( lst( jd ) - ra ) * dms::DegToRad );
+    return asin( m_sinLat * sinDec + m_cosLat * cosDec * cosH ) / dms::DegToRad;
+}
+
+ObjectVisibility VisibilityEngine::visibility( SkyObject *o ) const {
+    return o->isSolarSystem() ? movingVisibility( o ) : fixedVisibility( o );
+}
+
+QList<ObjectVisibility> VisibilityEngine::visibility( const QList<SkyObject*> &objects ) const {
+    QList<ObjectVisibility> result =
+        QtConcurrent::blockingMapped< QList<ObjectVisibility> >( objects, FixedSolver( this ) );
+
+    for ( int i = 0; i < objects.size(); ++i ) {
+        if ( objects.at( i )->isSolarSystem() )
+            result[ i ] = movingVisibility( objects.at( i ) );
+    }
+    return result;
+}
+
+QList<SkyObject*> VisibilityEngine::visibleObjects( const QList<SkyObject*> &objects ) const {
+    QList<SkyObject*> visible;
+    foreach ( const ObjectVisibility &v, visibility( objects ) ) {
+        if ( v.isVisible() )
+            visible.append( v.object );
+    }
+    return visible;
+}
+
+ObjectVisibility VisibilityEngine::fixedVisibility( SkyObject *o ) const {
+    // Work on a copy of the catalog position, the object itself is shared
+    SkyPoint p( o->ra0(), o->dec0() );
+    p.precessFromAnyEpoch( J2000, m_num->julianDay() );
+    p.nutate( m_num );
+    return solve( o, p.ra().Degrees(), p.dec().Degrees() );
+}
+
+ObjectVisibility VisibilityEngine::solve( SkyObject *o, double ra, double dec ) const {
+    ObjectVisibility v;
+    v.object = o;
+
+    const double period = 360.0 / SIDEREAL_RATE;  // Sidereal day, in days
+
+    // Upper transit nearest to the start
+    double nearestTransit = m_startJD - reduce180( m_startLST - ra ) / SIDEREAL_RATE;
+    v.transitJD = ( nearestTransit < m_startJD ) ? nearestTransit + period : nearestTransit;
+    v.transitAlt = 90.0 - fabs( m_lat - dec );
+
+    // Hour angle where the altitude equals the limit
+    double sinDec = sin( dec * dms::DegToRad );
+    double cosDec = cos( dec * dms::DegToRad );
+    double denom = m_cosLat * cosDec;
+    double cosH0 = ( denom == 0.0 ) ? ( m_sinLat * sinDec > m_sinMinAlt ? -2.0 : 2.0 )
+                                    : ( m_sinMinAlt - m_sinLat * sinDec ) / denom;
+
+    if ( cosH0 <= -1.0 ) {
+        v.alwaysUp = true;
+        v.windows.append( qMakePair( m_startJD, m_stopJD ) );
+        return v;
+    }
+    if ( cosH0 >= 1.0 ) {
+        v.neverUp = true;
+        return v;
+    }
+
+    // Half of the time spent above the limit in a sidereal day
+    double halfWindow = acos( cosH0 ) / dms::DegToRad / SIDEREAL_RATE;
+
+    v.riseJD = nearestTransit - halfWindow;
+    if ( v.riseJD < m_startJD )
+        v.riseJD += period;
+    v.setJD = nearestTransit + halfWindow;
+    if ( v.setJD < m_startJD )
+        v.setJD += period;
+
+    // The window of the transit before the nearest one ends before the start
+    for ( double transit = nearestTransit; transit - halfWindow < m_stopJD; transit += period )
+        addWindow( v, transit - halfWindow, transit + halfWindow, m_startJD, m_stopJD );
+
+    return v;
+}
+
+ObjectVisibility VisibilityEngine::movingVisibility( SkyObject *o ) const {
+    ObjectVisibility v;
+    v.object = o;
+
+    double span = qMax( m_stopJD - m_startJD, MIN_MOVING_SPAN );
+    double endJD = m_startJD + span;
+
+    int nNodes = int( ceil( span / NODE_STEP ) ) + 1;
+    Track track( m_startJD, nNodes );
+    for ( int i = 0; i < nNodes; ++i ) {
+        SkyPoint p = o->recomputeCoords( KStarsDateTime( m_startJD + i * NODE_STEP ), m_geo );
+        double ra = p.ra().Degrees();
+        if ( i > 0 )
+            ra = track.ra[ i - 1 ] + reduce180( ra - track.ra[ i - 1 ] );
+        track.ra[ i ] = ra;
+        track.dec[ i ] = p.dec().Degrees();
+    }
+
+    double ra, dec;
+    track.position( m_startJD, &ra, &dec );
+    double prevJD = m_startJD;
+    double prevAlt = altitude( prevJD, ra, dec );
+    double prevH = reduce180( lst( prevJD ) - ra );
+    bool up = prevAlt > m_minAlt;
+    bool everUp = up, everDown = ! up;
+    double windowStart = m_startJD;
+
+    int nSamples = int( ceil( span / SAMPLE_STEP ) ) + 1;
+    for ( int i = 1; i < nSamples; ++i ) {
+        double jd = qMin( m_startJD + i * SAMPLE_STEP, endJD );
+        track.position( jd, &ra, &dec );
+        double alt = altitude( jd, ra, dec );
+        double H = reduce180( lst( jd ) - ra );
+
+        // Upper transit: the hour angle goes through zero (not through 180 degrees)
+        if ( v.transitJD == 0.0 && prevH < 0.0 && H >= 0.0 ) {
+            v.transitJD = prevJD + ( jd - prevJD ) * ( -prevH / ( H - prevH ) );
+            double tra, tdec;
+            track.position( v.transitJD, &tra, &tdec );
+            v.transitAlt = altitude( v.transitJD, tra, tdec );
+        }
+
+        bool nowUp = alt > m_minAlt;
+        if ( nowUp != up ) {
+            double crossing = prevJD + ( jd - prevJD ) * ( m_minAlt - prevAlt ) / ( alt - prevAlt );
+            if ( nowUp ) {
+                if ( v.riseJD == 0.0 )
+                    v.riseJD = crossing;
+                windowStart = crossing;
+            } else {
+                if ( v.setJD == 0.0 )
+                    v.setJD = crossing;
+                addWindow( v, windowStart, crossing, m_startJD, m_stopJD );
+            }
+            up = nowUp;
+        }
+        everUp = everUp || nowUp;
+        everDown = everDown || ! nowUp;
+
+        prevJD = jd;
+        prevAlt = alt;
+        prevH = H;
+    }
+    if ( up )
+        addWindow( v, windowStart, endJD, m_startJD, m_stopJD );
+
+    v.alwaysUp = ! everDown;
+    v.neverUp = ! everUp;
+    return v;
+}
@@ -0,0 +1,126 @@
+/***************************************************************************
+                          visibilityengine.h  -  K Desktop Planetarium
+                             -------------------
+    begin                : Sat 17 Oct 2026
+    copyright            : (C) 2026 by KStars Developers
+    email                : kstars-devel@kde.org
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef VISIBILITYENGINE_H
+#define VISIBILITYENGINE_H
+
+#include <QList>
+#include <QPair>
+
+class GeoLocation;
+class KSNumbers;
+class SkyObject;
+
+/**
+    *@class ObjectVisibility
+    *When an object is above an altitude limit, as found by VisibilityEngine.
+    *All the times are Julian days (UT).
+    *@author KStars Developers
+    *@version 1.0
+    */
+class ObjectVisibility
+{
+public:
+    ObjectVisibility() : object( 0 ), riseJD( 0. ), transitJD( 0. ), setJD( 0. ), transitAlt( 0. ),
+                         alwaysUp( false ), neverUp( false ) {}
+
+    /** @return true if the object is above the altitude limit at some time of the range */
+    inline bool isVisible() const { return ! windows.isEmpty(); }
+
+    SkyObject *object;
+    double riseJD;              // First time after the start the object climbs above the limit, 0 if it never does
+    double transitJD;           // First upper transit after the start
+    double setJD;               // First time after the start the object sinks below the limit, 0 if it never does
+    double transitAlt;          // Altitude at that transit (degrees)
+    bool alwaysUp;              // The object never goes below the limit
+    bool neverUp;               // The object never gets above the limit
+    QList< QPair<double, double> > windows; // Parts of the time range where the object is above the limit
+};
+
+/**
+    *@class VisibilityEngine
+    *Finds when objects are above an altitude limit, for a location and a
+    *time range.
+    *
+    *For objects fixed on the sky, the hour angle where the altitude equals
+    *the limit is solved from the declination and the latitude, so no
+    *altitude is ever sampled. Solar system bodies are moving, so their
+    *coordinates are computed every few hours and interpolated, and the
+    *altitude crossings are found on the interpolated track.
+    *
+    *Fixed objects are processed in parallel. Moving bodies are processed in
+    *the calling thread, because computing their position changes them.
+    *@author KStars Developers
+    *@version 1.0
+    */
+class VisibilityEngine
+{
+public:
+    /**
+     *@short Constructor
+     *@param geo the location of the observer
+     *@param startJD start of the time range (UT)
+     *@param stopJD end of the time range (UT)
+     *@param minAlt the altitude limit, in degrees
+     */
+    VisibilityEngine( const GeoLocation *geo, double startJD, double stopJD, double minAlt = 0.0 );
+
+    ~VisibilityEngine();
+
+    /**
+     *@return when the object is above the altitude limit
+     */
+    ObjectVisibility visibility( SkyObject *o ) const;
+
+    /**
+     *@return the visibility of each object, in the same order.
+     *Fixed objects are processed in parallel.
+     */
+    QList<ObjectVisibility> visibility( const QList<SkyObject*> &objects ) const;
+
+    /**
+     *@return the objects which are above the altitude limit at some time of the range
+     */
+    QList<SkyObject*> visibleObjects( const QList<SkyObject*> &objects ) const;
+
+    /**
+     *@return the visibility of an object fixed on the sky. Thread safe.
+     */
+    ObjectVisibility fixedVisibility( SkyObject *o ) const;
+
+private:
+    /** @return the visibility of a point with the apparent coordinates ra, dec (degrees) */
+    ObjectVisibility solve( SkyObject *o, double ra, double dec ) const;
+
+    /** @return the visibility of a solar system body */
+    ObjectVisibility movingVisibility( SkyObject *o ) const;
+
+    /** @return the altitude in degrees of the point ra, dec (degrees) at time jd */
+    double altitude( double jd, double ra, double dec ) const;
+
+    /** @return the local sidereal time at jd, in degrees */
+    inline double lst( double jd ) const;
+
+    const GeoLocation *m_geo;
+    double m_startJD, m_stopJD;
+    double m_minAlt, m_sinMinAlt;
+    double m_lat, m_sinLat, m_cosLat;
+    double m_startLST;
+    KSNumbers *m_num;
+};
+
+#endif